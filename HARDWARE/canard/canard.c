@@ -27,6 +27,13 @@
 #include "canard_internals.h"
 #include <string.h>
 
+#if CANARD_ENABLE_FLOAT16 && (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_SSE2)
+# include <emmintrin.h>
+#endif
+#if CANARD_ENABLE_FLOAT16 && (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_F16C)
+# include <immintrin.h>
+#endif
+
 
 #undef MIN
 #undef MAX
@@ -59,16 +66,95 @@
 #define TOGGLE_BIT(x)                               ((bool)(((uint32_t)(x) >> 5U) & 0x1U))
 
 
-struct CanardTxQueueItem
+#if CANARD_ENABLE_STATIC_CAPACITY
+CANARD_STATIC_ASSERT(sizeof(CanardTxQueueItem) <= CANARD_MEM_BLOCK_SIZE, "TX queue item must fit into a slot");
+#endif
+
+#if CANARD_ENABLE_CONCURRENCY
+# define LOCK_ALLOCATOR(a)      do { } while (__atomic_test_and_set(&(a)->lock, __ATOMIC_ACQUIRE))
+# define UNLOCK_ALLOCATOR(a)    __atomic_clear(&(a)->lock, __ATOMIC_RELEASE)
+#else
+# define LOCK_ALLOCATOR(a)      ((void)(a))
+# define UNLOCK_ALLOCATOR(a)    ((void)(a))
+#endif
+
+#if CANARD_ENABLE_TRACE
+# define TRACE_FRAME(event, detail, frame)          canardTraceRecord((uint8_t)(event), (uint8_t)(detail), (frame))
+# define TRACE_TX_OUT_OF_MEMORY(can_id, tid)        traceTxOutOfMemory((can_id), (tid))
+# define TRACE_ENTRY_SIZE                           (12U + (CANARD_TRACE_FRAME_DATA ? 8U : 0U))
+# define TRACE_DUMP_HEADER_SIZE                     16U
+
+/// The trace is shared by all instances, so that the drivers can record into it without one
+static struct
 {
-    CanardTxQueueItem* next;
-    CanardCANFrame frame;
-};
+    CanardTraceEntry entries[CANARD_TRACE_CAPACITY];
+    uint32_t head;                                  ///< Events recorded since the reset, wraps around
+    uint32_t tail;                                  ///< Events read or lost since the reset, wraps around
+    uint32_t lost;                                  ///< Events lost since they were last reported
+} g_trace;
+#else
+# define TRACE_FRAME(event, detail, frame)          ((void)0)
+# define TRACE_TX_OUT_OF_MEMORY(can_id, tid)        ((void)0)
+#endif
+
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+# define LATENCY_RX_FRAME()             (g_latency.rx_arrived_at = CANARD_LATENCY_TIMESTAMP())
+# define LATENCY_RX_TRANSFER()          canardLatencyRecord(CanardLatencyPathRx,                                 \
+                                                            CANARD_LATENCY_TIMESTAMP() - g_latency.rx_arrived_at)
+# define LATENCY_TX_ENQUEUE(item)       ((item)->enqueued_at = CANARD_LATENCY_TIMESTAMP())
+# define LATENCY_TX_POP(item)           canardLatencyRecord(CanardLatencyPathTxQueue,                            \
+                                                            CANARD_LATENCY_TIMESTAMP() - (item)->enqueued_at)
+
+typedef struct
+{
+    uint32_t buckets[CANARD_LATENCY_NUM_BUCKETS];   ///< See getLatencyBucket()
+    uint32_t count;
+    uint32_t max;
+} CanardLatencyHistogram;
+
+/// Shared by all instances like the trace; the RX path is handled by one context at a time
+static struct
+{
+    CanardLatencyHistogram histograms[CANARD_LATENCY_NUM_PATHS];
+    uint32_t rx_arrived_at;                         ///< When the frame being handled was given to the library
+} g_latency;
+#else
+# define LATENCY_RX_FRAME()             ((void)0)
+# define LATENCY_RX_TRANSFER()          ((void)0)
+# define LATENCY_TX_ENQUEUE(item)       ((void)0)
+# define LATENCY_TX_POP(item)           ((void)0)
+#endif
+
+#if CANARD_ENABLE_PROFILING
+/// Shared by all instances like the latency histograms
+static CanardProfStatistics g_prof[CANARD_PROF_NUM_SITES];
+#endif
+
+// The multi-node host accounts the frames of its bus instance itself, as looped back and local frames never reach
+// the wire
+#if CANARD_ENABLE_BUSLOAD && CANARD_ENABLE_MULTINODE
+# define BUSLOAD_TX_FRAME(ins, frame)                                                       \
+    do { if (!isMultiNodeHostBus(ins)) { accountBusLoad(&(ins)->busload, (frame), true); } } while (0)
+# define BUSLOAD_RX_FRAME(ins, frame, timestamp_usec)                                       \
+    do { if (!isMultiNodeHostBus(ins)) { accountRxBusLoad(&(ins)->busload, (frame), (timestamp_usec)); } } while (0)
+#elif CANARD_ENABLE_BUSLOAD
+# define BUSLOAD_TX_FRAME(ins, frame)                   accountBusLoad(&(ins)->busload, (frame), true)
+# define BUSLOAD_RX_FRAME(ins, frame, timestamp_usec)   accountRxBusLoad(&(ins)->busload, (frame), (timestamp_usec))
+#else
+# define BUSLOAD_TX_FRAME(ins, frame)                   ((void)0)
+# define BUSLOAD_RX_FRAME(ins, frame, timestamp_usec)   ((void)0)
+#endif
+
+#define CAN_CRC_POLYNOMIAL                          0x4599U
+#define CAN_STUFF_RUN_LENGTH                        5U
+#define BUSLOAD_KEY_USED                            0x20000UL  ///< Bus load data type key: entry in use
+#define BUSLOAD_KEY_SERVICE                         0x10000UL  ///< Bus load data type key: service data type
 
 
 /*
  * API functions
  */
+#if !CANARD_ENABLE_STATIC_CAPACITY
 void canardInit(CanardInstance* out_ins,
                 void* mem_arena,
                 size_t mem_arena_size,
@@ -103,6 +189,51 @@ void canardInit(CanardInstance* out_ins,
 
     initPoolAllocator(&out_ins->allocator, mem_arena, (uint16_t)pool_capacity);
 }
+#else
+void canardInitStatic(CanardInstance* out_ins,
+                      CanardStaticSubscription* subscriptions,
+                      uint8_t num_subscriptions,
+                      CanardStaticPublisher* publishers,
+                      uint8_t num_publishers,
+                      CanardOnTransferReception on_reception,
+                      CanardShouldAcceptTransfer should_accept,
+                      void* user_reference)
+{
+    CANARD_ASSERT(out_ins != NULL);
+    CANARD_ASSERT((subscriptions != NULL) || (num_subscriptions == 0));
+    CANARD_ASSERT((publishers != NULL) || (num_publishers == 0));
+
+    memset(out_ins, 0, sizeof(*out_ins));
+
+    out_ins->node_id = CANARD_BROADCAST_NODE_ID;
+    out_ins->on_reception = on_reception;
+    out_ins->should_accept = should_accept;
+    out_ins->subscriptions = subscriptions;
+    out_ins->num_subscriptions = num_subscriptions;
+    out_ins->publishers = publishers;
+    out_ins->num_publishers = num_publishers;
+    out_ins->tx_queue = NULL;
+    out_ins->user_reference = user_reference;
+
+    for (uint8_t i = 0; i < num_subscriptions; i++)
+    {
+        for (uint8_t k = 0; k < subscriptions[i].max_sessions; k++)
+        {
+            subscriptions[i].sessions[k].dtid_tt_snid_dnid = CANARD_STATIC_SESSION_FREE;
+        }
+        subscriptions[i].peak_sessions = 0;
+        subscriptions[i].rejected_transfers = 0;
+    }
+
+    for (uint8_t i = 0; i < num_publishers; i++)
+    {
+        CANARD_ASSERT(publishers[i].num_slots <= 32U);     // Slot usage is tracked in a 32-bit mask
+        publishers[i].used_slots = 0;
+        publishers[i].peak_used_slots = 0;
+        publishers[i].rejected_transfers = 0;
+    }
+}
+#endif
 
 void* canardGetUserReference(CanardInstance* ins)
 {
@@ -155,12 +286,14 @@ int16_t canardBroadcast(CanardInstance* ins,
     {
         return -CANARD_ERROR_INVALID_ARGUMENT;
     }
+    CANARD_PROF_BEGIN(CanardProfSiteTxTransfer);
 
     uint32_t can_id = 0;
     uint16_t crc = 0xFFFFU;
 
     if (canardGetLocalNodeID(ins) == 0)
     {
+#if CANARD_ENABLE_ANONYMOUS
         if (payload_len > 7)
         {
             return -CANARD_ERROR_NODE_ID_NOT_SET;// 没有设置CANID
@@ -177,19 +310,27 @@ int16_t canardBroadcast(CanardInstance* ins,
         const uint16_t discriminator = (uint16_t)((crcAdd(0xFFFFU, payload, payload_len)) & 0x7FFEU);
         can_id = ((uint32_t) priority << 24U) | ((uint32_t) discriminator << 9U) |
                  ((uint32_t) (data_type_id & DTIDMask) << 8U) | (uint32_t) canardGetLocalNodeID(ins);
+#else
+        return -CANARD_ERROR_NODE_ID_NOT_SET;   // Anonymous transfers are disabled, see canard_config.h
+#endif
     }
     else
     {
         can_id = ((uint32_t) priority << 24U) | ((uint32_t) data_type_id << 8U) | (uint32_t) canardGetLocalNodeID(ins);
 
+#if CANARD_ENABLE_MULTI_FRAME_TX
         if (payload_len > 7)
         {
             crc = crcAddSignature(crc, data_type_signature);
             crc = crcAdd(crc, payload, payload_len);
         }
+#else
+        (void) data_type_signature;
+#endif
     }
 
     const int16_t result = enqueueTxFrames(ins, can_id, inout_transfer_id, crc, payload, payload_len);
+    CANARD_PROF_END(CanardProfSiteTxTransfer);
 
     incrementTransferID(inout_transfer_id);//传输ID值++，单帧传输用不着
 
@@ -203,31 +344,14 @@ int16_t singleCanardBroadcast(CanardInstance* ins,
                         const void* payload,            // 有效数据内容
                         uint16_t payload_len)           // 传输数据长度（byte）
 {
-    if (payload == NULL && payload_len > 0)
-    {
-        return -CANARD_ERROR_INVALID_ARGUMENT;
-    }
-    if (priority > CANARD_TRANSFER_PRIORITY_LOWEST)
+    if ((canardGetLocalNodeID(ins) == 0) ||                     // 暂时不需要匿名帧
+        (payload_len >= CANARD_CAN_FRAME_MAX_DATA_LEN))         // Must fit into one frame together with the tail byte
     {
         return -CANARD_ERROR_INVALID_ARGUMENT;
     }
 
-    uint32_t can_id = 0;
-
-    if (canardGetLocalNodeID(ins) == 0) // return ins->node_id;判断该帧是否是匿名帧
-    {
-        return -CANARD_ERROR_INVALID_ARGUMENT;//暂时不需要匿名帧，后期有时间再添加
-    }
-    else
-    {   /// 优先级 << 24 + 消息类型ID << 8 + isServiceMessage << 7 + SourceNodeID[bit 6 - 0]
-        can_id = ((uint32_t) priority << 24U) | ((uint32_t) data_type_id << 8U) | (uint32_t) canardGetLocalNodeID(ins);//( 0 - 127 )
-    }
-
-    const int16_t result = singleEnqueueTxFrames(ins, can_id, inout_transfer_id, payload, payload_len);
-
-    incrementTransferID(inout_transfer_id);//传输ID值++，单帧传输用不着
-
-    return result;
+    // The data type signature is used only for the CRC of multi-frame transfers
+    return canardBroadcast(ins, 0, data_type_id, inout_transfer_id, priority, payload, payload_len);
 }
 
 
@@ -253,21 +377,36 @@ int16_t canardRequestOrRespond(CanardInstance* ins,
     {
         return -CANARD_ERROR_NODE_ID_NOT_SET;
     }
+#if CANARD_ENABLE_SERVICE_CLIENT
+    const bool is_request = (kind == CanardRequest);
+#else
+    if (kind == CanardRequest)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;     // Service client is disabled, see canard_config.h
+    }
+    const bool is_request = false;                  // Lets the compiler drop the request-only code below
+#endif
+    CANARD_PROF_BEGIN(CanardProfSiteTxTransfer);
 
     const uint32_t can_id = ((uint32_t) priority << 24U) | ((uint32_t) data_type_id << 16U) |
-                            ((uint32_t) kind << 15U) | ((uint32_t) destination_node_id << 8U) |
+                            ((uint32_t) is_request << 15U) | ((uint32_t) destination_node_id << 8U) |
                             (1U << 7U) | (uint32_t) canardGetLocalNodeID(ins);
     uint16_t crc = 0xFFFFU;
 
+#if CANARD_ENABLE_MULTI_FRAME_TX
     if (payload_len > 7)
     {
         crc = crcAddSignature(crc, data_type_signature);
         crc = crcAdd(crc, payload, payload_len);
     }
+#else
+    (void) data_type_signature;
+#endif
 
     const int16_t result = enqueueTxFrames(ins, can_id, inout_transfer_id, crc, payload, payload_len);
+    CANARD_PROF_END(CanardProfSiteTxTransfer);
 
-    if (kind == CanardRequest)                      // Response Transfer ID must not be altered
+    if (is_request)                                 // Response Transfer ID must not be altered
     {
         incrementTransferID(inout_transfer_id);
     }
@@ -275,8 +414,313 @@ int16_t canardRequestOrRespond(CanardInstance* ins,
     return result;
 }
 
+int16_t canardBeginBroadcast(CanardInstance* ins,
+                             CanardBitWriter* out_writer,
+                             uint64_t data_type_signature,
+                             uint16_t data_type_id,
+                             uint8_t* inout_transfer_id,
+                             uint8_t priority)
+{
+    if (priority > CANARD_TRANSFER_PRIORITY_LOWEST)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (canardGetLocalNodeID(ins) == 0)
+    {
+#if CANARD_ENABLE_ANONYMOUS
+        static const uint16_t DTIDMask = (1U << ANON_MSG_DATA_TYPE_ID_BIT_LEN) - 1U;
+
+        if ((data_type_id & DTIDMask) != data_type_id)
+        {
+            return -CANARD_ERROR_INVALID_ARGUMENT;
+        }
+
+        // The discriminator is added once the payload is known, see canardFinishTransfer()
+        const uint32_t can_id = ((uint32_t) priority << 24U) | ((uint32_t) data_type_id << 8U);
+        return beginTransfer(ins, out_writer, can_id, data_type_signature, inout_transfer_id, true, true);
+#else
+        return -CANARD_ERROR_NODE_ID_NOT_SET;   // Anonymous transfers are disabled, see canard_config.h
+#endif
+    }
+
+    const uint32_t can_id = ((uint32_t) priority << 24U) | ((uint32_t) data_type_id << 8U) |
+                            (uint32_t) canardGetLocalNodeID(ins);
+    return beginTransfer(ins, out_writer, can_id, data_type_signature, inout_transfer_id, false, true);
+}
+
+int16_t canardBeginRequestOrRespond(CanardInstance* ins,
+                                    CanardBitWriter* out_writer,
+                                    uint8_t destination_node_id,
+                                    uint64_t data_type_signature,
+                                    uint8_t data_type_id,
+                                    uint8_t* inout_transfer_id,
+                                    uint8_t priority,
+                                    CanardRequestResponse kind)
+{
+    if (priority > CANARD_TRANSFER_PRIORITY_LOWEST)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+    if (canardGetLocalNodeID(ins) == 0)
+    {
+        return -CANARD_ERROR_NODE_ID_NOT_SET;
+    }
+#if CANARD_ENABLE_SERVICE_CLIENT
+    const bool is_request = (kind == CanardRequest);
+#else
+    if (kind == CanardRequest)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;     // Service client is disabled, see canard_config.h
+    }
+    const bool is_request = false;                  // Lets the compiler drop the request-only code below
+#endif
+
+    const uint32_t can_id = ((uint32_t) priority << 24U) | ((uint32_t) data_type_id << 16U) |
+                            ((uint32_t) is_request << 15U) | ((uint32_t) destination_node_id << 8U) |
+                            (1U << 7U) | (uint32_t) canardGetLocalNodeID(ins);
+
+    // Response Transfer ID must not be altered
+    return beginTransfer(ins, out_writer, can_id, data_type_signature, inout_transfer_id, false, is_request);
+}
+
+void canardWriteScalar(CanardBitWriter* writer,
+                       uint8_t bit_length,
+                       const void* value)
+{
+    CANARD_ASSERT(writer != NULL);
+    CANARD_ASSERT(value != NULL);
+
+    if ((bit_length < 1) || (bit_length > 64))
+    {
+        CANARD_ASSERT(false);
+        return;
+    }
+
+    putWriterBits(writer, scalarToStreamBits(loadArrayElement(value, bit_length), bit_length), bit_length);
+}
+
+void canardWriteArray(CanardBitWriter* writer,
+                      uint8_t bit_length,
+                      uint16_t count,
+                      const void* values)
+{
+    CANARD_ASSERT(writer != NULL);
+    CANARD_ASSERT((values != NULL) || (count == 0));
+
+    if ((bit_length < 1) || (bit_length > 64))
+    {
+        CANARD_ASSERT(false);
+        return;
+    }
+
+    const uint8_t* const input = (const uint8_t*) values;
+    const uint8_t element_size = getArrayElementSize(bit_length);
+
+    if ((writer->pending_bits == 0U) && (element_size * 8U == bit_length) && !isBigEndian())
+    {
+        // Byte-aligned 8, 16, 32 or 64 bit values are stored as they are laid out in memory
+        const uint32_t size = (uint32_t) count * element_size;
+        for (uint32_t i = 0; i < size; i++)
+        {
+            putWriterByte(writer, input[i]);
+        }
+        return;
+    }
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const uint64_t value = loadArrayElement(&input[(uint32_t) i * element_size], bit_length);
+        putWriterBits(writer, scalarToStreamBits(value, bit_length), bit_length);
+    }
+}
+
+#if CANARD_ENABLE_FLOAT16
+void canardWriteFloat16Array(CanardBitWriter* writer,
+                             uint16_t count,
+                             const float* values)
+{
+    CANARD_ASSERT(writer != NULL);
+    CANARD_ASSERT((values != NULL) || (count == 0));
+
+    uint16_t raw[32];
+    uint16_t done = 0;
+    while (done < count)
+    {
+        const uint16_t amount = (uint16_t)MIN((uint32_t)(count - done), sizeof(raw) / sizeof(raw[0]));
+        canardConvertNativeFloatArrayToFloat16(&values[done], raw, amount);
+        for (uint16_t i = 0; i < amount; i++)
+        {
+            putWriterBits(writer, scalarToStreamBits(raw[i], 16), 16);
+        }
+        done = (uint16_t)(done + amount);
+    }
+}
+#endif
+
+void canardWritePadding(CanardBitWriter* writer,
+                        uint16_t bit_length)
+{
+    CANARD_ASSERT(writer != NULL);
+
+    while (bit_length > 0)
+    {
+        const uint8_t amount = (uint8_t) MIN(bit_length, 64U);
+        putWriterBits(writer, 0, amount);
+        bit_length = (uint16_t)(bit_length - amount);
+    }
+}
+
+int16_t canardFinishTransfer(CanardBitWriter* writer)
+{
+    CANARD_ASSERT(writer != NULL);
+
+    if (writer->pending_bits > 0U)
+    {
+        putWriterByte(writer, (uint8_t)((uint32_t) writer->pending_byte << (8U - writer->pending_bits)));
+    }
+    if ((writer->error == 0) && (writer->first_frame == NULL))
+    {
+        (void) allocateWriterFrame(writer);                 // Empty payload, still one frame for the tail byte
+    }
+
+    const uint8_t transfer_id = *writer->inout_transfer_id;
+    if (writer->increment_transfer_id)
+    {
+        incrementTransferID(writer->inout_transfer_id);     // Consumed even if the transfer is dropped below
+    }
+
+    if (writer->error != 0)
+    {
+#if CANARD_ENABLE_STATIC_CAPACITY
+        if (writer->error == -CANARD_ERROR_OUT_OF_MEMORY)
+        {
+            writer->publisher->rejected_transfers++;
+        }
+#endif
+        if (writer->error == -CANARD_ERROR_OUT_OF_MEMORY)
+        {
+            TRACE_TX_OUT_OF_MEMORY(writer->can_id, transfer_id);
+        }
+        const int16_t error = writer->error;
+        releaseWriterFrames(writer);
+        return error;
+    }
+
+    CanardTxQueueItem* const last = writer->last_frame;
+    uint32_t can_id = writer->can_id;
+
+    if (writer->num_frames == 1U)
+    {
+#if CANARD_ENABLE_ANONYMOUS
+        if (writer->anonymous)
+        {
+            const uint16_t discriminator = (uint16_t)(crcAdd(0xFFFFU, last->frame.data, writer->frame_len) & 0x7FFEU);
+            can_id |= (uint32_t) discriminator << 9U;
+        }
+#endif
+        last->frame.data[writer->frame_len] = (uint8_t)(0xC0U | (transfer_id & 31U));
+    }
+    else
+    {
+#if CANARD_ENABLE_MULTI_FRAME_TX
+        writer->first_frame->frame.data[0] = (uint8_t) (writer->crc);
+        writer->first_frame->frame.data[1] = (uint8_t) (writer->crc >> 8U);
+#endif
+        const uint32_t toggle = (uint32_t)(writer->num_frames - 1U) & 1U;
+        last->frame.data[writer->frame_len] = (uint8_t)(0x40U | (toggle << 5U) | (transfer_id & 31U));
+    }
+    last->frame.data_len = (uint8_t)(writer->frame_len + 1U);
+
+#if CANARD_ENABLE_STATIC_CAPACITY
+    writer->publisher->peak_used_slots = (uint8_t) MAX(writer->publisher->peak_used_slots,
+                                                       countUsedStaticTxSlots(writer->publisher));
+#endif
+
+    // The frames are published in order, so frames of equal CAN ID keep their order in the TX queue
+#if CANARD_ENABLE_CONCURRENCY
+    CanardTxQueueItem* newest = NULL;
+#endif
+    CanardTxQueueItem* item = writer->first_frame;
+    while (item != NULL)
+    {
+        CanardTxQueueItem* const next = item->next;
+        item->frame.id = can_id | CANARD_CAN_FRAME_EFF;
+#if CANARD_ENABLE_CONCURRENCY
+        item->next = newest;
+        newest = item;
+#else
+        item->next = NULL;
+        pushTxQueue(writer->ins, item);
+#endif
+        item = next;
+    }
+#if CANARD_ENABLE_CONCURRENCY
+    submitTxChain(writer->ins, newest, writer->first_frame);
+#endif
+
+    const int16_t result = writer->num_frames;
+    writer->first_frame = NULL;
+    writer->last_frame = NULL;
+    return result;
+}
+
+void canardAbortTransfer(CanardBitWriter* writer)
+{
+    CANARD_ASSERT(writer != NULL);
+    releaseWriterFrames(writer);
+}
+
+int16_t canardBroadcastPrebuilt(CanardInstance* ins,
+                                const CanardPrebuiltTransfer* transfer,
+                                uint8_t* inout_transfer_id,
+                                uint8_t priority,
+                                const void* variable_bytes)
+{
+    if (transfer == NULL)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    CanardBitWriter writer;
+    const int16_t result = canardBeginBroadcast(ins, &writer, 0, transfer->data_type_id, inout_transfer_id, priority);
+    if (result < 0)
+    {
+        return result;
+    }
+    return finishPrebuiltTransfer(&writer, transfer, (const uint8_t*) variable_bytes);
+}
+
+int16_t canardRequestOrRespondPrebuilt(CanardInstance* ins,
+                                       uint8_t destination_node_id,
+                                       const CanardPrebuiltTransfer* transfer,
+                                       uint8_t* inout_transfer_id,
+                                       uint8_t priority,
+                                       CanardRequestResponse kind,
+                                       const void* variable_bytes)
+{
+    if ((transfer == NULL) || (transfer->data_type_id > 0xFFU))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    CanardBitWriter writer;
+    const int16_t result = canardBeginRequestOrRespond(ins, &writer, destination_node_id, 0,
+                                                       (uint8_t) transfer->data_type_id, inout_transfer_id,
+                                                       priority, kind);
+    if (result < 0)
+    {
+        return result;
+    }
+    return finishPrebuiltTransfer(&writer, transfer, (const uint8_t*) variable_bytes);
+}
+
 const CanardCANFrame* canardPeekTxQueue(const CanardInstance* ins)
 {
+#if CANARD_ENABLE_CONCURRENCY
+    // The TX queue is owned by the calling (TX) thread, so it can be updated here despite the const qualifier.
+    drainTxSubmissions((CanardInstance*) ins);
+#endif
     if (ins->tx_queue == NULL)
     {
         return NULL;
@@ -288,10 +732,27 @@ void canardPopTxQueue(CanardInstance* ins)
 {
     CanardTxQueueItem* item = ins->tx_queue;
     ins->tx_queue = item->next;
-    freeBlock(&ins->allocator, item);
+    BUSLOAD_TX_FRAME(ins, &item->frame);
+    LATENCY_TX_POP(item);
+#if CANARD_ENABLE_STATIC_CAPACITY
+    releaseStaticTxSlot(ins, item);
+#else
+    freeBlock(&ins->allocator, CanardPoolOwnerTxFrame, item);
+#endif
+}
+
+#if CANARD_ENABLE_PROFILING
+void canardHandleRxFrame(CanardInstance* ins, const CanardCANFrame* frame, uint64_t timestamp_usec)
+{
+    CANARD_PROF_BEGIN(CanardProfSiteHandleRxFrame);
+    handleRxFrame(ins, frame, timestamp_usec);
+    CANARD_PROF_END(CanardProfSiteHandleRxFrame);
 }
 
+CANARD_INTERNAL void handleRxFrame(CanardInstance* ins, const CanardCANFrame* frame, uint64_t timestamp_usec)
+#else
 void canardHandleRxFrame(CanardInstance* ins, const CanardCANFrame* frame, uint64_t timestamp_usec)
+#endif
 {
     const CanardTransferType transfer_type = extractTransferType(frame->id);    ///<判断帧类型
     const uint8_t destination_node_id = (transfer_type == CanardTransferTypeBroadcast) ?
@@ -299,18 +760,37 @@ void canardHandleRxFrame(CanardInstance* ins, const CanardCANFrame* frame, uint6
                                         DEST_ID_FROM_ID(frame->id);
 
     // TODO: This function should maintain statistics of transfer errors and such.此函数应维护传输错误等的统计信息。
+    TRACE_FRAME(CanardTraceEventRxFrame, 0, frame);
+    BUSLOAD_RX_FRAME(ins, frame, timestamp_usec);
+    LATENCY_RX_FRAME();
 
     if ((frame->id & CANARD_CAN_FRAME_EFF) == 0 ||
         (frame->id & CANARD_CAN_FRAME_RTR) != 0 ||
         (frame->id & CANARD_CAN_FRAME_ERR) != 0 ||
         (frame->data_len < 1))//扩展帧、远程帧、错误帧
     {
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropNotUavcan, frame);
         return;     // Unsupported frame, not UAVCAN - ignore uavcan不支持的类型
     }
 
+#if CANARD_ENABLE_MULTINODE
+    if (isMultiNodeHostBus(ins))
+    {
+        // The host accepts services addressed to any of its nodes; the callbacks pick the node by this field
+        if (transfer_type != CanardTransferTypeBroadcast &&
+            ins->host->nodes[destination_node_id] == NULL)
+        {
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropAddressMismatch, frame);
+            return;     // Address mismatch
+        }
+        ins->host->rx_destination_node_id = destination_node_id;
+    }
+    else
+#endif
     if (transfer_type != CanardTransferTypeBroadcast &&
         destination_node_id != canardGetLocalNodeID(ins))
     {
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropAddressMismatch, frame);
         return;     // Address mismatch 地址不匹配
     }
 
@@ -322,6 +802,39 @@ void canardHandleRxFrame(CanardInstance* ins, const CanardCANFrame* frame, uint6
 
     const uint8_t tail_byte = frame->data[frame->data_len - 1];// 尾帧数据，用来判断传输情况和源ID
 
+#if !CANARD_ENABLE_MULTI_FRAME_RX
+    if (!IS_START_OF_TRANSFER(tail_byte) || !IS_END_OF_TRANSFER(tail_byte))
+    {
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropDisabledFeature, frame);
+        return;     // Multi-frame reception is disabled, see canard_config.h
+    }
+#endif
+#if !CANARD_ENABLE_ANONYMOUS
+    if (source_node_id == CANARD_BROADCAST_NODE_ID)
+    {
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropDisabledFeature, frame);
+        return;     // Anonymous transfers are disabled
+    }
+#endif
+#if !CANARD_ENABLE_SERVICE_CLIENT
+    if (transfer_type == CanardTransferTypeResponse)
+    {
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropDisabledFeature, frame);
+        return;     // Service client is disabled, so no responses are expected
+    }
+#endif
+
+#if CANARD_ENABLE_STATIC_CAPACITY
+    const CanardRxTransfer transfer_header = {
+        .timestamp_usec = timestamp_usec,
+        .data_type_id = data_type_id,
+        .transfer_type = transfer_type,
+        .transfer_id = TRANSFER_ID_FROM_TAIL_BYTE(tail_byte),
+        .priority = priority,
+        .source_node_id = source_node_id
+    };
+    handleStaticRxFrame(ins, frame, transfer_descriptor, &transfer_header);
+#else
     CanardRxState* rx_state = NULL;
 
     if (IS_START_OF_TRANSFER(tail_byte))
@@ -347,13 +860,17 @@ void canardInit(CanardInstance* out_ins,
 
             if(rx_state == NULL)
             {
+                TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropOutOfMemory, frame);
                 return; // No allocator room for this frame，此框架没有分配器空间
             }
 
+#if CANARD_ENABLE_MULTI_FRAME_RX
             rx_state->calculated_crc = crcAddSignature(0xFFFFU, data_type_signature);
+#endif
         }
         else
         {
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropNotAccepted, frame);
             return;     // The application doesn't want this transfer，应用程序不希望此传输
         }
     }
@@ -363,6 +880,7 @@ void canardInit(CanardInstance* out_ins,
 
         if (rx_state == NULL)
         {
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropNoState, frame);
             return;
         }
     }
@@ -389,6 +907,7 @@ void canardInit(CanardInstance* out_ins,
         if (!IS_START_OF_TRANSFER(tail_byte)) // missed the first frame，错过了第一帧
         {
             rx_state->transfer_id++;
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropMissedStart, frame);
             return;
         }
     }
@@ -407,19 +926,24 @@ void canardInit(CanardInstance* out_ins,
             .source_node_id = source_node_id
         };
 
+        TRACE_FRAME(CanardTraceEventRxTransfer, 0, frame);
+        LATENCY_RX_TRANSFER();
         ins->on_reception(ins, &rx_transfer);
 
         prepareForNextTransfer(rx_state);
         return;
     }
 
+#if CANARD_ENABLE_MULTI_FRAME_RX
     if (TOGGLE_BIT(tail_byte) != rx_state->next_toggle)
     {
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropWrongToggle, frame);
         return; // wrong toggle
     }
 
     if (TRANSFER_ID_FROM_TAIL_BYTE(tail_byte) != rx_state->transfer_id)
     {
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropUnexpectedTransferID, frame);
         return; // unexpected tid，不是想要的 tid
     }
 
@@ -427,6 +951,7 @@ void canardInit(CanardInstance* out_ins,
     {
         if (frame->data_len <= 3)
         {
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropShortFrame, frame);
             return;     // Not enough data
         }
 
@@ -436,6 +961,7 @@ void canardInit(CanardInstance* out_ins,
                                                  (uint8_t) (frame->data_len - 3));
         if (ret < 0)
         {
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropOutOfMemory, frame);
             releaseStatePayload(ins, rx_state);
             prepareForNextTransfer(rx_state);
             return;
@@ -450,6 +976,7 @@ void canardInit(CanardInstance* out_ins,
                                                  (uint8_t) (frame->data_len - 1));
         if (ret < 0)
         {
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropOutOfMemory, frame);
             releaseStatePayload(ins, rx_state);
             prepareForNextTransfer(rx_state);
             return;
@@ -518,8 +1045,14 @@ void canardInit(CanardInstance* out_ins,
         rx_state->calculated_crc = crcAdd((uint16_t)rx_state->calculated_crc, frame->data, frame->data_len - 1U);
         if (rx_state->calculated_crc == rx_state->payload_crc)
         {
+            TRACE_FRAME(CanardTraceEventRxTransfer, 0, frame);
+            LATENCY_RX_TRANSFER();
             ins->on_reception(ins, &rx_transfer);
         }
+        else
+        {
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropBadCrc, frame);
+        }
 
         // Making sure the payload is released even if the application didn't bother with it
         // 确保有效负载被释放，即使应用程序不理会它
@@ -529,6 +1062,8 @@ void canardInit(CanardInstance* out_ins,
     }
 
     rx_state->next_toggle = rx_state->next_toggle ? 0 : 1;// toggle反转
+#endif
+#endif
 }
 
 /*
@@ -536,128 +1071,43 @@ canardHandleRxFrame(&g_canard, &rx_frame, HAL_GetTick() * 1000);
 */
 void singleCanardHandleRxFrame(CanardInstance* ins, const CanardCANFrame* frame, uint64_t timestamp_usec)
 {
-    const CanardTransferType transfer_type = extractTransferType(frame->id);    ///<判断帧类型
-    const uint8_t destination_node_id = (transfer_type == CanardTransferTypeBroadcast) ?
-                                        (uint8_t)CANARD_BROADCAST_NODE_ID :
-                                        DEST_ID_FROM_ID(frame->id);
-
-    // TODO: This function should maintain statistics of transfer errors and such.此函数应维护传输错误等的统计信息。
-
-    if ((frame->id & CANARD_CAN_FRAME_EFF) == 0 ||
-        (frame->id & CANARD_CAN_FRAME_RTR) != 0 ||
-        (frame->id & CANARD_CAN_FRAME_ERR) != 0 ||
-        (frame->data_len < 1))//扩展帧、远程帧、错误帧
+    if (frame->data_len < 1)
     {
+        TRACE_FRAME(CanardTraceEventRxFrame, 0, frame);
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropNotUavcan, frame);
+        BUSLOAD_RX_FRAME(ins, frame, timestamp_usec);
         return;     // Unsupported frame, not UAVCAN - ignore uavcan不支持的类型
     }
 
-    if (transfer_type != CanardTransferTypeBroadcast &&
-        destination_node_id != canardGetLocalNodeID(ins))
+    const uint8_t tail_byte = frame->data[frame->data_len - 1];
+    if (!IS_START_OF_TRANSFER(tail_byte) || !IS_END_OF_TRANSFER(tail_byte))
     {
-        return;     // Address mismatch 地址不匹配
+        TRACE_FRAME(CanardTraceEventRxFrame, 0, frame);
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropDisabledFeature, frame);
+        BUSLOAD_RX_FRAME(ins, frame, timestamp_usec);
+        return;     // Frames of multi-frame transfers are ignored 忽略多帧传输的帧
     }
 
-    const uint8_t priority = PRIORITY_FROM_ID(frame->id);
-    const uint8_t source_node_id = SOURCE_ID_FROM_ID(frame->id);
-    const uint16_t data_type_id = extractDataType(frame->id);
-    const uint32_t transfer_descriptor =
-            MAKE_TRANSFER_DESCRIPTOR(data_type_id, transfer_type, source_node_id, destination_node_id);
-
-    const uint8_t tail_byte = frame->data[frame->data_len - 1];// 尾帧数据，用来判断传输情况和源ID
+    canardHandleRxFrame(ins, frame, timestamp_usec);
+}
 
-    CanardRxState* rx_state = NULL;
 
-    if (IS_START_OF_TRANSFER(tail_byte))// 是传输开始标志吗？
+void canardCleanupStaleTransfers(CanardInstance* ins, uint64_t current_time_usec)
+{
+    CANARD_PROF_BEGIN(CanardProfSiteCleanup);
+#if CANARD_ENABLE_STATIC_CAPACITY
+    for (uint8_t i = 0; i < ins->num_subscriptions; i++)
     {
-        uint64_t data_type_signature = 0;
-
-        // ins->should_accept = shouldAcceptTransfer();
-        if (ins->should_accept(ins, &data_type_signature, data_type_id, transfer_type, source_node_id))//shouldAcceptTransfer？()返回TURE 或者 FALSE
+        const CanardStaticSubscription* const sub = &ins->subscriptions[i];
+        for (uint8_t k = 0; k < sub->max_sessions; k++)
         {
-            rx_state = traverseRxStates(ins, transfer_descriptor);//返回CanardRxState头部
-
-            if(rx_state == NULL)
+            if ((current_time_usec - sub->sessions[k].timestamp_usec) > TRANSFER_TIMEOUT_USEC)
             {
-                return; // No allocator room for this frame，此框架没有分配器空间
+                sub->sessions[k].dtid_tt_snid_dnid = CANARD_STATIC_SESSION_FREE;
             }
         }
-        else
-        {
-            return;     // The application doesn't want this transfer，应用程序不希望此传输
-        }
-    }
-    else
-    {
-        rx_state = findRxState(ins->rx_states, transfer_descriptor);//是否找到了 rx状态指针
-
-        if (rx_state == NULL)
-        {
-            return;
-        }
-    }
-
-    CANARD_ASSERT(rx_state != NULL);    // All paths that lead to NULL should be terminated with return above，所有导致NULL的路径都应在上面的return处终止
-
-    // Resolving the state flags: 处理这些标志位
-    const bool not_initialized = rx_state->timestamp_usec == 0;
-    const bool tid_timed_out = (timestamp_usec - rx_state->timestamp_usec) > TRANSFER_TIMEOUT_USEC;
-    const bool first_frame = IS_START_OF_TRANSFER(tail_byte);
-    const bool not_previous_tid =
-        computeTransferIDForwardDistance((uint8_t) rx_state->transfer_id, TRANSFER_ID_FROM_TAIL_BYTE(tail_byte)) > 1;
-
-    const bool need_restart =
-            (not_initialized) ||
-            (tid_timed_out) ||
-            (first_frame && not_previous_tid);
-
-    if (need_restart) //是否需要开始传输
-    {
-        rx_state->transfer_id = TRANSFER_ID_FROM_TAIL_BYTE(tail_byte);
-        rx_state->next_toggle = 0;
-        releaseStatePayload(ins, rx_state);
-        if (!IS_START_OF_TRANSFER(tail_byte)) // missed the first frame，错过了第一帧
-        {
-            rx_state->transfer_id++;
-            return;
-        }
-    }
-
-    if (IS_START_OF_TRANSFER(tail_byte) && IS_END_OF_TRANSFER(tail_byte)) // single frame transfer，单帧传输
-    {
-        rx_state->timestamp_usec = timestamp_usec;
-        CanardRxTransfer rx_transfer = {
-            .timestamp_usec = timestamp_usec,
-            .payload_head = frame->data,
-            .payload_len = (uint8_t)(frame->data_len - 1U),
-            .data_type_id = data_type_id,
-            .transfer_type = transfer_type,
-            .transfer_id = TRANSFER_ID_FROM_TAIL_BYTE(tail_byte),
-            .priority = priority,
-            .source_node_id = source_node_id
-        };
-
-        // ins->on_reception = onTransferReceived()
-        ins->on_reception(ins, &rx_transfer);
-
-        prepareForNextTransfer(rx_state);//准备开始下一次传输
-        return;
-    }
-
-    if (TOGGLE_BIT(tail_byte) != rx_state->next_toggle)
-    {
-        return; // wrong toggle
-    }
-
-    if (TRANSFER_ID_FROM_TAIL_BYTE(tail_byte) != rx_state->transfer_id)
-    {
-        return; // unexpected tid，不是想要的 tid
     }
-    rx_state->next_toggle = rx_state->next_toggle ? 0 : 1;// toggle反转
-}
-
-
-void canardCleanupStaleTransfers(CanardInstance* ins, uint64_t current_time_usec)
-{
+#else
     CanardRxState* prev = ins->rx_states, * state = ins->rx_states;
 
     while (state != NULL)
@@ -668,7 +1118,7 @@ void canardCleanupStaleTransfers(CanardInstance* ins, uint64_t current_time_usec
             {
                 releaseStatePayload(ins, state);
                 ins->rx_states = ins->rx_states->next;
-                freeBlock(&ins->allocator, state);
+                freeBlock(&ins->allocator, CanardPoolOwnerRxState, state);
                 state = ins->rx_states;
                 prev = state;
             }
@@ -676,7 +1126,7 @@ void canardCleanupStaleTransfers(CanardInstance* ins, uint64_t current_time_usec
             {
                 releaseStatePayload(ins, state);
                 prev->next = state->next;
-                freeBlock(&ins->allocator, state);
+                freeBlock(&ins->allocator, CanardPoolOwnerRxState, state);
                 state = prev->next;
             }
         }
@@ -686,6 +1136,8 @@ void canardCleanupStaleTransfers(CanardInstance* ins, uint64_t current_time_usec
             state = state->next;
         }
     }
+#endif
+    CANARD_PROF_END(CanardProfSiteCleanup);
 }
 
 int16_t canardDecodeScalar(const CanardRxTransfer* transfer,
@@ -849,6 +1301,206 @@ int16_t canardDecodeScalar(const CanardRxTransfer* transfer,
     return result;
 }
 
+void canardInitRxPayloadReader(CanardRxPayloadReader* out_reader,
+                               const CanardRxTransfer* transfer)
+{
+    CANARD_ASSERT(out_reader != NULL);
+    CANARD_ASSERT(transfer != NULL);
+
+    out_reader->transfer = transfer;
+    out_reader->data = transfer->payload_head;
+    out_reader->next_block = NULL;
+    out_reader->begin = 0;
+    out_reader->end = transfer->payload_len;
+
+#if CANARD_ENABLE_MULTI_FRAME_RX && !CANARD_ENABLE_STATIC_CAPACITY
+    if ((transfer->payload_middle != NULL) || (transfer->payload_tail != NULL))     // Multi frame
+    {
+        out_reader->next_block = transfer->payload_middle;
+        out_reader->end = (uint16_t)MIN(transfer->payload_len, CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE);
+    }
+#endif
+}
+
+uint16_t canardReadRxPayload(CanardRxPayloadReader* reader,
+                             uint16_t offset,
+                             uint16_t length,
+                             uint8_t* output)
+{
+    CANARD_ASSERT(reader != NULL);
+    CANARD_ASSERT((output != NULL) || (length == 0));
+
+    if (offset < reader->begin)
+    {
+        canardInitRxPayloadReader(reader, reader->transfer);
+    }
+
+    uint16_t copied = 0;
+    while (copied < length)
+    {
+        const uint32_t position = (uint32_t)offset + copied;
+        while (position >= reader->end)
+        {
+            if (!advanceRxPayloadReader(reader))
+            {
+                return copied;
+            }
+        }
+
+        const uint16_t amount = (uint16_t)MIN((uint32_t)(length - copied), reader->end - position);
+        memcpy(&output[copied], &reader->data[position - reader->begin], amount);
+        copied = (uint16_t)(copied + amount);
+    }
+    return copied;
+}
+
+int32_t canardDecodeArray(const CanardRxTransfer* transfer,
+                          uint32_t bit_offset,
+                          uint8_t bit_length,
+                          bool value_is_signed,
+                          uint16_t count,
+                          void* out_values)
+{
+    if (transfer == NULL)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    CanardRxPayloadReader reader;
+    canardInitRxPayloadReader(&reader, transfer);
+    return canardReadRxArray(&reader, bit_offset, bit_length, value_is_signed, count, out_values);
+}
+
+int32_t canardReadRxArray(CanardRxPayloadReader* reader,
+                          uint32_t bit_offset,
+                          uint8_t bit_length,
+                          bool value_is_signed,
+                          uint16_t count,
+                          void* out_values)
+{
+    if ((reader == NULL) || ((out_values == NULL) && (count > 0)))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    if ((bit_length < 1) || (bit_length > 64) || ((bit_length == 1) && value_is_signed))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Only whole elements are decoded
+    const uint32_t payload_bits = reader->transfer->payload_len * 8U;
+    if (bit_offset >= payload_bits)
+    {
+        return 0;
+    }
+    count = (uint16_t)MIN((uint32_t)count, (payload_bits - bit_offset) / bit_length);
+
+    uint8_t* const output = (uint8_t*) out_values;
+    const uint8_t element_size = getArrayElementSize(bit_length);
+
+    if (((bit_offset % 8U) == 0U) && ((bit_length % 8U) == 0U) && (element_size * 8U == bit_length))
+    {
+        /*
+         * Byte-aligned 8, 16, 32 or 64 bit values are stored in the payload exactly as they are in memory on a
+         * little-endian platform, so the whole array is copied at once.
+         */
+        (void) canardReadRxPayload(reader, (uint16_t)(bit_offset / 8U), (uint16_t)(count * element_size), output);
+        if (isBigEndian() && (element_size > 1U))
+        {
+            for (uint16_t i = 0; i < count; i++)
+            {
+                swapByteOrder(&output[i * element_size], element_size);
+            }
+        }
+        return count;
+    }
+
+    CanardRxBitCursor cursor;
+    initRxBitCursor(&cursor, reader, bit_offset);
+
+    const uint64_t sign_bit = ((uint64_t) 1) << (bit_length - 1U);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        uint64_t value = streamBitsToScalar(takeRxBits(&cursor, bit_length), bit_length);
+        if (value_is_signed && (bit_length < 64U))
+        {
+            value = (value ^ sign_bit) - sign_bit;      // Extending the sign bit
+        }
+
+        void* const element = &output[i * element_size];
+        if      (bit_length == 1)       { *(    (bool*) element) = (value != 0U); }
+        else if (element_size == 1U)    { *( (uint8_t*) element) = (uint8_t) value; }
+        else if (element_size == 2U)    { *((uint16_t*) element) = (uint16_t) value; }
+        else if (element_size == 4U)    { *((uint32_t*) element) = (uint32_t) value; }
+        else                            { *((uint64_t*) element) = value; }
+    }
+    return count;
+}
+
+#if CANARD_ENABLE_FLOAT16
+int32_t canardDecodeFloat16Array(const CanardRxTransfer* transfer,
+                                 uint32_t bit_offset,
+                                 uint16_t count,
+                                 float* out_values)
+{
+    if (transfer == NULL)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    CanardRxPayloadReader reader;
+    canardInitRxPayloadReader(&reader, transfer);
+    return canardReadRxFloat16Array(&reader, bit_offset, count, out_values);
+}
+
+int32_t canardReadRxFloat16Array(CanardRxPayloadReader* reader,
+                                 uint32_t bit_offset,
+                                 uint16_t count,
+                                 float* out_values)
+{
+    if ((reader == NULL) || ((out_values == NULL) && (count > 0)))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    const uint32_t payload_bits = reader->transfer->payload_len * 8U;
+    if (bit_offset >= payload_bits)
+    {
+        return 0;
+    }
+    count = (uint16_t)MIN((uint32_t)count, (payload_bits - bit_offset) / 16U);
+
+    if ((bit_offset % 8U) == 0U)
+    {
+        // Byte-aligned: the raw values are fetched in chunks and converted in batches
+        uint8_t chunk[64];
+        uint16_t raw[32];
+        uint16_t done = 0;
+        while (done < count)
+        {
+            const uint16_t amount = (uint16_t)MIN((uint32_t)(count - done), sizeof(raw) / sizeof(raw[0]));
+            (void) canardReadRxPayload(reader, (uint16_t)(bit_offset / 8U + done * 2U), (uint16_t)(amount * 2U), chunk);
+            for (uint16_t i = 0; i < amount; i++)
+            {
+                raw[i] = (uint16_t)(chunk[i * 2U] | (uint16_t)(chunk[i * 2U + 1U] << 8U));
+            }
+            canardConvertFloat16ArrayToNativeFloat(raw, &out_values[done], amount);
+            done = (uint16_t)(done + amount);
+        }
+        return count;
+    }
+
+    CanardRxBitCursor cursor;
+    initRxBitCursor(&cursor, reader, bit_offset);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        out_values[i] = canardConvertFloat16ToNativeFloat((uint16_t)streamBitsToScalar(takeRxBits(&cursor, 16), 16));
+    }
+    return count;
+}
+#endif
+
 void canardEncodeScalar(void* destination,
                         uint32_t bit_offset,
                         uint8_t bit_length,
@@ -928,14 +1580,112 @@ void canardEncodeScalar(void* destination,
     copyBitArray(&storage.bytes[0], 0, bit_length, (uint8_t*) destination, bit_offset);
 }
 
+void canardEncodeArray(void* destination,
+                       uint32_t bit_offset,
+                       uint8_t bit_length,
+                       uint16_t count,
+                       const void* values)
+{
+    // Same policy as canardEncodeScalar(): bad arguments trigger an assertion failure, otherwise best effort
+    CANARD_ASSERT(destination != NULL);
+    CANARD_ASSERT((values != NULL) || (count == 0));
+
+    if (bit_length > 64)
+    {
+        CANARD_ASSERT(false);
+        bit_length = 64;
+    }
+
+    if (bit_length < 1)
+    {
+        CANARD_ASSERT(false);
+        bit_length = 1;
+    }
+
+    uint8_t* const output = (uint8_t*) destination;
+    const uint8_t* const input = (const uint8_t*) values;
+    const uint8_t element_size = getArrayElementSize(bit_length);
+
+    if (((bit_offset % 8U) == 0U) && ((bit_length % 8U) == 0U) && (element_size * 8U == bit_length))
+    {
+        // Byte-aligned 8, 16, 32 or 64 bit values, see canardReadRxArray()
+        memcpy(&output[bit_offset / 8U], input, (size_t) count * element_size);
+        if (isBigEndian() && (element_size > 1U))
+        {
+            for (uint16_t i = 0; i < count; i++)
+            {
+                swapByteOrder(&output[bit_offset / 8U + (uint32_t) i * element_size], element_size);
+            }
+        }
+        return;
+    }
+
+    CanardTxBitCursor cursor;
+    initTxBitCursor(&cursor, output, bit_offset);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const uint64_t value = loadArrayElement(&input[i * element_size], bit_length);
+        putTxBits(&cursor, scalarToStreamBits(value, bit_length), bit_length);
+    }
+    flushTxBitCursor(&cursor);
+}
+
+#if CANARD_ENABLE_FLOAT16
+void canardEncodeFloat16Array(void* destination,
+                              uint32_t bit_offset,
+                              uint16_t count,
+                              const float* values)
+{
+    CANARD_ASSERT(destination != NULL);
+    CANARD_ASSERT((values != NULL) || (count == 0));
+
+    uint8_t* const output = (uint8_t*) destination;
+    if ((bit_offset % 8U) == 0U)
+    {
+        uint16_t raw[32];
+        uint16_t done = 0;
+        while (done < count)
+        {
+            const uint16_t amount = (uint16_t)MIN((uint32_t)(count - done), sizeof(raw) / sizeof(raw[0]));
+            canardConvertNativeFloatArrayToFloat16(&values[done], raw, amount);
+            for (uint16_t i = 0; i < amount; i++)
+            {
+                output[bit_offset / 8U + (uint32_t)(done + i) * 2U] = (uint8_t)(raw[i] & 0xFFU);
+                output[bit_offset / 8U + (uint32_t)(done + i) * 2U + 1U] = (uint8_t)(raw[i] >> 8U);
+            }
+            done = (uint16_t)(done + amount);
+        }
+        return;
+    }
+
+    CanardTxBitCursor cursor;
+    initTxBitCursor(&cursor, output, bit_offset);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        putTxBits(&cursor, scalarToStreamBits(canardConvertNativeFloatToFloat16(values[i]), 16), 16);
+    }
+    flushTxBitCursor(&cursor);
+}
+#endif
+
 void canardReleaseRxTransferPayload(CanardInstance* ins, CanardRxTransfer* transfer)
 {
+#if CANARD_ENABLE_MULTINODE
+    if ((ins->host != NULL) && !isMultiNodeHostBus(ins))
+    {
+        transfer->payload_middle = NULL;        // The blocks are shared with other hosted nodes; the host frees them
+    }
+#endif
+#if CANARD_ENABLE_STATIC_CAPACITY
+    (void) ins;                                 // Payloads are kept in the subscription buffers
+#else
     while (transfer->payload_middle != NULL)
     {
         CanardBufferBlock* const temp = transfer->payload_middle->next;
-        freeBlock(&ins->allocator, transfer->payload_middle);
+        freeBlock(&ins->allocator, CanardPoolOwnerRxBuffer, transfer->payload_middle);
         transfer->payload_middle = temp;
     }
+#endif
 
     transfer->payload_middle = NULL;
     transfer->payload_head = NULL;
@@ -943,29 +1693,450 @@ void canardReleaseRxTransferPayload(CanardInstance* ins, CanardRxTransfer* trans
     transfer->payload_len = 0;
 }
 
+#if !CANARD_ENABLE_STATIC_CAPACITY
 CanardPoolAllocatorStatistics canardGetPoolAllocatorStatistics(CanardInstance* ins)
 {
-    return ins->allocator.statistics;
+#if CANARD_ENABLE_MULTINODE
+    ins = getPoolOwner(ins);
+#endif
+    LOCK_ALLOCATOR(&ins->allocator);
+    const CanardPoolAllocatorStatistics statistics = ins->allocator.statistics;
+    UNLOCK_ALLOCATOR(&ins->allocator);
+    return statistics;
 }
 
-uint16_t canardConvertNativeFloatToFloat16(float value)
+CanardPoolOwnerStatistics canardGetPoolOwnerStatistics(CanardInstance* ins, CanardPoolOwner owner)
 {
-    CANARD_ASSERT(sizeof(float) == 4);
+    CANARD_ASSERT((unsigned) owner < CANARD_NUM_POOL_OWNERS);
+#if CANARD_ENABLE_MULTINODE
+    ins = getPoolOwner(ins);
+#endif
+    LOCK_ALLOCATOR(&ins->allocator);
+    const CanardPoolOwnerStatistics statistics = ins->allocator.owner_statistics[owner];
+    UNLOCK_ALLOCATOR(&ins->allocator);
+    return statistics;
+}
+#endif
 
-    union FP32
-    {
-        uint32_t u;
-        float f;
-    };
+#if CANARD_ENABLE_MULTINODE
+void canardMultiNodeHostInit(CanardMultiNodeHost* out_host,
+                             void* mem_arena,
+                             size_t mem_arena_size,
+                             void* user_reference)
+{
+    CANARD_ASSERT(out_host != NULL);
 
-    const union FP32 f32inf = { 255UL << 23U };
-    const union FP32 f16inf = { 31UL << 23U };
-    const union FP32 magic = { 15UL << 23U };
-    const uint32_t sign_mask = 0x80000000UL;
-    const uint32_t round_mask = ~0xFFFUL;
+    memset(out_host, 0, sizeof(*out_host));
+    canardInit(&out_host->bus, mem_arena, mem_arena_size,
+               &multiNodeHostOnReception, &multiNodeHostShouldAccept, user_reference);
+    out_host->bus.host = out_host;
+}
 
-    union FP32 in;
-    in.f = value;
+int16_t canardMultiNodeHostAddNode(CanardMultiNodeHost* host,
+                                   CanardInstance* out_node,
+                                   uint8_t node_id,
+                                   CanardOnTransferReception on_reception,
+                                   CanardShouldAcceptTransfer should_accept,
+                                   void* user_reference)
+{
+    CANARD_ASSERT((host != NULL) && (out_node != NULL));
+
+    if ((node_id < CANARD_MIN_NODE_ID) || (node_id > CANARD_MAX_NODE_ID) || (host->nodes[node_id] != NULL))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    canardInit(out_node, NULL, 0, on_reception, should_accept, user_reference);    // The node has no own pool
+    canardSetLocalNodeID(out_node, node_id);
+    out_node->host = host;
+    out_node->next_hosted = host->node_list;
+
+    host->node_list = out_node;
+    host->nodes[node_id] = out_node;
+    return CANARD_OK;
+}
+
+void canardMultiNodeHostRemoveNode(CanardMultiNodeHost* host, CanardInstance* node)
+{
+    CANARD_ASSERT((host != NULL) && (node != NULL) && (node->host == host));
+
+    CanardInstance** link = &host->node_list;
+    while (*link != NULL)
+    {
+        if (*link == node)
+        {
+            *link = node->next_hosted;
+            break;
+        }
+        link = &(*link)->next_hosted;
+    }
+
+    host->nodes[node->node_id] = NULL;
+    node->host = NULL;
+    node->next_hosted = NULL;
+}
+
+void canardMultiNodeHostHandleRxFrame(CanardMultiNodeHost* host,
+                                      const CanardCANFrame* frame,
+                                      uint64_t timestamp_usec)
+{
+#if CANARD_ENABLE_BUSLOAD
+    accountRxBusLoad(&host->bus.busload, frame, timestamp_usec);
+#endif
+    canardHandleRxFrame(&host->bus, frame, timestamp_usec);
+}
+
+const CanardCANFrame* canardMultiNodeHostPeekTxQueue(CanardMultiNodeHost* host, uint64_t timestamp_usec)
+{
+    const CanardCANFrame* frame = canardPeekTxQueue(&host->bus);
+
+    // Service frames between hosted nodes are delivered right here, the bus never sees them
+    while ((frame != NULL) &&
+           SERVICE_NOT_MSG_FROM_ID(frame->id) &&
+           (host->nodes[DEST_ID_FROM_ID(frame->id)] != NULL))
+    {
+        const CanardCANFrame local_frame = *frame;
+        canardPopTxQueue(&host->bus);
+        canardHandleRxFrame(&host->bus, &local_frame, timestamp_usec);
+        frame = canardPeekTxQueue(&host->bus);
+    }
+
+    return frame;
+}
+
+void canardMultiNodeHostPopTxQueue(CanardMultiNodeHost* host, uint64_t timestamp_usec)
+{
+    const CanardCANFrame* const frame = canardPeekTxQueue(&host->bus);
+    if (frame == NULL)
+    {
+        return;
+    }
+
+    // Loopback; the source node is excluded from delivery by the reception callbacks
+    const CanardCANFrame transmitted_frame = *frame;
+#if CANARD_ENABLE_BUSLOAD
+    accountBusLoad(&host->bus.busload, frame, true);
+#endif
+    canardPopTxQueue(&host->bus);
+    canardHandleRxFrame(&host->bus, &transmitted_frame, timestamp_usec);
+}
+
+void canardMultiNodeHostCleanupStaleTransfers(CanardMultiNodeHost* host, uint64_t current_time_usec)
+{
+    canardCleanupStaleTransfers(&host->bus, current_time_usec);
+}
+#endif
+
+#if CANARD_ENABLE_TRACE
+void canardTraceRecord(uint8_t event, uint8_t detail, const CanardCANFrame* frame)
+{
+    CANARD_ASSERT(frame->data_len <= CANARD_CAN_FRAME_MAX_DATA_LEN);
+    const uint32_t index = g_trace.head++;
+    CanardTraceEntry* const entry = &g_trace.entries[index & (CANARD_TRACE_CAPACITY - 1U)];
+    entry->timestamp = CANARD_TRACE_TIMESTAMP();
+    entry->can_id = frame->id;
+    entry->event = event;
+    entry->detail = detail;
+    entry->data_len = frame->data_len;
+    entry->tail_byte = (frame->data_len > 0U) ? frame->data[frame->data_len - 1U] : 0U;
+#if CANARD_TRACE_FRAME_DATA
+    memcpy(entry->data, frame->data, sizeof(entry->data));
+#endif
+}
+
+uint16_t canardTraceRead(CanardTraceEntry* out_entries, uint16_t max_entries, uint32_t* out_lost)
+{
+    const uint32_t head = g_trace.head;
+    if ((head - g_trace.tail) > CANARD_TRACE_CAPACITY)
+    {
+        g_trace.lost += head - g_trace.tail - CANARD_TRACE_CAPACITY;
+        g_trace.tail = head - CANARD_TRACE_CAPACITY;
+    }
+
+    uint16_t count = 0;
+    while ((count < max_entries) && (g_trace.tail != head))
+    {
+        out_entries[count++] = g_trace.entries[g_trace.tail & (CANARD_TRACE_CAPACITY - 1U)];
+        g_trace.tail++;
+    }
+
+    if (out_lost != NULL)
+    {
+        *out_lost = g_trace.lost;
+        g_trace.lost = 0;
+    }
+    return count;
+}
+
+void canardTraceDump(CanardTraceWrite write, void* user_reference)
+{
+    // Drained in small records, so that the stack usage does not depend on the capacity of the ring
+    CanardTraceEntry entries[8];
+    const uint16_t max_count = (uint16_t)(sizeof(entries) / sizeof(entries[0]));
+    bool first = true;
+
+    for (;;)
+    {
+        uint32_t lost = 0;
+        const uint16_t count = canardTraceRead(entries, max_count, &lost);
+        if ((count == 0U) && (lost == 0U) && !first)
+        {
+            break;                      // The first record is written even if empty, it tells that nothing was lost
+        }
+        first = false;
+
+        uint8_t header[TRACE_DUMP_HEADER_SIZE] = { 'C', 'T', 'R', 'C', 1U, (uint8_t) TRACE_ENTRY_SIZE };
+        header[6] = (uint8_t) count;
+        header[7] = (uint8_t)(count >> 8U);
+        putTraceWord(&header[8], CANARD_TRACE_TIMESTAMP_HZ);
+        putTraceWord(&header[12], lost);
+        write(user_reference, header, sizeof(header));
+
+        for (uint16_t i = 0; i < count; i++)
+        {
+            uint8_t bytes[TRACE_ENTRY_SIZE];
+            serializeTraceEntry(&entries[i], bytes);
+            write(user_reference, bytes, sizeof(bytes));
+        }
+
+        if (count < max_count)
+        {
+            break;
+        }
+    }
+}
+
+void canardTraceReset(void)
+{
+    memset(&g_trace, 0, sizeof(g_trace));
+}
+#endif
+
+uint16_t canardGetFrameBitLength(const CanardCANFrame* frame)
+{
+    const bool extended = (frame->id & CANARD_CAN_FRAME_EFF) != 0U;
+    const bool remote = (frame->id & CANARD_CAN_FRAME_RTR) != 0U;
+    const uint8_t data_len = (frame->data_len > CANARD_CAN_FRAME_MAX_DATA_LEN) ? CANARD_CAN_FRAME_MAX_DATA_LEN :
+                                                                                 frame->data_len;
+    CanardFrameBitStream stream = { 0U, 0U, 2U, 0U };       // No run yet, so the start of frame begins one
+
+    putFrameBits(&stream, 0U, 1U);                          // Start of frame
+    if (extended)
+    {
+        putFrameBits(&stream, (frame->id & CANARD_CAN_EXT_ID_MASK) >> 18U, 11U);
+        putFrameBits(&stream, 3U, 2U);                      // SRR, IDE
+        putFrameBits(&stream, frame->id & 0x3FFFFU, 18U);
+    }
+    else
+    {
+        putFrameBits(&stream, frame->id & CANARD_CAN_STD_ID_MASK, 11U);
+    }
+    putFrameBits(&stream, remote ? 1U : 0U, 1U);            // RTR
+    putFrameBits(&stream, 0U, 2U);                          // IDE and r0, or r1 and r0
+    putFrameBits(&stream, data_len, 4U);
+    if (!remote)
+    {
+        for (uint8_t i = 0; i < data_len; i++)
+        {
+            putFrameBits(&stream, frame->data[i], 8U);
+        }
+    }
+    putFrameBits(&stream, stream.crc, 15U);                 // The CRC bits are stuffed too
+
+    return (uint16_t)(stream.bit_count + CANARD_CAN_FRAME_TRAILER_BITS);
+}
+
+uint16_t canardGetWorstCaseFrameBitLength(uint8_t data_len, bool extended)
+{
+    if (data_len > CANARD_CAN_FRAME_MAX_DATA_LEN)
+    {
+        data_len = CANARD_CAN_FRAME_MAX_DATA_LEN;
+    }
+    const uint16_t stuffable_bits = (uint16_t)((extended ? 54U : 34U) + 8U * data_len);    // Start of frame to CRC
+    return (uint16_t)(stuffable_bits + (stuffable_bits - 1U) / (CAN_STUFF_RUN_LENGTH - 1U) +
+                      CANARD_CAN_FRAME_TRAILER_BITS);
+}
+
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+void canardLatencyRecord(uint8_t path, uint32_t ticks)
+{
+    CANARD_ASSERT(path < CANARD_LATENCY_NUM_PATHS);
+    CanardLatencyHistogram* const histogram = &g_latency.histograms[path];
+    histogram->buckets[getLatencyBucket(ticks)]++;
+    histogram->count++;
+    if (ticks > histogram->max)
+    {
+        histogram->max = ticks;
+    }
+}
+
+uint32_t canardGetLatencyPercentile(uint8_t path, uint16_t permille)
+{
+    CANARD_ASSERT(path < CANARD_LATENCY_NUM_PATHS);
+    const CanardLatencyHistogram* const histogram = &g_latency.histograms[path];
+    if (histogram->count == 0U)
+    {
+        return 0U;
+    }
+
+    // The rank of the sample, rounded up, so that e.g. the 99th percentile of 10 samples is the largest one
+    uint64_t rank = ((uint64_t) histogram->count * MIN(permille, 1000U) + 999U) / 1000U;
+    if (rank == 0U)
+    {
+        rank = 1U;
+    }
+
+    uint64_t seen = 0U;
+    for (uint16_t i = 0; i < (uint16_t)(CANARD_LATENCY_NUM_BUCKETS - 1U); i++)
+    {
+        seen += histogram->buckets[i];
+        if (seen >= rank)
+        {
+            return MIN(getLatencyBucketUpperBound(i), histogram->max);
+        }
+    }
+    return histogram->max;      // In the last bucket, which only knows the maximum
+}
+
+CanardLatencyStatistics canardGetLatencyStatistics(uint8_t path)
+{
+    CANARD_ASSERT(path < CANARD_LATENCY_NUM_PATHS);
+    CanardLatencyStatistics out;
+    out.count = g_latency.histograms[path].count;
+    out.p50 = canardGetLatencyPercentile(path, 500U);
+    out.p99 = canardGetLatencyPercentile(path, 990U);
+    out.max = g_latency.histograms[path].max;
+    return out;
+}
+
+void canardLatencyReset(void)
+{
+    memset(g_latency.histograms, 0, sizeof(g_latency.histograms));
+}
+#endif
+
+#if CANARD_ENABLE_PROFILING
+void canardProfRecord(uint8_t site, uint32_t ticks)
+{
+    CANARD_ASSERT(site < CANARD_PROF_NUM_SITES);
+    CanardProfStatistics* const stats = &g_prof[site];
+    if ((stats->count == 0U) || (ticks < stats->min))
+    {
+        stats->min = ticks;
+    }
+    if (ticks > stats->max)
+    {
+        stats->max = ticks;
+    }
+    stats->total += ticks;
+    stats->count++;
+}
+
+CanardProfStatistics canardGetProfStatistics(uint8_t site)
+{
+    CANARD_ASSERT(site < CANARD_PROF_NUM_SITES);
+    return g_prof[site];
+}
+
+void canardProfReset(void)
+{
+    memset(g_prof, 0, sizeof(g_prof));
+}
+#endif
+
+#if CANARD_ENABLE_BUSLOAD
+void canardUpdateBusLoad(CanardInstance* ins, uint64_t current_time_usec)
+{
+#if CANARD_ENABLE_MULTINODE
+    ins = getPoolOwner(ins);
+#endif
+    advanceBusLoadWindow(&ins->busload, current_time_usec);
+}
+
+CanardBusLoadStatistics canardGetBusLoadStatistics(const CanardInstance* ins, uint32_t bit_rate)
+{
+#if CANARD_ENABLE_MULTINODE
+    ins = getPoolOwner((CanardInstance*) ins);
+#endif
+    const CanardBusLoadState* const state = &ins->busload;
+
+    CanardBusLoadStatistics out;
+    memset(&out, 0, sizeof(out));
+    if (state->filled_slots > 0U)
+    {
+        out.window_usec = (uint32_t)((state->filled_slots - 1U) * CANARD_BUSLOAD_SLOT_USEC +
+                                     (state->now_usec - state->slot_started_usec));
+    }
+
+    uint32_t priority_band_bits[CANARD_BUSLOAD_NUM_PRIORITY_BANDS] = { 0U };
+    uint32_t untracked_bits = 0U;
+    for (uint8_t i = 0; i < CANARD_BUSLOAD_NUM_SLOTS; i++)
+    {
+        const CanardBusLoadSlot* const slot = &state->slots[i];
+        out.tx_bits += slot->tx_bits;
+        out.rx_bits += slot->rx_bits;
+        for (uint8_t k = 0; k < CANARD_BUSLOAD_NUM_PRIORITY_BANDS; k++)
+        {
+            priority_band_bits[k] += slot->priority_band_bits[k];
+        }
+        untracked_bits += slot->untracked_bits;
+    }
+    out.load_permille = getBusLoadPermille(out.tx_bits + out.rx_bits, out.window_usec, bit_rate);
+    out.tx_load_permille = getBusLoadPermille(out.tx_bits, out.window_usec, bit_rate);
+    out.rx_load_permille = getBusLoadPermille(out.rx_bits, out.window_usec, bit_rate);
+    for (uint8_t k = 0; k < CANARD_BUSLOAD_NUM_PRIORITY_BANDS; k++)
+    {
+        out.priority_band_load_permille[k] = getBusLoadPermille(priority_band_bits[k], out.window_usec, bit_rate);
+    }
+    out.untracked_load_permille = getBusLoadPermille(untracked_bits, out.window_usec, bit_rate);
+
+#if CANARD_BUSLOAD_MAX_DATA_TYPES > 0
+    for (uint8_t i = 0; i < CANARD_BUSLOAD_MAX_DATA_TYPES; i++)
+    {
+        const uint32_t bits = getBusLoadDataTypeBits(state, i);
+        if ((state->data_type_keys[i] == 0U) || (bits == 0U))
+        {
+            continue;
+        }
+
+        // Insertion sort, heaviest first; the table is small
+        uint8_t position = out.num_data_types;
+        while ((position > 0U) && (out.data_types[position - 1U].bits < bits))
+        {
+            out.data_types[position] = out.data_types[position - 1U];
+            position--;
+        }
+        CanardBusLoadDataTypeStatistics* const entry = &out.data_types[position];
+        entry->data_type_id = (uint16_t) state->data_type_keys[i];
+        entry->service = (state->data_type_keys[i] & BUSLOAD_KEY_SERVICE) != 0U;
+        entry->bits = bits;
+        entry->load_permille = getBusLoadPermille(bits, out.window_usec, bit_rate);
+        out.num_data_types++;
+    }
+#endif
+    return out;
+}
+#endif
+
+#if CANARD_ENABLE_FLOAT16
+uint16_t canardConvertNativeFloatToFloat16(float value)
+{
+    CANARD_ASSERT(sizeof(float) == 4);
+
+    union FP32
+    {
+        uint32_t u;
+        float f;
+    };
+
+    const union FP32 f32inf = { 255UL << 23U };
+    const union FP32 f16inf = { 31UL << 23U };
+    const union FP32 magic = { 15UL << 23U };
+    const uint32_t sign_mask = 0x80000000UL;
+    const uint32_t round_mask = ~(uint32_t)0xFFFU;
+
+    union FP32 in;
+    in.f = value;
     uint32_t sign = in.u & sign_mask;
     in.u ^= sign;
 
@@ -1017,6 +2188,252 @@ float canardConvertFloat16ToNativeFloat(uint16_t value)
     return out.f;
 }
 
+#if CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_TABLE
+/*
+ * Integer-only conversions for cores without an FPU, where each floating point multiplication of the scalar
+ * functions is a library call. They reproduce the scalar functions bit by bit: the exponent is rebiased with a
+ * lookup table indexed by the sign and the exponent of the half, and the rounding of the float to half conversion
+ * (round half up at bit 12, after the low 12 bits are dropped) is done on the integer representation.
+ * The classic mantissa table (8 KB) is not used, it does not fit the flash budget of the node.
+ */
+static const uint32_t Float16ExponentTable[64] =
+{
+    0x00000000UL, 0x38800000UL, 0x39000000UL, 0x39800000UL, 0x3A000000UL, 0x3A800000UL, 0x3B000000UL, 0x3B800000UL,
+    0x3C000000UL, 0x3C800000UL, 0x3D000000UL, 0x3D800000UL, 0x3E000000UL, 0x3E800000UL, 0x3F000000UL, 0x3F800000UL,
+    0x40000000UL, 0x40800000UL, 0x41000000UL, 0x41800000UL, 0x42000000UL, 0x42800000UL, 0x43000000UL, 0x43800000UL,
+    0x44000000UL, 0x44800000UL, 0x45000000UL, 0x45800000UL, 0x46000000UL, 0x46800000UL, 0x47000000UL, 0x7F800000UL,
+    0x80000000UL, 0xB8800000UL, 0xB9000000UL, 0xB9800000UL, 0xBA000000UL, 0xBA800000UL, 0xBB000000UL, 0xBB800000UL,
+    0xBC000000UL, 0xBC800000UL, 0xBD000000UL, 0xBD800000UL, 0xBE000000UL, 0xBE800000UL, 0xBF000000UL, 0xBF800000UL,
+    0xC0000000UL, 0xC0800000UL, 0xC1000000UL, 0xC1800000UL, 0xC2000000UL, 0xC2800000UL, 0xC3000000UL, 0xC3800000UL,
+    0xC4000000UL, 0xC4800000UL, 0xC5000000UL, 0xC5800000UL, 0xC6000000UL, 0xC6800000UL, 0xC7000000UL, 0xFF800000UL
+};
+
+CANARD_INTERNAL uint16_t convertNativeFloatToFloat16Table(uint32_t bits)
+{
+    const uint32_t sign = bits & 0x80000000U;
+    uint32_t magnitude = bits ^ sign;
+    uint32_t out = 0;
+
+    if (magnitude >= 0x7F800000U)
+    {
+        out = (magnitude > 0x7F800000U) ? 0x7FFFU : 0x7C00U;
+    }
+    else
+    {
+        magnitude &= ~(uint32_t)0xFFFU;
+        const uint32_t exponent = magnitude >> 23U;
+        if (exponent >= 113U)
+        {
+            // Rebiasing is exact, then rounding and saturation to infinity
+            out = magnitude - (112U << 23U) + 0x1000U;
+            if (out > (31U << 23U))
+            {
+                out = 31U << 23U;
+            }
+        }
+        else
+        {
+            // The rebiased value is a float denormal, rounded to nearest even like the multiplication would do it
+            const uint32_t mantissa = (exponent == 0U) ? magnitude : ((magnitude & 0x7FFFFFU) | 0x800000U);
+            const uint32_t shift = 113U - ((exponent == 0U) ? 1U : exponent);
+            uint32_t denormal = 0;
+            if (shift < 25U)
+            {
+                const uint32_t remainder = mantissa & ((1U << shift) - 1U);
+                const uint32_t half = 1U << (shift - 1U);
+                denormal = mantissa >> shift;
+                if ((remainder > half) || ((remainder == half) && ((denormal & 1U) != 0U)))
+                {
+                    denormal++;
+                }
+            }
+            out = denormal + 0x1000U;
+        }
+        out >>= 13U;
+    }
+
+    return (uint16_t)(out | (sign >> 16U));
+}
+
+CANARD_INTERNAL uint32_t convertFloat16ToNativeFloatTable(uint16_t value)
+{
+    const uint32_t mantissa = value & 0x3FFU;
+    const uint32_t base = Float16ExponentTable[value >> 10U];
+    if (((value & 0x7C00U) != 0U) || (mantissa == 0U))
+    {
+        return base | (mantissa << 13U);
+    }
+
+    // Denormal half, normalized into a float
+    uint32_t normalized = mantissa;
+    uint32_t exponent = 113U;
+    while ((normalized & 0x400U) == 0U)
+    {
+        normalized <<= 1U;
+        exponent--;
+    }
+    return base | (exponent << 23U) | ((normalized & 0x3FFU) << 13U);
+}
+#endif
+
+#if (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_SSE2) || (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_F16C)
+/*
+ * The scalar algorithm, four values at a time. The hardware conversion of F16C rounds half to even and quiets NaNs,
+ * so it is not used in this direction: the results would differ from canardConvertNativeFloatToFloat16().
+ */
+CANARD_INTERNAL size_t convertNativeFloatArrayToFloat16Sse2(const float* values,
+                                                           uint16_t* out_values,
+                                                           size_t count)
+{
+    const __m128i sign_mask = _mm_set1_epi32((int32_t)0x80000000UL);
+    const __m128i f32inf = _mm_set1_epi32(255 << 23);
+    const __m128i f16inf = _mm_set1_epi32(31 << 23);
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(15 << 23));
+    const __m128i round_mask = _mm_set1_epi32(~0xFFF);
+    const __m128i nan_payload = _mm_set1_epi32(0x3FF);
+    const __m128i inf_out = _mm_set1_epi32(0x7C00);
+
+    size_t i = 0;
+    for (; (i + 4U) <= count; i += 4U)
+    {
+        const __m128i in = _mm_castps_si128(_mm_loadu_ps(&values[i]));
+        const __m128i sign = _mm_and_si128(in, sign_mask);
+        const __m128i magnitude = _mm_xor_si128(in, sign);
+
+        const __m128i is_inf_nan = _mm_cmpgt_epi32(magnitude, _mm_sub_epi32(f32inf, _mm_set1_epi32(1)));
+        const __m128i is_nan = _mm_cmpgt_epi32(magnitude, f32inf);
+        const __m128i special = _mm_or_si128(inf_out, _mm_and_si128(is_nan, nan_payload));
+
+        __m128i finite = _mm_and_si128(magnitude, round_mask);
+        finite = _mm_castps_si128(_mm_mul_ps(_mm_castsi128_ps(finite), magic));
+        finite = _mm_sub_epi32(finite, round_mask);
+        const __m128i overflow = _mm_cmpgt_epi32(finite, f16inf);
+        finite = _mm_or_si128(_mm_and_si128(overflow, f16inf), _mm_andnot_si128(overflow, finite));
+        finite = _mm_srli_epi32(finite, 13);
+
+        __m128i out = _mm_or_si128(_mm_and_si128(is_inf_nan, special), _mm_andnot_si128(is_inf_nan, finite));
+        out = _mm_or_si128(out, _mm_srli_epi32(sign, 16));
+
+        // Sign extension keeps the signed saturation of the packing from clipping values above 0x7FFF
+        out = _mm_srai_epi32(_mm_slli_epi32(out, 16), 16);
+        _mm_storel_epi64((__m128i*)(void*)&out_values[i], _mm_packs_epi32(out, out));
+    }
+    return i;
+}
+#endif
+
+#if CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_SSE2
+/*
+ * The scalar algorithm, eight values at a time.
+ */
+CANARD_INTERNAL size_t convertFloat16ArrayToNativeFloatSse2(const uint16_t* values,
+                                                           float* out_values,
+                                                           size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i magnitude_mask = _mm_set1_epi32(0x7FFF);
+    const __m128i sign_mask = _mm_set1_epi32(0x8000);
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+    const __m128 was_inf_nan = _mm_castsi128_ps(_mm_set1_epi32((127 + 16) << 23));
+    const __m128 f32inf = _mm_castsi128_ps(_mm_set1_epi32(255 << 23));
+
+    size_t i = 0;
+    for (; (i + 8U) <= count; i += 8U)
+    {
+        const __m128i in = _mm_loadu_si128((const __m128i*)(const void*)&values[i]);
+        const __m128i halves[2] = { _mm_unpacklo_epi16(in, zero), _mm_unpackhi_epi16(in, zero) };
+        for (unsigned k = 0; k < 2U; k++)
+        {
+            __m128 out = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(halves[k], magnitude_mask), 13));
+            out = _mm_mul_ps(out, magic);
+            out = _mm_or_ps(out, _mm_and_ps(_mm_cmpge_ps(out, was_inf_nan), f32inf));
+            out = _mm_or_ps(out, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(halves[k], sign_mask), 16)));
+            _mm_storeu_ps(&out_values[i + k * 4U], out);
+        }
+    }
+    return i;
+}
+#endif
+
+#if CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_F16C
+/*
+ * Hardware conversion, eight values at a time. It is exact, except that signaling NaNs come out quieted, while the
+ * scalar function keeps the payload as is; such blocks are redone with the scalar function.
+ */
+CANARD_INTERNAL size_t convertFloat16ArrayToNativeFloatF16c(const uint16_t* values,
+                                                           float* out_values,
+                                                           size_t count)
+{
+    const __m128i magnitude_mask = _mm_set1_epi16(0x7FFF);
+    const __m128i f16inf = _mm_set1_epi16(0x7C00);
+
+    size_t i = 0;
+    for (; (i + 8U) <= count; i += 8U)
+    {
+        const __m128i in = _mm_loadu_si128((const __m128i*)(const void*)&values[i]);
+        _mm256_storeu_ps(&out_values[i], _mm256_cvtph_ps(in));
+
+        const __m128i is_nan = _mm_cmpgt_epi16(_mm_and_si128(in, magnitude_mask), f16inf);
+        if (_mm_movemask_epi8(is_nan) != 0)
+        {
+            for (size_t k = i; k < (i + 8U); k++)
+            {
+                out_values[k] = canardConvertFloat16ToNativeFloat(values[k]);
+            }
+        }
+    }
+    return i;
+}
+#endif
+
+void canardConvertNativeFloatArrayToFloat16(const float* values,
+                                            uint16_t* out_values,
+                                            size_t count)
+{
+    CANARD_ASSERT(((values != NULL) && (out_values != NULL)) || (count == 0));
+
+    size_t i = 0;
+#if CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_TABLE
+    for (; i < count; i++)
+    {
+        uint32_t bits = 0;
+        memcpy(&bits, &values[i], sizeof(bits));
+        out_values[i] = convertNativeFloatToFloat16Table(bits);
+    }
+#elif (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_SSE2) || (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_F16C)
+    i = convertNativeFloatArrayToFloat16Sse2(values, out_values, count);
+#endif
+    for (; i < count; i++)
+    {
+        out_values[i] = canardConvertNativeFloatToFloat16(values[i]);
+    }
+}
+
+void canardConvertFloat16ArrayToNativeFloat(const uint16_t* values,
+                                            float* out_values,
+                                            size_t count)
+{
+    CANARD_ASSERT(((values != NULL) && (out_values != NULL)) || (count == 0));
+
+    size_t i = 0;
+#if CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_TABLE
+    for (; i < count; i++)
+    {
+        const uint32_t bits = convertFloat16ToNativeFloatTable(values[i]);
+        memcpy(&out_values[i], &bits, sizeof(bits));
+    }
+#elif CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_SSE2
+    i = convertFloat16ArrayToNativeFloatSse2(values, out_values, count);
+#elif CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_F16C
+    i = convertFloat16ArrayToNativeFloatF16c(values, out_values, count);
+#endif
+    for (; i < count; i++)
+    {
+        out_values[i] = canardConvertFloat16ToNativeFloat(values[i]);
+    }
+}
+#endif
+
 /*
  * Internal (static functions)
  */
@@ -1059,6 +2476,9 @@ CANARD_INTERNAL int16_t enqueueTxFrames(CanardInstance* ins,
 {
     CANARD_ASSERT(ins != NULL);
     CANARD_ASSERT((can_id & CANARD_CAN_EXT_ID_MASK) == can_id);            // Flags must be cleared 标记必须清除
+#if CANARD_ENABLE_MULTINODE
+    ins = getPoolOwner(ins);                                                // Hosted nodes use the host's TX queue
+#endif
 
     if (transfer_id == NULL)
     {
@@ -1070,13 +2490,47 @@ CANARD_INTERNAL int16_t enqueueTxFrames(CanardInstance* ins,
         return -CANARD_ERROR_INVALID_ARGUMENT;
     }
 
+#if CANARD_ENABLE_STATIC_CAPACITY
+    CanardStaticPublisher* const publisher = findStaticPublisher(ins, can_id);
+    if (publisher == NULL)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;     // No storage was defined for this data type
+    }
+
+    // The transfer is enqueued as a whole or not at all
+    const uint32_t frames_needed = CANARD_TX_FRAMES(payload_len);
+    const uint32_t slots_used = countUsedStaticTxSlots(publisher);
+    if ((slots_used + frames_needed) > publisher->num_slots)
+    {
+        publisher->rejected_transfers++;
+        TRACE_TX_OUT_OF_MEMORY(can_id, *transfer_id);
+        return -CANARD_ERROR_OUT_OF_MEMORY;
+    }
+    publisher->peak_used_slots = (uint8_t) MAX(publisher->peak_used_slots, slots_used + frames_needed);
+#elif !CANARD_ENABLE_CONCURRENCY
+    // The transfer is enqueued as a whole or not at all; with concurrency the frames are chained and freed instead
+    const CanardPoolAllocatorStatistics* const stats = &ins->allocator.statistics;
+    if (CANARD_TX_FRAMES(payload_len) > (uint32_t)(stats->capacity_blocks - stats->current_usage_blocks))
+    {
+        CanardPoolOwnerStatistics* const owner_stats = &ins->allocator.owner_statistics[CanardPoolOwnerTxFrame];
+        owner_stats->allocation_failures = (uint16_t) MIN(owner_stats->allocation_failures + 1U, UINT16_MAX);
+        TRACE_TX_OUT_OF_MEMORY(can_id, *transfer_id);
+        return -CANARD_ERROR_OUT_OF_MEMORY;
+    }
+#endif
+
     int16_t result = 0;
 
     if (payload_len < CANARD_CAN_FRAME_MAX_DATA_LEN)                        // Single frame transfer ，单帧传输
     {
+#if CANARD_ENABLE_STATIC_CAPACITY
+        CanardTxQueueItem* queue_item = claimStaticTxSlot(ins, publisher);
+#else
         CanardTxQueueItem* queue_item = createTxItem(&ins->allocator);
+#endif
         if (queue_item == NULL)
         {
+            TRACE_TX_OUT_OF_MEMORY(can_id, *transfer_id);
             return -CANARD_ERROR_OUT_OF_MEMORY;
         }
 
@@ -1086,23 +2540,40 @@ CANARD_INTERNAL int16_t enqueueTxFrames(CanardInstance* ins,
         queue_item->frame.data[payload_len] = (uint8_t)(0xC0U | (*transfer_id & 31U));
         queue_item->frame.id = can_id | CANARD_CAN_FRAME_EFF;
 
+#if CANARD_ENABLE_CONCURRENCY
+        submitTxChain(ins, queue_item, queue_item);
+#else
         pushTxQueue(ins, queue_item);
+#endif
         result++;
     }
     else                                                                    // Multi frame transfer，多帧传输
     {
+#if CANARD_ENABLE_MULTI_FRAME_TX
         uint16_t data_index = 0;
         uint8_t toggle = 0;
         uint8_t sot_eot = 0x80;
 
         CanardTxQueueItem* queue_item = NULL;
+#if CANARD_ENABLE_CONCURRENCY
+        CanardTxQueueItem* chain_newest = NULL;     // Frames are published only when the whole transfer is ready
+        CanardTxQueueItem* chain_oldest = NULL;
+#endif
 
         while (payload_len - data_index != 0)
         {
+#if CANARD_ENABLE_STATIC_CAPACITY
+            queue_item = claimStaticTxSlot(ins, publisher);
+#else
             queue_item = createTxItem(&ins->allocator);
+#endif
             if (queue_item == NULL)
             {
-                return -CANARD_ERROR_OUT_OF_MEMORY;          // TODO: Purge all frames enqueued so far，清除到目前为止排队的所有帧
+#if CANARD_ENABLE_CONCURRENCY
+                freeTxChain(ins, chain_newest);     // Nothing has been published yet, so the transfer is dropped whole
+#endif
+                TRACE_TX_OUT_OF_MEMORY(can_id, *transfer_id);
+                return -CANARD_ERROR_OUT_OF_MEMORY;
             }
 
             uint8_t i = 0;
@@ -1117,72 +2588,314 @@ CANARD_INTERNAL int16_t enqueueTxFrames(CanardInstance* ins,
             {
                 i = 0;
             }
-
-            for (; i < (CANARD_CAN_FRAME_MAX_DATA_LEN - 1) && data_index < payload_len; i++, data_index++)
+
+            for (; i < (CANARD_CAN_FRAME_MAX_DATA_LEN - 1) && data_index < payload_len; i++, data_index++)
+            {
+                queue_item->frame.data[i] = payload[data_index];
+            }
+            // tail byte
+            sot_eot = (data_index == payload_len) ? (uint8_t)0x40 : sot_eot;
+
+            queue_item->frame.data[i] = (uint8_t)(sot_eot | ((uint32_t)toggle << 5U) | ((uint32_t)*transfer_id & 31U));
+            queue_item->frame.id = can_id | CANARD_CAN_FRAME_EFF;
+            queue_item->frame.data_len = (uint8_t)(i + 1);
+#if CANARD_ENABLE_CONCURRENCY
+            queue_item->next = chain_newest;
+            chain_newest = queue_item;
+            chain_oldest = (chain_oldest == NULL) ? queue_item : chain_oldest;
+#else
+            pushTxQueue(ins, queue_item);
+#endif
+
+            result++;
+            toggle ^= 1;
+            sot_eot = 0;
+        }
+#if CANARD_ENABLE_CONCURRENCY
+        submitTxChain(ins, chain_newest, chain_oldest);
+#endif
+#else
+        (void) crc;
+        return -CANARD_ERROR_INVALID_ARGUMENT;  // Multi-frame transmission is disabled, see canard_config.h
+#endif
+    }
+
+    return result;
+}
+
+CANARD_INTERNAL int16_t beginTransfer(CanardInstance* ins,
+                                      CanardBitWriter* writer,
+                                      uint32_t can_id,
+                                      uint64_t data_type_signature,
+                                      uint8_t* inout_transfer_id,
+                                      bool anonymous,
+                                      bool increment_transfer_id)
+{
+    CANARD_ASSERT(ins != NULL);
+    CANARD_ASSERT((can_id & CANARD_CAN_EXT_ID_MASK) == can_id);
+
+    if ((writer == NULL) || (inout_transfer_id == NULL))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+#if CANARD_ENABLE_MULTINODE
+    writer->ins = getPoolOwner(ins);                        // Hosted nodes use the host's TX queue
+#else
+    writer->ins = ins;
+#endif
+#if CANARD_ENABLE_STATIC_CAPACITY
+    writer->publisher = findStaticPublisher(writer->ins, can_id);
+    if (writer->publisher == NULL)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;              // No storage was defined for this data type
+    }
+#endif
+    writer->inout_transfer_id = inout_transfer_id;
+    writer->can_id = can_id;
+    writer->anonymous = anonymous;
+    writer->increment_transfer_id = increment_transfer_id;
+#if CANARD_ENABLE_MULTI_FRAME_TX
+    writer->crc = crcAddSignature(0xFFFFU, data_type_signature);
+#else
+    (void) data_type_signature;
+    writer->crc = 0xFFFFU;
+#endif
+    return 0;
+}
+
+CANARD_INTERNAL CanardTxQueueItem* allocateWriterFrame(CanardBitWriter* writer)
+{
+#if CANARD_ENABLE_STATIC_CAPACITY
+    CanardTxQueueItem* const item = claimStaticTxSlot(writer->ins, writer->publisher);
+#else
+    CanardTxQueueItem* const item = createTxItem(&writer->ins->allocator);
+#endif
+    if (item == NULL)
+    {
+        writer->error = -CANARD_ERROR_OUT_OF_MEMORY;
+        return NULL;
+    }
+
+    if (writer->last_frame == NULL)
+    {
+        writer->first_frame = item;
+    }
+    else
+    {
+        writer->last_frame->next = item;
+    }
+    writer->last_frame = item;
+    writer->frame_len = 0;
+    writer->num_frames++;
+    return item;
+}
+
+CANARD_INTERNAL void releaseWriterFrames(CanardBitWriter* writer)
+{
+    while (writer->first_frame != NULL)
+    {
+        CanardTxQueueItem* const next = writer->first_frame->next;
+#if CANARD_ENABLE_STATIC_CAPACITY
+        releaseStaticTxSlot(writer->ins, writer->first_frame);
+#else
+        freeBlock(&writer->ins->allocator, CanardPoolOwnerTxFrame, writer->first_frame);
+#endif
+        writer->first_frame = next;
+    }
+    writer->last_frame = NULL;
+    writer->num_frames = 0;
+}
+
+CANARD_INTERNAL void putWriterByte(CanardBitWriter* writer, uint8_t byte)
+{
+    if (writer->error != 0)
+    {
+        return;
+    }
+    if (writer->payload_len == UINT16_MAX)
+    {
+        writer->error = -CANARD_ERROR_INVALID_ARGUMENT;
+        return;
+    }
+
+    if (writer->last_frame == NULL)
+    {
+        if (allocateWriterFrame(writer) == NULL)
+        {
+            return;
+        }
+    }
+    else if (writer->frame_len == (CANARD_CAN_FRAME_MAX_DATA_LEN - 1U))
+    {
+        CanardTxQueueItem* const full = writer->last_frame;
+        const uint8_t transfer_id = (uint8_t)(*writer->inout_transfer_id & 31U);
+
+        if (writer->num_frames == 1U)
+        {
+            /*
+             * The 8th payload byte makes it a multi-frame transfer. Up to this point the first frame has been laid out
+             * as a single frame one, so its payload is moved behind the CRC and the last two bytes of it go to
+             * the second frame.
+             */
+#if CANARD_ENABLE_MULTI_FRAME_TX
+            if (writer->anonymous)
+            {
+                writer->error = -CANARD_ERROR_NODE_ID_NOT_SET;
+                return;
+            }
+            if (allocateWriterFrame(writer) == NULL)
+            {
+                return;
+            }
+            writer->last_frame->frame.data[0] = full->frame.data[5];
+            writer->last_frame->frame.data[1] = full->frame.data[6];
+            writer->frame_len = 2;
+            memmove(&full->frame.data[2], &full->frame.data[0], 5);
+            full->frame.data[7] = (uint8_t)(0x80U | transfer_id);
+#else
+            writer->error = -CANARD_ERROR_INVALID_ARGUMENT;  // Multi-frame transmission is disabled
+            return;
+#endif
+        }
+        else
+        {
+            const uint32_t toggle = (uint32_t)(writer->num_frames - 1U) & 1U;
+            full->frame.data[7] = (uint8_t)((toggle << 5U) | transfer_id);
+            if (allocateWriterFrame(writer) == NULL)
             {
-                queue_item->frame.data[i] = payload[data_index];
+                return;
             }
-            // tail byte
-            sot_eot = (data_index == payload_len) ? (uint8_t)0x40 : sot_eot;
+        }
+        full->frame.data_len = CANARD_CAN_FRAME_MAX_DATA_LEN;
+    }
+    else
+    {
+        ;   // There is room in the last frame
+    }
 
-            queue_item->frame.data[i] = (uint8_t)(sot_eot | ((uint32_t)toggle << 5U) | ((uint32_t)*transfer_id & 31U));
-            queue_item->frame.id = can_id | CANARD_CAN_FRAME_EFF;
-            queue_item->frame.data_len = (uint8_t)(i + 1);
-            pushTxQueue(ins, queue_item);
+    writer->last_frame->frame.data[writer->frame_len++] = byte;
+    writer->payload_len++;
+#if CANARD_ENABLE_MULTI_FRAME_TX
+    writer->crc = crcAddByte(writer->crc, byte);
+#endif
+}
 
-            result++;
-            toggle ^= 1;
-            sot_eot = 0;
+CANARD_INTERNAL void putWriterBits(CanardBitWriter* writer,
+                                   uint64_t bits,
+                                   uint8_t bit_length)
+{
+    while (bit_length > 0)
+    {
+        const uint8_t amount = (uint8_t) MIN(bit_length, 8U - writer->pending_bits);
+        bit_length = (uint8_t)(bit_length - amount);
+
+        const uint32_t chunk = (uint32_t)(bits >> bit_length) & ((1U << amount) - 1U);
+        writer->pending_byte = (uint8_t)(((uint32_t) writer->pending_byte << amount) | chunk);
+        writer->pending_bits = (uint8_t)(writer->pending_bits + amount);
+        if (writer->pending_bits == 8U)
+        {
+            putWriterByte(writer, writer->pending_byte);
+            writer->pending_byte = 0;
+            writer->pending_bits = 0;
         }
     }
-
-    return result;
 }
 
-CANARD_INTERNAL int16_t singleEnqueueTxFrames(CanardInstance* ins,
-                                        uint32_t can_id,
-                                        uint8_t* transfer_id,
-                                        const uint8_t* payload,
-                                        uint16_t payload_len)
+CANARD_INTERNAL int16_t finishPrebuiltTransfer(CanardBitWriter* writer,
+                                               const CanardPrebuiltTransfer* transfer,
+                                               const uint8_t* variable_bytes)
 {
-    CANARD_ASSERT(ins != NULL);
-    CANARD_ASSERT((can_id & CANARD_CAN_EXT_ID_MASK) == can_id);            // Flags must be cleared 标记必须清除
+    CANARD_ASSERT(writer != NULL);
+    CANARD_ASSERT(transfer != NULL);
 
-    if (transfer_id == NULL)
+    // The writer holds no frames yet, so it can be left as it is on errors
+    if ((transfer->frames == NULL) ||
+        (transfer->num_frames != CANARD_TX_FRAMES(transfer->payload_len)) ||
+        ((transfer->num_fields > 0U) && ((transfer->fields == NULL) || (variable_bytes == NULL))))
     {
         return -CANARD_ERROR_INVALID_ARGUMENT;
     }
 
-    if ((payload_len > 0) && (payload == NULL))
+    const bool multi_frame = transfer->num_frames > 1U;
+    if (multi_frame)
     {
-        return -CANARD_ERROR_INVALID_ARGUMENT;
+#if CANARD_ENABLE_MULTI_FRAME_TX
+        if (writer->anonymous)
+        {
+            return -CANARD_ERROR_NODE_ID_NOT_SET;
+        }
+#else
+        return -CANARD_ERROR_INVALID_ARGUMENT;      // Multi-frame transmission is disabled, see canard_config.h
+#endif
     }
 
-    int16_t result = 0;
-
-    if (payload_len < CANARD_CAN_FRAME_MAX_DATA_LEN)                        // Single frame transfer ，单帧传输
+    uint32_t fields_end = 0;
+    for (uint8_t i = 0; i < transfer->num_fields; i++)
     {
-        CanardTxQueueItem* queue_item = createTxItem(&ins->allocator);
-        if (queue_item == NULL)
+        const CanardPrebuiltField* const field = &transfer->fields[i];
+        if ((field->offset < fields_end) || ((uint32_t)(field->offset + field->length) > transfer->payload_len))
         {
-            return -CANARD_ERROR_OUT_OF_MEMORY;
+            return -CANARD_ERROR_INVALID_ARGUMENT;
         }
+        fields_end = (uint32_t)(field->offset + field->length);
+    }
 
-        memcpy(queue_item->frame.data, payload, payload_len);// 数据拷贝
-
-        queue_item->frame.data_len = (uint8_t)(payload_len + 1);
-        queue_item->frame.data[payload_len] = (uint8_t)(0xC0U | (*transfer_id & 31U));
-        queue_item->frame.id = can_id | CANARD_CAN_FRAME_EFF; //设置扩展帧格式
-
-        pushTxQueue(ins, queue_item);
-        result++;
+    // The frames are copied as they are; the tail byte of the last frame is written by canardFinishTransfer()
+    const uint8_t transfer_id = (uint8_t)(*writer->inout_transfer_id & 31U);
+    for (uint8_t i = 0; i < transfer->num_frames; i++)
+    {
+        CanardTxQueueItem* const item = allocateWriterFrame(writer);
+        if (item == NULL)
+        {
+            return canardFinishTransfer(writer);    // Drops the frames and reports the error
+        }
+        memcpy(item->frame.data, &transfer->frames[i * CANARD_CAN_FRAME_MAX_DATA_LEN], CANARD_CAN_FRAME_MAX_DATA_LEN);
+        item->frame.data[CANARD_CAN_FRAME_MAX_DATA_LEN - 1U] |= transfer_id;
+        item->frame.data_len = CANARD_CAN_FRAME_MAX_DATA_LEN;
     }
-    else
+    writer->payload_len = transfer->payload_len;
+    writer->frame_len = (uint8_t)(multi_frame ?
+                                  (transfer->payload_len + 2U - (transfer->num_frames - 1U) * 7U) :
+                                  transfer->payload_len);
+#if CANARD_ENABLE_MULTI_FRAME_TX
+    writer->crc = (uint16_t)(transfer->frames[0] | ((uint32_t) transfer->frames[1] << 8U));
+#endif
+
+    /*
+     * Every variable byte is written into the frame where it belongs; the frames and the fields are in the payload
+     * order, so the frames are walked once. The CRC of a multi-frame transfer is corrected by the CRC of the
+     * difference between the prebuilt bytes and the new ones, see crcMultiply().
+     */
+    CanardTxQueueItem* item = writer->first_frame;
+    uint32_t item_index = 0;
+    for (uint8_t i = 0; i < transfer->num_fields; i++)
     {
-        return -CANARD_ERROR_INVALID_ARGUMENT;
+        const CanardPrebuiltField* const field = &transfer->fields[i];
+#if CANARD_ENABLE_MULTI_FRAME_TX
+        uint16_t difference_crc = 0;
+#endif
+        for (uint32_t offset = field->offset; offset < (uint32_t)(field->offset + field->length); offset++)
+        {
+            const uint32_t position = multi_frame ? (offset + 2U) : offset;     // The CRC precedes the payload
+            while (item_index < (position / 7U))
+            {
+                item = item->next;
+                item_index++;
+            }
+            const uint8_t value = *variable_bytes++;
+#if CANARD_ENABLE_MULTI_FRAME_TX
+            difference_crc = crcAddByte(difference_crc, (uint8_t)(item->frame.data[position % 7U] ^ value));
+#endif
+            item->frame.data[position % 7U] = value;
+        }
+#if CANARD_ENABLE_MULTI_FRAME_TX
+        writer->crc = (uint16_t)(writer->crc ^ crcMultiply(difference_crc, field->crc_shift));
+#endif
     }
-    
-    return result;
+
+    return canardFinishTransfer(writer);
 }
 
 /**
@@ -1193,6 +2906,7 @@ CANARD_INTERNAL void pushTxQueue(CanardInstance* ins, CanardTxQueueItem* item)
 {
     CANARD_ASSERT(ins != NULL);
     CANARD_ASSERT(item->frame.data_len > 0);       // UAVCAN doesn't allow zero-payload frames
+    TRACE_FRAME(CanardTraceEventTxEnqueue, 0, &item->frame);
 
     if (ins->tx_queue == NULL)
     {
@@ -1235,20 +2949,165 @@ CANARD_INTERNAL void pushTxQueue(CanardInstance* ins, CanardTxQueueItem* item)
     }
 }
 
+#if CANARD_ENABLE_CONCURRENCY
+/**
+ * Publishes a chain of TX items on the lock-free submission stack with a single atomic operation.
+ * The chain is linked from the newest item to the oldest one; any thread can call this.
+ */
+CANARD_INTERNAL void submitTxChain(CanardInstance* ins, CanardTxQueueItem* newest, CanardTxQueueItem* oldest)
+{
+    CANARD_ASSERT(ins != NULL);
+    CANARD_ASSERT((newest != NULL) && (oldest != NULL));
+
+    oldest->next = __atomic_load_n(&ins->tx_submissions, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&ins->tx_submissions, &oldest->next, newest,
+                                        true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    {
+        // oldest->next has been updated with the current top of the stack, retrying
+    }
+}
+
+/**
+ * Moves all submitted items into the priority TX queue. Must be called from the TX thread only.
+ * The submission stack is LIFO, so it is reversed first; this way frames with equal CAN ID (e.g. the frames of one
+ * transfer) keep their submission order in the TX queue.
+ */
+CANARD_INTERNAL void drainTxSubmissions(CanardInstance* ins)
+{
+    CanardTxQueueItem* item = __atomic_exchange_n(&ins->tx_submissions, NULL, __ATOMIC_ACQUIRE);
+    CanardTxQueueItem* reversed = NULL;
+
+    while (item != NULL)
+    {
+        CanardTxQueueItem* const next = item->next;
+        item->next = reversed;
+        reversed = item;
+        item = next;
+    }
+
+    while (reversed != NULL)
+    {
+        CanardTxQueueItem* const next = reversed->next;
+        reversed->next = NULL;
+        pushTxQueue(ins, reversed);
+        reversed = next;
+    }
+}
+
+# if CANARD_ENABLE_MULTI_FRAME_TX
+/**
+ * Returns a chain of TX items that has not been published back to the allocator.
+ */
+CANARD_INTERNAL void freeTxChain(CanardInstance* ins, CanardTxQueueItem* chain)
+{
+    while (chain != NULL)
+    {
+        CanardTxQueueItem* const next = chain->next;
+        freeBlock(&ins->allocator, CanardPoolOwnerTxFrame, chain);
+        chain = next;
+    }
+}
+# endif
+#endif
+
+#if CANARD_ENABLE_MULTINODE
+/**
+ * Returns true if the instance is the bus instance of a multi-node host
+ */
+CANARD_INTERNAL bool isMultiNodeHostBus(const CanardInstance* ins)
+{
+    return (ins->host != NULL) && (&ins->host->bus == ins);
+}
+
+/**
+ * Returns the instance that owns the pool and the TX queue used by the given instance
+ */
+CANARD_INTERNAL CanardInstance* getPoolOwner(CanardInstance* ins)
+{
+    return (ins->host != NULL) ? &ins->host->bus : ins;
+}
+
+/**
+ * Acceptance filter of the bus instance of a multi-node host.
+ * Services are filtered by the addressed node; messages are accepted if any hosted node except the source wants them.
+ */
+CANARD_INTERNAL bool multiNodeHostShouldAccept(const CanardInstance* ins,
+                                               uint64_t* out_data_type_signature,
+                                               uint16_t data_type_id,
+                                               CanardTransferType transfer_type,
+                                               uint8_t source_node_id)
+{
+    const CanardMultiNodeHost* const host = ins->host;
+
+    if (transfer_type != CanardTransferTypeBroadcast)
+    {
+        const CanardInstance* const node = host->nodes[host->rx_destination_node_id];
+        return (node != NULL) &&
+               node->should_accept(node, out_data_type_signature, data_type_id, transfer_type, source_node_id);
+    }
+
+    for (const CanardInstance* node = host->node_list; node != NULL; node = node->next_hosted)
+    {
+        if ((node->node_id != source_node_id) &&
+            node->should_accept(node, out_data_type_signature, data_type_id, transfer_type, source_node_id))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Reception callback of the bus instance of a multi-node host; fans the transfer out to the hosted nodes.
+ * Every node gets its own copy of the transfer object, the payload storage is shared.
+ */
+CANARD_INTERNAL void multiNodeHostOnReception(CanardInstance* ins,
+                                              CanardRxTransfer* transfer)
+{
+    CanardMultiNodeHost* const host = ins->host;
+
+    if (transfer->transfer_type != CanardTransferTypeBroadcast)
+    {
+        CanardInstance* const node = host->nodes[host->rx_destination_node_id];
+        if (node != NULL)
+        {
+            CanardRxTransfer node_transfer = *transfer;
+            node->on_reception(node, &node_transfer);
+        }
+        return;
+    }
+
+    for (CanardInstance* node = host->node_list; node != NULL; node = node->next_hosted)
+    {
+        uint64_t data_type_signature = 0;
+        if ((node->node_id != transfer->source_node_id) &&
+            node->should_accept(node, &data_type_signature, transfer->data_type_id,
+                                (CanardTransferType) transfer->transfer_type, transfer->source_node_id))
+        {
+            CanardRxTransfer node_transfer = *transfer;
+            node->on_reception(node, &node_transfer);
+        }
+    }
+}
+#endif
+
+#if !CANARD_ENABLE_STATIC_CAPACITY
 /**
  * Creates new tx queue item from allocator
  * 从分配器创建新的TX队列
  */
 CANARD_INTERNAL CanardTxQueueItem* createTxItem(CanardPoolAllocator* allocator)
 {
-    CanardTxQueueItem* item = (CanardTxQueueItem*) allocateBlock(allocator);
+    CanardTxQueueItem* item = (CanardTxQueueItem*) allocateBlock(allocator, CanardPoolOwnerTxFrame);
     if (item == NULL)
     {
         return NULL;
     }
     memset(item, 0, sizeof(*item));
+    LATENCY_TX_ENQUEUE(item);
     return item;
 }
+#endif
 
 /**
  * Returns true if priority of rhs is higher than id
@@ -1294,6 +3153,7 @@ CANARD_INTERNAL bool isPriorityHigher(uint32_t rhs, uint32_t id)
     return clean_id < rhs_clean_id;
 }
 
+#if !CANARD_ENABLE_STATIC_CAPACITY
 /**
  * preps the rx state for the next transfer. does not delete the state
  */
@@ -1304,6 +3164,7 @@ CANARD_INTERNAL void prepareForNextTransfer(CanardRxState* state)
     state->payload_len = 0;
     state->next_toggle = 0;
 }
+#endif
 
 /**
  * returns data type from id
@@ -1345,6 +3206,244 @@ CANARD_INTERNAL CanardTransferType extractTransferType(uint32_t id)
     }
 }
 
+#if CANARD_ENABLE_TRACE
+/**
+ * Records a transfer that could not be enqueued. There is no frame, so the event holds the CAN ID and the tail byte
+ * the transfer would have ended with.
+ */
+CANARD_INTERNAL void traceTxOutOfMemory(uint32_t can_id, uint8_t transfer_id)
+{
+    CanardCANFrame frame;
+    frame.id = can_id | CANARD_CAN_FRAME_EFF;
+    frame.data[0] = (uint8_t)(0x40U | (transfer_id & 31U));
+    frame.data_len = 1;
+    canardTraceRecord(CanardTraceEventDrop, CanardTraceDropTxOutOfMemory, &frame);
+}
+
+CANARD_INTERNAL void putTraceWord(uint8_t* bytes, uint32_t value)
+{
+    bytes[0] = (uint8_t) value;
+    bytes[1] = (uint8_t)(value >> 8U);
+    bytes[2] = (uint8_t)(value >> 16U);
+    bytes[3] = (uint8_t)(value >> 24U);
+}
+
+/**
+ * Writes the event in the layout of the dump, which is that of CanardTraceEntry in little endian.
+ */
+CANARD_INTERNAL void serializeTraceEntry(const CanardTraceEntry* entry, uint8_t* out_bytes)
+{
+    putTraceWord(&out_bytes[0], entry->timestamp);
+    putTraceWord(&out_bytes[4], entry->can_id);
+    out_bytes[8] = entry->event;
+    out_bytes[9] = entry->detail;
+    out_bytes[10] = entry->data_len;
+    out_bytes[11] = entry->tail_byte;
+#if CANARD_TRACE_FRAME_DATA
+    memcpy(&out_bytes[12], entry->data, sizeof(entry->data));
+#endif
+}
+#endif
+
+/*
+ * Bus load accounting
+ */
+CANARD_INTERNAL void putFrameBits(CanardFrameBitStream* stream, uint32_t value, uint8_t width)
+{
+    while (width > 0U)
+    {
+        width--;
+        const uint8_t bit = (uint8_t)((value >> width) & 1U);
+
+        const bool invert = (bit != 0U) != ((stream->crc & 0x4000U) != 0U);
+        stream->crc = (uint16_t)((stream->crc << 1U) & 0x7FFFU);
+        if (invert)
+        {
+            stream->crc ^= CAN_CRC_POLYNOMIAL;
+        }
+
+        // A stuff bit follows every run of five equal bits, and starts the next run itself
+        stream->bit_count++;
+        if (bit == stream->run_level)
+        {
+            stream->run_length++;
+        }
+        else
+        {
+            stream->run_level = bit;
+            stream->run_length = 1U;
+        }
+        if (stream->run_length == CAN_STUFF_RUN_LENGTH)
+        {
+            stream->bit_count++;
+            stream->run_level ^= 1U;
+            stream->run_length = 1U;
+        }
+    }
+}
+
+#if CANARD_ENABLE_BUSLOAD
+CANARD_INTERNAL void advanceBusLoadWindow(CanardBusLoadState* state, uint64_t current_time_usec)
+{
+    if (current_time_usec < state->now_usec)
+    {
+        return;     // A frame timestamped before the last update, or another clock
+    }
+
+    uint64_t elapsed_usec = current_time_usec - state->slot_started_usec;
+    if ((state->filled_slots == 0U) ||
+        (elapsed_usec >= (uint64_t) CANARD_BUSLOAD_SLOT_USEC * CANARD_BUSLOAD_NUM_SLOTS))
+    {
+        // The first update, or idle for longer than the window: the window starts over
+        memset(state->slots, 0, sizeof(state->slots));
+        state->current_slot = 0;
+        state->filled_slots = 1;
+        state->slot_started_usec = current_time_usec;
+    }
+    else
+    {
+        while (elapsed_usec >= CANARD_BUSLOAD_SLOT_USEC)
+        {
+            state->current_slot = (uint8_t)((state->current_slot + 1U) % CANARD_BUSLOAD_NUM_SLOTS);
+            memset(&state->slots[state->current_slot], 0, sizeof(CanardBusLoadSlot));
+            if (state->filled_slots < CANARD_BUSLOAD_NUM_SLOTS)
+            {
+                state->filled_slots++;
+            }
+            state->slot_started_usec += CANARD_BUSLOAD_SLOT_USEC;
+            elapsed_usec -= CANARD_BUSLOAD_SLOT_USEC;
+        }
+    }
+    state->now_usec = current_time_usec;
+}
+
+CANARD_INTERNAL void accountBusLoad(CanardBusLoadState* state, const CanardCANFrame* frame, bool tx)
+{
+    CanardBusLoadSlot* const slot = &state->slots[state->current_slot];
+#if CANARD_BUSLOAD_WORST_CASE_STUFFING
+    const uint32_t bits = canardGetWorstCaseFrameBitLength(frame->data_len, (frame->id & CANARD_CAN_FRAME_EFF) != 0U);
+#else
+    const uint32_t bits = canardGetFrameBitLength(frame);
+#endif
+    if (tx)
+    {
+        slot->tx_bits += bits;
+    }
+    else
+    {
+        slot->rx_bits += bits;
+    }
+
+    if (((frame->id & CANARD_CAN_FRAME_EFF) == 0U) ||
+        ((frame->id & (CANARD_CAN_FRAME_RTR | CANARD_CAN_FRAME_ERR)) != 0U) ||
+        (frame->data_len < 1U))
+    {
+        slot->untracked_bits += bits;       // Not UAVCAN
+        return;
+    }
+    slot->priority_band_bits[PRIORITY_FROM_ID(frame->id) >> 3U] += bits;
+
+#if CANARD_BUSLOAD_MAX_DATA_TYPES > 0
+    const uint32_t key = BUSLOAD_KEY_USED | extractDataType(frame->id) |
+                         ((extractTransferType(frame->id) != CanardTransferTypeBroadcast) ? BUSLOAD_KEY_SERVICE : 0U);
+    uint8_t vacant = CANARD_BUSLOAD_MAX_DATA_TYPES;
+    for (uint8_t i = 0; i < CANARD_BUSLOAD_MAX_DATA_TYPES; i++)
+    {
+        if (state->data_type_keys[i] == key)
+        {
+            slot->data_type_bits[i] += bits;
+            return;
+        }
+        if ((vacant == CANARD_BUSLOAD_MAX_DATA_TYPES) &&
+            ((state->data_type_keys[i] == 0U) || (getBusLoadDataTypeBits(state, i) == 0U)))
+        {
+            vacant = i;
+        }
+    }
+    if (vacant < CANARD_BUSLOAD_MAX_DATA_TYPES)
+    {
+        state->data_type_keys[vacant] = key;
+        slot->data_type_bits[vacant] += bits;
+        return;
+    }
+#endif
+    slot->untracked_bits += bits;
+}
+
+CANARD_INTERNAL void accountRxBusLoad(CanardBusLoadState* state, const CanardCANFrame* frame, uint64_t timestamp_usec)
+{
+    advanceBusLoadWindow(state, timestamp_usec);
+    accountBusLoad(state, frame, false);
+}
+
+#if CANARD_BUSLOAD_MAX_DATA_TYPES > 0
+CANARD_INTERNAL uint32_t getBusLoadDataTypeBits(const CanardBusLoadState* state, uint8_t index)
+{
+    uint32_t bits = 0U;
+    for (uint8_t i = 0; i < CANARD_BUSLOAD_NUM_SLOTS; i++)
+    {
+        bits += state->slots[i].data_type_bits[index];
+    }
+    return bits;
+}
+#endif
+
+CANARD_INTERNAL uint16_t getBusLoadPermille(uint32_t bits, uint32_t window_usec, uint32_t bit_rate)
+{
+    const uint64_t window_bits = (uint64_t) bit_rate * window_usec;
+    if (window_bits == 0U)
+    {
+        return 0U;
+    }
+    const uint64_t permille = ((uint64_t) bits * 1000000000ULL + window_bits / 2U) / window_bits;
+    return (uint16_t)((permille > 0xFFFFU) ? 0xFFFFU : permille);
+}
+#endif
+
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+/*
+ * Latency histograms
+ */
+CANARD_INTERNAL uint16_t getLatencyBucket(uint32_t ticks)
+{
+    if ((ticks >> (CANARD_LATENCY_RANGE_BITS - 1U)) > 1U)
+    {
+        return (uint16_t)(CANARD_LATENCY_NUM_BUCKETS - 1U);     // Out of range, the maximum tells how far
+    }
+    if (ticks < (1UL << CANARD_LATENCY_SUB_BUCKET_BITS))
+    {
+        return (uint16_t) ticks;                                // Small values are exact
+    }
+
+    // Position of the most significant bit; a single instruction on Cortex-M3
+#if defined(__GNUC__)
+    const uint8_t msb = (uint8_t)(31U - (uint32_t) __builtin_clz(ticks));
+#else
+    uint8_t msb = 0U;
+    while ((ticks >> msb) > 1U)
+    {
+        msb++;
+    }
+#endif
+    const uint8_t shift = (uint8_t)(msb - CANARD_LATENCY_SUB_BUCKET_BITS);
+    const uint32_t sub_bucket = (ticks >> shift) & ((1UL << CANARD_LATENCY_SUB_BUCKET_BITS) - 1U);
+    return (uint16_t)(((uint32_t)(shift + 1U) << CANARD_LATENCY_SUB_BUCKET_BITS) | sub_bucket);
+}
+
+CANARD_INTERNAL uint32_t getLatencyBucketUpperBound(uint16_t bucket)
+{
+    if (bucket < (1UL << CANARD_LATENCY_SUB_BUCKET_BITS))
+    {
+        return bucket;
+    }
+    const uint8_t shift = (uint8_t)((bucket >> CANARD_LATENCY_SUB_BUCKET_BITS) - 1U);
+    const uint32_t lower_bound = (uint32_t)((1UL << CANARD_LATENCY_SUB_BUCKET_BITS) +
+                                            (bucket & ((1UL << CANARD_LATENCY_SUB_BUCKET_BITS) - 1U))) << shift;
+    return lower_bound + (uint32_t)((1UL << shift) - 1U);
+}
+#endif
+
+#if !CANARD_ENABLE_STATIC_CAPACITY
 /*
  *  CanardRxState functions
  */
@@ -1424,7 +3523,7 @@ CANARD_INTERNAL CanardRxState* createRxState(CanardPoolAllocator* allocator, uin
         .dtid_tt_snid_dnid = transfer_descriptor
     };
 
-    CanardRxState* state = (CanardRxState*) allocateBlock(allocator);
+    CanardRxState* state = (CanardRxState*) allocateBlock(allocator, CanardPoolOwnerRxState);
     if (state == NULL)
     {
         return NULL;
@@ -1439,13 +3538,15 @@ CANARD_INTERNAL uint64_t releaseStatePayload(CanardInstance* ins, CanardRxState*
     while (rxstate->buffer_blocks != NULL)
     {
         CanardBufferBlock* const temp = rxstate->buffer_blocks->next;
-        freeBlock(&ins->allocator, rxstate->buffer_blocks);
+        freeBlock(&ins->allocator, CanardPoolOwnerRxBuffer, rxstate->buffer_blocks);
         rxstate->buffer_blocks = temp;
     }
     rxstate->payload_len = 0;
     return CANARD_OK;
 }
+#endif
 
+#if CANARD_ENABLE_MULTI_FRAME_RX && !CANARD_ENABLE_STATIC_CAPACITY
 /*
  *  CanardBufferBlock functions
  */
@@ -1552,7 +3653,7 @@ CANARD_INTERNAL int16_t bufferBlockPushBytes(CanardPoolAllocator* allocator,
 
 CANARD_INTERNAL CanardBufferBlock* createBufferBlock(CanardPoolAllocator* allocator)
 {
-    CanardBufferBlock* block = (CanardBufferBlock*) allocateBlock(allocator);
+    CanardBufferBlock* block = (CanardBufferBlock*) allocateBlock(allocator, CanardPoolOwnerRxBuffer);
     if (block == NULL)
     {
         return NULL;
@@ -1560,6 +3661,7 @@ CANARD_INTERNAL CanardBufferBlock* createBufferBlock(CanardPoolAllocator* alloca
     block->next = NULL;
     return block;
 }
+#endif
 
 /**
  * Bit array copy routine, originally developed by Ben Dyer for Libuavcan. Thanks Ben.
@@ -1576,7 +3678,7 @@ void copyBitArray(const uint8_t* src, uint32_t src_offset, uint32_t src_len,
     src_offset %= 8U;
     dst_offset %= 8U;
 
-    const size_t last_bit = src_offset + src_len;
+    const uint32_t last_bit = src_offset + src_len;
     while (last_bit - src_offset)
     {
         const uint8_t src_bit_offset = (uint8_t)(src_offset % 8U);
@@ -1615,6 +3717,7 @@ CANARD_INTERNAL int16_t descatterTransferPayload(const CanardRxTransfer* transfe
 
     CANARD_ASSERT(bit_length > 0);
 
+#if CANARD_ENABLE_MULTI_FRAME_RX && !CANARD_ENABLE_STATIC_CAPACITY
     if ((transfer->payload_middle != NULL) || (transfer->payload_tail != NULL)) // Multi frame
     {
         /*
@@ -1640,14 +3743,14 @@ CANARD_INTERNAL int16_t descatterTransferPayload(const CanardRxTransfer* transfe
         }
 
         // Reading middle
-        uint32_t remaining_bits = transfer->payload_len * 8U - CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE * 8U;
+        uint32_t remaining_bits = (uint32_t)(transfer->payload_len * 8U - CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE * 8U);
         uint32_t block_bit_offset = CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE * 8U;
         const CanardBufferBlock* block = transfer->payload_middle;
 
         while ((block != NULL) && (remaining_bit_length > 0))
         {
             CANARD_ASSERT(remaining_bits > 0);
-            const uint32_t block_end_bit_offset = block_bit_offset + MIN(CANARD_BUFFER_BLOCK_DATA_SIZE * 8,
+            const uint32_t block_end_bit_offset = block_bit_offset + MIN((uint32_t)CANARD_BUFFER_BLOCK_DATA_SIZE * 8U,
                                                                          remaining_bits);
 
             // Perform copy if we've reached the requested offset, otherwise jump over this block and try next
@@ -1692,6 +3795,7 @@ CANARD_INTERNAL int16_t descatterTransferPayload(const CanardRxTransfer* transfe
         CANARD_ASSERT(remaining_bit_length == 0);
     }
     else                                                                    // Single frame
+#endif
     {
         copyBitArray(&transfer->payload_head[0], bit_offset, bit_length, (uint8_t*) output, 0);
     }
@@ -1699,6 +3803,187 @@ CANARD_INTERNAL int16_t descatterTransferPayload(const CanardRxTransfer* transfe
     return bit_length;
 }
 
+CANARD_INTERNAL bool advanceRxPayloadReader(CanardRxPayloadReader* reader)
+{
+    const CanardRxTransfer* const transfer = reader->transfer;
+    if (reader->end >= transfer->payload_len)
+    {
+        return false;
+    }
+
+#if CANARD_ENABLE_MULTI_FRAME_RX && !CANARD_ENABLE_STATIC_CAPACITY
+    if (reader->next_block != NULL)
+    {
+        reader->begin = reader->end;
+        reader->data = &reader->next_block->data[0];
+        reader->end = (uint16_t)MIN((uint32_t)transfer->payload_len,
+                                    (uint32_t)reader->begin + CANARD_BUFFER_BLOCK_DATA_SIZE);
+        reader->next_block = reader->next_block->next;
+        return true;
+    }
+    if (transfer->payload_tail != NULL)
+    {
+        // Whatever did not fit into the head and the middle blocks is in the tail
+        reader->begin = reader->end;
+        reader->data = transfer->payload_tail;
+        reader->end = transfer->payload_len;
+        return true;
+    }
+    CANARD_ASSERT(false);
+    return false;
+#else
+    CANARD_ASSERT(false);       // Single frame payloads are contiguous
+    return false;
+#endif
+}
+
+CANARD_INTERNAL void initRxBitCursor(CanardRxBitCursor* cursor,
+                                     CanardRxPayloadReader* reader,
+                                     uint32_t bit_offset)
+{
+    cursor->reader = reader;
+    cursor->next_byte = bit_offset / 8U;
+    cursor->bits = 0;
+    cursor->bit_count = 0;
+    if ((bit_offset % 8U) != 0U)
+    {
+        (void) takeRxBits(cursor, (uint8_t)(bit_offset % 8U));      // Skipping the leading bits of the first byte
+    }
+}
+
+CANARD_INTERNAL uint64_t takeRxBits(CanardRxBitCursor* cursor,
+                                    uint8_t bit_length)
+{
+    CanardRxPayloadReader* const reader = cursor->reader;
+    uint64_t result = 0;
+    while (bit_length > 0)
+    {
+        // Taking at most 32 bits at a time, so that the queue never holds more than 64 bits
+        const uint8_t amount = (uint8_t) MIN(bit_length, 32U);
+        while (cursor->bit_count < amount)
+        {
+            uint8_t byte = 0;
+            if ((cursor->next_byte >= reader->begin) && (cursor->next_byte < reader->end))
+            {
+                byte = reader->data[cursor->next_byte - reader->begin];
+            }
+            else if (cursor->next_byte < reader->transfer->payload_len)
+            {
+                (void) canardReadRxPayload(reader, (uint16_t) cursor->next_byte, 1U, &byte);
+            }
+            else
+            {
+                ;   // Past the end of the payload
+            }
+            cursor->next_byte++;
+            cursor->bits = (cursor->bits << 8U) | byte;
+            cursor->bit_count = (uint8_t)(cursor->bit_count + 8U);
+        }
+
+        cursor->bit_count = (uint8_t)(cursor->bit_count - amount);
+        result = (result << amount) | ((cursor->bits >> cursor->bit_count) & ((((uint64_t) 1) << amount) - 1U));
+        bit_length = (uint8_t)(bit_length - amount);
+    }
+    return result;
+}
+
+CANARD_INTERNAL void initTxBitCursor(CanardTxBitCursor* cursor,
+                                     uint8_t* destination,
+                                     uint32_t bit_offset)
+{
+    const uint8_t skip = (uint8_t)(bit_offset % 8U);
+    cursor->destination = destination;
+    cursor->next_byte = bit_offset / 8U;
+    cursor->bits = (skip != 0U) ? (uint64_t)(destination[cursor->next_byte] >> (8U - skip)) : 0U;
+    cursor->bit_count = skip;
+}
+
+CANARD_INTERNAL void putTxBits(CanardTxBitCursor* cursor,
+                               uint64_t bits,
+                               uint8_t bit_length)
+{
+    while (bit_length > 0)
+    {
+        const uint8_t amount = (uint8_t) MIN(bit_length, 32U);
+        bit_length = (uint8_t)(bit_length - amount);
+
+        cursor->bits = (cursor->bits << amount) | ((bits >> bit_length) & ((((uint64_t) 1) << amount) - 1U));
+        cursor->bit_count = (uint8_t)(cursor->bit_count + amount);
+        while (cursor->bit_count >= 8U)
+        {
+            cursor->bit_count = (uint8_t)(cursor->bit_count - 8U);
+            cursor->destination[cursor->next_byte++] = (uint8_t)(cursor->bits >> cursor->bit_count);
+        }
+    }
+}
+
+CANARD_INTERNAL void flushTxBitCursor(CanardTxBitCursor* cursor)
+{
+    if (cursor->bit_count > 0U)
+    {
+        uint8_t* const byte = &cursor->destination[cursor->next_byte];
+        const uint8_t kept = (uint8_t)(0xFFU >> cursor->bit_count);
+        *byte = (uint8_t)((*byte & kept) | (uint8_t)(cursor->bits << (8U - cursor->bit_count)));
+    }
+}
+
+CANARD_INTERNAL uint64_t scalarToStreamBits(uint64_t value,
+                                            uint8_t bit_length)
+{
+    uint64_t bits = 0;
+    uint8_t remaining = bit_length;
+    while (remaining >= 8U)
+    {
+        bits = (bits << 8U) | (value & 0xFFU);
+        value >>= 8U;
+        remaining = (uint8_t)(remaining - 8U);
+    }
+    if (remaining > 0U)
+    {
+        bits = (bits << remaining) | (value & ((1U << remaining) - 1U));
+    }
+    return bits;
+}
+
+CANARD_INTERNAL uint64_t streamBitsToScalar(uint64_t bits,
+                                            uint8_t bit_length)
+{
+    const uint8_t whole_bytes = (uint8_t)(bit_length / 8U);
+    const uint8_t remaining = (uint8_t)(bit_length % 8U);
+    uint64_t value = 0;
+    if (remaining > 0U)
+    {
+        value = (bits & ((1U << remaining) - 1U)) << (8U * whole_bytes);
+        bits >>= remaining;
+    }
+    for (uint8_t i = whole_bytes; i > 0U; i--)
+    {
+        value |= (bits & 0xFFU) << (8U * (i - 1U));
+        bits >>= 8U;
+    }
+    return value;
+}
+
+CANARD_INTERNAL uint8_t getArrayElementSize(uint8_t bit_length)
+{
+    if      (bit_length == 1)   { return sizeof(bool); }
+    else if (bit_length <= 8)   { return 1; }
+    else if (bit_length <= 16)  { return 2; }
+    else if (bit_length <= 32)  { return 4; }
+    else                        { return 8; }
+}
+
+CANARD_INTERNAL uint64_t loadArrayElement(const void* element,
+                                          uint8_t bit_length)
+{
+    const uint8_t element_size = getArrayElementSize(bit_length);
+    if      (bit_length == 1)       { return (*((const bool*) element) != 0) ? 1U : 0U; }
+    else if (element_size == 1U)    { return *((const uint8_t*) element); }
+    else if (element_size == 2U)    { return *((const uint16_t*) element); }
+    else if (element_size == 4U)    { return *((const uint32_t*) element); }
+    else                            { return *((const uint64_t*) element); }
+}
+
 CANARD_INTERNAL bool isBigEndian(void)
 {
 #if defined(BYTE_ORDER) && defined(BIG_ENDIAN)
@@ -1736,6 +4021,7 @@ CANARD_INTERNAL void swapByteOrder(void* data, size_t size)
 /*
  * CRC functions
  */
+#if CANARD_ENABLE_MULTI_FRAME_RX || CANARD_ENABLE_MULTI_FRAME_TX || CANARD_ENABLE_ANONYMOUS
 CANARD_INTERNAL uint16_t crcAddByte(uint16_t crc_val, uint8_t byte)
 {
     crc_val ^= (uint16_t) ((uint16_t) (byte) << 8U);
@@ -1753,6 +4039,7 @@ CANARD_INTERNAL uint16_t crcAddByte(uint16_t crc_val, uint8_t byte)
     return crc_val;
 }
 
+#if CANARD_ENABLE_MULTI_FRAME_RX || CANARD_ENABLE_MULTI_FRAME_TX
 CANARD_INTERNAL uint16_t crcAddSignature(uint16_t crc_val, uint64_t data_type_signature)
 {
     for (uint16_t shift_val = 0; shift_val < 64; shift_val = (uint16_t)(shift_val + 8U))
@@ -1761,6 +4048,30 @@ CANARD_INTERNAL uint16_t crcAddSignature(uint16_t crc_val, uint64_t data_type_si
     }
     return crc_val;
 }
+#endif
+
+#if CANARD_ENABLE_MULTI_FRAME_TX
+CANARD_INTERNAL uint16_t crcMultiply(uint16_t a, uint16_t b)
+{
+    uint16_t product = 0;
+    for (uint8_t bit = 16; bit > 0; bit--)
+    {
+        if (product & 0x8000U)
+        {
+            product = (uint16_t) ((uint16_t) (product << 1U) ^ 0x1021U);
+        }
+        else
+        {
+            product = (uint16_t) (product << 1U);
+        }
+        if ((b >> (bit - 1U)) & 1U)
+        {
+            product = (uint16_t) (product ^ a);
+        }
+    }
+    return product;
+}
+#endif
 
 CANARD_INTERNAL uint16_t crcAdd(uint16_t crc_val, const uint8_t* bytes, size_t len)
 {
@@ -1770,7 +4081,9 @@ CANARD_INTERNAL uint16_t crcAdd(uint16_t crc_val, const uint8_t* bytes, size_t l
     }
     return crc_val;
 }
+#endif
 
+#if !CANARD_ENABLE_STATIC_CAPACITY
 /*
  *  Pool Allocator functions
  */
@@ -1791,13 +4104,26 @@ CANARD_INTERNAL void initPoolAllocator(CanardPoolAllocator* allocator,
     allocator->statistics.capacity_blocks = buf_len;
     allocator->statistics.current_usage_blocks = 0;
     allocator->statistics.peak_usage_blocks = 0;
+    memset(allocator->owner_statistics, 0, sizeof(allocator->owner_statistics));
+#if CANARD_ENABLE_CONCURRENCY
+    allocator->lock = false;
+#endif
 }
 
-CANARD_INTERNAL void* allocateBlock(CanardPoolAllocator* allocator)
+CANARD_INTERNAL void* allocateBlock(CanardPoolAllocator* allocator, CanardPoolOwner owner)
 {
+    CanardPoolOwnerStatistics* const owner_statistics = &allocator->owner_statistics[owner];
+
+    LOCK_ALLOCATOR(allocator);
+
     // Check if there are any blocks available in the free list.
     if (allocator->free_list == NULL)
     {
+        if (owner_statistics->allocation_failures < UINT16_MAX)
+        {
+            owner_statistics->allocation_failures++;
+        }
+        UNLOCK_ALLOCATOR(allocator);
         return NULL;
     }
 
@@ -1811,17 +4137,344 @@ CANARD_INTERNAL void* allocateBlock(CanardPoolAllocator* allocator)
     {
         allocator->statistics.peak_usage_blocks = allocator->statistics.current_usage_blocks;
     }
+    owner_statistics->current_usage_blocks++;
+    if (owner_statistics->peak_usage_blocks < owner_statistics->current_usage_blocks)
+    {
+        owner_statistics->peak_usage_blocks = owner_statistics->current_usage_blocks;
+    }
 
+    UNLOCK_ALLOCATOR(allocator);
     return result;
 }
 
-CANARD_INTERNAL void freeBlock(CanardPoolAllocator* allocator, void* p)
+CANARD_INTERNAL void freeBlock(CanardPoolAllocator* allocator, CanardPoolOwner owner, void* p)
 {
     CanardPoolAllocatorBlock* block = (CanardPoolAllocatorBlock*) p;
 
+    LOCK_ALLOCATOR(allocator);
+
     block->next = allocator->free_list;
     allocator->free_list = block;
 
     CANARD_ASSERT(allocator->statistics.current_usage_blocks > 0);
     allocator->statistics.current_usage_blocks--;
+    CANARD_ASSERT(allocator->owner_statistics[owner].current_usage_blocks > 0);
+    allocator->owner_statistics[owner].current_usage_blocks--;
+
+    UNLOCK_ALLOCATOR(allocator);
+}
+#endif
+
+#if CANARD_ENABLE_STATIC_CAPACITY
+/*
+ *  Static-capacity mode functions
+ */
+
+/**
+ * Returns the subscription of the given data type, or NULL if there is none
+ */
+CANARD_INTERNAL CanardStaticSubscription* findStaticSubscription(const CanardInstance* ins,
+                                                                 uint16_t data_type_id,
+                                                                 CanardTransferType transfer_type)
+{
+    for (uint8_t i = 0; i < ins->num_subscriptions; i++)
+    {
+        CanardStaticSubscription* const sub = &ins->subscriptions[i];
+        if ((sub->data_type_id == data_type_id) && (sub->transfer_type == (uint8_t) transfer_type))
+        {
+            return sub;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Returns the session that reassembles the given transfer, or NULL if there is none
+ */
+CANARD_INTERNAL CanardStaticRxSession* findStaticRxSession(CanardStaticSubscription* sub,
+                                                           uint32_t transfer_descriptor)
+{
+    for (uint8_t i = 0; i < sub->max_sessions; i++)
+    {
+        if (sub->sessions[i].dtid_tt_snid_dnid == transfer_descriptor)
+        {
+            return &sub->sessions[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Takes a free session of the subscription; if all of them are in use, reuses one that has timed out.
+ * Returns NULL if every session is busy.
+ */
+CANARD_INTERNAL CanardStaticRxSession* acquireStaticRxSession(CanardStaticSubscription* sub,
+                                                              uint32_t transfer_descriptor,
+                                                              uint64_t timestamp_usec)
+{
+    CanardStaticRxSession* free_session = NULL;
+    CanardStaticRxSession* stale_session = NULL;
+    uint8_t sessions_in_use = 0;
+
+    for (uint8_t i = 0; i < sub->max_sessions; i++)
+    {
+        CanardStaticRxSession* const session = &sub->sessions[i];
+        if (session->dtid_tt_snid_dnid == CANARD_STATIC_SESSION_FREE)
+        {
+            free_session = (free_session == NULL) ? session : free_session;
+        }
+        else
+        {
+            sessions_in_use++;
+            if ((stale_session == NULL) && ((timestamp_usec - session->timestamp_usec) > TRANSFER_TIMEOUT_USEC))
+            {
+                stale_session = session;
+            }
+        }
+    }
+
+    CanardStaticRxSession* const session = (free_session != NULL) ? free_session : stale_session;
+    if (session == NULL)
+    {
+        return NULL;
+    }
+
+    if (session == free_session)
+    {
+        sessions_in_use++;
+        sub->peak_sessions = (uint8_t) MAX(sub->peak_sessions, sessions_in_use);
+    }
+
+    memset(session, 0, sizeof(*session));
+    session->dtid_tt_snid_dnid = transfer_descriptor;
+    return session;
+}
+
+/**
+ * Same as prepareForNextTransfer(), for the sessions of the static-capacity mode
+ */
+CANARD_INTERNAL void prepareStaticRxSession(CanardStaticRxSession* session)
+{
+    incrementTransferID(&session->transfer_id);
+    session->payload_len = 0;
+    session->next_toggle = 0;
+}
+
+/**
+ * Reception state machine of the static-capacity mode; the frame has been validated by canardHandleRxFrame().
+ * Multi-frame payloads are collected in the contiguous buffer of the session, so the transfer is passed to the
+ * application with the head pointing at the whole payload.
+ */
+CANARD_INTERNAL void handleStaticRxFrame(CanardInstance* ins,
+                                         const CanardCANFrame* frame,
+                                         uint32_t transfer_descriptor,
+                                         const CanardRxTransfer* transfer_header)
+{
+    const uint8_t tail_byte = frame->data[frame->data_len - 1];
+    const uint64_t timestamp_usec = transfer_header->timestamp_usec;
+    const CanardTransferType transfer_type = (CanardTransferType) transfer_header->transfer_type;
+
+    CanardStaticSubscription* const sub = findStaticSubscription(ins, transfer_header->data_type_id, transfer_type);
+    if (sub == NULL)
+    {
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropNotAccepted, frame);
+        return;     // No storage was defined for this data type
+    }
+
+    CanardStaticRxSession* session = findStaticRxSession(sub, transfer_descriptor);
+
+    if (IS_START_OF_TRANSFER(tail_byte))
+    {
+        uint64_t data_type_signature = 0;
+        if (!ins->should_accept(ins, &data_type_signature, transfer_header->data_type_id, transfer_type,
+                                transfer_header->source_node_id))
+        {
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropNotAccepted, frame);
+            return;     // The application doesn't want this transfer
+        }
+
+        if (session == NULL)
+        {
+            session = acquireStaticRxSession(sub, transfer_descriptor, timestamp_usec);
+            if (session == NULL)
+            {
+                sub->rejected_transfers++;
+                TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropOutOfMemory, frame);
+                return; // All sessions of this subscription are busy
+            }
+        }
+#if CANARD_ENABLE_MULTI_FRAME_RX
+        session->calculated_crc = crcAddSignature(0xFFFFU, data_type_signature);
+#endif
+    }
+    else if (session == NULL)
+    {
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropNoState, frame);
+        return;
+    }
+
+    // Resolving the state flags, same as in canardHandleRxFrame()
+    const bool not_initialized = session->timestamp_usec == 0;
+    const bool tid_timed_out = (timestamp_usec - session->timestamp_usec) > TRANSFER_TIMEOUT_USEC;
+    const bool first_frame = IS_START_OF_TRANSFER(tail_byte);
+    const bool not_previous_tid =
+        computeTransferIDForwardDistance(session->transfer_id, TRANSFER_ID_FROM_TAIL_BYTE(tail_byte)) > 1;
+
+    if (not_initialized || tid_timed_out || (first_frame && not_previous_tid))
+    {
+        session->transfer_id = TRANSFER_ID_FROM_TAIL_BYTE(tail_byte);
+        session->next_toggle = 0;
+        session->payload_len = 0;
+        if (!first_frame)   // missed the first frame
+        {
+            incrementTransferID(&session->transfer_id);
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropMissedStart, frame);
+            return;
+        }
+    }
+
+    if (IS_START_OF_TRANSFER(tail_byte) && IS_END_OF_TRANSFER(tail_byte))  // single frame transfer
+    {
+        session->timestamp_usec = timestamp_usec;
+
+        CanardRxTransfer rx_transfer = *transfer_header;
+        rx_transfer.payload_head = frame->data;
+        rx_transfer.payload_len = (uint16_t)(frame->data_len - 1U);
+        TRACE_FRAME(CanardTraceEventRxTransfer, 0, frame);
+        LATENCY_RX_TRANSFER();
+        ins->on_reception(ins, &rx_transfer);
+
+        prepareStaticRxSession(session);
+        return;
+    }
+
+#if CANARD_ENABLE_MULTI_FRAME_RX
+    if ((TOGGLE_BIT(tail_byte) ? 1U : 0U) != session->next_toggle)
+    {
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropWrongToggle, frame);
+        return; // wrong toggle
+    }
+
+    if (TRANSFER_ID_FROM_TAIL_BYTE(tail_byte) != session->transfer_id)
+    {
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropUnexpectedTransferID, frame);
+        return; // unexpected tid
+    }
+
+    const uint8_t* data = frame->data;
+    uint8_t data_len = (uint8_t)(frame->data_len - 1U);
+
+    if (IS_START_OF_TRANSFER(tail_byte))    // Beginning of multi frame transfer, take off the crc
+    {
+        if (frame->data_len <= 3)
+        {
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropShortFrame, frame);
+            return;     // Not enough data
+        }
+        session->timestamp_usec = timestamp_usec;
+        session->payload_crc = (uint16_t)(((uint16_t) frame->data[0]) | (uint16_t)((uint16_t) frame->data[1] << 8U));
+        data += 2;
+        data_len = (uint8_t)(data_len - 2U);
+    }
+
+    if (((uint32_t) session->payload_len + data_len) > sub->max_payload_len)
+    {
+        sub->rejected_transfers++;
+        TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropTooLong, frame);
+        prepareStaticRxSession(session);
+        return;         // Longer than the subscription allows
+    }
+
+    uint8_t* const buffer = &sub->buffers[(size_t)(session - sub->sessions) * sub->max_payload_len];
+    memcpy(&buffer[session->payload_len], data, data_len);
+    session->payload_len = (uint16_t)(session->payload_len + data_len);
+    session->calculated_crc = crcAdd(session->calculated_crc, data, data_len);
+
+    if (IS_END_OF_TRANSFER(tail_byte))
+    {
+        if (session->calculated_crc == session->payload_crc)
+        {
+            CanardRxTransfer rx_transfer = *transfer_header;
+            rx_transfer.timestamp_usec = session->timestamp_usec;
+            rx_transfer.payload_head = buffer;
+            rx_transfer.payload_len = session->payload_len;
+            TRACE_FRAME(CanardTraceEventRxTransfer, 0, frame);
+            LATENCY_RX_TRANSFER();
+            ins->on_reception(ins, &rx_transfer);
+        }
+        else
+        {
+            TRACE_FRAME(CanardTraceEventDrop, CanardTraceDropBadCrc, frame);
+        }
+        prepareStaticRxSession(session);
+        return;
+    }
+
+    session->next_toggle = (uint8_t)(session->next_toggle ? 0U : 1U);
+#endif
+}
+
+/**
+ * Returns the publisher of the data type the CAN ID belongs to, or NULL if there is none
+ */
+CANARD_INTERNAL CanardStaticPublisher* findStaticPublisher(const CanardInstance* ins, uint32_t can_id)
+{
+    const uint16_t data_type_id = extractDataType(can_id);
+    const uint8_t transfer_type = (uint8_t) extractTransferType(can_id);
+
+    for (uint8_t i = 0; i < ins->num_publishers; i++)
+    {
+        CanardStaticPublisher* const pub = &ins->publishers[i];
+        if ((pub->data_type_id == data_type_id) && (pub->transfer_type == transfer_type))
+        {
+            return pub;
+        }
+    }
+    return NULL;
+}
+
+CANARD_INTERNAL uint8_t countUsedStaticTxSlots(const CanardStaticPublisher* pub)
+{
+    uint8_t count = 0;
+    for (uint32_t mask = pub->used_slots; mask != 0; mask &= mask - 1U)
+    {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Takes a free slot of the publisher and initializes it as a TX queue item. Returns NULL if all slots are in use.
+ */
+CANARD_INTERNAL CanardTxQueueItem* claimStaticTxSlot(CanardInstance* ins, CanardStaticPublisher* pub)
+{
+    for (uint8_t i = 0; i < pub->num_slots; i++)
+    {
+        if ((pub->used_slots & (1UL << i)) == 0)
+        {
+            pub->used_slots |= (uint32_t)(1UL << i);
+
+            CanardTxQueueItem* const item = (CanardTxQueueItem*) &pub->slots[i];
+            memset(item, 0, sizeof(*item));
+            item->publisher_index = (uint8_t)(pub - ins->publishers);
+            LATENCY_TX_ENQUEUE(item);
+            return item;
+        }
+    }
+    return NULL;
 }
+
+/**
+ * Returns the slot of a TX queue item to its publisher
+ */
+CANARD_INTERNAL void releaseStaticTxSlot(CanardInstance* ins, CanardTxQueueItem* item)
+{
+    CANARD_ASSERT(item->publisher_index < ins->num_publishers);
+
+    CanardStaticPublisher* const pub = &ins->publishers[item->publisher_index];
+    const size_t slot = (size_t)((CanardPoolAllocatorBlock*) item - pub->slots);
+    CANARD_ASSERT(slot < pub->num_slots);
+
+    pub->used_slots &= (uint32_t) ~(1UL << slot);
+}
+#endif
@@ -31,6 +31,7 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <assert.h>
+#include "canard_config.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -73,13 +74,28 @@ extern "C" {
 #define CANARD_ERROR_INTERNAL                       9
 
 /// The size of a memory block in bytes.
-/// 内存块的大小（以字节为单位）。
-#define CANARD_MEM_BLOCK_SIZE                       32U
+/// It can be increased to build the library natively on 64-bit hosts (e.g. for sanitizer runs), where the
+/// internal structures do not fit into 32 bytes.
+/// 内存块的大小（以字节为单位）。在64位主机上本地构建时（例如使用sanitizer），可以增大该值。
+#ifndef CANARD_MEM_BLOCK_SIZE
+# define CANARD_MEM_BLOCK_SIZE                      32U
+#endif
 
 /// This will be changed when the support for CAN FD is added
 /// 当添加对CAN FD的支持时，将更改此设置
 #define CANARD_CAN_FRAME_MAX_DATA_LEN               8U
 
+/// Number of CAN frames of a transfer with the given payload length; each of them takes one memory block (or one TX
+/// slot) while it is queued. Multi-frame transfers carry the 2-byte CRC and one tail byte per frame.
+/// 给定有效负载长度的传输所需的CAN帧数；每帧排队时占用一个内存块（或一个TX槽）。
+#define CANARD_TX_FRAMES(payload_len)                                                                      \
+    (((payload_len) < CANARD_CAN_FRAME_MAX_DATA_LEN) ? 1U : (((payload_len) + 2U + 6U) / 7U))
+
+/// Bits that follow the CRC of every CAN data frame: CRC delimiter, ACK slot, ACK delimiter, end of frame and the
+/// intermission before the next frame. Refer to canardGetFrameBitLength().
+/// 每个CAN数据帧CRC之后的位数：CRC界定符、应答间隙、应答界定符、帧结束和帧间隔。
+#define CANARD_CAN_FRAME_TRAILER_BITS               13U
+
 /// Node ID values. Refer to the specification for more info.
 /// 节点ID值。 有关更多信息，请参考规范。
 #define CANARD_BROADCAST_NODE_ID                    0
@@ -164,6 +180,9 @@ typedef struct CanardInstance CanardInstance;
 typedef struct CanardRxTransfer CanardRxTransfer;
 typedef struct CanardRxState CanardRxState;
 typedef struct CanardTxQueueItem CanardTxQueueItem;
+#if CANARD_ENABLE_MULTINODE
+typedef struct CanardMultiNodeHost CanardMultiNodeHost;
+#endif
 
 /**
  * The application must implement this function and supply a pointer to it to the library during initialization.
@@ -219,6 +238,32 @@ typedef struct
     uint16_t peak_usage_blocks;             ///< Maximum number of blocks used since initialization，自初始化以来使用的最大块数
 } CanardPoolAllocatorStatistics;
 
+/**
+ * Owners of the memory pool blocks, used to attribute the pool usage.
+ * 内存池块的所有者，用于区分内存池的使用情况。
+ */
+typedef enum
+{
+    CanardPoolOwnerTxFrame = 0,             ///< Frames waiting in the TX queue，TX队列中等待发送的帧
+    CanardPoolOwnerRxState = 1,             ///< RX reassembly states, including the head of the payload，RX重组状态
+    CanardPoolOwnerRxBuffer = 2             ///< RX payload buffer blocks of multi-frame transfers，多帧传输的RX缓冲块
+} CanardPoolOwner;
+
+#define CANARD_NUM_POOL_OWNERS              3
+
+/**
+ * Usage statistics of the memory pool blocks held by one owner.
+ * If the TX frames dominate, the interface cannot keep up with the transmitted traffic; if the RX states dominate,
+ * the stale transfers are not cleaned up often enough; if the RX buffers dominate, the received transfers are large.
+ * 单个所有者持有的内存池块的使用情况统计信息。
+ */
+typedef struct
+{
+    uint16_t current_usage_blocks;          ///< Number of blocks currently held by the owner，所有者当前持有的块数
+    uint16_t peak_usage_blocks;             ///< Maximum number of blocks held since initialization，自初始化以来持有的最大块数
+    uint16_t allocation_failures;           ///< Number of failed allocations, saturates at 0xFFFF，分配失败的次数
+} CanardPoolOwnerStatistics;
+
 /**
  * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
  * 内部使用，请勿直接使用
@@ -227,6 +272,10 @@ typedef struct
 {
     CanardPoolAllocatorBlock* free_list;
     CanardPoolAllocatorStatistics statistics;
+    CanardPoolOwnerStatistics owner_statistics[CANARD_NUM_POOL_OWNERS];
+#if CANARD_ENABLE_CONCURRENCY
+    bool lock;                                      ///< Spinlock guarding the fields above
+#endif
 } CanardPoolAllocator;
 
 /**
@@ -264,9 +313,159 @@ struct CanardRxState
 
     uint8_t buffer_head[];
 };
-CANARD_STATIC_ASSERT(offsetof(CanardRxState, buffer_head) <= 28, "Invalid memory layout");
+CANARD_STATIC_ASSERT(offsetof(CanardRxState, buffer_head) <= (CANARD_MEM_BLOCK_SIZE - 4U), "Invalid memory layout");
 CANARD_STATIC_ASSERT(CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE >= 4, "Invalid memory layout");
 
+#if CANARD_ENABLE_STATIC_CAPACITY
+/**
+ * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
+ * Reassembly session of the static-capacity mode. The payload is collected in a contiguous buffer.
+ * 静态容量模式的重组会话，有效数据保存在连续的缓冲区中。
+ */
+typedef struct
+{
+    uint64_t timestamp_usec;
+    uint32_t dtid_tt_snid_dnid;             ///< CANARD_STATIC_SESSION_FREE if the session is not in use
+    uint16_t payload_len;
+    uint16_t calculated_crc;
+    uint16_t payload_crc;
+    uint8_t transfer_id;
+    uint8_t next_toggle;
+} CanardStaticRxSession;
+
+#define CANARD_STATIC_SESSION_FREE                  0xFFFFFFFFUL
+
+/**
+ * Storage of one subscription in the static-capacity mode. Use CANARD_STATIC_SUBSCRIPTION() to define it.
+ * Every session can reassemble one transfer at a time, so max_sessions is the number of remote nodes that may
+ * send this data type concurrently. Sessions that are silent for longer than the transfer timeout are reused.
+ * The counters can be read by the application at any time.
+ * 静态容量模式下一个订阅的存储。每个会话同时只能重组一个传输。
+ */
+typedef struct
+{
+    uint16_t data_type_id;
+    uint8_t transfer_type;                  ///< See CanardTransferType
+    uint8_t max_sessions;
+    uint16_t max_payload_len;               ///< Longer transfers are dropped
+    CanardStaticRxSession* sessions;        ///< max_sessions items
+    uint8_t* buffers;                       ///< max_sessions * max_payload_len bytes
+
+    uint8_t peak_sessions;                  ///< Maximum number of sessions in use at the same time
+    uint16_t rejected_transfers;            ///< Transfers dropped because no session was free or they were too long
+} CanardStaticSubscription;
+
+/**
+ * Storage of one publisher in the static-capacity mode. Use CANARD_STATIC_PUBLISHER() to define it.
+ * Every slot holds one CAN frame until it is removed from the TX queue; up to 32 slots per publisher.
+ * A transfer is enqueued only if all of its frames fit, otherwise nothing is enqueued.
+ * 静态容量模式下一个发布者的存储。每个槽保存一个CAN帧，直到它从TX队列中移除。
+ */
+typedef struct
+{
+    uint16_t data_type_id;
+    uint8_t transfer_type;                  ///< See CanardTransferType
+    uint8_t num_slots;
+    CanardPoolAllocatorBlock* slots;        ///< num_slots items
+    uint32_t used_slots;                    ///< Bit mask
+
+    uint8_t peak_used_slots;                ///< Maximum number of slots in use at the same time
+    uint16_t rejected_transfers;            ///< Transfers rejected because there were not enough free slots
+} CanardStaticPublisher;
+
+/// Number of TX slots needed to keep the given number of transfers of the given length queued.
+/// 为排队指定数量和长度的传输所需的TX槽数。
+#define CANARD_STATIC_TX_SLOTS(max_payload_len, max_queued_transfers)                                      \
+    (CANARD_TX_FRAMES(max_payload_len) * (max_queued_transfers))
+
+/// Defines the storage of a subscription; use CANARD_STATIC_SUBSCRIPTION_ENTRY() in the subscription table.
+/// 定义一个订阅的存储。
+#define CANARD_STATIC_SUBSCRIPTION(name, max_payload_len, max_sessions)                                     \
+    static CanardStaticRxSession name##_sessions[(max_sessions)];                                           \
+    static uint8_t name##_buffers[(max_sessions) * (max_payload_len)]
+
+#define CANARD_STATIC_SUBSCRIPTION_ENTRY(name, data_type_id, transfer_type, max_payload_len, max_sessions)  \
+    { (data_type_id), (transfer_type), (max_sessions), (max_payload_len),                                   \
+      name##_sessions, name##_buffers, 0, 0 }
+
+/// Defines the storage of a publisher; use CANARD_STATIC_PUBLISHER_ENTRY() in the publisher table.
+/// 定义一个发布者的存储。
+#define CANARD_STATIC_PUBLISHER(name, num_slots)                                                            \
+    static CanardPoolAllocatorBlock name##_slots[(num_slots)]
+
+#define CANARD_STATIC_PUBLISHER_ENTRY(name, data_type_id, transfer_type, num_slots)                         \
+    { (data_type_id), (transfer_type), (num_slots), name##_slots, 0, 0, 0 }
+#endif
+
+#if CANARD_ENABLE_BUSLOAD
+/// Priority bands of the bus load statistics: CAN ID priorities 0-7, 8-15, 16-23 and 24-31.
+/// 总线负载统计的优先级段：优先级0-7、8-15、16-23和24-31。
+#define CANARD_BUSLOAD_NUM_PRIORITY_BANDS           4U
+
+/**
+ * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
+ * Bits on the wire accounted in one slot of the sliding window. Refer to canardGetBusLoadStatistics().
+ */
+typedef struct
+{
+    uint32_t tx_bits;
+    uint32_t rx_bits;
+    uint32_t priority_band_bits[CANARD_BUSLOAD_NUM_PRIORITY_BANDS];
+    uint32_t untracked_bits;
+#if CANARD_BUSLOAD_MAX_DATA_TYPES > 0
+    uint32_t data_type_bits[CANARD_BUSLOAD_MAX_DATA_TYPES];
+#endif
+} CanardBusLoadSlot;
+
+/**
+ * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
+ */
+typedef struct
+{
+    CanardBusLoadSlot slots[CANARD_BUSLOAD_NUM_SLOTS];
+#if CANARD_BUSLOAD_MAX_DATA_TYPES > 0
+    uint32_t data_type_keys[CANARD_BUSLOAD_MAX_DATA_TYPES];    ///< Zero if the entry is free
+#endif
+    uint64_t slot_started_usec;                     ///< Start of the current slot
+    uint64_t now_usec;                              ///< Latest time given to the library
+    uint8_t current_slot;
+    uint8_t filled_slots;                           ///< Slots in the window, the current one included; zero
+                                                    ///< until the first time is given
+} CanardBusLoadState;
+
+/**
+ * Share of the bus load taken by one data type.
+ */
+typedef struct
+{
+    uint16_t data_type_id;
+    bool service;
+    uint32_t bits;                                  ///< Bits on the wire in the window, both directions
+    uint16_t load_permille;
+} CanardBusLoadDataTypeStatistics;
+
+/**
+ * Bus load over the sliding window, see canardGetBusLoadStatistics().
+ * The load figures are in permille of the bit time of the window.
+ * 滑动窗口内的总线负载，负载以窗口位时间的千分比表示。
+ */
+typedef struct
+{
+    uint32_t window_usec;                           ///< Time covered by the figures
+    uint32_t tx_bits;                               ///< Bits of the frames popped from the TX queue
+    uint32_t rx_bits;                               ///< Bits of the frames given to canardHandleRxFrame()
+    uint16_t load_permille;                         ///< Both directions
+    uint16_t tx_load_permille;
+    uint16_t rx_load_permille;
+    uint16_t priority_band_load_permille[CANARD_BUSLOAD_NUM_PRIORITY_BANDS];
+    uint16_t untracked_load_permille;               ///< Frames of other protocols, and of data types without an entry
+    uint8_t num_data_types;
+#if CANARD_BUSLOAD_MAX_DATA_TYPES > 0
+    CanardBusLoadDataTypeStatistics data_types[CANARD_BUSLOAD_MAX_DATA_TYPES];  ///< Heaviest first
+#endif
+} CanardBusLoadStatistics;
+#endif
+
 /**
  * This is the core structure that keeps all of the states and allocated resources of the library instance.
  * The application should never access any of the fields directly! Instead, API functions should be used.
@@ -279,14 +478,48 @@ struct CanardInstance
     CanardShouldAcceptTransfer should_accept;       ///< Function to decide whether the application wants this transfer，决定应用程序是否要进行此转移的功能
     CanardOnTransferReception on_reception;         ///< Function the library calls after RX transfer is complete，RX传输完成后函数调用库
 
+#if CANARD_ENABLE_STATIC_CAPACITY
+    CanardStaticSubscription* subscriptions;        ///< RX storage, see canardInitStatic()
+    CanardStaticPublisher* publishers;              ///< TX storage
+    uint8_t num_subscriptions;
+    uint8_t num_publishers;
+#else
     CanardPoolAllocator allocator;                  ///< Pool allocator，池分配器
 
     CanardRxState* rx_states;                       ///< RX transfer states，RX传输状态
+#endif
     CanardTxQueueItem* tx_queue;                    ///< TX frames awaiting transmission，TX帧等待传输
+#if CANARD_ENABLE_CONCURRENCY
+    CanardTxQueueItem* tx_submissions;              ///< Lock-free stack of frames submitted by producer threads
+#endif
 
     void* user_reference;                           ///< User pointer that can link this instance with other objects，可以将此实例与其他对象链接的用户指针
+
+#if CANARD_ENABLE_BUSLOAD
+    CanardBusLoadState busload;                     ///< Bus load accounting, see canardGetBusLoadStatistics()
+#endif
+
+#if CANARD_ENABLE_MULTINODE
+    CanardMultiNodeHost* host;                      ///< Host this instance belongs to, or NULL if it is standalone
+    CanardInstance* next_hosted;                    ///< Next node in the list of nodes of the same host
+#endif
 };
 
+#if CANARD_ENABLE_MULTINODE
+/**
+ * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
+ * Refer to canardMultiNodeHostInit().
+ */
+struct CanardMultiNodeHost
+{
+    CanardInstance bus;                             ///< Owns the shared pool, the RX states and the interface TX queue
+    CanardInstance* nodes[CANARD_MAX_NODE_ID + 1];  ///< Hosted nodes indexed by node ID
+    CanardInstance* node_list;                      ///< Same nodes as a list, so that dispatch cost does not depend
+                                                    ///< on the size of the node ID space
+    uint8_t rx_destination_node_id;                 ///< Destination of the frame being processed
+};
+#endif
+
 /**
  * This structure represents a received transfer for the application.
  * An instance of it is passed to the application via callback when the library receives a new transfer.
@@ -318,7 +551,7 @@ struct CanardRxTransfer
      * of the payload of the CAN frame.
      *
      * In simple cases it should be possible to get data directly from the head and/or tail pointers.
-     * Otherwise it is advised to use canardDecodeScalar().
+     * Otherwise it is advised to use canardDecodeScalar() or canardReadRxPayload().
      * 
      * 有效负载分散在三个存储中：
      * -Head指向CanardRxState.buffer_head（其长度最多为CANARD_PAYLOAD_HEAD_SIZE），或指向最后接收到的CAN帧的有效负载字段（可能带有偏移）。
@@ -353,6 +586,75 @@ struct CanardRxTransfer
     uint8_t source_node_id;                 ///< 1 to 127, or 0 if the source is anonymous
 };
 
+/**
+ * Sequential reader of the scattered payload of a received transfer; see canardReadRxPayload().
+ * The fields describe the piece of storage (head, one of the middle blocks, or tail) the reader is currently at.
+ * 按顺序读取接收传输的分散有效负载；字段描述读取器当前所在的存储片段（头部、中间块或尾部）。
+ */
+typedef struct
+{
+    const CanardRxTransfer* transfer;
+    const uint8_t* data;                    ///< Bytes of the current piece
+    const CanardBufferBlock* next_block;    ///< Block that follows the current piece, or NULL
+    uint16_t begin;                         ///< Payload offset of data[0], in bytes
+    uint16_t end;                           ///< Payload offset past the last byte of the current piece
+} CanardRxPayloadReader;
+
+/**
+ * Streaming serializer of one outgoing transfer; see canardBeginBroadcast().
+ * The fields are packed straight into TX frames taken from the memory pool (or from the publisher slots in the
+ * static-capacity mode), and the transfer CRC is updated byte by byte, so no payload buffer is needed.
+ * The frames are kept private until canardFinishTransfer() puts the transfer into the TX queue.
+ * 一个待发送传输的流式序列化器：字段直接打包进TX帧，同时逐字节更新传输CRC，无需有效数据缓冲区。
+ */
+typedef struct
+{
+    CanardInstance* ins;                    ///< Owner of the TX queue and of the memory pool
+    CanardTxQueueItem* first_frame;         ///< Frames of the transfer, linked from the first one
+    CanardTxQueueItem* last_frame;
+    uint8_t* inout_transfer_id;
+    uint32_t can_id;
+    uint16_t crc;                           ///< Signature and the payload bytes written so far
+    uint16_t payload_len;                   ///< Whole bytes written so far
+    uint8_t frame_len;                      ///< Bytes of the last frame in use, the CRC of the first frame included
+    uint8_t num_frames;
+    uint8_t pending_byte;                   ///< Incomplete byte, filled from the most significant bit
+    uint8_t pending_bits;                   ///< Number of bits in pending_byte, 0 to 7
+    bool anonymous;
+    bool increment_transfer_id;
+    int16_t error;                          ///< First error, reported by canardFinishTransfer()
+#if CANARD_ENABLE_STATIC_CAPACITY
+    CanardStaticPublisher* publisher;       ///< Owner of the TX slots
+#endif
+} CanardBitWriter;
+
+/**
+ * Variable field of a prebuilt transfer: a range of whole payload bytes that is supplied when the transfer is sent.
+ * 预构建传输的可变字段：发送时提供的一段完整有效负载字节。
+ */
+typedef struct
+{
+    uint16_t offset;                        ///< Payload offset of the first byte
+    uint16_t length;                        ///< In bytes
+    uint16_t crc_shift;                     ///< x^(8 * payload bytes after the field) modulo the CRC polynomial
+} CanardPrebuiltField;
+
+/**
+ * Transfer whose frames have been built ahead of time, normally by the DSDL compiler (libcanard_dsdlc --prebuild).
+ * The frames are stored as they go on the bus, the CRC and the tail bytes included, with the transfer ID bits zeroed;
+ * see canardBroadcastPrebuilt().
+ * 预先构建好帧的传输（通常由DSDL编译器生成）。帧按总线上的格式存储，包括CRC和尾字节，传输ID位为零。
+ */
+typedef struct
+{
+    const uint8_t* frames;                  ///< num_frames * CANARD_CAN_FRAME_MAX_DATA_LEN bytes
+    const CanardPrebuiltField* fields;      ///< Variable fields in ascending order, or NULL
+    uint16_t data_type_id;
+    uint16_t payload_len;
+    uint8_t num_frames;                     ///< Must be CANARD_TX_FRAMES(payload_len)
+    uint8_t num_fields;
+} CanardPrebuiltTransfer;
+
 /**
  * Initializes a library instance.
  * Local node ID will be set to zero, i.e. the node will be anonymous.
@@ -363,12 +665,45 @@ struct CanardRxTransfer
  * 初始化库实例。本地节点ID将设置为零，即该节点将是匿名的。
  * 通常，内存池的大小不应少于1K，尽管它取决于应用程序的检测所需池大小的推荐方法是在压力测试后测量峰值池使用量。参考函数canardGetPoolAllocatorStatistics（）。
  */
+#if !CANARD_ENABLE_STATIC_CAPACITY
 void canardInit(CanardInstance* out_ins,                    ///< Uninitialized library instance，未初始化的库实例
                 void* mem_arena,                            ///< Raw memory chunk used for dynamic allocation，用于动态分配的原始内存块
                 size_t mem_arena_size,                      ///< Size of the above, in bytes，上面的大小，以字节为单位
                 CanardOnTransferReception on_reception,     ///< Callback, see CanardOnTransferReception，回调，请参阅CanardOnTransferReception
                 CanardShouldAcceptTransfer should_accept,   ///< Callback, see CanardShouldAcceptTransfer
                 void* user_reference);                      ///< Optional pointer for user's convenience, can be NULL，为方便用户使用的可选指针，可以为NULL
+#else
+/**
+ * Initializes a library instance in the static-capacity mode (CANARD_ENABLE_STATIC_CAPACITY).
+ * There is no memory pool; the instance uses only the storage of the given subscriptions and publishers, which
+ * is defined at compile time:
+ *
+ *   CANARD_STATIC_SUBSCRIPTION(raw_command, 32, 1);
+ *   CANARD_STATIC_PUBLISHER(node_status, CANARD_STATIC_TX_SLOTS(7, 2));
+ *
+ *   static CanardStaticSubscription subscriptions[] = {
+ *       CANARD_STATIC_SUBSCRIPTION_ENTRY(raw_command, 1030, CanardTransferTypeBroadcast, 32, 1)
+ *   };
+ *   static CanardStaticPublisher publishers[] = {
+ *       CANARD_STATIC_PUBLISHER_ENTRY(node_status, 341, CanardTransferTypeBroadcast, CANARD_STATIC_TX_SLOTS(7, 2))
+ *   };
+ *
+ * Transfers without a matching subscription are ignored; transfers without a matching publisher are rejected
+ * with -CANARD_ERROR_INVALID_ARGUMENT. When a publisher runs out of slots, the transfer is rejected as a whole
+ * with -CANARD_ERROR_OUT_OF_MEMORY. The callbacks are used in the same way as with canardInit().
+ * Received payloads are contiguous, so canardReleaseRxTransferPayload() is never needed in this mode.
+ *
+ * 在静态容量模式下初始化库实例。没有内存池，实例只使用在编译时定义的订阅和发布者的存储。
+ */
+void canardInitStatic(CanardInstance* out_ins,                      ///< Uninitialized library instance
+                      CanardStaticSubscription* subscriptions,      ///< RX storage, one entry per data type
+                      uint8_t num_subscriptions,
+                      CanardStaticPublisher* publishers,            ///< TX storage, one entry per data type
+                      uint8_t num_publishers,
+                      CanardOnTransferReception on_reception,       ///< Callback, see CanardOnTransferReception
+                      CanardShouldAcceptTransfer should_accept,     ///< Callback, see CanardShouldAcceptTransfer
+                      void* user_reference);                        ///< Optional pointer for user's convenience
+#endif
 
 /**
  * Returns the value of the user pointer.
@@ -426,12 +761,21 @@ int16_t canardBroadcast(CanardInstance* ins,            ///< Library instance
                         const void* payload,            ///< Transfer payload
                         uint16_t payload_len);          ///< Length of the above, in bytes
 						
+
+/**
+ * Sends a single-frame broadcast transfer; no data type signature is needed for those.
+ * Fails with -CANARD_ERROR_INVALID_ARGUMENT if the node is anonymous or the payload does not fit into one frame.
+ * This is a thin wrapper over canardBroadcast(); the multi-frame code can be removed from the build with
+ * CANARD_PROFILE_SINGLE_FRAME_ONLY (see canard_config.h).
+ * 发送单帧广播传输。节点为匿名或数据超过一帧时返回错误。这是canardBroadcast()的简单封装。
+ */
 int16_t singleCanardBroadcast(CanardInstance* ins,
                         uint16_t data_type_id,          // 数据类型ID
                         uint8_t* inout_transfer_id,     // 传输的ID，sourceID
                         uint8_t priority,               // 传输优先级
                         const void* payload,            // 有效数据内容
                         uint16_t payload_len);           // 传输数据长度（byte）
+
 /**
  * Sends a request or a response transfer.
  * Fails if the node is in passive mode.
@@ -472,6 +816,123 @@ int16_t canardRequestOrRespond(CanardInstance* ins,             ///< Library ins
                                const void* payload,             ///< Transfer payload，转移有效载荷，就是有效数据部分
                                uint16_t payload_len);           ///< Length of the above, in bytes
 
+/**
+ * Starts a broadcast transfer that is serialized with canardWriteScalar() and friends and completed with
+ * canardFinishTransfer(). The arguments are the same as those of canardBroadcast(), the payload excepted.
+ * This avoids both the payload buffer of canardBroadcast() and the copy of the buffer into the frames: every field is
+ * written into the frame where it belongs, and a frame gets its tail byte as soon as it is full.
+ *
+ * A transfer of up to 7 bytes becomes a single frame transfer once it is finished. Anonymous transfers must not
+ * exceed 7 bytes. Between the calls the writer holds pool blocks, so a started transfer must always be finished
+ * or aborted, and the calls must not be interleaved with canardPeekTxQueue()/canardPopTxQueue() of another thread
+ * unless the concurrency mode is enabled.
+ *
+ * Returns 0, or negative error code; in that case the writer must not be used.
+ * 开始一个流式序列化的广播传输，参数与canardBroadcast()相同（除有效数据外）。每个字段直接写入其所在的帧，
+ * 帧写满后立即写入尾字节。必须以canardFinishTransfer()或canardAbortTransfer()结束。
+ */
+int16_t canardBeginBroadcast(CanardInstance* ins,
+                             CanardBitWriter* out_writer,
+                             uint64_t data_type_signature,
+                             uint16_t data_type_id,
+                             uint8_t* inout_transfer_id,
+                             uint8_t priority);
+
+/**
+ * Starts a request or a response transfer; see canardBeginBroadcast() and canardRequestOrRespond().
+ * 开始一个流式序列化的请求或响应传输。
+ */
+int16_t canardBeginRequestOrRespond(CanardInstance* ins,
+                                    CanardBitWriter* out_writer,
+                                    uint8_t destination_node_id,
+                                    uint64_t data_type_signature,
+                                    uint8_t data_type_id,
+                                    uint8_t* inout_transfer_id,
+                                    uint8_t priority,
+                                    CanardRequestResponse kind);
+
+/**
+ * Appends a scalar value to the transfer; the value is taken as by canardEncodeScalar().
+ * Errors (e.g. out of memory) are remembered by the writer and reported by canardFinishTransfer().
+ * 向传输追加一个标量值，取值方式与canardEncodeScalar()相同。
+ */
+void canardWriteScalar(CanardBitWriter* writer,
+                       uint8_t bit_length,
+                       const void* value);
+
+/**
+ * Appends an array of values of the same bit length; see canardEncodeArray().
+ * 追加一个相同位长的数组。
+ */
+void canardWriteArray(CanardBitWriter* writer,
+                      uint8_t bit_length,
+                      uint16_t count,
+                      const void* values);
+
+#if CANARD_ENABLE_FLOAT16
+/**
+ * Appends an array of native floats as float16 values; see canardEncodeFloat16Array().
+ * 将本机浮点数数组作为float16值追加。
+ */
+void canardWriteFloat16Array(CanardBitWriter* writer,
+                             uint16_t count,
+                             const float* values);
+#endif
+
+/**
+ * Appends zero bits, e.g. for the void fields of DSDL.
+ * 追加零位（例如DSDL的void字段）。
+ */
+void canardWritePadding(CanardBitWriter* writer,
+                        uint16_t bit_length);
+
+/**
+ * Completes the transfer: the last byte is padded with zeros, the CRC and the last tail byte are written, and the
+ * frames are put into the TX queue. The transfer ID is updated like canardBroadcast() and canardRequestOrRespond()
+ * do it. If an error occurred, nothing is enqueued and the frames are returned to the pool.
+ *
+ * Returns the number of frames enqueued, or negative error code.
+ * 完成传输：补齐最后一个字节，写入CRC和最后的尾字节，并将帧放入TX队列。出错时不入队任何帧。
+ * 返回入队的帧数或负错误代码。
+ */
+int16_t canardFinishTransfer(CanardBitWriter* writer);
+
+/**
+ * Drops a started transfer and returns its frames to the pool. The transfer ID is not updated.
+ * 丢弃已开始的传输，并释放其帧。
+ */
+void canardAbortTransfer(CanardBitWriter* writer);
+
+/**
+ * Sends a broadcast transfer from prebuilt frames. The frames are copied into the TX queue, and only the transfer ID,
+ * the CAN ID and the variable fields are filled in; nothing is encoded, and the CRC is updated only for the bytes of
+ * the variable fields. The values of the variable fields are given in variable_bytes, one after another in the order
+ * of the fields; it may be NULL if there are none. Otherwise this works like canardBroadcast(); anonymous nodes can
+ * send single frame transfers only.
+ *
+ * Returns the number of frames enqueued, or negative error code.
+ * 从预构建的帧发送广播传输：只填入传输ID、CAN ID和可变字段，无需编码，CRC只针对可变字段的字节更新。
+ * 返回入队的帧数或负错误代码。
+ */
+int16_t canardBroadcastPrebuilt(CanardInstance* ins,
+                                const CanardPrebuiltTransfer* transfer,
+                                uint8_t* inout_transfer_id,
+                                uint8_t priority,
+                                const void* variable_bytes);
+
+/**
+ * Sends a request or a response transfer from prebuilt frames; see canardBroadcastPrebuilt() and
+ * canardRequestOrRespond().
+ * 从预构建的帧发送请求或响应传输。
+ */
+int16_t canardRequestOrRespondPrebuilt(CanardInstance* ins,
+                                       uint8_t destination_node_id,
+                                       const CanardPrebuiltTransfer* transfer,
+                                       uint8_t* inout_transfer_id,
+                                       uint8_t priority,
+                                       CanardRequestResponse kind,
+                                       const void* variable_bytes);
+
 /**
  * Returns a pointer to the top priority frame in the TX queue.
  * Returns NULL if the TX queue is empty.
@@ -488,7 +949,8 @@ const CanardCANFrame* canardPeekTxQueue(const CanardInstance* ins);
  * Removes the top priority frame from the TX queue.
  * The application will call this function after canardPeekTxQueue() once the obtained frame has been processed.
  * Calling canardBroadcast() or canardRequestOrRespond() between canardPeekTxQueue() and canardPopTxQueue()
- * is NOT allowed, because it may change the frame at the top of the TX queue.
+ * is NOT allowed, because it may change the frame at the top of the TX queue. In the concurrency mode
+ * (CANARD_ENABLE_CONCURRENCY) this is allowed, since submitted frames enter the TX queue only in canardPeekTxQueue().
  * 从TX队列中删除最高优先级帧。
  * 处理完获取的帧后，应用程序将在canardPeekTxQueue（）之后调用此函数。
  * 在canardPeekTxQueue（）和canardPopTxQueue（）之间调用canardBroadcast（）或canardRequestOrRespond（）不允许使用*，因为它可能会更改TX队列顶部的帧。
@@ -506,6 +968,10 @@ void canardHandleRxFrame(CanardInstance* ins,
                          const CanardCANFrame* frame,
                          uint64_t timestamp_usec);
 
+/**
+ * Same as canardHandleRxFrame(), except that frames of multi-frame transfers are ignored.
+ * 与canardHandleRxFrame()相同，但忽略多帧传输的帧。
+ */
 void singleCanardHandleRxFrame(CanardInstance* ins, 
                         const CanardCANFrame* frame, 
                         uint64_t timestamp_usec);
@@ -565,6 +1031,81 @@ int16_t canardDecodeScalar(const CanardRxTransfer* transfer,    ///< The RX tran
                            bool value_is_signed,                ///< True if the value can be negative; see the table
                            void* out_value);                    ///< Pointer to the output storage; see the table
 
+/**
+ * Prepares a reader for canardReadRxPayload(); the reader starts at the head of the payload.
+ * The reader is valid as long as the transfer is.
+ * 初始化有效负载读取器，从有效负载的头部开始。
+ */
+void canardInitRxPayloadReader(CanardRxPayloadReader* out_reader,
+                               const CanardRxTransfer* transfer);
+
+/**
+ * Copies bytes of a received payload into a contiguous buffer, with one memcpy() per piece of storage.
+ * Unlike canardDecodeScalar(), which walks the storage from the head on every call, the reader remembers where it
+ * stopped, so that reading a transfer front to back visits the head, every middle block and the tail only once.
+ * Reading backwards is allowed but restarts the walk from the head.
+ *
+ * Returns the number of bytes copied, which is less than requested if the payload ends earlier.
+ * This is what the code generated by the DSDL compiler uses to decode transfers.
+ *
+ * 将接收到的有效负载复制到连续的缓冲区中。读取器记住上次停止的位置，因此从前向后读取传输时，
+ * 头部、每个中间块和尾部只访问一次。返回复制的字节数。
+ */
+uint16_t canardReadRxPayload(CanardRxPayloadReader* reader,    ///< Reader, see canardInitRxPayloadReader()
+                             uint16_t offset,                   ///< Offset, in bytes, from the beginning of the payload
+                             uint16_t length,                   ///< Number of bytes to copy
+                             uint8_t* output);                  ///< Destination buffer, at least length bytes
+
+/**
+ * Decodes an array of count values of the same bit length, placed back to back from the specified bit position in
+ * the RX transfer buffer. The result is the same as that of count calls to canardDecodeScalar(), and the elements are
+ * stored in the same types (see the table of canardDecodeScalar()), but the payload is walked only once and
+ * byte-aligned arrays of 8, 16, 32 or 64 bit values are copied in bulk. Signed values are sign-extended per element.
+ *
+ * Returns the number of elements decoded, which may be less than requested if the payload ends earlier (an element
+ * that is cut off by the end of the payload is not decoded), or negated error code, such as invalid argument.
+ *
+ * 从RX传输缓冲区的指定位位置解码由count个相同位长的值组成的数组。结果与count次调用canardDecodeScalar()相同，
+ * 但有效负载只遍历一次，字节对齐的8/16/32/64位数组被整体复制。返回解码的元素数或否定的错误代码。
+ */
+int32_t canardDecodeArray(const CanardRxTransfer* transfer,     ///< The RX transfer where the data will be copied from
+                          uint32_t bit_offset,                  ///< Offset, in bits, of the first element
+                          uint8_t bit_length,                   ///< Length of one element, in bits
+                          bool value_is_signed,                 ///< True if the values can be negative
+                          uint16_t count,                       ///< Number of elements to decode
+                          void* out_values);                    ///< Array of count elements; see canardDecodeScalar()
+
+/**
+ * Same as canardDecodeArray(), reading through a payload reader, so that the decoding of the data that follows the
+ * array continues from where the array ended. This is what the code generated by the DSDL compiler uses.
+ * 与canardDecodeArray()相同，但通过有效负载读取器读取。
+ */
+int32_t canardReadRxArray(CanardRxPayloadReader* reader,
+                          uint32_t bit_offset,
+                          uint8_t bit_length,
+                          bool value_is_signed,
+                          uint16_t count,
+                          void* out_values);
+
+#if CANARD_ENABLE_FLOAT16
+/**
+ * Decodes an array of float16 values into native floats; see canardDecodeArray().
+ * 将float16数组解码为本机浮点数。
+ */
+int32_t canardDecodeFloat16Array(const CanardRxTransfer* transfer,
+                                 uint32_t bit_offset,
+                                 uint16_t count,
+                                 float* out_values);
+
+/**
+ * See canardDecodeFloat16Array() and canardReadRxArray().
+ */
+int32_t canardReadRxFloat16Array(CanardRxPayloadReader* reader,
+                                 uint32_t bit_offset,
+                                 uint16_t count,
+                                 float* out_values);
+#endif
+
 /**
  * This function can be used to encode values for later transmission in a UAVCAN transfer. It encodes a scalar value -
  * boolean, integer, character, or floating point - and puts it to the specified bit position in the specified
@@ -598,6 +1139,33 @@ void canardEncodeScalar(void* destination,      ///< Destination buffer where th
                         uint8_t bit_length,     ///< Length of the value, in bits; see the table
                         const void* value);     ///< Pointer to the value; see the table
 
+/**
+ * Encodes an array of count values of the same bit length back to back, starting from the specified bit position in
+ * the destination buffer. The result is the same as that of count calls to canardEncodeScalar(), and the elements
+ * are taken from the same types (see the table of canardEncodeScalar()), but the bits are packed in one pass, and
+ * byte-aligned arrays of 8, 16, 32 or 64 bit values are copied in bulk. Values that do not fit into bit_length bits are
+ * truncated. Bits of the destination buffer outside of the array are left intact.
+ *
+ * 从目标缓冲区的指定位位置开始，依次编码由count个相同位长的值组成的数组。结果与count次调用canardEncodeScalar()相同，
+ * 但一次完成打包，字节对齐的8/16/32/64位数组被整体复制。
+ */
+void canardEncodeArray(void* destination,       ///< Destination buffer where the result will be stored
+                       uint32_t bit_offset,     ///< Offset, in bits, of the first element in the destination buffer
+                       uint8_t bit_length,      ///< Length of one element, in bits
+                       uint16_t count,          ///< Number of elements to encode
+                       const void* values);     ///< Array of count elements; see canardEncodeScalar()
+
+#if CANARD_ENABLE_FLOAT16
+/**
+ * Encodes an array of native floats as float16 values; see canardEncodeArray().
+ * 将本机浮点数数组编码为float16值。
+ */
+void canardEncodeFloat16Array(void* destination,
+                              uint32_t bit_offset,
+                              uint16_t count,
+                              const float* values);
+#endif
+
 /**
  * This function can be invoked by the application to release pool blocks that are used
  * to store the payload of the transfer.
@@ -623,8 +1191,371 @@ void canardReleaseRxTransferPayload(CanardInstance* ins,
  * 返回池分配器使用情况统计信息的副本。请参阅类型CanardPoolAllocatorStatistics。
  * 使用此功能可以确定应用程序的最坏情况的内存需求。
  */
+#if !CANARD_ENABLE_STATIC_CAPACITY
 CanardPoolAllocatorStatistics canardGetPoolAllocatorStatistics(CanardInstance* ins);
 
+/**
+ * Returns a copy of the usage statistics of the pool blocks held by the given owner.
+ * Use this function to find out what a lack of memory is caused by: TX backlog, stale RX states, or large RX transfers.
+ * The sum of the current usage of all owners equals the current usage of the pool.
+ * 返回给定所有者持有的内存池块的使用情况统计信息的副本。使用此功能可以确定内存不足的原因。
+ */
+CanardPoolOwnerStatistics canardGetPoolOwnerStatistics(CanardInstance* ins,
+                                                       CanardPoolOwner owner);
+#endif
+
+/**
+ * Returns the number of bits the frame takes on the bus: start of frame to the end of the CRC with the stuff bits,
+ * plus CANARD_CAN_FRAME_TRAILER_BITS. The stuff bits depend on the CAN ID and the data, so the exact length is computed
+ * bit by bit, together with the CRC-15 of the frame.
+ * 返回帧在总线上占用的位数（含填充位和帧尾）。
+ */
+uint16_t canardGetFrameBitLength(const CanardCANFrame* frame);
+
+/**
+ * Returns the longest number of bits a data frame with the given data length can take on the bus, i.e. with a stuff
+ * bit after every four bits past the first one. This is the figure used for schedulability analysis.
+ * 返回给定数据长度的数据帧在总线上可能占用的最大位数（最坏情况的填充位）。
+ */
+uint16_t canardGetWorstCaseFrameBitLength(uint8_t data_len,
+                                          bool extended);
+
+#if CANARD_ENABLE_BUSLOAD
+/**
+ * Advances the sliding window of the bus load statistics to the given time. Call it from the main loop at least once
+ * per CANARD_BUSLOAD_SLOT_USEC, with the same clock as the timestamps given to canardHandleRxFrame(), which advance the
+ * window too. Frames are accounted in the slot that is current when they are popped from the TX queue or received.
+ * The window starts at the first time given; times earlier than the latest one given are ignored.
+ * 将总线负载统计的滑动窗口推进到给定时间，应在主循环中至少每个时隙调用一次。
+ */
+void canardUpdateBusLoad(CanardInstance* ins,
+                         uint64_t current_time_usec);
+
+/**
+ * Returns the bus load over the sliding window, at the given bit rate of the bus.
+ * A frame is accounted as transmitted when it is popped from the TX queue, i.e. when the driver has loaded it into a
+ * mailbox. The node sees its own frames and the frames that pass its acceptance filters only, so the figures are
+ * exact for the whole bus only if the filters accept everything. Under multinode, the figures are kept by the host.
+ * 返回滑动窗口内给定位速率下的总线负载。节点只能看到自己的帧和通过接收过滤器的帧。
+ */
+CanardBusLoadStatistics canardGetBusLoadStatistics(const CanardInstance* ins,
+                                                   uint32_t bit_rate);
+#endif
+
+#if CANARD_ENABLE_MULTINODE
+/**
+ * Initializes a multi-node host, which runs many virtual nodes in one process (e.g. a hardware-in-the-loop rig)
+ * on top of one memory pool and one CAN interface:
+ *  - Every received frame is parsed and reassembled once. Completed message transfers are delivered to every hosted
+ *    node that accepts them; service transfers are delivered to the hosted node they are addressed to.
+ *  - Hosted nodes transmit through the shared TX queue. Frames addressed to another hosted node never reach the bus;
+ *    broadcasts go to the bus and are also looped back to the other hosted nodes once they have been transmitted.
+ *  - RX states and buffers come from the shared pool, so memory grows with traffic rather than with the number of
+ *    nodes.
+ *
+ * The application drives the host with canardMultiNodeHostHandleRxFrame(), canardMultiNodeHostPeekTxQueue(),
+ * canardMultiNodeHostPopTxQueue() and canardMultiNodeHostCleanupStaleTransfers(). Hosted nodes are regular library
+ * instances: canardBroadcast(), canardRequestOrRespond() and the other API functions work on them as usual.
+ *
+ * Payload buffers of a received transfer are shared between all nodes it is delivered to; they are released by the
+ * host after the last reception callback, so canardReleaseRxTransferPayload() only invalidates the caller's view.
+ *
+ * 初始化多节点主机：每帧只解析一次，然后分发给匹配的本地节点；本地节点之间的传输在本地环回，不经过总线。
+ */
+void canardMultiNodeHostInit(CanardMultiNodeHost* out_host,     ///< Uninitialized host
+                             void* mem_arena,                   ///< Memory shared by all hosted nodes
+                             size_t mem_arena_size,             ///< Size of the above, in bytes
+                             void* user_reference);             ///< Optional pointer for user's convenience
+
+/**
+ * Adds a node to the host. The node instance must stay valid until it is removed.
+ * The node ID cannot be changed afterwards. Anonymous nodes cannot be hosted.
+ * Returns CANARD_OK, or negative error code if the node ID is invalid or already taken.
+ * 向主机添加节点。
+ */
+int16_t canardMultiNodeHostAddNode(CanardMultiNodeHost* host,
+                                   CanardInstance* out_node,                   ///< Uninitialized node instance
+                                   uint8_t node_id,                            ///< 1 to 127
+                                   CanardOnTransferReception on_reception,     ///< Callback of this node
+                                   CanardShouldAcceptTransfer should_accept,   ///< Callback of this node
+                                   void* user_reference);                      ///< Optional pointer for the node
+
+/**
+ * Removes a node from the host. Its pending TX frames remain queued.
+ * 从主机移除节点。
+ */
+void canardMultiNodeHostRemoveNode(CanardMultiNodeHost* host,
+                                   CanardInstance* node);
+
+/**
+ * Processes a frame received from the bus; see canardHandleRxFrame().
+ * 处理从总线接收的帧。
+ */
+void canardMultiNodeHostHandleRxFrame(CanardMultiNodeHost* host,
+                                      const CanardCANFrame* frame,
+                                      uint64_t timestamp_usec);
+
+/**
+ * Returns the top priority frame that has to be transmitted on the bus, or NULL if there is none.
+ * Frames addressed to hosted nodes are delivered locally by this function, so it may invoke reception callbacks.
+ * 返回需要发送到总线的最高优先级帧；发给本地节点的帧在此直接递交。
+ */
+const CanardCANFrame* canardMultiNodeHostPeekTxQueue(CanardMultiNodeHost* host,
+                                                     uint64_t timestamp_usec);
+
+/**
+ * Removes the top priority frame after it has been transmitted and loops it back to the other hosted nodes.
+ * 帧发送后将其移除，并环回给其他本地节点。
+ */
+void canardMultiNodeHostPopTxQueue(CanardMultiNodeHost* host,
+                                   uint64_t timestamp_usec);
+
+/**
+ * See canardCleanupStaleTransfers().
+ */
+void canardMultiNodeHostCleanupStaleTransfers(CanardMultiNodeHost* host,
+                                              uint64_t current_time_usec);
+#endif
+
+#if CANARD_ENABLE_TRACE
+/**
+ * Events of the binary trace, see CANARD_ENABLE_TRACE.
+ * 二进制跟踪的事件类型。
+ */
+typedef enum
+{
+    CanardTraceEventTxEnqueue = 0,      ///< A frame was added to the TX queue
+    CanardTraceEventTxMailbox = 1,      ///< The driver loaded a frame into a TX mailbox; detail is the mailbox
+    CanardTraceEventRxFrame = 2,        ///< A frame was given to canardHandleRxFrame()
+    CanardTraceEventRxTransfer = 3,     ///< A transfer was completed by the frame and delivered to the application
+    CanardTraceEventDrop = 4            ///< The frame was dropped; detail is a CanardTraceDropReason
+} CanardTraceEvent;
+
+/**
+ * Why a frame was dropped.
+ * 帧被丢弃的原因。
+ */
+typedef enum
+{
+    CanardTraceDropNotUavcan = 0,           ///< Standard, remote, error or empty frame
+    CanardTraceDropAddressMismatch = 1,     ///< Service transfer addressed to another node
+    CanardTraceDropDisabledFeature = 2,     ///< Needs a feature that is disabled in canard_config.h
+    CanardTraceDropNotAccepted = 3,         ///< Rejected by the should_accept callback, or no static subscription
+    CanardTraceDropOutOfMemory = 4,         ///< No memory for the RX state or the payload
+    CanardTraceDropNoState = 5,             ///< Not the first frame of a transfer, and the first one was not received
+    CanardTraceDropMissedStart = 6,         ///< The RX state was restarted by a frame that is not the first one
+    CanardTraceDropWrongToggle = 7,         ///< A frame of the transfer was lost or duplicated
+    CanardTraceDropUnexpectedTransferID = 8,
+    CanardTraceDropShortFrame = 9,          ///< First frame of a multi-frame transfer without payload
+    CanardTraceDropBadCrc = 10,             ///< The transfer CRC did not match; the whole transfer is lost
+    CanardTraceDropTooLong = 11,            ///< Longer than the static subscription allows
+    CanardTraceDropTxOutOfMemory = 12,      ///< A transfer could not be enqueued; the frame holds only the CAN ID
+    CanardTraceDropRxOverrun = 13           ///< Reported by the driver: the controller lost frames before this one
+} CanardTraceDropReason;
+
+/**
+ * One event of the trace.
+ * 跟踪中的一个事件。
+ */
+typedef struct
+{
+    uint32_t timestamp;                 ///< CANARD_TRACE_TIMESTAMP() at the event, wraps around
+    uint32_t can_id;                    ///< With the flags
+    uint8_t event;                      ///< CanardTraceEvent
+    uint8_t detail;                     ///< Depends on the event
+    uint8_t data_len;
+    uint8_t tail_byte;                  ///< Last data byte: start, end, toggle and transfer ID
+#if CANARD_TRACE_FRAME_DATA
+    uint8_t data[CANARD_CAN_FRAME_MAX_DATA_LEN];
+#endif
+} CanardTraceEntry;
+
+/**
+ * Receives the bytes of a trace dump, e.g. to send them over a UART or to write them into a file.
+ */
+typedef void (*CanardTraceWrite)(void* user_reference,
+                                 const uint8_t* bytes,
+                                 uint16_t len);
+
+/**
+ * Records an event of the frame into the trace ring. The library records its own events; drivers use this
+ * function for CanardTraceEventTxMailbox and CanardTraceDropRxOverrun.
+ * The trace is shared by all library instances. Events must be recorded and read from one context at a time.
+ * 将帧的事件记录到跟踪环形缓冲区。库记录自己的事件；驱动程序用此函数记录邮箱装载和接收溢出。
+ */
+void canardTraceRecord(uint8_t event,                       ///< CanardTraceEvent
+                       uint8_t detail,
+                       const CanardCANFrame* frame);
+
+/**
+ * Moves up to max_entries of the oldest events out of the ring. The number of events that were overwritten before
+ * they could be read is stored into out_lost, counting from the previous call that reported it; it can be NULL.
+ * Returns the number of events moved.
+ * 从环形缓冲区取出最旧的事件，并返回取出的数量；out_lost为上次调用以来被覆盖的事件数。
+ */
+uint16_t canardTraceRead(CanardTraceEntry* out_entries,
+                         uint16_t max_entries,
+                         uint32_t* out_lost);
+
+/**
+ * Drains the trace ring into the callback in the binary format that trace_decode.py turns into candump logs and
+ * pcapng files. The dump is a sequence of records, each one a 16-byte header followed by its events, all little
+ * endian:
+ *
+ *   char     magic[4]          "CTRC"
+ *   uint8_t  version           1
+ *   uint8_t  entry_size        12, or 20 with CANARD_TRACE_FRAME_DATA
+ *   uint16_t count             events in this record
+ *   uint32_t timestamp_hz      CANARD_TRACE_TIMESTAMP_HZ
+ *   uint32_t lost              events overwritten before this record
+ *
+ * The events are laid out like CanardTraceEntry. Dumps can be concatenated, e.g. by draining periodically.
+ * 将跟踪环形缓冲区以二进制格式输出到回调函数（例如串口或文件），由trace_decode.py转换为candump日志和pcapng文件。
+ */
+void canardTraceDump(CanardTraceWrite write,
+                     void* user_reference);
+
+/**
+ * Discards all events.
+ */
+void canardTraceReset(void);
+
+#endif
+
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+/// Number of buckets of a latency histogram, see CANARD_LATENCY_SUB_BUCKET_BITS.
+#define CANARD_LATENCY_NUM_BUCKETS  ((CANARD_LATENCY_RANGE_BITS - CANARD_LATENCY_SUB_BUCKET_BITS + 1U) << \
+                                     CANARD_LATENCY_SUB_BUCKET_BITS)
+#define CANARD_LATENCY_NUM_PATHS    3U
+
+/**
+ * Paths whose latency is measured, see CANARD_ENABLE_LATENCY_HISTOGRAMS.
+ * 测量延迟的路径。
+ */
+typedef enum
+{
+    CanardLatencyPathRx = 0,            ///< Frame given to canardHandleRxFrame() to on_reception of its transfer
+    CanardLatencyPathTxQueue = 1,       ///< Transfer enqueued, e.g. by canardBroadcast(), to its frame popped from
+                                        ///< the TX queue after the driver loaded it into a mailbox
+    CanardLatencyPathTxComplete = 2     ///< Frame loaded into a mailbox to its transmission completed; reported
+                                        ///< by the driver
+} CanardLatencyPath;
+
+/**
+ * Latency percentiles of a path, in ticks of CANARD_LATENCY_TIMESTAMP(). The percentiles are the upper bounds of
+ * their buckets, so they are never below the true values.
+ * 路径的延迟百分位数，单位为CANARD_LATENCY_TIMESTAMP()的计数值。
+ */
+typedef struct
+{
+    uint32_t count;                     ///< Samples since the reset
+    uint32_t p50;
+    uint32_t p99;
+    uint32_t max;                       ///< Exact
+} CanardLatencyStatistics;
+
+/**
+ * Adds a latency sample to the histogram of the path. The library records the RX and TX queue paths itself;
+ * drivers use this function for CanardLatencyPathTxComplete.
+ * The histograms are shared by all library instances. Each path must be recorded from one context at a time;
+ * in the concurrency mode these are the RX thread for the RX path and the TX thread for the TX paths.
+ * 向路径的直方图添加一个延迟样本。库自己记录接收和发送队列路径；驱动程序用此函数记录发送完成路径。
+ */
+void canardLatencyRecord(uint8_t path,                      ///< CanardLatencyPath
+                         uint32_t ticks);
+
+/**
+ * Returns the latency of the path below which the given fraction of the samples lies, in ticks, or zero if there
+ * are no samples. For example, 990 per mille gives the 99th percentile.
+ * 返回路径的延迟百分位数（千分比），没有样本时返回零。
+ */
+uint32_t canardGetLatencyPercentile(uint8_t path,           ///< CanardLatencyPath
+                                    uint16_t permille);
+
+/**
+ * Returns the p50, p99 and maximum latency of the path.
+ * 返回路径延迟的p50、p99和最大值。
+ */
+CanardLatencyStatistics canardGetLatencyStatistics(uint8_t path);     ///< CanardLatencyPath
+
+/**
+ * Discards the samples of all paths.
+ */
+void canardLatencyReset(void);
+#endif
+
+#if CANARD_ENABLE_PROFILING
+/**
+ * Profiling sites, see CANARD_ENABLE_PROFILING. The application has CANARD_PROF_USER_SITES sites of its own from
+ * CanardProfSiteUser on.
+ * 剖析测量点。应用程序从CanardProfSiteUser开始拥有CANARD_PROF_USER_SITES个自己的测量点。
+ */
+typedef enum
+{
+    CanardProfSiteHandleRxFrame = 0,    ///< canardHandleRxFrame(), including on_reception
+    CanardProfSiteTxTransfer = 1,       ///< Splitting a transfer into the TX queue in canardBroadcast() and
+                                        ///< canardRequestOrRespond()
+    CanardProfSiteCleanup = 2,          ///< canardCleanupStaleTransfers()
+    CanardProfSiteDriverTransmit = 3,   ///< Transmit function of a driver, e.g. canardSTM32Transmit()
+    CanardProfSiteDriverReceive = 4,    ///< Receive function of a driver, e.g. canardSTM32Receive()
+    CanardProfSiteUser = 5
+} CanardProfSite;
+
+#define CANARD_PROF_NUM_SITES       (CanardProfSiteUser + CANARD_PROF_USER_SITES)
+
+/**
+ * Counters of a profiling site, in ticks of CANARD_PROF_TIMESTAMP(). The minimum is zero if there were no passes.
+ * 测量点的计数器，单位为CANARD_PROF_TIMESTAMP()的计数值。
+ */
+typedef struct
+{
+    uint32_t count;                     ///< Passes since the reset
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} CanardProfStatistics;
+
+/**
+ * Marks the start and the end of a profiled section in the same block; the site must be an enumerator or a macro
+ * name, not an expression, since it names the variable that holds the start time. Both compile to nothing when
+ * profiling is disabled.
+ * 标记同一代码块中剖析区段的开始和结束；site必须是枚举常量或宏名。禁用剖析时二者不产生任何代码。
+ */
+# define CANARD_PROF_BEGIN(site)    const uint32_t canard_prof_begin_##site = CANARD_PROF_TIMESTAMP()
+# define CANARD_PROF_END(site)      canardProfRecord((site), CANARD_PROF_TIMESTAMP() - canard_prof_begin_##site)
+
+/**
+ * Adds a pass of the given duration to the counters of the site. The counters are shared by all library instances
+ * and are not atomic; each site must be passed from one context at a time, so profiling is not available in the
+ * concurrency mode.
+ * 向测量点的计数器添加一次给定时长的通过。计数器由所有库实例共享且非原子操作。
+ */
+void canardProfRecord(uint8_t site,                         ///< CanardProfSite
+                      uint32_t ticks);
+
+/**
+ * Returns the counters of the site.
+ * 返回测量点的计数器。
+ */
+CanardProfStatistics canardGetProfStatistics(uint8_t site); ///< CanardProfSite
+
+/**
+ * Clears the counters of all sites.
+ */
+void canardProfReset(void);
+#else
+# define CANARD_PROF_BEGIN(site)    ((void)0)
+# define CANARD_PROF_END(site)      ((void)0)
+#endif
+
+#if CANARD_ENABLE_TRACE || CANARD_ENABLE_LATENCY_HISTOGRAMS || (CANARD_ENABLE_PROFILING && !CANARD_PROF_USE_TSC)
+/**
+ * The timestamp source of the trace, of the latency histograms and of the profiling counters on platforms without a
+ * default, see CANARD_TRACE_TIMESTAMP in canard_config.h. Defined by the application.
+ */
+uint32_t canardTraceGetTimestamp(void);
+#endif
+
 /**
  * Float16 marshaling helpers.
  * These functions convert between the native float and 16-bit float.
@@ -635,14 +1566,29 @@ CanardPoolAllocatorStatistics canardGetPoolAllocatorStatistics(CanardInstance* i
  * 这些函数在本机浮点数和16位浮点数之间转换。假定本机浮点数是IEEE 754单精度浮点数，否则结果将不可预测。
  * 绝大多数现代计算机和微控制器都使用IEEE 754，因此此限制不应影响可移植性。
  */
+#if CANARD_ENABLE_FLOAT16
 uint16_t canardConvertNativeFloatToFloat16(float value);
 float canardConvertFloat16ToNativeFloat(uint16_t value);
 
+/**
+ * Batch versions of the above; the input and the output must not overlap.
+ * The results are bit-exact with the scalar functions, including rounding and NaN payloads, whichever backend is
+ * selected with CANARD_FLOAT16_BACKEND (see canard_config.h).
+ * 上述函数的批量版本；输入和输出不能重叠。无论选择哪种实现，结果都与标量函数逐位一致。
+ */
+void canardConvertNativeFloatArrayToFloat16(const float* values,
+                                            uint16_t* out_values,
+                                            size_t count);
+void canardConvertFloat16ArrayToNativeFloat(const uint16_t* values,
+                                            float* out_values,
+                                            size_t count);
+#endif
+
 /// Abort the build if the current platform is not supported.
 /// 如果不支持当前平台，则中止构建。
-CANARD_STATIC_ASSERT(((uint32_t)CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE) < 32,
-                     "Platforms where sizeof(void*) > 4 are not supported. "
-                     "On AMD64 use 32-bit mode (e.g. GCC flag -m32).");
+CANARD_STATIC_ASSERT(((uint32_t)CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE) < CANARD_MEM_BLOCK_SIZE,
+                     "Platforms where sizeof(void*) > 4 are not supported with the default block size. "
+                     "On AMD64 use 32-bit mode (e.g. GCC flag -m32), or increase CANARD_MEM_BLOCK_SIZE.");
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ *
+ * Documentation: http://uavcan.org/Implementations/Libcanard
+ */
+
+/*
+ * Compile-time configuration of the library.
+ * Every option can be overridden from the compiler command line (e.g. -DCANARD_ENABLE_FLOAT16=0), or one of the
+ * profiles below can be selected (e.g. -DCANARD_PROFILE_SINGLE_FRAME_ONLY). Options that are set explicitly take
+ * precedence over the profiles. Disabled features are removed from the build entirely, except the service client,
+ * which has almost no code of its own; see CANARD_ENABLE_SERVICE_CLIENT.
+ * 库的编译时配置。可以在编译器命令行上覆盖每个选项，或者选择下面的某个配置文件。被禁用的功能会从构建中完全移除
+ * （服务客户端除外，它几乎没有独立的代码）。
+ *
+ * The CAN node firmware needs neither multi-frame reception, nor anonymous transfers, nor the service client, nor
+ * float16, so it can be built with:
+ *   CANARD_PROFILE_NO_ANONYMOUS, CANARD_PROFILE_NO_SERVICE_CLIENT, CANARD_PROFILE_NO_FLOAT16,
+ *   CANARD_ENABLE_MULTI_FRAME_RX=0
+ * Multi-frame transmission must stay enabled there, because GetNodeInfo and ParamGetSet responses exceed one frame.
+ * Run tests/profile_sizes.sh to compare the footprint of the profiles. Its output for x86-64 with GCC 12,
+ * CC=gcc SIZE=size CFLAGS="-Os -DCANARD_MEM_BLOCK_SIZE=64", in bytes; RAM excludes the memory arena:
+ *   Profile                   Flash        RAM Flash diff
+ *   FULL                      13289         80         +0
+ *   SINGLE_FRAME_ONLY         10420         80      -2869
+ *   NO_ANONYMOUS              13074         80       -215
+ *   NO_SERVICE_CLIENT         13290         80         +1
+ *   NO_FLOAT16                11186         80      -2103
+ *   FIRMWARE                   9181         80      -4108
+ *   ALL                        8002         80      -5287
+ */
+
+#ifndef CANARD_CONFIG_H
+#define CANARD_CONFIG_H
+
+/*
+ * Profiles. Each one is a shorthand for a set of the options below.
+ * 配置文件：每个配置文件都是下列选项组合的简写。
+ */
+
+/// Single-frame transfers only, in both directions. Replaces the former single*() API flavor.
+/// 仅支持单帧传输（收发两个方向）。
+#ifdef CANARD_PROFILE_SINGLE_FRAME_ONLY
+# ifndef CANARD_ENABLE_MULTI_FRAME_RX
+#  define CANARD_ENABLE_MULTI_FRAME_RX              0
+# endif
+# ifndef CANARD_ENABLE_MULTI_FRAME_TX
+#  define CANARD_ENABLE_MULTI_FRAME_TX              0
+# endif
+#endif
+
+/// The node never runs without a node ID and ignores anonymous transfers of other nodes.
+/// 节点不使用匿名模式，并忽略其他节点的匿名传输。
+#ifdef CANARD_PROFILE_NO_ANONYMOUS
+# ifndef CANARD_ENABLE_ANONYMOUS
+#  define CANARD_ENABLE_ANONYMOUS                   0
+# endif
+#endif
+
+/// The node only serves requests; it never sends requests and ignores responses. A rejection-only switch, it does
+/// not shrink the flash, see CANARD_ENABLE_SERVICE_CLIENT.
+/// 节点仅作为服务端：不发送请求，并忽略响应。仅用于拒绝，不减少闪存占用。
+#ifdef CANARD_PROFILE_NO_SERVICE_CLIENT
+# ifndef CANARD_ENABLE_SERVICE_CLIENT
+#  define CANARD_ENABLE_SERVICE_CLIENT              0
+# endif
+#endif
+
+/// Removes the float16 conversion helpers.
+/// 移除float16转换函数。
+#ifdef CANARD_PROFILE_NO_FLOAT16
+# ifndef CANARD_ENABLE_FLOAT16
+#  define CANARD_ENABLE_FLOAT16                     0
+# endif
+#endif
+
+/*
+ * Options. All features are enabled by default, except the ones that need a hosted environment.
+ * 选项：默认启用所有功能，需要主机环境的功能除外。
+ */
+
+/// Reassembly of multi-frame transfers. When disabled, frames of multi-frame transfers are dropped before any
+/// RX state lookup, and the RX states never allocate payload buffer blocks.
+/// 多帧传输的重组。禁用时，多帧传输的帧在查找接收状态之前即被丢弃。
+#ifndef CANARD_ENABLE_MULTI_FRAME_RX
+# define CANARD_ENABLE_MULTI_FRAME_RX               1
+#endif
+
+/// Transmission of multi-frame transfers. When disabled, transfers longer than 7 bytes are rejected with
+/// -CANARD_ERROR_INVALID_ARGUMENT, and no transfer CRC is computed on the TX path.
+/// 多帧传输的发送。禁用时，超过7字节的传输将被拒绝。
+#ifndef CANARD_ENABLE_MULTI_FRAME_TX
+# define CANARD_ENABLE_MULTI_FRAME_TX               1
+#endif
+
+/// Anonymous transfers. When disabled, broadcasting without a node ID fails with -CANARD_ERROR_NODE_ID_NOT_SET,
+/// and received anonymous frames are dropped.
+/// 匿名传输。禁用时，未设置节点ID的广播返回错误，接收到的匿名帧被丢弃。
+#ifndef CANARD_ENABLE_ANONYMOUS
+# define CANARD_ENABLE_ANONYMOUS                    1
+#endif
+
+/// Service client role. When disabled, sending requests fails with -CANARD_ERROR_INVALID_ARGUMENT and received
+/// responses are dropped before any RX state is allocated for them; responding to requests is not affected.
+/// Requests and responses share the TX and RX paths, so only the transfer ID update of requests is compiled out;
+/// the checks added for the rejection cost about as much, so the flash size does not change.
+/// 服务客户端角色。禁用时，发送请求返回错误，接收到的响应在分配接收状态之前被丢弃；响应请求不受影响。
+/// 请求和响应共用收发路径，因此闪存占用不会减少。
+#ifndef CANARD_ENABLE_SERVICE_CLIENT
+# define CANARD_ENABLE_SERVICE_CLIENT               1
+#endif
+
+/// canardConvertNativeFloatToFloat16() and canardConvertFloat16ToNativeFloat().
+/// float16转换函数。
+#ifndef CANARD_ENABLE_FLOAT16
+# define CANARD_ENABLE_FLOAT16                      1
+#endif
+
+/// Backend of the batch float16 conversions, canardConvertNativeFloatArrayToFloat16() and
+/// canardConvertFloat16ArrayToNativeFloat(). Every backend is bit-exact with the scalar functions.
+///  - SCALAR: one call of the scalar function per value; the reference.
+///  - TABLE:  integer arithmetic and a small exponent table, for cores without an FPU (Cortex-M3), where the
+///            floating point multiplications of the scalar functions are library calls.
+///  - SSE2:   four values per step on x86.
+///  - F16C:   hardware half to float conversion on x86 (SSE2 for the other direction, see canard.c).
+/// By default the best one the compiler targets is used (-mf16c, -msse2, or no FPU on ARM).
+/// float16批量转换的实现方式：标量（参考实现）、整数查表（无FPU的内核）、SSE2或F16C（x86主机）。
+#define CANARD_FLOAT16_BACKEND_SCALAR               0
+#define CANARD_FLOAT16_BACKEND_TABLE                1
+#define CANARD_FLOAT16_BACKEND_SSE2                 2
+#define CANARD_FLOAT16_BACKEND_F16C                 3
+
+#ifndef CANARD_FLOAT16_BACKEND
+# if defined(__F16C__)
+#  define CANARD_FLOAT16_BACKEND                    CANARD_FLOAT16_BACKEND_F16C
+# elif defined(__SSE2__)
+#  define CANARD_FLOAT16_BACKEND                    CANARD_FLOAT16_BACKEND_SSE2
+# elif defined(__arm__) && !defined(__ARM_FP)
+#  define CANARD_FLOAT16_BACKEND                    CANARD_FLOAT16_BACKEND_TABLE
+# else
+#  define CANARD_FLOAT16_BACKEND                    CANARD_FLOAT16_BACKEND_SCALAR
+# endif
+#endif
+
+/// Opt-in concurrency mode for multi-threaded hosts, such as Linux gateways with separate RX and TX threads.
+/// When enabled, the threading contract is as follows:
+///  - The pool allocator is guarded by a spinlock, so blocks can be allocated and freed from any thread.
+///  - canardBroadcast() and canardRequestOrRespond() can be called from any thread. The frames of a transfer are
+///    built privately and then published with one atomic operation on a lock-free MPSC submission stack.
+///    Each transfer ID variable must still be used by one thread only.
+///  - canardPeekTxQueue() and canardPopTxQueue() must be called from a single TX thread. It owns the priority
+///    TX queue and moves newly submitted frames into it.
+///  - canardHandleRxFrame() and canardCleanupStaleTransfers() must be called from a single RX thread. It owns the
+///    RX reassembly states; the reception callback is invoked from that thread.
+///  - The local node ID must be assigned before the other threads are started.
+/// Requires GCC or Clang (__atomic builtins). Disabled by default.
+/// 可选的并发模式：RX线程拥有重组状态，TX线程拥有优先级队列，任意线程可以提交传输。
+#ifndef CANARD_ENABLE_CONCURRENCY
+# define CANARD_ENABLE_CONCURRENCY                  0
+#endif
+
+/// Enables CanardMultiNodeHost, which runs many virtual nodes on one pool and one interface.
+/// Refer to canardMultiNodeHostInit() for details. Disabled by default.
+/// 启用多节点主机：多个虚拟节点共享一个内存池和一个接口。
+#ifndef CANARD_ENABLE_MULTINODE
+# define CANARD_ENABLE_MULTINODE                    0
+#endif
+
+/// Allocation-free mode for nodes where dynamic memory is not acceptable (e.g. safety-critical ESCs).
+/// The memory pool is replaced with storage that is sized at compile time per subscription and per publisher:
+/// every subscription owns a fixed number of reassembly sessions with contiguous buffers, and every publisher owns
+/// a fixed number of TX frame slots. Refer to canardInitStatic() for details. Disabled by default.
+/// 静态容量模式：不使用内存池，每个订阅和每个发布者的存储在编译时确定，最坏情况下的内存在链接时已知。
+#ifndef CANARD_ENABLE_STATIC_CAPACITY
+# define CANARD_ENABLE_STATIC_CAPACITY              0
+#endif
+
+/// Binary event trace for debugging lost transfers in the field. Every TX enqueue, TX mailbox load (reported by the
+/// driver), received frame, completed transfer and dropped frame is recorded into a fixed-size ring in RAM, with a
+/// timestamp and the CAN ID, in a few instructions. Refer to canardTraceDump() for draining it. Disabled by default;
+/// not available in the concurrency mode, since the ring is not thread-safe.
+/// 二进制事件跟踪：将发送入队、邮箱装载、接收帧、完成的传输和丢弃原因记录到RAM中的固定大小环形缓冲区。
+#ifndef CANARD_ENABLE_TRACE
+# define CANARD_ENABLE_TRACE                        0
+#endif
+
+/// Number of events the trace ring holds; a power of two. Once it is full, the oldest events are overwritten.
+/// 跟踪环形缓冲区的事件数（2的幂）；满时覆盖最旧的事件。
+#ifndef CANARD_TRACE_CAPACITY
+# define CANARD_TRACE_CAPACITY                      64U
+#endif
+
+/// Whether the trace stores the data bytes of the frames, which the host decoder needs for complete candump logs.
+/// An event takes 12 bytes without them and 20 bytes with them.
+/// 跟踪是否保存帧的数据字节：不保存时每个事件12字节，保存时20字节。
+#ifndef CANARD_TRACE_FRAME_DATA
+# define CANARD_TRACE_FRAME_DATA                    0
+#endif
+
+/// Timestamp of the trace events, a free-running uint32_t counter, and its frequency. The default on Cortex-M3/M4
+/// is the DWT cycle counter at the core clock of the node, which the application must enable; elsewhere the
+/// application defines canardTraceGetTimestamp().
+/// 跟踪事件的时间戳及其频率。Cortex-M3/M4上默认使用DWT周期计数器（需由应用程序启用），其他平台由应用程序定义。
+#ifndef CANARD_TRACE_TIMESTAMP
+# if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#  define CANARD_TRACE_TIMESTAMP()                  (*(volatile const uint32_t*)0xE0001004UL)
+# else
+#  define CANARD_TRACE_TIMESTAMP()                  canardTraceGetTimestamp()
+# endif
+#endif
+
+#ifndef CANARD_TRACE_TIMESTAMP_HZ
+# define CANARD_TRACE_TIMESTAMP_HZ                  72000000UL
+#endif
+
+/// Bus load accounting. Every frame popped from the TX queue and every frame given to canardHandleRxFrame() is
+/// accounted with its exact length on the wire, stuff bits included, per direction, per priority band and per data
+/// type over a sliding window. Refer to canardGetBusLoadStatistics(). Disabled by default.
+/// 总线负载统计：按方向、优先级段和数据类型，在滑动窗口内统计每帧在总线上的精确长度（含填充位）。
+#ifndef CANARD_ENABLE_BUSLOAD
+# define CANARD_ENABLE_BUSLOAD                      0
+#endif
+
+/// The sliding window consists of CANARD_BUSLOAD_NUM_SLOTS slots of CANARD_BUSLOAD_SLOT_USEC each; the statistics
+/// cover the last CANARD_BUSLOAD_NUM_SLOTS - 1 slots and the elapsed part of the current one. A slot takes
+/// 4 * (7 + CANARD_BUSLOAD_MAX_DATA_TYPES) bytes of RAM in the instance.
+/// 滑动窗口由若干时隙组成；每个时隙占用 4 * (7 + CANARD_BUSLOAD_MAX_DATA_TYPES) 字节的RAM。
+#ifndef CANARD_BUSLOAD_SLOT_USEC
+# define CANARD_BUSLOAD_SLOT_USEC                   250000UL
+#endif
+
+#ifndef CANARD_BUSLOAD_NUM_SLOTS
+# define CANARD_BUSLOAD_NUM_SLOTS                   5U
+#endif
+
+/// Number of data types whose load is tracked separately. A data type whose frames left the window gives its entry
+/// to the next new one; the load of the data types that find no entry is reported as untracked.
+/// 单独统计负载的数据类型数量；没有表项的数据类型的负载计为未跟踪。
+#ifndef CANARD_BUSLOAD_MAX_DATA_TYPES
+# define CANARD_BUSLOAD_MAX_DATA_TYPES              8U
+#endif
+
+/// Accounts every frame with the longest length its data length allows, instead of stuffing it bit by bit.
+/// Cheaper on slow cores, and the right figure for schedulability analysis.
+/// 按最坏情况的填充位计算帧长，而不是逐位计算：在慢速内核上开销更小，适用于可调度性分析。
+#ifndef CANARD_BUSLOAD_WORST_CASE_STUFFING
+# define CANARD_BUSLOAD_WORST_CASE_STUFFING         0
+#endif
+
+/// Latency histograms of the RX and TX paths: frame given to canardHandleRxFrame() to on_reception, transfer
+/// enqueued to frame popped from the TX queue (i.e. loaded into a mailbox by the driver), and mailbox load to TX
+/// complete (reported by the driver). Every sample costs a timestamp read and a bucket increment. Refer to
+/// canardGetLatencyStatistics(). Disabled by default.
+/// 接收和发送路径的延迟直方图：帧到达至on_reception、发送入队至装载到邮箱、邮箱装载至发送完成。
+#ifndef CANARD_ENABLE_LATENCY_HISTOGRAMS
+# define CANARD_ENABLE_LATENCY_HISTOGRAMS           0
+#endif
+
+/// The histograms are log-linear: every power of two of the latency is split into 2^CANARD_LATENCY_SUB_BUCKET_BITS
+/// buckets, so the reported percentiles are within 1 / 2^CANARD_LATENCY_SUB_BUCKET_BITS of the true values.
+/// Latencies from 2^CANARD_LATENCY_RANGE_BITS ticks on fall into the last bucket; the maximum is kept exactly.
+/// A histogram takes 4 * (CANARD_LATENCY_RANGE_BITS - CANARD_LATENCY_SUB_BUCKET_BITS + 1) *
+/// 2^CANARD_LATENCY_SUB_BUCKET_BITS + 8 bytes of RAM, 376 bytes with the defaults (233 ms at 72 MHz).
+/// 对数线性直方图：每个2的幂区间分为2^CANARD_LATENCY_SUB_BUCKET_BITS个桶；超过2^CANARD_LATENCY_RANGE_BITS的延迟计入最后一个桶。
+#ifndef CANARD_LATENCY_SUB_BUCKET_BITS
+# define CANARD_LATENCY_SUB_BUCKET_BITS             2U
+#endif
+
+#ifndef CANARD_LATENCY_RANGE_BITS
+# define CANARD_LATENCY_RANGE_BITS                  24U
+#endif
+
+/// Monotonic clock of the latency histograms, a free-running uint32_t counter, and its frequency. The same clock as
+/// the trace by default, see CANARD_TRACE_TIMESTAMP.
+/// 延迟直方图的单调时钟及其频率，默认与跟踪的时间戳相同。
+#ifndef CANARD_LATENCY_TIMESTAMP
+# define CANARD_LATENCY_TIMESTAMP()                 CANARD_TRACE_TIMESTAMP()
+#endif
+
+#ifndef CANARD_LATENCY_TIMESTAMP_HZ
+# define CANARD_LATENCY_TIMESTAMP_HZ                CANARD_TRACE_TIMESTAMP_HZ
+#endif
+
+/// Cycle-count profiling of the hot paths. The CANARD_PROF_BEGIN()/CANARD_PROF_END() points in the library and the
+/// drivers accumulate, per site, the number of passes and the minimum, maximum and total ticks between them; refer to
+/// canardGetProfStatistics(). A pass costs two clock reads and a few compares. When disabled, the default, the points
+/// and the counters are compiled out entirely. Not available in the concurrency mode, since the counters are not
+/// thread-safe.
+/// 热路径的周期计数剖析：每个测量点累计通过次数及最小、最大和总计数值；禁用时（默认）完全编译掉。
+#ifndef CANARD_ENABLE_PROFILING
+# define CANARD_ENABLE_PROFILING                    0
+#endif
+
+/// Number of sites reserved for the application after the sites of the library, see CanardProfSiteUser.
+/// 在库的测量点之后为应用程序保留的测量点数量。
+#ifndef CANARD_PROF_USER_SITES
+# define CANARD_PROF_USER_SITES                     4U
+#endif
+
+/// Reads the time stamp counter of x86 hosts for the profiling clock instead of the trace clock: a few cycles instead
+/// of a call to clock_gettime(), but in TSC ticks, whose frequency the library does not know.
+/// 在x86主机上使用时间戳计数器（TSC）作为剖析时钟，开销更小，但单位为TSC计数。
+#ifndef CANARD_PROF_USE_TSC
+# define CANARD_PROF_USE_TSC                        0
+#endif
+
+/// Clock of the profiling counters, a free-running uint32_t counter, and its frequency. The same clock as the trace
+/// by default, see CANARD_TRACE_TIMESTAMP: the DWT cycle counter on Cortex-M3/M4, which the application must enable,
+/// and canardTraceGetTimestamp() elsewhere, which a host application defines e.g. with clock_gettime().
+/// 剖析计数器的时钟及其频率，默认与跟踪的时间戳相同（Cortex-M3/M4上为DWT周期计数器）。
+#ifndef CANARD_PROF_TIMESTAMP
+# if CANARD_PROF_USE_TSC
+#  define CANARD_PROF_TIMESTAMP()                   ((uint32_t)__builtin_ia32_rdtsc())
+# else
+#  define CANARD_PROF_TIMESTAMP()                   CANARD_TRACE_TIMESTAMP()
+# endif
+#endif
+
+#ifndef CANARD_PROF_TIMESTAMP_HZ
+# define CANARD_PROF_TIMESTAMP_HZ                   CANARD_TRACE_TIMESTAMP_HZ
+#endif
+
+#if (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_SSE2) && !defined(__SSE2__)
+# error "CANARD_FLOAT16_BACKEND_SSE2 requires a compiler targeting SSE2 (-msse2)"
+#endif
+#if (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_F16C) && !defined(__F16C__)
+# error "CANARD_FLOAT16_BACKEND_F16C requires a compiler targeting F16C (-mf16c)"
+#endif
+
+#if CANARD_ENABLE_TRACE && ((CANARD_TRACE_CAPACITY < 2U) || (CANARD_TRACE_CAPACITY > 32768U) || \
+                            ((CANARD_TRACE_CAPACITY & (CANARD_TRACE_CAPACITY - 1U)) != 0U))
+# error "CANARD_TRACE_CAPACITY must be a power of two from 2 to 32768"
+#endif
+
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS && ((CANARD_LATENCY_SUB_BUCKET_BITS > 4U) || \
+                                         (CANARD_LATENCY_RANGE_BITS <= CANARD_LATENCY_SUB_BUCKET_BITS) || \
+                                         (CANARD_LATENCY_RANGE_BITS > 32U))
+# error "CANARD_LATENCY_SUB_BUCKET_BITS must be up to 4, CANARD_LATENCY_RANGE_BITS above it and up to 32"
+#endif
+
+#if CANARD_ENABLE_PROFILING && (CANARD_PROF_USER_SITES > 200U)
+# error "CANARD_PROF_USER_SITES must be up to 200"
+#endif
+
+#if CANARD_PROF_USE_TSC && !(defined(__x86_64__) || defined(__i386__))
+# error "CANARD_PROF_USE_TSC requires an x86 host"
+#endif
+
+#if CANARD_ENABLE_BUSLOAD && ((CANARD_BUSLOAD_NUM_SLOTS < 2U) || (CANARD_BUSLOAD_NUM_SLOTS > 255U) || \
+                              (CANARD_BUSLOAD_MAX_DATA_TYPES > 255U))
+# error "CANARD_BUSLOAD_NUM_SLOTS must be from 2 to 255, CANARD_BUSLOAD_MAX_DATA_TYPES up to 255"
+#endif
+
+#if CANARD_ENABLE_TRACE && CANARD_ENABLE_CONCURRENCY
+# error "CANARD_ENABLE_TRACE cannot be combined with CANARD_ENABLE_CONCURRENCY, the RX and TX threads would race"
+#endif
+
+#if CANARD_ENABLE_PROFILING && CANARD_ENABLE_CONCURRENCY
+# error "CANARD_ENABLE_PROFILING cannot be combined with CANARD_ENABLE_CONCURRENCY, the producer threads would race"
+#endif
+
+#if CANARD_ENABLE_BUSLOAD && CANARD_ENABLE_CONCURRENCY
+# error "CANARD_ENABLE_BUSLOAD cannot be combined with CANARD_ENABLE_CONCURRENCY, the RX and TX threads would race"
+#endif
+
+#if CANARD_ENABLE_STATIC_CAPACITY && (CANARD_ENABLE_CONCURRENCY || CANARD_ENABLE_MULTINODE)
+# error "CANARD_ENABLE_STATIC_CAPACITY cannot be combined with CANARD_ENABLE_CONCURRENCY or CANARD_ENABLE_MULTINODE"
+#endif
+
+#endif
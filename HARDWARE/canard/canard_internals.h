@@ -43,7 +43,22 @@ extern "C" {
 # define CANARD_INTERNAL static
 #endif
 
+/**
+ * Frame in the TX queue, ordered by CAN ID priority.
+ */
+struct CanardTxQueueItem
+{
+    CanardTxQueueItem* next;
+    CanardCANFrame frame;
+#if CANARD_ENABLE_STATIC_CAPACITY
+    uint8_t publisher_index;                        ///< Publisher that owns the slot of this item
+#endif
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+    uint32_t enqueued_at;                           ///< CANARD_LATENCY_TIMESTAMP() when the transfer was enqueued
+#endif
+};
 
+#if !CANARD_ENABLE_STATIC_CAPACITY
 CANARD_INTERNAL CanardRxState* traverseRxStates(CanardInstance* ins,
                                                 uint32_t transfer_descriptor);
 
@@ -56,12 +71,22 @@ CANARD_INTERNAL CanardRxState* prependRxState(CanardInstance* ins,
 CANARD_INTERNAL CanardRxState* findRxState(CanardRxState* state,
                                            uint32_t transfer_descriptor);
 
+# if CANARD_ENABLE_MULTI_FRAME_RX
 CANARD_INTERNAL int16_t bufferBlockPushBytes(CanardPoolAllocator* allocator,
                                              CanardRxState* state,
                                              const uint8_t* data,
                                              uint8_t data_len);
 
 CANARD_INTERNAL CanardBufferBlock* createBufferBlock(CanardPoolAllocator* allocator);
+# endif
+
+CANARD_INTERNAL CanardTxQueueItem* createTxItem(CanardPoolAllocator* allocator);
+
+CANARD_INTERNAL void prepareForNextTransfer(CanardRxState* state);
+
+CANARD_INTERNAL uint64_t releaseStatePayload(CanardInstance* ins,
+                                             CanardRxState* rxstate);
+#endif
 
 CANARD_INTERNAL CanardTransferType extractTransferType(uint32_t id);
 
@@ -73,18 +98,24 @@ CANARD_INTERNAL void pushTxQueue(CanardInstance* ins,
 CANARD_INTERNAL bool isPriorityHigher(uint32_t id,
                                       uint32_t rhs);
 
-CANARD_INTERNAL CanardTxQueueItem* createTxItem(CanardPoolAllocator* allocator);
+#if CANARD_ENABLE_CONCURRENCY
+CANARD_INTERNAL void submitTxChain(CanardInstance* ins,
+                                   CanardTxQueueItem* newest,
+                                   CanardTxQueueItem* oldest);
 
-CANARD_INTERNAL void prepareForNextTransfer(CanardRxState* state);
+CANARD_INTERNAL void drainTxSubmissions(CanardInstance* ins);
+
+# if CANARD_ENABLE_MULTI_FRAME_TX
+CANARD_INTERNAL void freeTxChain(CanardInstance* ins,
+                                 CanardTxQueueItem* chain);
+# endif
+#endif
 
 CANARD_INTERNAL int16_t computeTransferIDForwardDistance(uint8_t a,
                                                          uint8_t b);
 
 CANARD_INTERNAL void incrementTransferID(uint8_t* transfer_id);
 
-CANARD_INTERNAL uint64_t releaseStatePayload(CanardInstance* ins,
-                                             CanardRxState* rxstate);
-
 /// Returns the number of frames enqueued
 /// 返回入队的帧数消息入队并返回入队帧数
 CANARD_INTERNAL int16_t enqueueTxFrames(CanardInstance* ins,
@@ -93,12 +124,44 @@ CANARD_INTERNAL int16_t enqueueTxFrames(CanardInstance* ins,
                                         uint16_t crc,
                                         const uint8_t* payload,
                                         uint16_t payload_len);
-										
-CANARD_INTERNAL int16_t singleEnqueueTxFrames(CanardInstance* ins,
-                                        uint32_t can_id,
-                                        uint8_t* transfer_id,
-                                        const uint8_t* payload,
-                                        uint16_t payload_len);
+
+/**
+ * Initializes the streaming writer of a transfer; the CAN ID of an anonymous transfer lacks the discriminator.
+ */
+CANARD_INTERNAL int16_t beginTransfer(CanardInstance* ins,
+                                      CanardBitWriter* writer,
+                                      uint32_t can_id,
+                                      uint64_t data_type_signature,
+                                      uint8_t* inout_transfer_id,
+                                      bool anonymous,
+                                      bool increment_transfer_id);
+
+/**
+ * Appends a frame to the transfer of the writer. Returns NULL and sets the error of the writer if out of memory.
+ */
+CANARD_INTERNAL CanardTxQueueItem* allocateWriterFrame(CanardBitWriter* writer);
+
+CANARD_INTERNAL void releaseWriterFrames(CanardBitWriter* writer);
+
+/**
+ * Appends one payload byte, starting a new frame when the last one is full.
+ */
+CANARD_INTERNAL void putWriterByte(CanardBitWriter* writer,
+                                   uint8_t byte);
+
+/**
+ * Appends bits given in the order of the bit stream, see scalarToStreamBits().
+ */
+CANARD_INTERNAL void putWriterBits(CanardBitWriter* writer,
+                                   uint64_t bits,
+                                   uint8_t bit_length);
+
+/**
+ * Fills the started transfer of the writer with the frames of a prebuilt transfer and finishes it.
+ */
+CANARD_INTERNAL int16_t finishPrebuiltTransfer(CanardBitWriter* writer,
+                                               const CanardPrebuiltTransfer* transfer,
+                                               const uint8_t* variable_bytes);
 
 CANARD_INTERNAL void copyBitArray(const uint8_t* src,
                                   uint32_t src_offset,
@@ -115,23 +178,164 @@ CANARD_INTERNAL int16_t descatterTransferPayload(const CanardRxTransfer* transfe
                                                  uint8_t bit_length,
                                                  void* output);
 
+/**
+ * Moves the payload reader to the next piece of storage.
+ * Returns false if the reader is already at the last piece.
+ */
+CANARD_INTERNAL bool advanceRxPayloadReader(CanardRxPayloadReader* reader);
+
 CANARD_INTERNAL bool isBigEndian(void);
 
-CANARD_INTERNAL void swapByteOrder(void* data, unsigned size);
+CANARD_INTERNAL void swapByteOrder(void* data, size_t size);
+
+#if CANARD_ENABLE_MULTINODE
+CANARD_INTERNAL bool isMultiNodeHostBus(const CanardInstance* ins);
+
+CANARD_INTERNAL CanardInstance* getPoolOwner(CanardInstance* ins);
+
+CANARD_INTERNAL bool multiNodeHostShouldAccept(const CanardInstance* ins,
+                                               uint64_t* out_data_type_signature,
+                                               uint16_t data_type_id,
+                                               CanardTransferType transfer_type,
+                                               uint8_t source_node_id);
+
+CANARD_INTERNAL void multiNodeHostOnReception(CanardInstance* ins,
+                                              CanardRxTransfer* transfer);
+#endif
+
+#if CANARD_ENABLE_TRACE
+CANARD_INTERNAL void traceTxOutOfMemory(uint32_t can_id,
+                                        uint8_t transfer_id);
+
+CANARD_INTERNAL void putTraceWord(uint8_t* bytes,
+                                  uint32_t value);
+
+CANARD_INTERNAL void serializeTraceEntry(const CanardTraceEntry* entry,
+                                         uint8_t* out_bytes);
+#endif
+
+/**
+ * A CAN frame as it goes on the wire, from the start of frame: the CRC-15 of the bits and their number, stuff bits
+ * included. run_level is 2 before the first bit.
+ */
+typedef struct
+{
+    uint16_t crc;
+    uint16_t bit_count;
+    uint8_t run_level;
+    uint8_t run_length;
+} CanardFrameBitStream;
+
+/**
+ * Appends the width least significant bits of the value, most significant first.
+ */
+CANARD_INTERNAL void putFrameBits(CanardFrameBitStream* stream,
+                                  uint32_t value,
+                                  uint8_t width);
+
+#if CANARD_ENABLE_BUSLOAD
+CANARD_INTERNAL void advanceBusLoadWindow(CanardBusLoadState* state,
+                                          uint64_t current_time_usec);
+
+CANARD_INTERNAL void accountBusLoad(CanardBusLoadState* state,
+                                    const CanardCANFrame* frame,
+                                    bool tx);
+
+CANARD_INTERNAL void accountRxBusLoad(CanardBusLoadState* state,
+                                      const CanardCANFrame* frame,
+                                      uint64_t timestamp_usec);
+
+# if CANARD_BUSLOAD_MAX_DATA_TYPES > 0
+/**
+ * Bits of the data type in the given entry of the table, over the whole window.
+ */
+CANARD_INTERNAL uint32_t getBusLoadDataTypeBits(const CanardBusLoadState* state,
+                                                uint8_t index);
+# endif
+
+CANARD_INTERNAL uint16_t getBusLoadPermille(uint32_t bits,
+                                            uint32_t window_usec,
+                                            uint32_t bit_rate);
+#endif
+
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+/**
+ * Log-linear bucket of the latency: the values below 2^CANARD_LATENCY_SUB_BUCKET_BITS have a bucket each, then every
+ * power of two is split into 2^CANARD_LATENCY_SUB_BUCKET_BITS buckets.
+ */
+CANARD_INTERNAL uint16_t getLatencyBucket(uint32_t ticks);
+
+/**
+ * Largest latency that falls into the bucket.
+ */
+CANARD_INTERNAL uint32_t getLatencyBucketUpperBound(uint16_t bucket);
+#endif
+
+#if CANARD_ENABLE_PROFILING
+/**
+ * Body of canardHandleRxFrame(), which wraps it in its profiling site.
+ */
+CANARD_INTERNAL void handleRxFrame(CanardInstance* ins,
+                                   const CanardCANFrame* frame,
+                                   uint64_t timestamp_usec);
+#endif
 
 /*
  * Transfer CRC
  */
+#if CANARD_ENABLE_MULTI_FRAME_RX || CANARD_ENABLE_MULTI_FRAME_TX || CANARD_ENABLE_ANONYMOUS
 CANARD_INTERNAL uint16_t crcAddByte(uint16_t crc_val,
                                     uint8_t byte);
 
-CANARD_INTERNAL uint16_t crcAddSignature(uint16_t crc_val,
-                                         uint64_t data_type_signature);
-
 CANARD_INTERNAL uint16_t crcAdd(uint16_t crc_val,
                                 const uint8_t* bytes,
                                 size_t len);
+#endif
+
+#if CANARD_ENABLE_MULTI_FRAME_RX || CANARD_ENABLE_MULTI_FRAME_TX
+CANARD_INTERNAL uint16_t crcAddSignature(uint16_t crc_val,
+                                         uint64_t data_type_signature);
+#endif
+
+#if CANARD_ENABLE_MULTI_FRAME_TX
+/**
+ * Multiplies two polynomials modulo the CRC polynomial. Since the CRC is linear, changing bytes of a payload changes
+ * its CRC by the CRC (from zero) of the XOR difference of the bytes, multiplied by x^(8 * number of bytes after them).
+ */
+CANARD_INTERNAL uint16_t crcMultiply(uint16_t a,
+                                     uint16_t b);
+#endif
+
+#if CANARD_ENABLE_STATIC_CAPACITY
+CANARD_INTERNAL CanardStaticSubscription* findStaticSubscription(const CanardInstance* ins,
+                                                                 uint16_t data_type_id,
+                                                                 CanardTransferType transfer_type);
 
+CANARD_INTERNAL CanardStaticRxSession* findStaticRxSession(CanardStaticSubscription* sub,
+                                                           uint32_t transfer_descriptor);
+
+CANARD_INTERNAL CanardStaticRxSession* acquireStaticRxSession(CanardStaticSubscription* sub,
+                                                              uint32_t transfer_descriptor,
+                                                              uint64_t timestamp_usec);
+
+CANARD_INTERNAL void prepareStaticRxSession(CanardStaticRxSession* session);
+
+CANARD_INTERNAL void handleStaticRxFrame(CanardInstance* ins,
+                                         const CanardCANFrame* frame,
+                                         uint32_t transfer_descriptor,
+                                         const CanardRxTransfer* transfer_header);
+
+CANARD_INTERNAL CanardStaticPublisher* findStaticPublisher(const CanardInstance* ins,
+                                                           uint32_t can_id);
+
+CANARD_INTERNAL uint8_t countUsedStaticTxSlots(const CanardStaticPublisher* pub);
+
+CANARD_INTERNAL CanardTxQueueItem* claimStaticTxSlot(CanardInstance* ins,
+                                                     CanardStaticPublisher* pub);
+
+CANARD_INTERNAL void releaseStaticTxSlot(CanardInstance* ins,
+                                         CanardTxQueueItem* item);
+#else
 /**
  * Inits a memory allocator.
  *
@@ -144,15 +348,112 @@ CANARD_INTERNAL void initPoolAllocator(CanardPoolAllocator* allocator,
                                        uint16_t buf_len);
 
 /**
- * Allocates a block from the given pool allocator.
+ * Allocates a block from the given pool allocator on behalf of the given owner.
  */
-CANARD_INTERNAL void* allocateBlock(CanardPoolAllocator* allocator);
+CANARD_INTERNAL void* allocateBlock(CanardPoolAllocator* allocator,
+                                    CanardPoolOwner owner);
 
 /**
  * Frees a memory block previously returned by canardAllocateBlock.
+ * The owner must be the same as the one the block was allocated for.
  */
 CANARD_INTERNAL void freeBlock(CanardPoolAllocator* allocator,
+                               CanardPoolOwner owner,
                                void* p);
+#endif
+
+/**
+ * Bit-level cursors used by the array codecs. Bits are queued in the order of the bit stream, the oldest one being
+ * the most significant of the bit_count valid ones.
+ */
+typedef struct
+{
+    CanardRxPayloadReader* reader;
+    uint32_t next_byte;         ///< Payload offset of the next byte to be loaded
+    uint64_t bits;
+    uint8_t bit_count;
+} CanardRxBitCursor;
+
+typedef struct
+{
+    uint8_t* destination;
+    uint32_t next_byte;         ///< Offset of the next byte to be stored
+    uint64_t bits;
+    uint8_t bit_count;
+} CanardTxBitCursor;
+
+CANARD_INTERNAL void initRxBitCursor(CanardRxBitCursor* cursor,
+                                     CanardRxPayloadReader* reader,
+                                     uint32_t bit_offset);
+
+/**
+ * Takes the next bit_length (up to 64) bits of the payload; bits past the end of the payload read as zero.
+ */
+CANARD_INTERNAL uint64_t takeRxBits(CanardRxBitCursor* cursor,
+                                    uint8_t bit_length);
+
+/**
+ * Keeps the bits of the destination byte that precede bit_offset.
+ */
+CANARD_INTERNAL void initTxBitCursor(CanardTxBitCursor* cursor,
+                                     uint8_t* destination,
+                                     uint32_t bit_offset);
+
+CANARD_INTERNAL void putTxBits(CanardTxBitCursor* cursor,
+                               uint64_t bits,
+                               uint8_t bit_length);
+
+/**
+ * Stores the last partial byte, keeping the bits of the destination that follow it.
+ */
+CANARD_INTERNAL void flushTxBitCursor(CanardTxBitCursor* cursor);
+
+/**
+ * Conversion between a value and its bit_length bits in the order of the bit stream: whole bytes go first, least
+ * significant one first, followed by the remaining bits. This is the layout of canardEncodeScalar().
+ */
+CANARD_INTERNAL uint64_t scalarToStreamBits(uint64_t value,
+                                            uint8_t bit_length);
+
+CANARD_INTERNAL uint64_t streamBitsToScalar(uint64_t bits,
+                                            uint8_t bit_length);
+
+/**
+ * Size of an array element of the given bit length; see the table of canardDecodeScalar().
+ */
+CANARD_INTERNAL uint8_t getArrayElementSize(uint8_t bit_length);
+
+/**
+ * Loads a value of the C type that holds bit_length bits, see the table of canardEncodeScalar().
+ */
+CANARD_INTERNAL uint64_t loadArrayElement(const void* element,
+                                          uint8_t bit_length);
+
+#if CANARD_ENABLE_FLOAT16 && (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_TABLE)
+CANARD_INTERNAL uint16_t convertNativeFloatToFloat16Table(uint32_t bits);
+
+CANARD_INTERNAL uint32_t convertFloat16ToNativeFloatTable(uint16_t value);
+#endif
+
+#if CANARD_ENABLE_FLOAT16 && ((CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_SSE2) || \
+                              (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_F16C))
+/// Converts as many values as the vector width allows; returns how many were converted.
+CANARD_INTERNAL size_t convertNativeFloatArrayToFloat16Sse2(const float* values,
+                                                           uint16_t* out_values,
+                                                           size_t count);
+#endif
+
+#if CANARD_ENABLE_FLOAT16 && (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_SSE2)
+CANARD_INTERNAL size_t convertFloat16ArrayToNativeFloatSse2(const uint16_t* values,
+                                                           float* out_values,
+                                                           size_t count);
+#endif
+
+#if CANARD_ENABLE_FLOAT16 && (CANARD_FLOAT16_BACKEND == CANARD_FLOAT16_BACKEND_F16C)
+CANARD_INTERNAL size_t convertFloat16ArrayToNativeFloatF16c(const uint16_t* values,
+                                                           float* out_values,
+                                                           size_t count);
+#endif
 
 
 #ifdef __cplusplus
@@ -0,0 +1,475 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Distributed under the MIT License, available in the file LICENSE.
+ *
+ */
+
+// This is needed to enable necessary declarations in sys/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
+#include "canard_replay.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define NSEC_PER_SEC                    1000000000ULL
+#define USEC_PER_SEC                    1000000ULL
+
+#define CAN_ERR_FLAG                    0x20000000UL    ///< Error frame flag of the SocketCAN IDs in candump logs
+
+#define TRACE_MAGIC                     "CTRC"
+#define TRACE_HEADER_SIZE               16U
+#define TRACE_ENTRY_WITH_DATA_SIZE      20U
+#define TRACE_EVENT_RX_FRAME            2U              ///< CanardTraceEventRxFrame
+
+/// The replay whose instance is being fed, for the transfer counter; see canardReplayRun()
+static CanardReplayInstance* g_running = NULL;
+
+
+static uint64_t getMonotonicNsec(void)
+{
+    struct timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static void sleepUntilNsec(uint64_t deadline_nsec)
+{
+    if (getMonotonicNsec() >= deadline_nsec)
+    {
+        return;                         // Late already; not sleeping lets the replay catch up with the schedule
+    }
+    struct timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    ts.tv_sec = (time_t)(deadline_nsec / NSEC_PER_SEC);
+    ts.tv_nsec = (long)(deadline_nsec % NSEC_PER_SEC);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    {
+        // Interrupted by a signal, sleeping the rest
+    }
+}
+
+static void countTransfer(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    g_running->stats.transfers++;
+    g_running->on_reception(ins, transfer);
+}
+
+static void noteTimestamp(CanardReplayInstance* replay, uint64_t timestamp_usec)
+{
+    if (!replay->has_timestamp)
+    {
+        replay->first_timestamp_usec = timestamp_usec;
+        replay->has_timestamp = true;
+    }
+    replay->last_timestamp_usec = timestamp_usec;
+    replay->stats.log_span_usec = (timestamp_usec > replay->first_timestamp_usec) ?
+                                  (timestamp_usec - replay->first_timestamp_usec) : 0U;
+}
+
+/*
+ * candump logs
+ */
+static int8_t getHexDigit(char c)
+{
+    if ((c >= '0') && (c <= '9'))
+    {
+        return (int8_t)(c - '0');
+    }
+    if ((c >= 'A') && (c <= 'F'))
+    {
+        return (int8_t)(c - 'A' + 10);
+    }
+    if ((c >= 'a') && (c <= 'f'))
+    {
+        return (int8_t)(c - 'a' + 10);
+    }
+    return -1;
+}
+
+static const char* skipSpaces(const char* p, const char* end)
+{
+    while ((p < end) && ((*p == ' ') || (*p == '\t')))
+    {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * Parses "(seconds.fraction) interface id#data" in place. Returns false if the line is not a classic CAN frame.
+ */
+static bool parseCandumpLine(const char* p, const char* end, CanardCANFrame* out_frame, uint64_t* out_timestamp_usec)
+{
+    p = skipSpaces(p, end);
+    if ((p == end) || (*p != '('))
+    {
+        return false;
+    }
+    p++;
+
+    // Timestamp, the fraction scaled to microseconds whatever its number of digits
+    uint64_t seconds = 0;
+    while ((p < end) && (*p >= '0') && (*p <= '9'))
+    {
+        seconds = seconds * 10U + (uint64_t)(*p++ - '0');
+    }
+    uint64_t usec = 0;
+    uint64_t scale = USEC_PER_SEC;
+    if ((p < end) && (*p == '.'))
+    {
+        p++;
+        while ((p < end) && (*p >= '0') && (*p <= '9'))
+        {
+            if (scale > 1U)
+            {
+                scale /= 10U;
+                usec += scale * (uint64_t)(*p - '0');
+            }
+            p++;
+        }
+    }
+    if ((p == end) || (*p != ')'))
+    {
+        return false;
+    }
+    *out_timestamp_usec = seconds * USEC_PER_SEC + usec;
+    p++;
+
+    // Interface name
+    p = skipSpaces(p, end);
+    while ((p < end) && (*p != ' ') && (*p != '\t'))
+    {
+        p++;
+    }
+    p = skipSpaces(p, end);
+
+    // CAN ID: three digits for base frames, eight for extended and error frames
+    uint32_t id = 0;
+    uint8_t id_digits = 0;
+    while ((p < end) && (getHexDigit(*p) >= 0) && (id_digits < 8U))
+    {
+        id = (id << 4U) | (uint8_t)getHexDigit(*p++);
+        id_digits++;
+    }
+    if ((id_digits == 0U) || (p == end) || (*p != '#'))
+    {
+        return false;
+    }
+    p++;
+    if (id_digits > 3U)
+    {
+        if ((id & CAN_ERR_FLAG) != 0U)
+        {
+            return false;               // Error frames are not passed to the application by the drivers
+        }
+        out_frame->id = (id & CANARD_CAN_EXT_ID_MASK) | CANARD_CAN_FRAME_EFF;
+    }
+    else
+    {
+        out_frame->id = id & CANARD_CAN_STD_ID_MASK;
+    }
+
+    // Data, or R with an optional DLC for remote frames; "##" starts a CAN FD frame, which is not supported
+    out_frame->data_len = 0;
+    if ((p < end) && (*p == 'R'))
+    {
+        out_frame->id |= CANARD_CAN_FRAME_RTR;
+        p++;
+        if ((p < end) && (*p >= '0') && (*p <= '8'))
+        {
+            out_frame->data_len = (uint8_t)(*p - '0');
+        }
+        return true;
+    }
+    while ((p < end) && (*p != ' ') && (*p != '\t') && (*p != '\r'))
+    {
+        if (*p == '.')
+        {
+            p++;
+            continue;
+        }
+        const int8_t high = getHexDigit(*p);
+        const int8_t low = ((p + 1) < end) ? getHexDigit(p[1]) : (int8_t)-1;
+        if ((high < 0) || (low < 0) || (out_frame->data_len >= CANARD_CAN_FRAME_MAX_DATA_LEN))
+        {
+            return false;
+        }
+        out_frame->data[out_frame->data_len++] = (uint8_t)(((uint8_t)high << 4U) | (uint8_t)low);
+        p += 2;
+    }
+    return true;
+}
+
+static int16_t readCandump(CanardReplayInstance* replay,
+                           CanardCANFrame* out_frames,
+                           uint64_t* out_timestamps_usec,
+                           uint16_t max_frames)
+{
+    const char* const end = replay->data + replay->size;
+    uint16_t count = 0;
+    while ((count < max_frames) && (replay->offset < replay->size))
+    {
+        const char* const line = replay->data + replay->offset;
+        const char* eol = memchr(line, '\n', (size_t)(end - line));
+        if (eol == NULL)
+        {
+            eol = end;
+        }
+        replay->offset = (size_t)(eol - replay->data) + ((eol < end) ? 1U : 0U);
+
+        if (parseCandumpLine(line, eol, &out_frames[count], &out_timestamps_usec[count]))
+        {
+            noteTimestamp(replay, out_timestamps_usec[count]);
+            count++;
+        }
+        else if (skipSpaces(line, eol) < eol)
+        {
+            replay->stats.skipped++;    // Empty lines do not count
+        }
+    }
+    return (int16_t)count;
+}
+
+/*
+ * Binary trace dumps, see canardTraceDump()
+ */
+static uint32_t getLittleEndian32(const char* bytes)
+{
+    const uint8_t* const b = (const uint8_t*)bytes;
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8U) | ((uint32_t)b[2] << 16U) | ((uint32_t)b[3] << 24U);
+}
+
+static int16_t readTrace(CanardReplayInstance* replay,
+                         CanardCANFrame* out_frames,
+                         uint64_t* out_timestamps_usec,
+                         uint16_t max_frames)
+{
+    uint16_t count = 0;
+    while ((count < max_frames) && (replay->offset < replay->size))
+    {
+        const char* const p = replay->data + replay->offset;
+        const size_t left = replay->size - replay->offset;
+
+        if (replay->trace_remaining == 0U)
+        {
+            const uint8_t* const header = (const uint8_t*)p;
+            if ((left < TRACE_HEADER_SIZE) || (memcmp(p, TRACE_MAGIC, 4U) != 0) || (header[4] != 1U) ||
+                (header[5] < TRACE_ENTRY_WITH_DATA_SIZE) || (getLittleEndian32(p + 8) == 0U))
+            {
+                return -EINVAL;         // Malformed, or recorded without CANARD_TRACE_FRAME_DATA
+            }
+            replay->trace_entry_size = header[5];
+            replay->trace_remaining = (uint16_t)(header[6] | (header[7] << 8U));
+            replay->trace_timestamp_hz = getLittleEndian32(p + 8);
+            replay->offset += TRACE_HEADER_SIZE;
+            continue;
+        }
+
+        if (left < replay->trace_entry_size)
+        {
+            return -EINVAL;
+        }
+        replay->offset += replay->trace_entry_size;
+        replay->trace_remaining--;
+
+        // The timestamps wrap around; they are unwrapped like trace_decode.py does
+        const uint32_t timestamp = getLittleEndian32(p);
+        if (replay->trace_started)
+        {
+            replay->trace_ticks += (uint32_t)(timestamp - replay->trace_last_timestamp);
+        }
+        replay->trace_started = true;
+        replay->trace_last_timestamp = timestamp;
+
+        const uint8_t event = (uint8_t)p[8];
+        const uint8_t data_len = (uint8_t)p[10];
+        if ((event != TRACE_EVENT_RX_FRAME) || (data_len > CANARD_CAN_FRAME_MAX_DATA_LEN))
+        {
+            replay->stats.skipped++;    // Only the received frames are replayed
+            continue;
+        }
+
+        CanardCANFrame* const frame = &out_frames[count];
+        frame->id = getLittleEndian32(p + 4);
+        frame->data_len = data_len;
+        memcpy(frame->data, p + 12, CANARD_CAN_FRAME_MAX_DATA_LEN);
+
+        const uint64_t hz = replay->trace_timestamp_hz;
+        out_timestamps_usec[count] = (replay->trace_ticks / hz) * USEC_PER_SEC +
+                                     (replay->trace_ticks % hz) * USEC_PER_SEC / hz;
+        noteTimestamp(replay, out_timestamps_usec[count]);
+        count++;
+    }
+    return (int16_t)count;
+}
+
+/*
+ * API
+ */
+int16_t canardReplayOpenMemory(CanardReplayInstance* out_replay, const void* data, size_t size)
+{
+    if ((out_replay == NULL) || ((data == NULL) && (size > 0U)))
+    {
+        return -EINVAL;
+    }
+    memset(out_replay, 0, sizeof(*out_replay));
+    out_replay->data = (const char*)data;
+    out_replay->size = size;
+    out_replay->format = ((size >= 4U) && (memcmp(data, TRACE_MAGIC, 4U) == 0)) ?
+                         (uint8_t)CanardReplayFormatTrace : (uint8_t)CanardReplayFormatCandump;
+    return 0;
+}
+
+int16_t canardReplayOpen(CanardReplayInstance* out_replay, const char* path)
+{
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return (int16_t)-errno;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        const int error = errno;
+        (void)close(fd);
+        return (int16_t)-error;
+    }
+
+    const size_t size = (size_t)st.st_size;
+    void* data = NULL;
+    if (size > 0U)                      // Empty files cannot be mapped
+    {
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            const int error = errno;
+            (void)close(fd);
+            return (int16_t)-error;
+        }
+        (void)madvise(data, size, MADV_SEQUENTIAL);
+    }
+    (void)close(fd);                    // The mapping stays valid
+
+    const int16_t result = canardReplayOpenMemory(out_replay, data, size);
+    out_replay->mapped = (data != NULL);
+    return result;
+}
+
+int16_t canardReplayClose(CanardReplayInstance* replay)
+{
+    int16_t result = 0;
+    if (replay->mapped && (munmap((void*)replay->data, replay->size) < 0))
+    {
+        result = (int16_t)-errno;
+    }
+    replay->data = NULL;
+    replay->size = 0;
+    replay->offset = 0;
+    replay->mapped = false;
+    return result;
+}
+
+void canardReplayRewind(CanardReplayInstance* replay)
+{
+    const char* const data = replay->data;
+    const size_t size = replay->size;
+    const bool mapped = replay->mapped;
+    (void)canardReplayOpenMemory(replay, data, size);
+    replay->mapped = mapped;
+}
+
+int16_t canardReplayRead(CanardReplayInstance* replay,
+                         CanardCANFrame* out_frames,
+                         uint64_t* out_timestamps_usec,
+                         uint16_t max_frames)
+{
+    const int16_t result = (replay->format == CanardReplayFormatTrace) ?
+                           readTrace(replay, out_frames, out_timestamps_usec, max_frames) :
+                           readCandump(replay, out_frames, out_timestamps_usec, max_frames);
+    if (result > 0)
+    {
+        replay->stats.frames += (uint64_t)result;
+    }
+    return result;
+}
+
+int16_t canardReplayRun(CanardReplayInstance* replay, CanardInstance* ins, float speed, uint64_t max_frames)
+{
+    CanardCANFrame frames[CANARD_REPLAY_BATCH_SIZE];
+    uint64_t timestamps_usec[CANARD_REPLAY_BATCH_SIZE];
+
+    replay->on_reception = ins->on_reception;
+    ins->on_reception = countTransfer;
+    g_running = replay;
+
+    const uint64_t started_at_nsec = getMonotonicNsec();
+    uint64_t origin_usec = 0;
+    uint64_t next_cleanup_usec = 0;
+    uint64_t num_fed = 0;
+    int16_t result = 0;
+
+    while ((max_frames == 0U) || (num_fed < max_frames))
+    {
+        uint16_t batch = CANARD_REPLAY_BATCH_SIZE;
+        if ((max_frames > 0U) && ((max_frames - num_fed) < batch))
+        {
+            batch = (uint16_t)(max_frames - num_fed);
+        }
+        const int16_t count = canardReplayRead(replay, frames, timestamps_usec, batch);
+        if (count <= 0)
+        {
+            result = count;
+            break;
+        }
+
+        for (int16_t i = 0; i < count; i++)
+        {
+            const uint64_t timestamp_usec = timestamps_usec[i];
+            if (num_fed == 0U)
+            {
+                origin_usec = timestamp_usec;
+                next_cleanup_usec = timestamp_usec + CANARD_RECOMMENDED_STALE_TRANSFER_CLEANUP_INTERVAL_USEC;
+            }
+            if ((speed > 0.0F) && (timestamp_usec > origin_usec))
+            {
+                const double offset_nsec = (double)(timestamp_usec - origin_usec) * 1000.0 / (double)speed;
+                sleepUntilNsec(started_at_nsec + (uint64_t)offset_nsec);
+            }
+
+            canardHandleRxFrame(ins, &frames[i], timestamp_usec);
+            num_fed++;
+
+            if (timestamp_usec >= next_cleanup_usec)
+            {
+                canardCleanupStaleTransfers(ins, timestamp_usec);
+                next_cleanup_usec = timestamp_usec + CANARD_RECOMMENDED_STALE_TRANSFER_CLEANUP_INTERVAL_USEC;
+            }
+        }
+    }
+
+    replay->stats.elapsed_nsec += getMonotonicNsec() - started_at_nsec;
+    ins->on_reception = replay->on_reception;
+    g_running = NULL;
+    return result;
+}
+
+CanardReplayStatistics canardReplayGetStatistics(const CanardReplayInstance* replay)
+{
+    CanardReplayStatistics out = replay->stats;
+    if (out.elapsed_nsec > 0U)
+    {
+        out.frames_per_sec = (uint32_t)(out.frames * NSEC_PER_SEC / out.elapsed_nsec);
+        out.transfers_per_sec = (uint32_t)(out.transfers * NSEC_PER_SEC / out.elapsed_nsec);
+    }
+    return out;
+}
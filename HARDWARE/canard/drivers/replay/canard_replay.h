@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Distributed under the MIT License, available in the file LICENSE.
+ *
+ */
+
+#ifndef CANARD_REPLAY_H
+#define CANARD_REPLAY_H
+
+#include <canard.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Number of frames parsed ahead before they are given to canardHandleRxFrame(), so that the parser and the library
+ * each run over a batch while their code and data are hot.
+ */
+#if !defined(CANARD_REPLAY_BATCH_SIZE)
+# define CANARD_REPLAY_BATCH_SIZE                               64U
+#endif
+
+/**
+ * Formats of the logs, detected from their first bytes.
+ */
+typedef enum
+{
+    CanardReplayFormatCandump = 0,      ///< Text log of candump -l: "(1436509052.249713) can0 0C7D5522#0102C0"
+    CanardReplayFormatTrace = 1         ///< Binary dump of canardTraceDump(), built with CANARD_TRACE_FRAME_DATA
+} CanardReplayFormat;
+
+/**
+ * Statistics of the replay since the log was opened or rewound.
+ */
+typedef struct
+{
+    uint64_t frames;                    ///< Frames read from the log, which canardReplayRun() feeds to the library
+    uint64_t transfers;                 ///< Transfers that reached on_reception
+    uint64_t skipped;                   ///< Lines or events that are not classic CAN frames received by the node
+    uint64_t log_span_usec;             ///< Time between the first and the last frame in the log
+    uint64_t elapsed_nsec;              ///< Wall time spent in canardReplayRun()
+    uint32_t frames_per_sec;            ///< Over elapsed_nsec
+    uint32_t transfers_per_sec;
+} CanardReplayStatistics;
+
+/**
+ * A log mapped into memory. All fields are internal, see canardReplayOpen().
+ */
+typedef struct
+{
+    const char* data;
+    size_t size;
+    size_t offset;
+    bool mapped;                        ///< Unmapped by canardReplayClose()
+    uint8_t format;                     ///< CanardReplayFormat
+
+    // Binary trace records
+    uint16_t trace_entry_size;
+    uint16_t trace_remaining;           ///< Events left in the current record
+    uint32_t trace_timestamp_hz;
+    uint32_t trace_last_timestamp;
+    uint64_t trace_ticks;               ///< Unwrapped timestamp of the last event
+    bool trace_started;
+
+    uint64_t first_timestamp_usec;
+    uint64_t last_timestamp_usec;
+    bool has_timestamp;
+
+    CanardOnTransferReception on_reception;     ///< Of the instance being fed, while canardReplayRun() counts
+
+    CanardReplayStatistics stats;
+} CanardReplayInstance;
+
+/**
+ * Maps the log file into memory and detects its format. The frames are parsed straight from the mapping.
+ * Returns 0 on success, negative errno on error.
+ */
+int16_t canardReplayOpen(CanardReplayInstance* out_replay,
+                         const char* path);
+
+/**
+ * Same as canardReplayOpen() for a log that is already in memory; it must stay valid until canardReplayClose().
+ * Returns 0 on success, negative errno on error.
+ */
+int16_t canardReplayOpenMemory(CanardReplayInstance* out_replay,
+                               const void* data,
+                               size_t size);
+
+/**
+ * Unmaps the log.
+ * Returns 0 on success, negative errno on error.
+ */
+int16_t canardReplayClose(CanardReplayInstance* replay);
+
+/**
+ * Restarts from the first frame of the log and clears the statistics.
+ */
+void canardReplayRewind(CanardReplayInstance* replay);
+
+/**
+ * Parses up to max_frames next frames of the log, with their timestamps in microseconds from the log.
+ * Returns the number of frames, 0 at the end of the log, negative errno if the binary log is malformed.
+ * Malformed lines of text logs are skipped.
+ */
+int16_t canardReplayRead(CanardReplayInstance* replay,
+                         CanardCANFrame* out_frames,
+                         uint64_t* out_timestamps_usec,
+                         uint16_t max_frames);
+
+/**
+ * Feeds the frames of the log to canardHandleRxFrame() in batches, with the timestamps of the log, and calls
+ * canardCleanupStaleTransfers() once per second of log time. A speed of zero replays as fast as possible; otherwise
+ * the frames are paced at the given multiple of the recorded rate, e.g. 1 for real time or 10 for ten times faster.
+ * Stops at the end of the log or after max_frames frames, unless max_frames is zero.
+ * The on_reception callback of the instance is wrapped for the duration of the call to count the transfers, so only
+ * one replay can run at a time in a process.
+ * Returns 0 on success, negative errno if the binary log is malformed.
+ */
+int16_t canardReplayRun(CanardReplayInstance* replay,
+                        CanardInstance* ins,
+                        float speed,
+                        uint64_t max_frames);
+
+CanardReplayStatistics canardReplayGetStatistics(const CanardReplayInstance* replay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Distributed under the MIT License, available in the file LICENSE.
+ *
+ */
+
+#include "canard_sim.h"
+#include <string.h>
+
+#define NSEC_PER_SEC                    1000000000ULL
+#define NSEC_PER_USEC                   1000ULL
+#define MAX_BIT_RATE                    1000000U
+
+#define TAIL_END_OF_TRANSFER            0x40U
+#define TAIL_TRANSFER_ID_MASK           0x1FU
+
+CANARD_STATIC_ASSERT(CANARD_SIM_MAX_TX_MAILBOXES <= 8U, "The mailboxes are tracked in a byte-wide mask");
+
+
+/*
+ * Frame timing
+ */
+uint32_t canardSimGetFrameBitLength(const CanardCANFrame* frame)
+{
+    return canardGetFrameBitLength(frame);
+}
+
+/**
+ * The bits of the arbitration field in the order they are sent, the first one being the most significant.
+ * The frame with the lower value wins the arbitration, as zero bits are dominant.
+ */
+static uint32_t getArbitrationKey(uint32_t can_id)
+{
+    const uint32_t remote = ((can_id & CANARD_CAN_FRAME_RTR) != 0U) ? 1U : 0U;
+    if ((can_id & CANARD_CAN_FRAME_EFF) != 0U)
+    {
+        const uint32_t id = can_id & CANARD_CAN_EXT_ID_MASK;
+        return ((id >> 18U) << 21U) | (1UL << 20U) | (1UL << 19U) | ((id & 0x3FFFFU) << 1U) | remote;
+    }
+    return ((can_id & CANARD_CAN_STD_ID_MASK) << 21U) | (remote << 20U);
+}
+
+static uint64_t bitsToNsec(const CanardSimBus* bus, uint32_t bits)
+{
+    return ((uint64_t)bits * NSEC_PER_SEC + bus->bit_rate / 2U) / bus->bit_rate;
+}
+
+static uint32_t nextRandom(CanardSimBus* bus)
+{
+    // xorshift32
+    uint32_t x = bus->random_state;
+    x ^= x << 13U;
+    x ^= x >> 17U;
+    x ^= x << 5U;
+    bus->random_state = x;
+    return x;
+}
+
+/*
+ * Transfer tracking
+ */
+static void trackTransfer(CanardSimBus* bus,
+                          CanardSimNode* node,
+                          uint16_t data_type_id,
+                          CanardTransferType kind,
+                          uint8_t transfer_id)
+{
+    for (uint8_t i = 0; i < CANARD_SIM_MAX_PENDING_TRANSFERS; i++)
+    {
+        CanardSimPendingTransfer* const p = &node->pending[i];
+        if (!p->used)
+        {
+            p->submitted_at_nsec = bus->now_nsec;
+            p->data_type_id = data_type_id;
+            p->transfer_id = (uint8_t)(transfer_id & TAIL_TRANSFER_ID_MASK);
+            p->kind = (uint8_t)kind;
+            p->used = true;
+            return;
+        }
+    }
+    node->stats.untracked_transfers++;
+}
+
+/**
+ * Called when the last frame of a transfer has been sent; finds the oldest matching tracked transfer.
+ */
+static void completeTransfer(CanardSimBus* bus,
+                             CanardSimNode* node,
+                             const CanardCANFrame* frame)
+{
+    const uint32_t id = frame->id & CANARD_CAN_EXT_ID_MASK;
+    const bool service = ((id >> 7U) & 1U) != 0U;
+    const uint16_t data_type_id = (uint16_t)(service ? ((id >> 16U) & 0xFFU) : ((id >> 8U) & 0xFFFFU));
+    const uint8_t kind = (uint8_t)(!service ? CanardTransferTypeBroadcast :
+                                   (((id >> 15U) & 1U) != 0U) ? CanardTransferTypeRequest :
+                                                                CanardTransferTypeResponse);
+    const uint8_t transfer_id = (uint8_t)(frame->data[frame->data_len - 1U] & TAIL_TRANSFER_ID_MASK);
+
+    CanardSimPendingTransfer* match = NULL;
+    for (uint8_t i = 0; i < CANARD_SIM_MAX_PENDING_TRANSFERS; i++)
+    {
+        CanardSimPendingTransfer* const p = &node->pending[i];
+        if (p->used && (p->data_type_id == data_type_id) && (p->kind == kind) && (p->transfer_id == transfer_id) &&
+            ((match == NULL) || (p->submitted_at_nsec < match->submitted_at_nsec)))
+        {
+            match = p;
+        }
+    }
+    if (match == NULL)
+    {
+        return;
+    }
+    match->used = false;
+
+    const uint64_t latency = bus->now_nsec - match->submitted_at_nsec;
+    CanardSimLatencyStatistics* const stats = &bus->stats.latency;
+    if ((stats->count == 0U) || (latency < stats->min_nsec))
+    {
+        stats->min_nsec = latency;
+    }
+    if (latency > stats->max_nsec)
+    {
+        stats->max_nsec = latency;
+    }
+    stats->total_nsec += latency;
+    stats->count++;
+
+    if (bus->on_transfer_sent != NULL)
+    {
+        bus->on_transfer_sent(bus, node, frame->id, transfer_id, latency);
+    }
+}
+
+/*
+ * Bus and controllers
+ */
+static void serviceNode(CanardSimBus* bus,
+                        CanardSimNode* node)
+{
+    // The reception callbacks may enqueue responses, which are loaded right after
+    while (node->rx_fifo_count > 0U)
+    {
+        const CanardCANFrame frame = node->rx_fifo[node->rx_fifo_head];
+        node->rx_fifo_head = (uint8_t)((node->rx_fifo_head + 1U) % node->rx_fifo_depth);
+        node->rx_fifo_count--;
+        canardHandleRxFrame(node->ins, &frame, bus->now_nsec / NSEC_PER_USEC);
+    }
+
+    // Like the STM32 driver, a frame is loaded only if it outranks all pending ones, otherwise the controller could
+    // reorder the frames of a transfer
+    for (const CanardCANFrame* frame = canardPeekTxQueue(node->ins);
+         frame != NULL;
+         frame = canardPeekTxQueue(node->ins))
+    {
+        const uint32_t key = getArbitrationKey(frame->id);
+        int16_t free_mailbox = -1;
+        for (uint8_t i = 0; i < node->num_mailboxes; i++)
+        {
+            if ((node->mailbox_used_mask & (1U << i)) == 0U)
+            {
+                if (free_mailbox < 0)
+                {
+                    free_mailbox = (int16_t)i;
+                }
+            }
+            else if (getArbitrationKey(node->mailboxes[i].id) <= key)
+            {
+                return;
+            }
+        }
+        if (free_mailbox < 0)
+        {
+            return;
+        }
+        node->mailboxes[free_mailbox] = *frame;
+        node->mailbox_used_mask = (uint8_t)(node->mailbox_used_mask | (1U << (uint8_t)free_mailbox));
+        canardPopTxQueue(node->ins);
+    }
+}
+
+static void serviceDueNodes(CanardSimBus* bus)
+{
+    for (CanardSimNode* node = bus->nodes; node != NULL; node = node->next)
+    {
+        if (node->poll_interval_nsec == 0U)
+        {
+            serviceNode(bus, node);
+        }
+        else if (node->next_poll_nsec <= bus->now_nsec)
+        {
+            serviceNode(bus, node);
+            while (node->next_poll_nsec <= bus->now_nsec)
+            {
+                node->next_poll_nsec += node->poll_interval_nsec;
+            }
+        }
+    }
+}
+
+/**
+ * Returns the mailbox of the node that the controller would send first, or -1 if all are empty.
+ */
+static int16_t selectMailbox(const CanardSimNode* node)
+{
+    int16_t best = -1;
+    for (uint8_t i = 0; i < node->num_mailboxes; i++)
+    {
+        if (((node->mailbox_used_mask & (1U << i)) != 0U) &&
+            ((best < 0) || (getArbitrationKey(node->mailboxes[i].id) <
+                            getArbitrationKey(node->mailboxes[(uint8_t)best].id))))
+        {
+            best = (int16_t)i;
+        }
+    }
+    return best;
+}
+
+static void startTransmission(CanardSimBus* bus)
+{
+    CanardSimNode* winner = NULL;
+    uint8_t winner_mailbox = 0;
+    uint32_t winner_key = 0;
+    uint16_t contenders = 0;
+
+    for (CanardSimNode* node = bus->nodes; node != NULL; node = node->next)
+    {
+        const int16_t mailbox = selectMailbox(node);
+        if (mailbox < 0)
+        {
+            continue;
+        }
+        contenders++;
+        const uint32_t key = getArbitrationKey(node->mailboxes[mailbox].id);
+        if ((winner == NULL) || (key < winner_key))
+        {
+            winner = node;
+            winner_mailbox = (uint8_t)mailbox;
+            winner_key = key;
+        }
+    }
+    if (winner == NULL)
+    {
+        return;
+    }
+    if (contenders > 1U)
+    {
+        for (CanardSimNode* node = bus->nodes; node != NULL; node = node->next)
+        {
+            if ((node != winner) && (selectMailbox(node) >= 0))
+            {
+                node->stats.tx_lost_arbitration++;
+            }
+        }
+    }
+
+    const uint32_t frame_bits = canardSimGetFrameBitLength(&winner->mailboxes[winner_mailbox]);
+    bool fails = false;
+    if (bus->forced_errors > 0U)
+    {
+        bus->forced_errors--;
+        fails = true;
+    }
+    else if (bus->error_rate_ppm > 0U)
+    {
+        fails = (nextRandom(bus) % 1000000U) < bus->error_rate_ppm;
+    }
+
+    bus->transmitter = winner;
+    bus->transmitter_mailbox = winner_mailbox;
+    bus->transmission_fails = fails;
+    if (fails)
+    {
+        // The error is detected at a random bit before the end of frame, then the error frame follows
+        const uint32_t error_bit = 1U + (nextRandom(bus) % (frame_bits - 3U));
+        bus->transmission_bits = error_bit + CANARD_SIM_ERROR_FRAME_BITS;
+    }
+    else
+    {
+        bus->transmission_bits = frame_bits;
+    }
+    bus->transmission_started_nsec = bus->now_nsec;
+    bus->busy_until_nsec = bus->now_nsec + bitsToNsec(bus, bus->transmission_bits);
+}
+
+static void completeTransmission(CanardSimBus* bus)
+{
+    CanardSimNode* const transmitter = bus->transmitter;
+    bus->transmitter = NULL;
+    bus->stats.busy_nsec += bus->busy_until_nsec - bus->transmission_started_nsec;
+
+    if (bus->transmission_fails)
+    {
+        // The frame stays in its mailbox and takes part in the next arbitration
+        transmitter->stats.tx_errors++;
+        bus->stats.error_frames++;
+        return;
+    }
+
+    const CanardCANFrame frame = transmitter->mailboxes[bus->transmitter_mailbox];
+    transmitter->mailbox_used_mask = (uint8_t)(transmitter->mailbox_used_mask & ~(1U << bus->transmitter_mailbox));
+    transmitter->stats.tx_frames++;
+    bus->stats.frames++;
+    bus->stats.frame_bits += bus->transmission_bits;
+
+    for (CanardSimNode* node = bus->nodes; node != NULL; node = node->next)
+    {
+        if (node == transmitter)
+        {
+            continue;
+        }
+        if (node->rx_fifo_count < node->rx_fifo_depth)
+        {
+            const uint8_t index = (uint8_t)((node->rx_fifo_head + node->rx_fifo_count) % node->rx_fifo_depth);
+            node->rx_fifo[index] = frame;
+            node->rx_fifo_count++;
+            node->stats.rx_frames++;
+        }
+        else
+        {
+            node->stats.rx_overruns++;
+        }
+    }
+
+    if ((frame.data_len > 0U) && ((frame.data[frame.data_len - 1U] & TAIL_END_OF_TRANSFER) != 0U))
+    {
+        completeTransfer(bus, transmitter, &frame);
+    }
+}
+
+/*
+ * Public functions
+ */
+int16_t canardSimInit(CanardSimBus* out_bus,
+                      uint32_t bit_rate)
+{
+    if ((out_bus == NULL) || (bit_rate == 0U) || (bit_rate > MAX_BIT_RATE))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+    memset(out_bus, 0, sizeof(*out_bus));
+    out_bus->bit_rate = bit_rate;
+    out_bus->random_state = 1U;
+    return 0;
+}
+
+int16_t canardSimAddNode(CanardSimBus* bus,
+                         CanardSimNode* out_node,
+                         CanardInstance* ins,
+                         uint8_t num_mailboxes,
+                         uint8_t rx_fifo_depth,
+                         uint32_t poll_interval_usec)
+{
+    if ((bus == NULL) || (out_node == NULL) || (ins == NULL) ||
+        (num_mailboxes == 0U) || (num_mailboxes > CANARD_SIM_MAX_TX_MAILBOXES) ||
+        (rx_fifo_depth == 0U) || (rx_fifo_depth > CANARD_SIM_MAX_RX_FIFO_DEPTH))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+    memset(out_node, 0, sizeof(*out_node));
+    out_node->ins = ins;
+    out_node->num_mailboxes = num_mailboxes;
+    out_node->rx_fifo_depth = rx_fifo_depth;
+    out_node->poll_interval_nsec = poll_interval_usec * NSEC_PER_USEC;
+    out_node->next_poll_nsec = bus->now_nsec;
+
+    // The nodes are kept in the order they were added, so that the simulation does not depend on anything else
+    CanardSimNode** tail = &bus->nodes;
+    while (*tail != NULL)
+    {
+        tail = &(*tail)->next;
+    }
+    *tail = out_node;
+    return 0;
+}
+
+void canardSimSetErrorRate(CanardSimBus* bus,
+                           uint32_t error_rate_ppm,
+                           uint32_t seed)
+{
+    bus->error_rate_ppm = error_rate_ppm;
+    bus->random_state = (seed != 0U) ? seed : 1U;       // Zero is a fixed point of xorshift
+}
+
+void canardSimInjectErrors(CanardSimBus* bus,
+                           uint32_t count)
+{
+    bus->forced_errors += count;
+}
+
+void canardSimSetOnTransferSent(CanardSimBus* bus,
+                                CanardSimOnTransferSent callback)
+{
+    bus->on_transfer_sent = callback;
+}
+
+void canardSimRunUntil(CanardSimBus* bus,
+                       uint64_t time_usec)
+{
+    const uint64_t end_nsec = time_usec * NSEC_PER_USEC;
+    if (end_nsec < bus->now_nsec)
+    {
+        return;
+    }
+
+    for (;;)
+    {
+        serviceDueNodes(bus);
+        if (bus->transmitter == NULL)
+        {
+            startTransmission(bus);
+        }
+
+        uint64_t next_nsec = end_nsec;
+        if ((bus->transmitter != NULL) && (bus->busy_until_nsec < next_nsec))
+        {
+            next_nsec = bus->busy_until_nsec;
+        }
+        for (const CanardSimNode* node = bus->nodes; node != NULL; node = node->next)
+        {
+            if ((node->poll_interval_nsec > 0U) && (node->next_poll_nsec < next_nsec))
+            {
+                next_nsec = node->next_poll_nsec;
+            }
+        }
+
+        bus->now_nsec = next_nsec;
+        bus->stats.elapsed_nsec = next_nsec;
+        if ((bus->transmitter != NULL) && (bus->busy_until_nsec == next_nsec))
+        {
+            completeTransmission(bus);
+            continue;
+        }
+        if (next_nsec >= end_nsec)
+        {
+            break;
+        }
+    }
+}
+
+uint64_t canardSimGetTimeUsec(const CanardSimBus* bus)
+{
+    return bus->now_nsec / NSEC_PER_USEC;
+}
+
+int16_t canardSimBroadcast(CanardSimBus* bus,
+                           CanardSimNode* node,
+                           uint64_t data_type_signature,
+                           uint16_t data_type_id,
+                           uint8_t* inout_transfer_id,
+                           uint8_t priority,
+                           const void* payload,
+                           uint16_t payload_len)
+{
+    if ((bus == NULL) || (node == NULL) || (inout_transfer_id == NULL))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+    const uint8_t transfer_id = *inout_transfer_id;
+    const int16_t result = canardBroadcast(node->ins, data_type_signature, data_type_id, inout_transfer_id,
+                                           priority, payload, payload_len);
+    if (result > 0)
+    {
+        trackTransfer(bus, node, data_type_id, CanardTransferTypeBroadcast, transfer_id);
+    }
+    return result;
+}
+
+int16_t canardSimRequestOrRespond(CanardSimBus* bus,
+                                  CanardSimNode* node,
+                                  uint8_t destination_node_id,
+                                  uint64_t data_type_signature,
+                                  uint8_t data_type_id,
+                                  uint8_t* inout_transfer_id,
+                                  uint8_t priority,
+                                  CanardRequestResponse kind,
+                                  const void* payload,
+                                  uint16_t payload_len)
+{
+    if ((bus == NULL) || (node == NULL) || (inout_transfer_id == NULL))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+    const uint8_t transfer_id = *inout_transfer_id;
+    const int16_t result = canardRequestOrRespond(node->ins, destination_node_id, data_type_signature, data_type_id,
+                                                  inout_transfer_id, priority, kind, payload, payload_len);
+    if (result > 0)
+    {
+        trackTransfer(bus, node, data_type_id,
+                      (kind == CanardRequest) ? CanardTransferTypeRequest : CanardTransferTypeResponse, transfer_id);
+    }
+    return result;
+}
+
+CanardSimBusStatistics canardSimGetBusStatistics(const CanardSimBus* bus)
+{
+    return bus->stats;
+}
+
+float canardSimGetBusLoad(const CanardSimBus* bus)
+{
+    if (bus->stats.elapsed_nsec == 0U)
+    {
+        return 0.0F;
+    }
+    return (float)((double)bus->stats.busy_nsec / (double)bus->stats.elapsed_nsec);
+}
+
+CanardSimNodeStatistics canardSimGetNodeStatistics(const CanardSimNode* node)
+{
+    return node->stats;
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Distributed under the MIT License, available in the file LICENSE.
+ *
+ */
+
+#ifndef CANARD_SIM_H
+#define CANARD_SIM_H
+
+#include <canard.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Capacities of the simulated controllers. The defaults are those of the bxCAN of the STM32F103:
+ * three TX mailboxes and an RX FIFO of three frames.
+ */
+#if !defined(CANARD_SIM_MAX_TX_MAILBOXES)
+# define CANARD_SIM_MAX_TX_MAILBOXES                            3U
+#endif
+
+#if !defined(CANARD_SIM_MAX_RX_FIFO_DEPTH)
+# define CANARD_SIM_MAX_RX_FIFO_DEPTH                           3U
+#endif
+
+/**
+ * Number of transfers submitted through canardSimBroadcast() and canardSimRequestOrRespond() per node
+ * whose latency can be tracked at the same time.
+ */
+#if !defined(CANARD_SIM_MAX_PENDING_TRANSFERS)
+# define CANARD_SIM_MAX_PENDING_TRANSFERS                       16U
+#endif
+
+/**
+ * Bits that follow the CRC of every data frame, see CANARD_CAN_FRAME_TRAILER_BITS.
+ */
+#define CANARD_SIM_FRAME_TRAILER_BITS                           CANARD_CAN_FRAME_TRAILER_BITS
+
+/**
+ * Bits that an error takes on the bus after the bit where it was detected: error flag, error delimiter and
+ * intermission.
+ */
+#define CANARD_SIM_ERROR_FRAME_BITS                             17U
+
+/**
+ * Statistics of one simulated node.
+ */
+typedef struct
+{
+    uint32_t tx_frames;                 ///< Frames transmitted successfully
+    uint32_t tx_lost_arbitration;       ///< Times a mailbox frame took part in arbitration and lost
+    uint32_t tx_errors;                 ///< Frames of this node destroyed by an error and retransmitted
+    uint32_t rx_frames;                 ///< Frames stored into the RX FIFO
+    uint32_t rx_overruns;               ///< Frames lost because the RX FIFO was full
+    uint32_t untracked_transfers;       ///< Submitted transfers whose latency was not tracked, the table was full
+} CanardSimNodeStatistics;
+
+/**
+ * Latency statistics of the transfers submitted through canardSimBroadcast() and canardSimRequestOrRespond().
+ * The latency of a transfer runs from its submission to the end of its last frame on the bus.
+ */
+typedef struct
+{
+    uint32_t count;
+    uint64_t min_nsec;
+    uint64_t max_nsec;
+    uint64_t total_nsec;
+} CanardSimLatencyStatistics;
+
+/**
+ * Statistics of the bus.
+ */
+typedef struct
+{
+    uint64_t elapsed_nsec;              ///< Virtual time since the bus was initialized
+    uint64_t busy_nsec;                 ///< Time taken by frames and errors, intermissions included
+    uint32_t frames;                    ///< Frames transmitted successfully
+    uint32_t error_frames;              ///< Frames destroyed by an injected error
+    uint64_t frame_bits;                ///< Bits of the successful frames, stuff bits and intermissions included
+    CanardSimLatencyStatistics latency;
+} CanardSimBusStatistics;
+
+/**
+ * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
+ * A transfer submitted through the wrappers of the simulator, waiting for its last frame to leave the node.
+ */
+typedef struct
+{
+    uint64_t submitted_at_nsec;
+    uint16_t data_type_id;
+    uint8_t transfer_id;
+    uint8_t kind;                       ///< CanardTransferType
+    bool used;
+} CanardSimPendingTransfer;
+
+typedef struct CanardSimBus CanardSimBus;
+typedef struct CanardSimNode CanardSimNode;
+
+/**
+ * Called for every tracked transfer once its last frame has left the node, for custom latency statistics.
+ */
+typedef void (*CanardSimOnTransferSent)(CanardSimBus* bus,
+                                        CanardSimNode* node,
+                                        uint32_t can_id,
+                                        uint8_t transfer_id,
+                                        uint64_t latency_nsec);
+
+/**
+ * A node on the simulated bus: a library instance behind a CAN controller with TX mailboxes and an RX FIFO.
+ * The storage is provided by the application; all fields are internal, see canardSimAddNode().
+ */
+struct CanardSimNode
+{
+    CanardInstance* ins;
+    CanardSimNode* next;
+
+    uint64_t poll_interval_nsec;
+    uint64_t next_poll_nsec;
+
+    uint8_t num_mailboxes;
+    uint8_t rx_fifo_depth;
+    uint8_t rx_fifo_head;
+    uint8_t rx_fifo_count;
+    uint8_t mailbox_used_mask;
+
+    CanardCANFrame mailboxes[CANARD_SIM_MAX_TX_MAILBOXES];
+    CanardCANFrame rx_fifo[CANARD_SIM_MAX_RX_FIFO_DEPTH];
+    CanardSimPendingTransfer pending[CANARD_SIM_MAX_PENDING_TRANSFERS];
+
+    CanardSimNodeStatistics stats;
+};
+
+/**
+ * The simulated bus. The storage is provided by the application; all fields are internal.
+ */
+struct CanardSimBus
+{
+    CanardSimNode* nodes;
+    uint32_t bit_rate;
+    uint64_t now_nsec;
+
+    // Frame on the bus
+    CanardSimNode* transmitter;
+    uint8_t transmitter_mailbox;
+    bool transmission_fails;
+    uint32_t transmission_bits;
+    uint64_t transmission_started_nsec;
+    uint64_t busy_until_nsec;
+
+    // Error injection
+    uint32_t error_rate_ppm;
+    uint32_t random_state;
+    uint32_t forced_errors;
+
+    CanardSimOnTransferSent on_transfer_sent;
+    CanardSimBusStatistics stats;
+};
+
+/**
+ * Initializes an idle bus at virtual time zero. Any bit rate up to 1 Mbit/s is accepted.
+ * Returns 0 on success, negative on error.
+ */
+int16_t canardSimInit(CanardSimBus* out_bus,
+                      uint32_t bit_rate);
+
+/**
+ * Connects a node to the bus. The library instance must be initialized already; its node ID must be set for the
+ * transfers to be tracked. The node services its controller every poll_interval_usec: it feeds the frames of the RX
+ * FIFO to canardHandleRxFrame() and moves frames from the TX queue into the free mailboxes, as long as they outrank the
+ * pending ones, like the STM32 driver does.
+ * A poll interval of zero services the node after every event on the bus, like an interrupt handler would.
+ * Returns 0 on success, negative on error.
+ */
+int16_t canardSimAddNode(CanardSimBus* bus,
+                         CanardSimNode* out_node,
+                         CanardInstance* ins,
+                         uint8_t num_mailboxes,        ///< 1 to CANARD_SIM_MAX_TX_MAILBOXES
+                         uint8_t rx_fifo_depth,        ///< 1 to CANARD_SIM_MAX_RX_FIFO_DEPTH
+                         uint32_t poll_interval_usec);
+
+/**
+ * Destroys frames on the bus at random, with the given probability per frame in parts per million. The sequence of
+ * errors is determined by the seed. A destroyed frame is retransmitted by its node, as a real controller would.
+ */
+void canardSimSetErrorRate(CanardSimBus* bus,
+                           uint32_t error_rate_ppm,
+                           uint32_t seed);
+
+/**
+ * Destroys the next count frames that start on the bus.
+ */
+void canardSimInjectErrors(CanardSimBus* bus,
+                           uint32_t count);
+
+/**
+ * Sets the callback for the tracked transfers, may be NULL.
+ */
+void canardSimSetOnTransferSent(CanardSimBus* bus,
+                                CanardSimOnTransferSent callback);
+
+/**
+ * Advances the virtual time to the given instant, running the bus and the nodes in between. The transfers submitted
+ * by the application before the call are submitted at the current virtual time.
+ */
+void canardSimRunUntil(CanardSimBus* bus,
+                       uint64_t time_usec);
+
+/**
+ * Current virtual time, e.g. for the timestamps given to canardCleanupStaleTransfers().
+ */
+uint64_t canardSimGetTimeUsec(const CanardSimBus* bus);
+
+/**
+ * Same as canardBroadcast() on the instance of the node, but the latency of the transfer is tracked.
+ */
+int16_t canardSimBroadcast(CanardSimBus* bus,
+                           CanardSimNode* node,
+                           uint64_t data_type_signature,
+                           uint16_t data_type_id,
+                           uint8_t* inout_transfer_id,
+                           uint8_t priority,
+                           const void* payload,
+                           uint16_t payload_len);
+
+/**
+ * Same as canardRequestOrRespond() on the instance of the node, but the latency of the transfer is tracked.
+ */
+int16_t canardSimRequestOrRespond(CanardSimBus* bus,
+                                  CanardSimNode* node,
+                                  uint8_t destination_node_id,
+                                  uint64_t data_type_signature,
+                                  uint8_t data_type_id,
+                                  uint8_t* inout_transfer_id,
+                                  uint8_t priority,
+                                  CanardRequestResponse kind,
+                                  const void* payload,
+                                  uint16_t payload_len);
+
+/**
+ * Number of bits the frame takes on the bus, same as canardGetFrameBitLength().
+ */
+uint32_t canardSimGetFrameBitLength(const CanardCANFrame* frame);
+
+CanardSimBusStatistics canardSimGetBusStatistics(const CanardSimBus* bus);
+
+/**
+ * Fraction of the elapsed time the bus was busy, from 0 to 1.
+ */
+float canardSimGetBusLoad(const CanardSimBus* bus);
+
+CanardSimNodeStatistics canardSimGetNodeStatistics(const CanardSimNode* node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
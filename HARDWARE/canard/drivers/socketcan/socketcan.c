@@ -16,6 +16,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <linux/can.h>
 #include <errno.h>
 #include <stdlib.h>
@@ -42,6 +43,52 @@ static int16_t getErrorCode()
     }
 }
 
+/// Waits until the socket is ready for the given poll() event; returns 1 if ready, 0 on timeout, negative on error
+static int16_t waitForSocket(const SocketCANInstance* ins, short event, int32_t timeout_msec)
+{
+    struct pollfd fds;
+    memset(&fds, 0, sizeof(fds));
+    fds.fd = ins->fd;
+    fds.events |= event;
+
+    const int poll_result = poll(&fds, 1, timeout_msec);
+    if (poll_result < 0)
+    {
+        return getErrorCode();
+    }
+    if (poll_result == 0)
+    {
+        return 0;
+    }
+    if (((uint32_t)fds.revents & (uint32_t)event) == 0)
+    {
+        return -EIO;
+    }
+    return 1;
+}
+
+static void convertToSocketCAN(const CanardCANFrame* frame, struct can_frame* out_frame)
+{
+    memset(out_frame, 0, sizeof(*out_frame));
+    out_frame->can_id = frame->id;                      // TODO: Map flags properly
+    out_frame->can_dlc = frame->data_len;
+    memcpy(out_frame->data, frame->data, frame->data_len);
+}
+
+/// Returns false if the frame is malformed
+static bool convertFromSocketCAN(const struct can_frame* frame, CanardCANFrame* out_frame)
+{
+    if (frame->can_dlc > CAN_MAX_DLEN)                  // Appeasing Coverity Scan
+    {
+        return false;
+    }
+
+    out_frame->id = frame->can_id;                      // TODO: Map flags properly
+    out_frame->data_len = frame->can_dlc;
+    memcpy(out_frame->data, &frame->data, frame->can_dlc);
+    return true;
+}
+
 int16_t socketcanInit(SocketCANInstance* out_ins, const char* can_iface_name)
 {
     const size_t iface_name_size = strlen(can_iface_name) + 1;
@@ -95,30 +142,15 @@ int16_t socketcanClose(SocketCANInstance* ins)
 
 int16_t socketcanTransmit(SocketCANInstance* ins, const CanardCANFrame* frame, int32_t timeout_msec)
 {
-    struct pollfd fds;
-    memset(&fds, 0, sizeof(fds));
-    fds.fd = ins->fd;
-    fds.events |= POLLOUT;
-
-    const int poll_result = poll(&fds, 1, timeout_msec);
-    if (poll_result < 0)
-    {
-        return getErrorCode();
-    }
-    if (poll_result == 0)
+    const int16_t wait_result = waitForSocket(ins, POLLOUT, timeout_msec);
+    if (wait_result <= 0)
     {
-        return 0;
-    }
-    if (((uint32_t)fds.revents & (uint32_t)POLLOUT) == 0)
-    {
-        return -EIO;
+        return wait_result;
     }
+    CANARD_PROF_BEGIN(CanardProfSiteDriverTransmit);   // The wait for the socket is left out
 
     struct can_frame transmit_frame;
-    memset(&transmit_frame, 0, sizeof(transmit_frame));
-    transmit_frame.can_id = frame->id;                  // TODO: Map flags properly
-    transmit_frame.can_dlc = frame->data_len;
-    memcpy(transmit_frame.data, frame->data, frame->data_len);
+    convertToSocketCAN(frame, &transmit_frame);
 
     const ssize_t nbytes = write(ins->fd, &transmit_frame, sizeof(transmit_frame));
     if (nbytes < 0)
@@ -129,30 +161,22 @@ int16_t socketcanTransmit(SocketCANInstance* ins, const CanardCANFrame* frame, i
     {
         return -EIO;
     }
+#if CANARD_ENABLE_TRACE
+    canardTraceRecord(CanardTraceEventTxMailbox, 0, frame);   // The socket buffer stands for the mailboxes
+#endif
+    CANARD_PROF_END(CanardProfSiteDriverTransmit);
 
     return 1;
 }
 
 int16_t socketcanReceive(SocketCANInstance* ins, CanardCANFrame* out_frame, int32_t timeout_msec)
 {
-    struct pollfd fds;
-    memset(&fds, 0, sizeof(fds));
-    fds.fd = ins->fd;
-    fds.events |= POLLIN;
-
-    const int poll_result = poll(&fds, 1, timeout_msec);
-    if (poll_result < 0)
+    const int16_t wait_result = waitForSocket(ins, POLLIN, timeout_msec);
+    if (wait_result <= 0)
     {
-        return getErrorCode();
-    }
-    if (poll_result == 0)
-    {
-        return 0;
-    }
-    if (((uint32_t)fds.revents & (uint32_t)POLLIN) == 0)
-    {
-        return -EIO;
+        return wait_result;
     }
+    CANARD_PROF_BEGIN(CanardProfSiteDriverReceive);
 
     struct can_frame receive_frame;
     const ssize_t nbytes = read(ins->fd, &receive_frame, sizeof(receive_frame));
@@ -165,18 +189,120 @@ int16_t socketcanReceive(SocketCANInstance* ins, CanardCANFrame* out_frame, int3
         return -EIO;
     }
 
-    if (receive_frame.can_dlc > CAN_MAX_DLEN)           // Appeasing Coverity Scan
+    if (!convertFromSocketCAN(&receive_frame, out_frame))
     {
         return -EIO;
     }
-
-    out_frame->id = receive_frame.can_id;               // TODO: Map flags properly
-    out_frame->data_len = receive_frame.can_dlc;
-    memcpy(out_frame->data, &receive_frame.data, receive_frame.can_dlc);
+    CANARD_PROF_END(CanardProfSiteDriverReceive);
 
     return 1;
 }
 
+int16_t socketcanTransmitBatch(SocketCANInstance* ins,
+                               const CanardCANFrame* frames,
+                               uint16_t num_frames,
+                               int32_t timeout_msec)
+{
+    if (num_frames > SOCKETCAN_BATCH_MAX_FRAMES)
+    {
+        num_frames = SOCKETCAN_BATCH_MAX_FRAMES;
+    }
+    if (num_frames == 0)
+    {
+        return 0;
+    }
+
+    const int16_t wait_result = waitForSocket(ins, POLLOUT, timeout_msec);
+    if (wait_result <= 0)
+    {
+        return wait_result;
+    }
+    CANARD_PROF_BEGIN(CanardProfSiteDriverTransmit);
+
+    struct can_frame transmit_frames[SOCKETCAN_BATCH_MAX_FRAMES];
+    struct iovec iovs[SOCKETCAN_BATCH_MAX_FRAMES];
+    struct mmsghdr msgs[SOCKETCAN_BATCH_MAX_FRAMES];
+    memset(msgs, 0, sizeof(msgs[0]) * num_frames);
+    for (uint16_t i = 0; i < num_frames; i++)
+    {
+        convertToSocketCAN(&frames[i], &transmit_frames[i]);
+        iovs[i].iov_base = &transmit_frames[i];
+        iovs[i].iov_len = sizeof(transmit_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // The socket is non-blocking, so a full socket buffer ends the batch early
+    const int num_sent = sendmmsg(ins->fd, msgs, num_frames, 0);
+    if (num_sent < 0)
+    {
+        return ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? 0 : getErrorCode();
+    }
+#if CANARD_ENABLE_TRACE
+    for (int i = 0; i < num_sent; i++)
+    {
+        canardTraceRecord(CanardTraceEventTxMailbox, 0, &frames[i]);
+    }
+#endif
+    CANARD_PROF_END(CanardProfSiteDriverTransmit);
+
+    return (int16_t)num_sent;
+}
+
+int16_t socketcanReceiveBatch(SocketCANInstance* ins,
+                              CanardCANFrame* out_frames,
+                              uint16_t max_frames,
+                              int32_t timeout_msec)
+{
+    if (max_frames > SOCKETCAN_BATCH_MAX_FRAMES)
+    {
+        max_frames = SOCKETCAN_BATCH_MAX_FRAMES;
+    }
+    if (max_frames == 0)
+    {
+        return 0;
+    }
+
+    const int16_t wait_result = waitForSocket(ins, POLLIN, timeout_msec);
+    if (wait_result <= 0)
+    {
+        return wait_result;
+    }
+    CANARD_PROF_BEGIN(CanardProfSiteDriverReceive);
+
+    struct can_frame receive_frames[SOCKETCAN_BATCH_MAX_FRAMES];
+    struct iovec iovs[SOCKETCAN_BATCH_MAX_FRAMES];
+    struct mmsghdr msgs[SOCKETCAN_BATCH_MAX_FRAMES];
+    memset(msgs, 0, sizeof(msgs[0]) * max_frames);
+    for (uint16_t i = 0; i < max_frames; i++)
+    {
+        iovs[i].iov_base = &receive_frames[i];
+        iovs[i].iov_len = sizeof(receive_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Takes whatever is queued, up to the batch size, without waiting for the rest of the batch
+    const int num_received = recvmmsg(ins->fd, msgs, max_frames, MSG_DONTWAIT, NULL);
+    if (num_received < 0)
+    {
+        return ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? 0 : getErrorCode();
+    }
+
+    int16_t num_valid = 0;
+    for (int i = 0; i < num_received; i++)
+    {
+        if ((msgs[i].msg_len == sizeof(receive_frames[i])) &&
+            convertFromSocketCAN(&receive_frames[i], &out_frames[num_valid]))
+        {
+            num_valid++;
+        }
+    }
+    CANARD_PROF_END(CanardProfSiteDriverReceive);
+
+    return num_valid;
+}
+
 int socketcanGetSocketFileDescriptor(const SocketCANInstance* ins)
 {
     return ins->fd;
@@ -15,6 +15,14 @@ extern "C"
 {
 #endif
 
+/**
+ * Largest number of frames moved by one call of socketcanTransmitBatch() or socketcanReceiveBatch().
+ * The buffers of a batch are on the stack, about 100 bytes per frame.
+ */
+#ifndef SOCKETCAN_BATCH_MAX_FRAMES
+# define SOCKETCAN_BATCH_MAX_FRAMES     64U
+#endif
+
 typedef struct
 {
     int fd;
@@ -46,6 +54,29 @@ int16_t socketcanTransmit(SocketCANInstance* ins, const CanardCANFrame* frame, i
  */
 int16_t socketcanReceive(SocketCANInstance* ins, CanardCANFrame* out_frame, int32_t timeout_msec);
 
+/**
+ * Transmits up to num_frames CanardCANFrames, in order, with one sendmmsg() call once the socket is writable.
+ * At most SOCKETCAN_BATCH_MAX_FRAMES frames are transmitted per call.
+ * Use negative timeout to block infinitely.
+ * Returns the number of frames transmitted, which is less than requested if the socket buffer is full,
+ * 0 on timeout, negative on error.
+ */
+int16_t socketcanTransmitBatch(SocketCANInstance* ins,
+                               const CanardCANFrame* frames,
+                               uint16_t num_frames,
+                               int32_t timeout_msec);
+
+/**
+ * Receives up to max_frames CanardCANFrames with one recvmmsg() call once the socket is readable.
+ * At most SOCKETCAN_BATCH_MAX_FRAMES frames are received per call; malformed frames are dropped.
+ * Use negative timeout to block infinitely.
+ * Returns the number of frames received, 0 on timeout, negative on error.
+ */
+int16_t socketcanReceiveBatch(SocketCANInstance* ins,
+                              CanardCANFrame* out_frames,
+                              uint16_t max_frames,
+                              int32_t timeout_msec);
+
 /**
  * Returns the file descriptor of the CAN socket.
  * Can be used for external IO multiplexing.
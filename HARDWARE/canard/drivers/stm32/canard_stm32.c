@@ -26,6 +26,11 @@ static CanardSTM32Stats g_stats;
 
 static bool g_abort_tx_on_error = false;
 
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+static uint32_t g_tx_loaded_at[3];                      ///< CANARD_LATENCY_TIMESTAMP() of the mailbox loads
+static uint8_t g_tx_pending_mask;                       ///< Mailboxes whose completion has not been seen yet
+#endif
+
 
 static bool isFramePriorityHigher(uint32_t a, uint32_t b)
 {
@@ -179,6 +184,47 @@ static void processErrorStatus(void)
 }
 
 
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+static void processTxCompletion(void)
+{
+    /*
+     * Records the latency of the frames that have left their mailboxes since the previous call. The completion is
+     * seen when this function is polled, so the samples include up to one polling period.
+     * Aborted frames are not recorded. RQCP is also cleared by the hardware when a mailbox is loaded again.
+     * 记录自上次调用以来发送完成的帧的延迟；被中止的帧不记录。
+     */
+    static const uint32_t RQCP[3] =
+    {
+        CANARD_STM32_CAN_TSR_RQCP0, CANARD_STM32_CAN_TSR_RQCP1, CANARD_STM32_CAN_TSR_RQCP2
+    };
+    static const uint32_t TXOK[3] =
+    {
+        CANARD_STM32_CAN_TSR_TXOK0, CANARD_STM32_CAN_TSR_TXOK1, CANARD_STM32_CAN_TSR_TXOK2
+    };
+
+    if (g_tx_pending_mask == 0)
+    {
+        return;
+    }
+
+    const uint32_t now = CANARD_LATENCY_TIMESTAMP();
+    const uint32_t tsr = BXCAN->TSR;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        if (((g_tx_pending_mask & (1U << i)) != 0) && ((tsr & RQCP[i]) != 0))
+        {
+            g_tx_pending_mask &= (uint8_t) ~(1U << i);
+            BXCAN->TSR = RQCP[i];                       // Also clears TXOK, ALST and TERR of this mailbox
+            if ((tsr & TXOK[i]) != 0)
+            {
+                canardLatencyRecord(CanardLatencyPathTxComplete, now - g_tx_loaded_at[i]);
+            }
+        }
+    }
+}
+#endif
+
+
 int16_t canardSTM32Init(const CanardSTM32CANTimings* const timings,
                         const CanardSTM32IfaceMode iface_mode)
 {
@@ -207,6 +253,9 @@ int16_t canardSTM32Init(const CanardSTM32CANTimings* const timings,
      * 初始化设定
      */
     memset(&g_stats, 0, sizeof(g_stats));
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+    g_tx_pending_mask = 0;
+#endif
 
     g_abort_tx_on_error = (iface_mode == CanardSTM32IfaceModeAutomaticTxAbortOnError);
 
@@ -311,12 +360,16 @@ int16_t canardSTM32Transmit(const CanardCANFrame* const frame)
     {
         return -CANARD_STM32_ERROR_UNSUPPORTED_FRAME_FORMAT;
     }
+    CANARD_PROF_BEGIN(CanardProfSiteDriverTransmit);
 
     /*
      * Handling error status might free up some slots through aborts
      * 处理错误状态可能会通过中止释放一些插槽
      */
     processErrorStatus();
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+    processTxCompletion();
+#endif
 
     /*
      * Seeking an empty slot, checking if priority inversion would occur if we enqueued now.
@@ -347,6 +400,7 @@ int16_t canardSTM32Transmit(const CanardCANFrame* const frame)
                 if (!isFramePriorityHigher(frame->id, convertFrameIDRegisterToCanard(BXCAN->TxMailbox[i].TIR)))
                 {
                     // There's a mailbox whose priority is higher or equal the priority of the new frame.有一个邮箱的优先级高于或等于新框架的优先级。
+                    CANARD_PROF_END(CanardProfSiteDriverTransmit);
                     return 0;                           // Priority inversion would occur! Reject transmission.优先级反转！ 拒绝传输。
                 }
             }
@@ -380,6 +434,7 @@ int16_t canardSTM32Transmit(const CanardCANFrame* const frame)
 #if CANARD_STM32_DEBUG_INNER_PRIORITY_INVERSION
             CANARD_ASSERT(!"CAN PRIO INV");
 #endif
+            CANARD_PROF_END(CanardProfSiteDriverTransmit);
             return 0;
         }
     }
@@ -411,10 +466,18 @@ int16_t canardSTM32Transmit(const CanardCANFrame* const frame)
                (((uint32_t)frame->data[0]) <<  0U);
 
     mb->TIR = convertFrameIDCanardToRegister(frame->id) | CANARD_STM32_CAN_TIR_TXRQ;    // Go.
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+    g_tx_loaded_at[tx_mailbox] = CANARD_LATENCY_TIMESTAMP();
+    g_tx_pending_mask |= (uint8_t)(1U << tx_mailbox);
+#endif
+#if CANARD_ENABLE_TRACE
+    canardTraceRecord(CanardTraceEventTxMailbox, tx_mailbox, frame);
+#endif
 	//printf("%x,    ID == %x\r\n", mb->TIR, frame->id);
     /*
      * The frame is now enqueued and pending transmission.
      */
+    CANARD_PROF_END(CanardProfSiteDriverTransmit);
     return 1;
 }
 
@@ -425,6 +488,7 @@ int16_t canardSTM32Receive(CanardCANFrame* const out_frame)
     {
         return -CANARD_ERROR_INVALID_ARGUMENT;
     }
+    CANARD_PROF_BEGIN(CanardProfSiteDriverReceive);
 
     static volatile uint32_t* const RFxR[2] =
     {
@@ -436,6 +500,9 @@ int16_t canardSTM32Receive(CanardCANFrame* const out_frame)
      * This function must be polled periodically, so we use this opportunity to do it.
      */
     processErrorStatus();
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+    processTxCompletion();
+#endif
 
     /*
      * Reading the TX FIFO
@@ -468,15 +535,24 @@ int16_t canardSTM32Receive(CanardCANFrame* const out_frame)
             out_frame->data[6] = (uint8_t)(0xFFU & (rdhr >> 16U));
             out_frame->data[7] = (uint8_t)(0xFFU & (rdhr >> 24U));
 
+#if CANARD_ENABLE_TRACE
+            if (*RFxR[i] & CANARD_STM32_CAN_RFR_FOVR)
+            {
+                canardTraceRecord(CanardTraceEventDrop, CanardTraceDropRxOverrun, out_frame);
+            }
+#endif
+
             // Release FIFO entry we just read
             *RFxR[i] = CANARD_STM32_CAN_RFR_RFOM | CANARD_STM32_CAN_RFR_FOVR | CANARD_STM32_CAN_RFR_FULL;
 
             // Reading successful
+            CANARD_PROF_END(CanardProfSiteDriverReceive);
             return 1;
         }
     }
 
     // No frames to read
+    CANARD_PROF_END(CanardProfSiteDriverReceive);
     return 0;
 }
 
@@ -18,6 +18,8 @@ It is based on the DSDL parsing package from pyuavcan.
 from __future__ import division, absolute_import, print_function, unicode_literals
 import sys, os, logging, errno, re
 from .pyratemp import Template
+from . import harness
+from . import prebuilt
 from uavcan import dsdl
 
 # Python 2.7 compatibility
@@ -31,6 +33,9 @@ OUTPUT_CODE_FILE_EXTENSION = 'c'
 OUTPUT_FILE_PERMISSIONS = 0o444  # Read only for all
 HEADER_TEMPLATE_FILENAME = os.path.join(os.path.dirname(__file__), 'data_type_template.tmpl')
 CODE_TEMPLATE_FILENAME = os.path.join(os.path.dirname(__file__), 'code_type_template.tmpl')
+CPP_OUTPUT_FILE_EXTENSION = 'hpp'
+CPP_TEMPLATE_FILENAME = os.path.join(os.path.dirname(__file__), 'cpp_type_template.tmpl')
+CPP_SUPPORT_HEADER_FILENAME = os.path.join(os.path.dirname(__file__), 'canard_dsdl.hpp')
 
 __all__ = ['run', 'logger', 'DsdlCompilerException']
 
@@ -39,7 +44,7 @@ class DsdlCompilerException(Exception):
 
 logger = logging.getLogger(__name__)
 
-def run(source_dirs, include_dirs, output_dir, header_only):
+def run(source_dirs, include_dirs, output_dir, header_only, cpp=False, harness=False, prebuild=None):
     '''
     This function takes a list of root namespace directories (containing DSDL definition files to parse), a
     possibly empty list of search directories (containing DSDL definition files that can be referenced from the types
@@ -56,6 +61,9 @@ def run(source_dirs, include_dirs, output_dir, header_only):
                        automaitcally extended with source_dirs.
         output_dir     Output directory path. Will be created if doesn't exist.
         header_only    Weather to generated as header only library.
+        cpp            Generate C++17 headers instead of C code; header_only is ignored then.
+        harness        Also generate the benchmark and round-trip harness of the C code (see harness.py).
+        prebuild       List of JSON files declaring constant transfers to compile into CAN frames (see prebuilt.py).
     '''
     assert isinstance(source_dirs, list)
     assert isinstance(include_dirs, list)
@@ -66,7 +74,16 @@ def run(source_dirs, include_dirs, output_dir, header_only):
         die('No type definitions were found')
 
     logger.info('%d types total', len(types))
-    run_generator(types, output_dir, header_only)
+    if cpp:
+        if harness:
+            die('The harness is generated for the C code only')
+        run_cpp_generator(types, output_dir)
+    else:
+        run_generator(types, output_dir, header_only)
+        if harness:
+            run_harness_generator(types, output_dir, header_only)
+    for spec in prebuild or []:
+        run_prebuild_generator(spec, types, output_dir, header_only and not cpp)
 
 # -----------------
 
@@ -139,6 +156,43 @@ def run_generator(types, dest_dir, header_only):
         logger.info('Generator failure', exc_info=True)
         die(ex)
 
+def run_cpp_generator(types, dest_dir):
+    try:
+        template_expander = make_template_expander(CPP_TEMPLATE_FILENAME)
+        dest_dir = os.path.abspath(dest_dir)  # Removing '..'
+        makedirs(dest_dir)
+        with open(CPP_SUPPORT_HEADER_FILENAME) as f:
+            write_generated_data(os.path.join(dest_dir, os.path.basename(CPP_SUPPORT_HEADER_FILENAME)), f.read(), False)
+        for t in types:
+            logger.info('Generating type %s', t.full_name)
+            filename = os.path.join(dest_dir, type_output_filename(t, CPP_OUTPUT_FILE_EXTENSION))
+            write_generated_data(filename, generate_one_cpp_type(template_expander, t), False)
+    except Exception as ex:
+        logger.info('Generator failure', exc_info=True)
+        die(ex)
+
+def run_harness_generator(types, dest_dir, header_only):
+    try:
+        dest_dir = os.path.abspath(dest_dir)
+        logger.info('Generating the harness')
+        write_generated_data(os.path.join(dest_dir, harness.HARNESS_SOURCE_FILENAME),
+                             harness.harness_source(types, type_output_filename), False)
+        write_generated_data(os.path.join(dest_dir, harness.HARNESS_CMAKE_FILENAME),
+                             harness.harness_cmake(header_only), False)
+    except Exception as ex:
+        logger.info('Generator failure', exc_info=True)
+        die(ex)
+
+def run_prebuild_generator(spec_filename, types, dest_dir, header_only):
+    try:
+        dest_dir = os.path.abspath(dest_dir)
+        logger.info('Generating the prebuilt transfers of %s', pretty_filename(spec_filename))
+        for filename, text in prebuilt.prebuild(spec_filename, types, header_only).items():
+            write_generated_data(os.path.join(dest_dir, filename), text, False)
+    except Exception as ex:
+        logger.info('Generator failure', exc_info=True)
+        die(ex)
+
 def write_generated_data(filename, data, header_only, append_file=False):
     dirname = os.path.dirname(filename)
     makedirs(dirname)
@@ -199,7 +253,9 @@ def type_to_c_type(t):
                     'bitlen':t.bitlen,
                     'max_size':get_max_size(t.bitlen, False),
                     'signedness':'false',
-                    'saturate':False} # do not saturate floats
+                    'saturate':False, # do not saturate floats
+                    'float16':t.bitlen == 16,
+                    'read_expr':'canardInternalReadFloat%d(reader, %%s)' % (t.bitlen, )}
         else:
             c_type = {
                 t.KIND_BOOLEAN: 'bool',
@@ -219,19 +275,25 @@ def type_to_c_type(t):
                     'bitlen':t.bitlen,
                     'max_size':get_max_size(t.bitlen, False),
                     'signedness':signedness,
-                    'saturate':saturate}
+                    'saturate':saturate,
+                    'float16':False,
+                    'read_expr':'(canardInternalReadScalar(reader, %s, 1) != 0)'}
             else:
                 if saturate:
                     # Do not staturate if struct field length is equal bitlen
                     if (expand_to_next_full(t.bitlen) == t.bitlen):
                         saturate = False
-                return {'cpp_type':'%s%d_t' % (c_type, expand_to_next_full(t.bitlen)),
+                c_type = '%s%d_t' % (c_type, expand_to_next_full(t.bitlen))
+                read = 'canardInternalReadSigned' if t.kind == t.KIND_SIGNED_INT else 'canardInternalReadScalar'
+                return {'cpp_type':c_type,
                     'post_cpp_type':'',
                     'cpp_type_comment':'bit len %d' % (t.bitlen, ),
                     'bitlen':t.bitlen,
                     'max_size':get_max_size(t.bitlen, t.kind == t.KIND_UNSIGNED_INT),
                     'signedness':signedness,
-                    'saturate':saturate}
+                    'saturate':saturate,
+                    'float16':False,
+                    'read_expr':'(%s)%s(reader, %%s, %d)' % (c_type, read, t.bitlen)}
 
     elif t.category == t.CATEGORY_ARRAY:
         values = type_to_c_type(t.value_type)
@@ -250,6 +312,9 @@ def type_to_c_type(t):
             'saturate':values['saturate'],
             'dynamic_array': t.mode == t.MODE_DYNAMIC,
             'max_array_elements': t.max_size,
+            'float16':values['float16'],
+            'read_expr':values.get('read_expr'),
+            'fixed_item_size':values.get('fixed_size', True),
             }
     elif t.category == t.CATEGORY_COMPOUND:
         return {
@@ -259,7 +324,9 @@ def type_to_c_type(t):
             'bitlen':t.get_max_bitlen(),
             'max_size':0,
             'signedness':'false',
-            'saturate':False}
+            'saturate':False,
+            'float16':False,
+            'fixed_size':t.get_max_bitlen() == t.get_min_bitlen()}
     elif t.category == t.CATEGORY_VOID:
         return {'cpp_type':'',
             'post_cpp_type':'',
@@ -267,7 +334,8 @@ def type_to_c_type(t):
             'bitlen':t.bitlen,
             'max_size':0,
             'signedness':'false',
-            'saturate':False}
+            'saturate':False,
+            'float16':False}
     else:
         raise DsdlCompilerException('Unknown type category: %s' % t.category)
 
@@ -323,7 +391,7 @@ def generate_one_type(template_expander, t):
     def has_float16(attributes):
         has_float16 = False
         for a in attributes:
-            if a.type.category == t.CATEGORY_PRIMITIVE and a.type.kind == a.type.KIND_FLOAT and a.bitlen == 16:
+            if a.float16:   # Scalars and arrays
                 has_float16 = True
         return has_float16
 
@@ -368,6 +436,17 @@ def generate_one_type(template_expander, t):
         inject_constant_info(t.request_constants)
         inject_constant_info(t.response_constants)
 
+    # Views and encoded sizes
+    if t.kind == t.KIND_MESSAGE:
+        t.view = CViewSection(t.name_space_type_name, t.fields, t.union)
+        t.size = CEncodedSizeSection(t.name_space_type_name, t.fields, t.union)
+    else:
+        t.request_size = CEncodedSizeSection(t.name_space_type_name + 'Request', t.request_fields, t.request_union)
+        t.response_size = CEncodedSizeSection(t.name_space_type_name + 'Response', t.response_fields,
+                                              t.response_union)
+        t.request_view = CViewSection(t.name_space_type_name + 'Request', t.request_fields, t.request_union)
+        t.response_view = CViewSection(t.name_space_type_name + 'Response', t.response_fields, t.response_union)
+
     # Data type kind
     t.cpp_kind = {
         t.KIND_MESSAGE: '::uavcan::DataTypeKindMessage',
@@ -381,6 +460,454 @@ def generate_one_type(template_expander, t):
     text = text.replace('{\n\n ', '{\n ')
     return text
 
+# -----------------
+# C views
+#
+# A view reads single fields of a received item without decoding the rest of it. The offset of a field is a constant
+# relative to the beginning of the item, or to the end of the preceding variable-length field; the ends of the
+# variable-length fields are found on demand, in order, and are cached in the view (see <type>_view_resolve()).
+
+class CViewSection(object):
+    '''
+    Views of a message, or of a request or response of a service, for the C backend.
+    Every function is a (return type, name, parameters, body lines) tuple.
+    '''
+    def __init__(self, type_name, fields, union):
+        self.type_name = type_name
+        self.view_name = type_name + '_view'
+        self.union = union
+        self.num_ends = 0
+        self.functions = []
+        self._resolve_cases = []
+
+        self._add('void', 'init', '%s* view, CanardRxPayloadReader* reader, uint32_t offset, uint8_t tao' %
+                  self.view_name,
+                  ['view->reader = reader;',
+                   'view->offset = offset;',
+                   'view->tao = tao;'])
+
+        if union:
+            at = 'view->offset + %dU' % union
+            self._add(type_name + '_ENUM', 'get_union_tag', '%s* view' % self.view_name,
+                      ['return (%s_ENUM)canardInternalReadScalar(view->reader, view->offset, %d);' %
+                       (type_name, union)])
+            end = ['uint32_t end = %s;' % at, 'switch (%s_view_get_union_tag(view))' % type_name, '{']
+            for index, f in enumerate(fields):
+                self._getters(f, at)
+                end.append('case %d:' % index)
+                end.append('{')
+                end += ['    ' + x for x in self._end(f, at)]
+                end.append('    break;')
+                end.append('}')
+            end += ['default:', '{', '    break;', '}', '}', 'return end;']
+            self._add_end(end)
+        else:
+            anchor, rel = None, 0
+            for f in fields:
+                at = self._position(anchor, rel)
+                if f.type.category != f.type.CATEGORY_VOID:
+                    self._getters(f, at)
+                if cpp_is_fixed(f.type):
+                    rel += f.type.get_max_bitlen()
+                else:
+                    self._resolve_cases.append(['const uint32_t at = start + %dU;' % rel] +
+                                               self._end(f, 'at'))
+                    anchor, rel = self.num_ends, 0
+                    self.num_ends += 1
+            self._add_end(['return %s;' % self._position(anchor, rel)])
+
+        if self.num_ends:
+            self.functions[0][3].append('view->num_resolved = 0;')
+            body = ['while (view->num_resolved <= index)',
+                    '{',
+                    '    const uint32_t start = (view->num_resolved == 0U) ? view->offset :',
+                    '                           view->ends[view->num_resolved - 1U];',
+                    '    uint32_t end = start;',
+                    '    switch (view->num_resolved)',
+                    '    {']
+            for index, case in enumerate(self._resolve_cases):
+                body += ['    case %d:' % index, '    {'] + ['        ' + x for x in case] + ['        break;', '    }']
+            body += ['    default:',
+                     '    {',
+                     '        break;',
+                     '    }',
+                     '    }',
+                     '    view->ends[view->num_resolved++] = end;',
+                     '}',
+                     'return view->ends[index];']
+            self.functions.insert(1, ('uint32_t', self.view_name + '_resolve',
+                                      '%s* view, uint8_t index' % self.view_name, body))
+
+    def _add(self, ret, name, params, body):
+        self.functions.append((ret, '%s_%s' % (self.view_name, name), params, body))
+
+    def _add_end(self, body):
+        self._add('uint32_t', 'end', '%s* view' % self.view_name, body)
+
+    def _position(self, anchor, rel):
+        base = 'view->offset' if anchor is None else '%s_resolve(view, %d)' % (self.view_name, anchor)
+        return base if rel == 0 else '%s + %dU' % (base, rel)
+
+    @staticmethod
+    def _tao_array(f):
+        return f.type.mode == f.type.MODE_DYNAMIC and f.last_item and f.bitlen > 7
+
+    def _items(self, f, at):
+        '''The offset of the first item of an array field'''
+        if f.type.mode == f.type.MODE_STATIC:
+            return at
+        if self._tao_array(f):
+            return '%s + ((view->tao == CANARD_INTERNAL_ENABLE_TAO) ? 0U : %dU)' % (at, f.array_max_size_bit_len)
+        return '%s + %dU' % (at, f.array_max_size_bit_len)
+
+    @staticmethod
+    def _walk(item_view, count, start, declare=False):
+        '''Statements that step over count variable-length items; the end is left in "end"'''
+        return [('uint32_t end = %s;' if declare else 'end = %s;') % start,
+                'for (uint32_t i = 0; i < %s; i++)' % count,
+                '{',
+                '    %s item;' % item_view,
+                '    %s_init(&item, view->reader, end, CANARD_INTERNAL_DISABLE_TAO);' % item_view,
+                '    end = %s_end(&item);' % item_view,
+                '}']
+
+    def _end(self, f, at):
+        '''Statements that leave the end of the field at the given offset in "end", which is declared by the caller'''
+        t = f.type
+        if cpp_is_fixed(t):
+            return ['end = %s + %dU;' % (at, t.get_max_bitlen())]
+        if t.category == t.CATEGORY_COMPOUND:
+            item_view = f.cpp_type + '_view'
+            return ['%s item;' % item_view,
+                    '%s_init(&item, view->reader, %s, CANARD_INTERNAL_DISABLE_TAO);' % (item_view, at),
+                    'end = %s_end(&item);' % item_view]
+        count = '%dU' % t.max_size if t.mode == t.MODE_STATIC else \
+                '%s_get_%s_len(view)' % (self.view_name, f.name)
+        if cpp_is_fixed(t.value_type):
+            return ['end = %s + (uint32_t)%s * %dU;' % (self._items(f, at), count, f.bitlen)]
+        return self._walk(f.cpp_type + '_view', count, self._items(f, at))
+
+    def _getters(self, f, at):
+        t = f.type
+        view = '%s* view' % self.view_name
+        if t.category == t.CATEGORY_PRIMITIVE:
+            self._add(f.cpp_type, 'get_' + f.name, view,
+                      ['CanardRxPayloadReader* const reader = view->reader;',
+                       'return %s;' % (f.read_expr % at)])
+            return
+        if t.category == t.CATEGORY_COMPOUND:
+            self._add('void', 'get_' + f.name, '%s, %s_view* out' % (view, f.cpp_type),
+                      ['%s_view_init(out, view->reader, %s, CANARD_INTERNAL_DISABLE_TAO);' % (f.cpp_type, at)])
+            return
+
+        if t.mode == t.MODE_DYNAMIC:
+            self._add('uint16_t', 'get_%s_len' % f.name, view, self._len(f, at))
+
+        items = self._items(f, at)
+        if t.value_type.category == t.CATEGORY_PRIMITIVE:
+            self._add(f.cpp_type, 'get_' + f.name, '%s, uint16_t index' % view,
+                      ['CanardRxPayloadReader* const reader = view->reader;',
+                       'return %s;' % (f.read_expr % ('%s + (uint32_t)index * %dU' % (items, f.bitlen)))])
+        elif cpp_is_fixed(t.value_type):
+            self._add('void', 'get_' + f.name, '%s, uint16_t index, %s_view* out' % (view, f.cpp_type),
+                      ['%s_view_init(out, view->reader, %s + (uint32_t)index * %dU, CANARD_INTERNAL_DISABLE_TAO);' %
+                       (f.cpp_type, items, f.bitlen)])
+        else:
+            self._add('void', 'get_' + f.name, '%s, uint16_t index, %s_view* out' % (view, f.cpp_type),
+                      self._walk(f.cpp_type + '_view', 'index', items, declare=True) +
+                      ['%s_view_init(out, view->reader, end, CANARD_INTERNAL_DISABLE_TAO);' % f.cpp_type])
+
+    def _len(self, f, at):
+        '''Length of a dynamic array; like the decoders, the length is limited to the capacity'''
+        read = ['const uint32_t len = (uint32_t)canardInternalReadScalar(view->reader, %s, %d);' %
+                (at, f.array_max_size_bit_len),
+                'return (uint16_t)((len > %dU) ? %dU : len);' % (f.type.max_size, f.type.max_size)]
+        if not self._tao_array(f):
+            return read
+        lines = ['if (view->tao == CANARD_INTERNAL_ENABLE_TAO)',
+                 '{',
+                 '    // Tail array optimization: the items take the rest of the payload',
+                 '    const uint32_t payload_bits = (uint32_t)view->reader->transfer->payload_len * 8U;']
+        if cpp_is_fixed(f.type.value_type):
+            lines += ['    const uint32_t at = %s;' % at,
+                      '    const uint32_t len = (at < payload_bits) ? ((payload_bits - at) / %dU) : 0U;' % f.bitlen,
+                      '    return (uint16_t)((len > %dU) ? %dU : len);' % (f.type.max_size, f.type.max_size)]
+        else:
+            item_view = f.cpp_type + '_view'
+            lines += ['    uint32_t end = %s;' % at,
+                      '    uint16_t len = 0;',
+                      '    while ((len < %dU) && ((end + 8U) <= payload_bits))' % f.type.max_size,
+                      '    {',
+                      '        %s item;' % item_view,
+                      '        %s_init(&item, view->reader, end, CANARD_INTERNAL_DISABLE_TAO);' % item_view,
+                      '        end = %s_end(&item);' % item_view,
+                      '        len++;',
+                      '    }',
+                      '    return len;']
+        return lines + ['}'] + read
+
+# -----------------
+# C encoded size
+#
+# The exact length of a populated item, as <type>_encode() would produce it. Fields of constant length are summed up at
+# generation time, so the generated code only adds the union branch, the array lengths and the variable-length
+# nested items; the tail array optimization is applied exactly like the encoders do.
+
+class CEncodedSizeSection(object):
+    '''
+    Encoded size functions of a message, or of a request or response of a service, for the C backend.
+    Every function is a (return type, name, parameters, body lines) tuple, like in CViewSection.
+    '''
+    def __init__(self, type_name, fields, union):
+        const_source = 'const %s* source' % type_name
+        if union:
+            body = ['uint32_t bits = %dU;' % union,
+                    'switch (source->union_tag)',
+                    '{']
+            for index, f in enumerate(fields):
+                constant, lines = self._field(f)
+                body += ['case %d:' % index, '{']
+                body += ['    ' + x for x in (['bits += %dU;' % constant] if constant else []) + lines]
+                body += ['    break;', '}']
+            body += ['default:', '{', '    break;', '}', '}']
+        else:
+            constant, lines = 0, []
+            for f in fields:
+                c, l = self._field(f)
+                constant, lines = constant + c, lines + l
+            body = ['uint32_t bits = %dU;' % constant] + lines
+        if not any('source->' in x for x in body):
+            body.append('(void)source;')
+        if not any('root_item' in x for x in body):
+            body.append('(void)root_item;')
+        body.append('return bits;')
+        self.functions = [
+            ('uint32_t', type_name + '_encoded_size_internal', const_source + ', uint8_t root_item', body),
+            ('uint32_t', type_name + '_encoded_size', const_source,
+             ['return (%s_encoded_size_internal(source, 1) + 7U) / 8U;' % type_name]),
+        ]
+
+    @staticmethod
+    def _item(t, size_of, indent=''):
+        '''The statements adding a variable-length nested item'''
+        return [indent + 'bits += %s_encoded_size_internal(&%s, 0);' % (get_name_space_prefix(t), size_of)]
+
+    def _field(self, f):
+        '''Returns the constant number of bits of the field and the statements adding the variable part'''
+        t = f.type
+        if cpp_is_fixed(t):
+            return t.get_max_bitlen(), []
+        if t.category == t.CATEGORY_COMPOUND:
+            return 0, self._item(t, 'source->' + f.name)
+        item = t.value_type
+        if t.mode == t.MODE_STATIC:
+            count, data = '%dU' % t.max_size, 'source->%s[c]' % f.name
+            prefix = 0
+        else:
+            count, data = 'source->%s.len' % f.name, 'source->%s.data[c]' % f.name
+            prefix = f.array_max_size_bit_len
+        lines = []
+        if prefix and CViewSection._tao_array(f):
+            lines += ['if (!root_item)',
+                      '{',
+                      '    bits += %dU;     // Array length; the tail array optimization drops it from the root item' %
+                      prefix,
+                      '}']
+            prefix = 0
+        if cpp_is_fixed(item):
+            lines.append('bits += (uint32_t)%s * %dU;' % (count, item.get_max_bitlen()))
+        else:
+            lines += ['for (uint32_t c = 0; c < %s; c++)' % count, '{'] + self._item(item, data, '    ') + ['}']
+        return prefix, lines
+
+# -----------------
+# C++17 backend
+#
+# Every field of a type is serialized at an offset that is either a compile-time constant relative to the beginning
+# of the type (canard::dsdl::StaticOffset), or relative to the end of the preceding variable-length field, which is
+# known at run time only (canard::dsdl::DynamicOffset). The offsets are tracked here, so the generated code contains
+# one put()/get() call per field with the bit position spelled out as a constant.
+
+def cpp_union_tag_bits(num_fields):
+    return max(num_fields - 1, 1).bit_length()
+
+def cpp_type_name(t):
+    if t.category == t.CATEGORY_PRIMITIVE:
+        if t.kind == t.KIND_BOOLEAN:
+            return 'bool'
+        if t.kind == t.KIND_FLOAT:
+            return 'double' if t.bitlen == 64 else 'float'
+        return 'std::%sint%d_t' % ('u' if t.kind == t.KIND_UNSIGNED_INT else '', expand_to_next_full(t.bitlen))
+    if t.category == t.CATEGORY_ARRAY:
+        if t.mode == t.MODE_STATIC:
+            return 'std::array<%s, %d>' % (cpp_type_name(t.value_type), t.max_size)
+        return 'canard::dsdl::Array<%s, %d>' % (cpp_type_name(t.value_type), t.max_size)
+    if t.category == t.CATEGORY_COMPOUND:
+        return '::' + t.full_name.replace('.', '::')
+    raise DsdlCompilerException('Unknown type category: %s' % t.category)
+
+def cpp_codec(t):
+    if t.category == t.CATEGORY_VOID:
+        return 'canard::dsdl::Void<%d>' % t.bitlen
+    saturated = 'true' if t.cast_mode == t.CAST_MODE_SATURATED else 'false'
+    return {
+        t.KIND_BOOLEAN: lambda: 'canard::dsdl::Bool',
+        t.KIND_UNSIGNED_INT: lambda: 'canard::dsdl::UnsignedInt<%d, %s>' % (t.bitlen, saturated),
+        t.KIND_SIGNED_INT: lambda: 'canard::dsdl::SignedInt<%d, %s>' % (t.bitlen, saturated),
+        t.KIND_FLOAT: lambda: 'canard::dsdl::Float<%d>' % t.bitlen,
+    }[t.kind]()
+
+def cpp_is_fixed(t):
+    if t.category in (t.CATEGORY_PRIMITIVE, t.CATEGORY_VOID):
+        return True
+    if t.category == t.CATEGORY_ARRAY:
+        return t.mode == t.MODE_STATIC and cpp_is_fixed(t.value_type)
+    return not t.union and all(cpp_is_fixed(f.type) for f in t.fields)
+
+class CppSection(object):
+    '''
+    Generated code of a message, or of a request or response of a service.
+    '''
+    def __init__(self, fields, constants, union, max_bitlen, min_bitlen):
+        self.max_bitlen = max_bitlen
+        self.min_bitlen = min_bitlen
+        self.union = bool(union and len(fields))
+        self.members = []
+        self.constants = []
+        self.layout = []
+        self.encode_lines = []
+        self.decode_lines = []
+        self._next_cursor = 1
+
+        for c in constants:
+            value = c.string_value + ('ULL' if c.type.kind == c.type.KIND_UNSIGNED_INT else '')
+            self.constants.append((cpp_type_name(c.type), c.name, value))
+
+        for f in fields:
+            if f.type.category != f.type.CATEGORY_VOID:
+                self.members.append((cpp_type_name(f.type), f.name))
+
+        if self.union:
+            self.tags = [f.name for f in fields]
+            self.tag_bits = cpp_union_tag_bits(len(fields))
+            self.layout.append(('union_tag', 0, self.tag_bits))
+            codec = 'canard::dsdl::UnsignedInt<%d, false>' % self.tag_bits
+            self.encode_lines.append('canard::dsdl::put<%s>(buf, at, static_cast<std::uint8_t>(union_tag));' % codec)
+            self.encode_lines.append('switch (union_tag)')
+            self.encode_lines.append('{')
+            self.decode_lines.append('std::uint8_t tag = 0;')
+            self.decode_lines.append('canard::dsdl::get<%s>(buf, at, tag);' % codec)
+            self.decode_lines.append('switch (tag)')
+            self.decode_lines.append('{')
+            for index, f in enumerate(fields):
+                self.layout.append((f.name, self.tag_bits, f.type.get_max_bitlen()))
+                encode, decode, end = self._field('at', self.tag_bits, f, 'Tao')
+                self.encode_lines.append('case Tag::%s:' % f.name)
+                self.encode_lines.append('{')
+                self.encode_lines += ['    ' + x for x in encode]
+                self.encode_lines.append('    return canard::dsdl::toDynamic(%s);' % end)
+                self.encode_lines.append('}')
+                self.decode_lines.append('case %dU:' % index)
+                self.decode_lines.append('{')
+                self.decode_lines.append('    union_tag = Tag::%s;' % f.name)
+                self.decode_lines += ['    ' + x for x in decode]
+                self.decode_lines.append('    return canard::dsdl::toDynamic(%s);' % end)
+                self.decode_lines.append('}')
+            self.encode_lines.append('}')
+            self.encode_lines.append('return canard::dsdl::DynamicOffset::invalid();')
+            self.decode_lines.append('default:')
+            self.decode_lines.append('{')
+            self.decode_lines.append('    break;')
+            self.decode_lines.append('}')
+            self.decode_lines.append('}')
+            self.decode_lines.append('return canard::dsdl::DynamicOffset::invalid();')
+        else:
+            cursor, offset = 'at', 0
+            for index, f in enumerate(fields):
+                last = index == len(fields) - 1
+                if cursor == 'at' and f.type.category != f.type.CATEGORY_VOID:
+                    self.layout.append((f.name, offset, f.type.get_max_bitlen()))
+                encode, decode, end = self._field(cursor, offset, f, 'Tao' if last else 'false')
+                self.encode_lines += encode
+                self.decode_lines += decode
+                if cpp_is_fixed(f.type):
+                    offset += f.type.get_max_bitlen()
+                else:
+                    cursor, offset = end, 0
+            self.encode_lines.append('return %s;' % self._position(cursor, offset))
+            self.decode_lines.append('return %s;' % self._position(cursor, offset))
+
+    @staticmethod
+    def _position(cursor, offset):
+        return cursor if offset == 0 else '%s + canard::dsdl::bits<%dU>' % (cursor, offset)
+
+    def _field(self, cursor, offset, f, tao):
+        '''
+        Returns the encoding and decoding statements of the field, and the expression of the position that follows it.
+        '''
+        t = f.type
+        at = self._position(cursor, offset)
+        after = self._position(cursor, offset + t.get_max_bitlen())
+        if t.category == t.CATEGORY_VOID:
+            return ['canard::dsdl::put<%s>(buf, %s, 0U);' % (cpp_codec(t), at)], [], after
+        if t.category == t.CATEGORY_PRIMITIVE:
+            codec = cpp_codec(t)
+            return ['canard::dsdl::put<%s>(buf, %s, %s);' % (codec, at, f.name)], \
+                   ['canard::dsdl::get<%s>(buf, %s, %s);' % (codec, at, f.name)], after
+
+        if t.category == t.CATEGORY_ARRAY and t.value_type.category == t.CATEGORY_PRIMITIVE:
+            codec = cpp_codec(t.value_type)
+            if t.mode == t.MODE_STATIC:
+                return ['canard::dsdl::putArray<%s>(buf, %s, %s);' % (codec, at, f.name)], \
+                       ['canard::dsdl::getArray<%s>(buf, %s, %s);' % (codec, at, f.name)], after
+            encode = 'canard::dsdl::putDynamicArray<%s, %s>(buf, %s, %s)' % (codec, tao, at, f.name)
+            decode = 'canard::dsdl::getDynamicArray<%s, %s>(buf, bit_len, %s, %s)' % (codec, tao, at, f.name)
+        elif t.category == t.CATEGORY_ARRAY:
+            kind = 'CompoundArray' if t.mode == t.MODE_STATIC else 'CompoundDynamicArray'
+            encode = 'canard::dsdl::put%s<%s>(buf, %s, %s)' % (kind, tao, at, f.name)
+            decode = 'canard::dsdl::get%s<%s>(buf, bit_len, %s, %s)' % (kind, tao, at, f.name)
+        else:
+            encode = '%s.encodeInto<%s>(buf, %s)' % (f.name, tao, at)
+            decode = '%s.decodeFrom<%s>(buf, bit_len, %s)' % (f.name, tao, at)
+
+        if cpp_is_fixed(t):
+            return [encode + ';'], [decode + ';'], after
+        end = 'p%d' % self._next_cursor
+        self._next_cursor += 1
+        return ['const auto %s = %s;' % (end, encode)], \
+               ['const auto %s = %s;' % (end, decode), 'if (!%s.valid())' % end, '{',
+                '    return %s;' % end, '}'], end
+
+def generate_one_cpp_type(template_expander, t):
+    t.short_name = t.full_name.split('.')[-1]
+    t.cpp_include_guard = 'CANARD_DSDL_' + t.full_name.replace('.', '_').upper() + '_HPP_INCLUDED'
+    t.cpp_namespace = '::'.join(t.full_name.split('.')[:-1])
+    t.has_default_dtid = t.default_dtid is not None
+
+    def detect_include(a):
+        if a.category == a.CATEGORY_COMPOUND:
+            return type_output_filename(a, CPP_OUTPUT_FILE_EXTENSION)
+        if a.category == a.CATEGORY_ARRAY:
+            return detect_include(a.value_type)
+    fields = t.fields if t.kind == t.KIND_MESSAGE else t.request_fields + t.response_fields
+    t.cpp_includes = list(sorted(set(filter(None, [detect_include(x.type) for x in fields]))))
+
+    if t.kind == t.KIND_MESSAGE:
+        t.cpp_sections = [('', CppSection(t.fields, t.constants, t.union, t.get_max_bitlen(), t.get_min_bitlen()))]
+    else:
+        t.cpp_sections = [
+            ('Request', CppSection(t.request_fields, t.request_constants, t.request_union,
+                                   t.get_max_bitlen_request(), t.get_min_bitlen_request())),
+            ('Response', CppSection(t.response_fields, t.response_constants, t.response_union,
+                                    t.get_max_bitlen_response(), t.get_min_bitlen_response())),
+        ]
+
+    text = template_expander(t=t)
+    text = '\n'.join(x.rstrip() for x in text.splitlines())
+    text = text.replace('\n\n\n\n\n', '\n\n').replace('\n\n\n\n', '\n\n').replace('\n\n\n', '\n\n')
+    text = text.replace('\n\n};', '\n};')
+    return text + '\n'
+
 def make_template_expander(filename):
     '''
     Templating is based on pyratemp (http://www.simple-is-better.org/template/pyratemp.html).
@@ -0,0 +1,730 @@
+/*
+ * Support library of the C++17 backend of the UAVCAN DSDL compiler for libcanard.
+ * It is copied into the output directory by libcanard_dsdlc --cpp; do not edit the copy.
+ *
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Released under the MIT license, check the file LICENSE.
+ */
+
+#ifndef CANARD_DSDL_HPP_INCLUDED
+#define CANARD_DSDL_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "canard.h"
+
+#if __cplusplus < 201703L
+# error "The C++ code generated by libcanard_dsdlc requires C++17"
+#endif
+
+namespace canard
+{
+namespace dsdl
+{
+/*
+ * Bit offsets.
+ * The generated code addresses every field through an offset type: offsets of the fields that precede the first
+ * variable-length field of a type are compile-time constants, so the serialization of those fields resolves into
+ * straight-line shifts and masks. Only the fields that follow a variable-length field are addressed at run time.
+ */
+
+/// Bit offset known at compile time
+template <std::uint32_t Bits>
+struct StaticOffset
+{
+    static constexpr std::uint32_t value = Bits;
+
+    constexpr operator std::uint32_t() const noexcept { return Bits; }
+};
+
+/// Bit offset known only at run time, i.e. the offset of a field that follows a variable-length field
+struct DynamicOffset
+{
+    static constexpr std::uint32_t Invalid = 0xFFFFFFFFUL;
+
+    std::uint32_t value = 0;
+
+    constexpr operator std::uint32_t() const noexcept { return value; }
+
+    constexpr bool valid() const noexcept { return value != Invalid; }
+
+    static constexpr DynamicOffset invalid() noexcept { return DynamicOffset{ Invalid }; }
+};
+
+template <std::uint32_t Bits>
+constexpr StaticOffset<Bits> bits{};
+
+template <std::uint32_t A, std::uint32_t B>
+constexpr StaticOffset<A + B> operator+(StaticOffset<A>, StaticOffset<B>) noexcept { return {}; }
+
+template <std::uint32_t B>
+constexpr DynamicOffset operator+(DynamicOffset a, StaticOffset<B>) noexcept { return DynamicOffset{ a.value + B }; }
+
+template <std::uint32_t Bits>
+constexpr DynamicOffset toDynamic(StaticOffset<Bits>) noexcept { return DynamicOffset{ Bits }; }
+
+constexpr DynamicOffset toDynamic(DynamicOffset offset) noexcept { return offset; }
+
+/// Position and width of a field, relative to the beginning of the type
+struct FieldLayout
+{
+    std::uint32_t offset;
+    std::uint32_t width;        ///< Maximum width for variable-length fields
+};
+
+/// Size of the buffer that holds a serialized object of the given maximum length
+constexpr std::size_t bufferSize(std::uint32_t max_bit_length) noexcept
+{
+    return (max_bit_length == 0U) ? 1U : ((max_bit_length + 7U) / 8U);
+}
+
+/// Length of the serialized object in bytes
+constexpr std::uint16_t bytesOf(std::uint32_t bit_length) noexcept
+{
+    return static_cast<std::uint16_t>((bit_length + 7U) / 8U);
+}
+
+/// Number of bits of the length prefix of a dynamic array
+constexpr unsigned lengthBits(std::size_t capacity) noexcept
+{
+    unsigned out = 0;
+    while (capacity > 0U)
+    {
+        out++;
+        capacity >>= 1U;
+    }
+    return out;
+}
+
+/// Static arrays up to this size are serialized item by item at compile-time offsets; larger ones are looped over.
+constexpr std::size_t MaxUnrolledArrayItems = 16U;
+
+/*
+ * Value codecs. Each one converts a field value to and from its raw bit representation of Width bits.
+ */
+
+template <unsigned Width>
+using RawFor = std::conditional_t<(Width <= 8U),  std::uint8_t,
+               std::conditional_t<(Width <= 16U), std::uint16_t,
+               std::conditional_t<(Width <= 32U), std::uint32_t, std::uint64_t>>>;
+
+template <unsigned Width, typename Raw>
+constexpr Raw lowBitsMask() noexcept
+{
+    if constexpr (Width >= (sizeof(Raw) * 8U))
+    {
+        return static_cast<Raw>(~static_cast<Raw>(0U));
+    }
+    else
+    {
+        return static_cast<Raw>((static_cast<Raw>(1U) << Width) - 1U);
+    }
+}
+
+template <unsigned W, bool Saturated>
+struct UnsignedInt
+{
+    static constexpr unsigned Width = W;
+    using Raw = RawFor<W>;
+
+    template <typename T>
+    static constexpr Raw toRaw(T value) noexcept
+    {
+        if constexpr (Saturated && (W < (sizeof(T) * 8U)))
+        {
+            constexpr T Max = static_cast<T>(lowBitsMask<W, Raw>());
+            value = (value > Max) ? Max : value;
+        }
+        return static_cast<Raw>(static_cast<Raw>(value) & lowBitsMask<W, Raw>());
+    }
+
+    template <typename T>
+    static constexpr T fromRaw(Raw raw) noexcept { return static_cast<T>(raw); }
+};
+
+template <unsigned W, bool Saturated>
+struct SignedInt
+{
+    static constexpr unsigned Width = W;
+    using Raw = RawFor<W>;
+
+    template <typename T>
+    static constexpr Raw toRaw(T value) noexcept
+    {
+        if constexpr (Saturated && (W < (sizeof(T) * 8U)))
+        {
+            constexpr T Max = static_cast<T>((static_cast<std::int64_t>(1) << (W - 1U)) - 1);
+            constexpr T Min = static_cast<T>(-Max - 1);
+            value = (value > Max) ? Max : ((value < Min) ? Min : value);
+        }
+        return static_cast<Raw>(static_cast<Raw>(value) & lowBitsMask<W, Raw>());
+    }
+
+    template <typename T>
+    static constexpr T fromRaw(Raw raw) noexcept
+    {
+        if constexpr (W == (sizeof(Raw) * 8U))
+        {
+            return static_cast<T>(static_cast<std::make_signed_t<Raw>>(raw));
+        }
+        else
+        {
+            constexpr Raw SignBit = static_cast<Raw>(static_cast<Raw>(1U) << (W - 1U));
+            return static_cast<T>(static_cast<std::int64_t>(raw ^ SignBit) - static_cast<std::int64_t>(SignBit));
+        }
+    }
+};
+
+struct Bool
+{
+    static constexpr unsigned Width = 1U;
+    using Raw = std::uint8_t;
+
+    static constexpr Raw toRaw(bool value) noexcept { return value ? 1U : 0U; }
+
+    template <typename T>
+    static constexpr T fromRaw(Raw raw) noexcept { return raw != 0U; }
+};
+
+template <unsigned W>
+struct Float;
+
+template <>
+struct Float<16>
+{
+    static constexpr unsigned Width = 16U;
+    using Raw = std::uint16_t;
+
+    static Raw toRaw(float value) noexcept { return canardConvertNativeFloatToFloat16(value); }
+
+    template <typename T>
+    static T fromRaw(Raw raw) noexcept { return canardConvertFloat16ToNativeFloat(raw); }
+};
+
+template <>
+struct Float<32>
+{
+    static constexpr unsigned Width = 32U;
+    using Raw = std::uint32_t;
+
+    static Raw toRaw(float value) noexcept
+    {
+        Raw out = 0;
+        std::memcpy(&out, &value, sizeof(out));
+        return out;
+    }
+
+    template <typename T>
+    static T fromRaw(Raw raw) noexcept
+    {
+        float out = 0;
+        std::memcpy(&out, &raw, sizeof(out));
+        return out;
+    }
+};
+
+template <>
+struct Float<64>
+{
+    static constexpr unsigned Width = 64U;
+    using Raw = std::uint64_t;
+
+    static Raw toRaw(double value) noexcept
+    {
+        Raw out = 0;
+        std::memcpy(&out, &value, sizeof(out));
+        return out;
+    }
+
+    template <typename T>
+    static T fromRaw(Raw raw) noexcept
+    {
+        double out = 0;
+        std::memcpy(&out, &raw, sizeof(out));
+        return out;
+    }
+};
+
+template <unsigned W>
+struct Void
+{
+    static constexpr unsigned Width = W;
+    using Raw = RawFor<W>;
+
+    template <typename T>
+    static constexpr Raw toRaw(T) noexcept { return 0U; }
+};
+
+/*
+ * Bit stream kernels.
+ * The wire format is that of canardEncodeScalar(): the value is split into little-endian bytes, the last partial
+ * byte is left-aligned, and the resulting byte stream is written MSB first starting at the field offset.
+ * A value of Width bits therefore consists of (Width + 7) / 8 chunks; chunk K holds ChunkWidth<Width, K> bits.
+ *
+ * The writer appends: fields are always written in the order of their offsets, so a chunk keeps the bits that precede
+ * it in its first byte and clears everything after itself. The output buffer need not be zeroed, and no byte is read
+ * before it has been written.
+ */
+namespace detail
+{
+template <unsigned Width, std::size_t K>
+constexpr unsigned chunkWidth() noexcept
+{
+    return (K < (Width / 8U)) ? 8U : (Width % 8U);
+}
+
+template <unsigned Count>
+constexpr std::uint8_t chunkMask() noexcept
+{
+    return static_cast<std::uint8_t>(0xFFU << (8U - Count));
+}
+
+/// Chunk K of the raw value, left-aligned
+template <unsigned Width, std::size_t K, typename Raw>
+constexpr std::uint8_t chunkOf(Raw raw) noexcept
+{
+    return static_cast<std::uint8_t>(static_cast<std::uint8_t>(raw >> (8U * K)) << (8U - chunkWidth<Width, K>()));
+}
+
+/// Puts chunk K back in place in the raw value
+template <unsigned Width, std::size_t K, typename Raw>
+constexpr Raw placeChunk(std::uint8_t chunk) noexcept
+{
+    return static_cast<Raw>(static_cast<Raw>(chunk >> (8U - chunkWidth<Width, K>())) << (8U * K));
+}
+
+template <std::uint32_t Pos, unsigned Count>
+inline void putChunk(std::uint8_t* buf, std::uint8_t chunk) noexcept
+{
+    constexpr std::uint32_t Index = Pos / 8U;
+    constexpr unsigned Shift = Pos % 8U;
+    if constexpr (Shift == 0U)
+    {
+        buf[Index] = chunk;
+    }
+    else
+    {
+        constexpr std::uint8_t Keep = static_cast<std::uint8_t>(0xFF00U >> Shift);
+        buf[Index] = static_cast<std::uint8_t>((buf[Index] & Keep) | (chunk >> Shift));
+        if constexpr ((Shift + Count) > 8U)
+        {
+            buf[Index + 1U] = static_cast<std::uint8_t>(chunk << (8U - Shift));
+        }
+    }
+}
+
+template <unsigned Count>
+inline void putChunk(std::uint8_t* buf, std::uint32_t pos, std::uint8_t chunk) noexcept
+{
+    const std::uint32_t index = pos / 8U;
+    const unsigned shift = pos % 8U;
+    if (shift == 0U)
+    {
+        buf[index] = chunk;
+    }
+    else
+    {
+        buf[index] = static_cast<std::uint8_t>((buf[index] & (0xFF00U >> shift)) | (chunk >> shift));
+        if ((shift + Count) > 8U)
+        {
+            buf[index + 1U] = static_cast<std::uint8_t>(chunk << (8U - shift));
+        }
+    }
+}
+
+template <std::uint32_t Pos, unsigned Count>
+inline std::uint8_t getChunk(const std::uint8_t* buf) noexcept
+{
+    constexpr std::uint32_t Index = Pos / 8U;
+    constexpr unsigned Shift = Pos % 8U;
+    if constexpr ((Shift + Count) <= 8U)
+    {
+        return static_cast<std::uint8_t>((buf[Index] << Shift) & chunkMask<Count>());
+    }
+    else
+    {
+        return static_cast<std::uint8_t>(((buf[Index] << Shift) | (buf[Index + 1U] >> (8U - Shift))) &
+                                         chunkMask<Count>());
+    }
+}
+
+template <unsigned Count>
+inline std::uint8_t getChunk(const std::uint8_t* buf, std::uint32_t pos) noexcept
+{
+    const std::uint32_t index = pos / 8U;
+    const unsigned shift = pos % 8U;
+    unsigned out = static_cast<unsigned>(buf[index] << shift);
+    if ((shift + Count) > 8U)
+    {
+        out |= static_cast<unsigned>(buf[index + 1U] >> (8U - shift));
+    }
+    return static_cast<std::uint8_t>(out & chunkMask<Count>());
+}
+
+template <unsigned Width, typename Raw, std::uint32_t Pos, std::size_t... K>
+inline void putRaw(std::uint8_t* buf, StaticOffset<Pos>, Raw raw, std::index_sequence<K...>) noexcept
+{
+    (putChunk<Pos + (8U * K), chunkWidth<Width, K>()>(buf, chunkOf<Width, K>(raw)), ...);
+}
+
+template <unsigned Width, typename Raw, std::size_t... K>
+inline void putRaw(std::uint8_t* buf, DynamicOffset at, Raw raw, std::index_sequence<K...>) noexcept
+{
+    (putChunk<chunkWidth<Width, K>()>(buf, at.value + (8U * K), chunkOf<Width, K>(raw)), ...);
+}
+
+template <unsigned Width, typename Raw, std::uint32_t Pos, std::size_t... K>
+inline Raw getRaw(const std::uint8_t* buf, StaticOffset<Pos>, std::index_sequence<K...>) noexcept
+{
+    return static_cast<Raw>((placeChunk<Width, K, Raw>(getChunk<Pos + (8U * K), chunkWidth<Width, K>()>(buf)) | ...));
+}
+
+template <unsigned Width, typename Raw, std::size_t... K>
+inline Raw getRaw(const std::uint8_t* buf, DynamicOffset at, std::index_sequence<K...>) noexcept
+{
+    return static_cast<Raw>((placeChunk<Width, K, Raw>(getChunk<chunkWidth<Width, K>()>(buf, at.value + (8U * K)))
+                             | ...));
+}
+} // namespace detail
+
+/// Writes one value at the given offset
+template <typename Codec, typename Pos, typename T>
+inline void put(std::uint8_t* buf, Pos at, const T& value) noexcept
+{
+    detail::putRaw<Codec::Width>(buf, at, Codec::toRaw(value), std::make_index_sequence<(Codec::Width + 7U) / 8U>{});
+}
+
+/// Reads one value at the given offset
+template <typename Codec, typename Pos, typename T>
+inline void get(const std::uint8_t* buf, Pos at, T& out) noexcept
+{
+    out = Codec::template fromRaw<T>(detail::getRaw<Codec::Width, typename Codec::Raw>(
+        buf, at, std::make_index_sequence<(Codec::Width + 7U) / 8U>{}));
+}
+
+/*
+ * Arrays
+ */
+
+/// Storage of a dynamic array; the items are kept inline, so no dynamic array buffer is needed for decoding.
+template <typename T, std::size_t Capacity>
+struct Array
+{
+    using SizeType = std::conditional_t<(Capacity > 255U), std::uint16_t, std::uint8_t>;
+
+    SizeType len{};
+    std::array<T, Capacity> data{};
+
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+    constexpr std::size_t size() const noexcept { return len; }
+
+    T& operator[](std::size_t index) noexcept { return data[index]; }
+    const T& operator[](std::size_t index) const noexcept { return data[index]; }
+
+    T* begin() noexcept { return data.data(); }
+    T* end() noexcept { return data.data() + len; }
+    const T* begin() const noexcept { return data.data(); }
+    const T* end() const noexcept { return data.data() + len; }
+
+    bool push_back(const T& value) noexcept
+    {
+        if (len >= Capacity)
+        {
+            return false;
+        }
+        data[len++] = value;
+        return true;
+    }
+};
+
+namespace detail
+{
+template <typename Codec, typename Pos, typename T, std::size_t N, std::size_t... I>
+inline void putItems(std::uint8_t* buf, Pos at, const std::array<T, N>& items, std::index_sequence<I...>) noexcept
+{
+    (put<Codec>(buf, at + bits<static_cast<std::uint32_t>(Codec::Width * I)>, items[I]), ...);
+}
+
+template <typename Codec, typename Pos, typename T, std::size_t N, std::size_t... I>
+inline void getItems(const std::uint8_t* buf, Pos at, std::array<T, N>& items, std::index_sequence<I...>) noexcept
+{
+    (get<Codec>(buf, at + bits<static_cast<std::uint32_t>(Codec::Width * I)>, items[I]), ...);
+}
+} // namespace detail
+
+template <typename Codec, typename Pos, typename T, std::size_t N>
+inline void putArray(std::uint8_t* buf, Pos at, const std::array<T, N>& items) noexcept
+{
+    if constexpr (N <= MaxUnrolledArrayItems)
+    {
+        detail::putItems<Codec>(buf, at, items, std::make_index_sequence<N>{});
+    }
+    else
+    {
+        DynamicOffset p = toDynamic(at);
+        for (const T& item : items)
+        {
+            put<Codec>(buf, p, item);
+            p.value += Codec::Width;
+        }
+    }
+}
+
+template <typename Codec, typename Pos, typename T, std::size_t N>
+inline void getArray(const std::uint8_t* buf, Pos at, std::array<T, N>& items) noexcept
+{
+    if constexpr (N <= MaxUnrolledArrayItems)
+    {
+        detail::getItems<Codec>(buf, at, items, std::make_index_sequence<N>{});
+    }
+    else
+    {
+        DynamicOffset p = toDynamic(at);
+        for (T& item : items)
+        {
+            get<Codec>(buf, p, item);
+            p.value += Codec::Width;
+        }
+    }
+}
+
+/*
+ * Tail array optimization follows pyuavcan: the Tao flag is passed down to the last field of a type, to the last item
+ * of an array, and to every field of a union; a dynamic array that receives it drops its length prefix if its items
+ * are at least 8 bits long. The flag is a template parameter, so the decision is made at compile time.
+ */
+
+template <typename Codec, bool Tao, typename Pos, typename T, std::size_t Capacity>
+inline DynamicOffset putDynamicArray(std::uint8_t* buf, Pos at, const Array<T, Capacity>& items) noexcept
+{
+    DynamicOffset p = toDynamic(at);
+    if constexpr (!(Tao && (Codec::Width >= 8U)))
+    {
+        put<UnsignedInt<lengthBits(Capacity), false>>(buf, p, items.len);
+        p.value += lengthBits(Capacity);
+    }
+    for (std::size_t i = 0; i < items.len; i++)
+    {
+        put<Codec>(buf, p, items.data[i]);
+        p.value += Codec::Width;
+    }
+    return p;
+}
+
+/// With the tail array optimization, the length is deduced from the payload length
+template <typename Codec, bool Tao, typename Pos, typename T, std::size_t Capacity>
+inline DynamicOffset getDynamicArray(const std::uint8_t* buf, std::uint32_t bit_len, Pos at,
+                                     Array<T, Capacity>& items) noexcept
+{
+    DynamicOffset p = toDynamic(at);
+    std::size_t len = 0;
+    if constexpr (Tao && (Codec::Width >= 8U))
+    {
+        len = (bit_len > p.value) ? ((bit_len - p.value) / Codec::Width) : 0U;
+    }
+    else
+    {
+        get<UnsignedInt<lengthBits(Capacity), false>>(buf, p, len);
+        p.value += lengthBits(Capacity);
+    }
+    if (len > Capacity)
+    {
+        return DynamicOffset::invalid();
+    }
+    items.len = static_cast<typename Array<T, Capacity>::SizeType>(len);
+    for (std::size_t i = 0; i < len; i++)
+    {
+        get<Codec>(buf, p, items.data[i]);
+        p.value += Codec::Width;
+    }
+    return p;
+}
+
+template <bool Tao, typename Pos, typename T, std::size_t N>
+inline DynamicOffset putCompoundArray(std::uint8_t* buf, Pos at, const std::array<T, N>& items) noexcept
+{
+    DynamicOffset p = toDynamic(at);
+    for (std::size_t i = 0; (i + 1U) < N; i++)
+    {
+        p = toDynamic(items[i].template encodeInto<false>(buf, p));
+    }
+    return toDynamic(items[N - 1U].template encodeInto<Tao>(buf, p));
+}
+
+template <bool Tao, typename Pos, typename T, std::size_t N>
+inline DynamicOffset getCompoundArray(const std::uint8_t* buf, std::uint32_t bit_len, Pos at,
+                                      std::array<T, N>& items) noexcept
+{
+    DynamicOffset p = toDynamic(at);
+    for (std::size_t i = 0; (i + 1U) < N; i++)
+    {
+        p = toDynamic(items[i].template decodeFrom<false>(buf, bit_len, p));
+        if (!p.valid())
+        {
+            return p;
+        }
+    }
+    return toDynamic(items[N - 1U].template decodeFrom<Tao>(buf, bit_len, p));
+}
+
+template <bool Tao, typename Pos, typename T, std::size_t Capacity>
+inline DynamicOffset putCompoundDynamicArray(std::uint8_t* buf, Pos at, const Array<T, Capacity>& items) noexcept
+{
+    DynamicOffset p = toDynamic(at);
+    if constexpr (Tao && (T::MinBitLength >= 8U))
+    {
+        for (const T& item : items)
+        {
+            p = toDynamic(item.template encodeInto<false>(buf, p));
+        }
+    }
+    else
+    {
+        put<UnsignedInt<lengthBits(Capacity), false>>(buf, p, items.len);
+        p.value += lengthBits(Capacity);
+        for (std::size_t i = 0; i < items.len; i++)
+        {
+            p = ((i + 1U) < items.len) ? toDynamic(items.data[i].template encodeInto<false>(buf, p)) :
+                                         toDynamic(items.data[i].template encodeInto<Tao>(buf, p));
+        }
+    }
+    return p;
+}
+
+template <bool Tao, typename Pos, typename T, std::size_t Capacity>
+inline DynamicOffset getCompoundDynamicArray(const std::uint8_t* buf, std::uint32_t bit_len, Pos at,
+                                             Array<T, Capacity>& items) noexcept
+{
+    DynamicOffset p = toDynamic(at);
+    items.len = 0;
+    if constexpr (Tao && (T::MinBitLength >= 8U))
+    {
+        while ((bit_len >= 8U) && (p.value <= (bit_len - 8U)))      // Whatever is left is shorter than one item
+        {
+            if (items.len >= Capacity)
+            {
+                return DynamicOffset::invalid();
+            }
+            p = toDynamic(items.data[items.len].template decodeFrom<false>(buf, bit_len, p));
+            if (!p.valid())
+            {
+                return p;
+            }
+            items.len++;
+        }
+    }
+    else
+    {
+        std::size_t len = 0;
+        get<UnsignedInt<lengthBits(Capacity), false>>(buf, p, len);
+        p.value += lengthBits(Capacity);
+        if (len > Capacity)
+        {
+            return DynamicOffset::invalid();
+        }
+        for (; items.len < len; items.len++)
+        {
+            p = ((items.len + 1U) < len) ?
+                toDynamic(items.data[items.len].template decodeFrom<false>(buf, bit_len, p)) :
+                toDynamic(items.data[items.len].template decodeFrom<Tao>(buf, bit_len, p));
+            if (!p.valid())
+            {
+                return p;
+            }
+        }
+    }
+    return p;
+}
+
+/*
+ * Entry points used by the generated encode() and decode() methods
+ */
+
+/// Copies the payload of a received transfer into a contiguous buffer; the rest of the buffer is zeroed.
+/// At most capacity bytes are copied.
+inline void linearize(const CanardRxTransfer& transfer, std::uint8_t* out, std::size_t capacity) noexcept
+{
+    std::size_t remaining = (transfer.payload_len < capacity) ? transfer.payload_len : capacity;
+    std::memset(out + remaining, 0, capacity - remaining);
+
+    if ((transfer.payload_middle == NULL) && (transfer.payload_tail == NULL))
+    {
+        std::memcpy(out, transfer.payload_head, remaining);     // Single frame, or a static-capacity session
+        return;
+    }
+
+    std::size_t amount = (remaining < CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE) ?
+                         remaining : CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE;
+    std::memcpy(out, transfer.payload_head, amount);
+    out += amount;
+    remaining -= amount;
+
+    // The middle blocks are always full, except that the payload may end in the last one
+    std::size_t middle_len = static_cast<std::size_t>(transfer.payload_len) - CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE;
+    for (const CanardBufferBlock* block = transfer.payload_middle; (block != NULL) && (remaining > 0U);
+         block = block->next)
+    {
+        const std::size_t block_len = (middle_len < CANARD_BUFFER_BLOCK_DATA_SIZE) ?
+                                      middle_len : CANARD_BUFFER_BLOCK_DATA_SIZE;
+        amount = (remaining < block_len) ? remaining : block_len;
+        std::memcpy(out, block->data, amount);
+        out += amount;
+        remaining -= amount;
+        middle_len -= block_len;
+    }
+
+    if ((remaining > 0U) && (transfer.payload_tail != NULL))
+    {
+        std::memcpy(out, transfer.payload_tail, remaining);
+    }
+}
+
+/// Returns the length of the encoded object in bytes, or zero if it could not be encoded (invalid union tag)
+constexpr std::uint16_t finishEncoding(std::uint32_t end) noexcept
+{
+    return (end == DynamicOffset::Invalid) ? 0U : bytesOf(end);
+}
+
+/// A decoded position past the end of the payload means that the payload was truncated
+constexpr std::int32_t finishDecoding(std::uint32_t end, std::uint32_t bit_len) noexcept
+{
+    return (end > bit_len) ? -CANARD_ERROR_INTERNAL : static_cast<std::int32_t>(end);
+}
+
+/// Decodes a top-level object from a contiguous payload. Short payloads are zero-padded to the maximum size, so
+/// that the fields can be read without bounds checks.
+template <typename T>
+inline std::int32_t decodeRoot(T& object, const std::uint8_t* payload, std::uint16_t payload_len) noexcept
+{
+    constexpr std::size_t Size = bufferSize(T::MaxBitLength);
+    const std::uint32_t bit_len = payload_len * 8U;
+    if (payload_len >= Size)
+    {
+        return finishDecoding(object.template decodeFrom<true>(payload, bit_len, bits<0U>), bit_len);
+    }
+    std::uint8_t padded[Size];
+    std::memcpy(padded, payload, payload_len);
+    std::memset(padded + payload_len, 0, Size - payload_len);
+    return finishDecoding(object.template decodeFrom<true>(padded, bit_len, bits<0U>), bit_len);
+}
+
+/// Decodes a top-level object from a received transfer; the scattered payload storage is walked once
+template <typename T>
+inline std::int32_t decodeRoot(T& object, const CanardRxTransfer& transfer) noexcept
+{
+    constexpr std::size_t Size = bufferSize(T::MaxBitLength);
+    std::uint8_t buf[Size];
+    linearize(transfer, buf, Size);
+    const std::uint32_t bit_len = transfer.payload_len * 8U;
+    return finishDecoding(object.template decodeFrom<true>(buf, bit_len, bits<0U>), bit_len);
+}
+
+} // namespace dsdl
+} // namespace canard
+
+#endif
@@ -0,0 +1,333 @@
+#
+# UAVCAN DSDL compiler for libcanard
+#
+# Copyright (c) 2018 UAVCAN Team
+#
+
+'''
+Generation of the benchmark and round-trip harness of the C backend (libcanard_dsdlc --emit_harness).
+
+For every generated message, request and response the harness fills the C structure with pseudo-random values,
+encodes it, decodes the payload, encodes the result again and compares both payloads. Encoding and decoding are timed
+separately; the harness prints one line per type with the payload size and the time per operation, and exits with a
+non-zero status if any round trip did not match.
+
+The functions that fill the structures are also used by the round-trip tests of the library (tests/dsdl_c).
+'''
+
+from __future__ import division, absolute_import, print_function, unicode_literals
+import os
+
+HARNESS_SOURCE_FILENAME = 'canard_dsdl_harness.c'
+HARNESS_CMAKE_FILENAME = 'CMakeLists.txt'
+LIBCANARD_DIR = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..'))
+
+# Pseudo-random values for the fill functions; the including file provides nothing but <stdint.h> and <stddef.h>
+RANDOM_SUPPORT = '''static uint32_t roundTripRandom(uint32_t* seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+static uint64_t roundTripRandomUnsigned(uint32_t* seed, uint8_t bits)
+{
+    const uint64_t value = ((uint64_t)roundTripRandom(seed) << 32U) | roundTripRandom(seed);
+    return (bits < 64U) ? (value & ((((uint64_t)1) << bits) - 1U)) : value;
+}
+
+static int64_t roundTripRandomSigned(uint32_t* seed, uint8_t bits)
+{
+    uint64_t value = roundTripRandomUnsigned(seed, bits);
+    if (bits < 64U)
+    {
+        const uint64_t sign = ((uint64_t)1) << (bits - 1U);
+        value = (value ^ sign) - sign;
+    }
+    return (int64_t)value;
+}
+
+static void* roundTripAllocate(uint8_t** pool, size_t size)
+{
+    void* const out = *pool;
+    *pool += (size + 7U) & ~(size_t)7U;
+    return out;
+}
+'''
+
+
+def c_name(t):
+    return t.full_name.replace('.', '_')
+
+
+def structs_of(types):
+    '''
+    The C structures generated for the types, sorted by name:
+    (C name, full name, signature, max size macro, fields, union, max bit length)
+    '''
+    structs = []
+    for t in sorted(types, key=lambda x: x.full_name):
+        macro = t.full_name.replace('.', '_').upper()
+        if t.kind == t.KIND_MESSAGE:
+            structs.append((c_name(t), t.full_name, t.get_data_type_signature(), macro + '_MAX_SIZE',
+                            t.fields, t.union, t.get_max_bitlen()))
+        else:
+            structs.append((c_name(t) + 'Request', t.full_name + '.Request', t.get_data_type_signature(),
+                            macro + '_REQUEST_MAX_SIZE', t.request_fields, t.request_union,
+                            t.get_max_bitlen_request()))
+            structs.append((c_name(t) + 'Response', t.full_name + '.Response', t.get_data_type_signature(),
+                            macro + '_RESPONSE_MAX_SIZE', t.response_fields, t.response_union,
+                            t.get_max_bitlen_response()))
+    return structs
+
+
+def fill_value(t, lvalue, indent):
+    '''Returns the lines that assign a pseudo-random value of the DSDL type t to lvalue.'''
+    from . import type_to_c_type
+    pad = ' ' * indent
+    if t.category == t.CATEGORY_PRIMITIVE:
+        if t.kind == t.KIND_BOOLEAN:
+            return [pad + '%s = (roundTripRandom(seed) & 1U) != 0U;' % lvalue]
+        if t.kind == t.KIND_FLOAT:
+            # Values that every float width represents exactly, so that the round trip is lossless
+            if t.bitlen == 16:
+                return [pad + '%s = (float)roundTripRandomSigned(seed, 12) / 8.0F;' % lvalue]
+            if t.bitlen == 32:
+                return [pad + '%s = (float)roundTripRandomSigned(seed, 24) / 128.0F;' % lvalue]
+            return [pad + '%s = (double)roundTripRandomSigned(seed, 52) / 1024.0;' % lvalue]
+        c_type = type_to_c_type(t)['cpp_type']
+        if t.kind == t.KIND_SIGNED_INT:
+            return [pad + '%s = (%s)roundTripRandomSigned(seed, %d);' % (lvalue, c_type, t.bitlen)]
+        return [pad + '%s = (%s)roundTripRandomUnsigned(seed, %d);' % (lvalue, c_type, t.bitlen)]
+    if t.category == t.CATEGORY_COMPOUND:
+        return [pad + 'fill_%s(&%s, seed, pool);' % (c_name(t), lvalue)]
+    if t.category == t.CATEGORY_ARRAY:
+        item = type_to_c_type(t.value_type)['cpp_type']
+        if t.mode == t.MODE_STATIC:
+            return [pad + 'for (uint32_t i%d = 0; i%d < %d; i%d++)' % (indent, indent, t.max_size, indent),
+                    pad + '{'] + \
+                   fill_value(t.value_type, '%s[i%d]' % (lvalue, indent), indent + 4) + \
+                   [pad + '}']
+        len_type = 'uint16_t' if t.max_size > 255 else 'uint8_t'
+        return [pad + '%s.len = (%s)(roundTripRandom(seed) %% %dU);' % (lvalue, len_type, t.max_size + 1),
+                pad + '%s.data = (%s*)roundTripAllocate(pool, sizeof(%s) * %s.len);' % (lvalue, item, item, lvalue),
+                pad + 'for (uint32_t i%d = 0; i%d < %s.len; i%d++)' % (indent, indent, lvalue, indent),
+                pad + '{'] + \
+               fill_value(t.value_type, '%s.data[i%d]' % (lvalue, indent), indent + 4) + \
+               [pad + '}']
+    return []   # Void
+
+
+def fill_function(name, fields, union, max_bitlen):
+    '''
+    Returns the lines of fill_<name>(value, seed, pool), which fills the structure with values derived from the seed.
+    The dynamic arrays are allocated from the pool. The function is kept out of line: it is not measured, and inlining
+    the nested fill functions into each other makes optimized builds take minutes.
+    '''
+    lines = ['static __attribute__((noinline)) void fill_%s(%s* value, uint32_t* seed, uint8_t** pool)' % (name, name),
+             '{']
+    if max_bitlen and union:
+        lines.append('    value->union_tag = (%s_ENUM)(roundTripRandom(seed) %% %dU);' % (name, len(fields)))
+        for index, f in enumerate(fields):
+            lines.append('    %s (value->union_tag == %d)' % ('if' if index == 0 else 'else if', index))
+            lines.append('    {')
+            lines += fill_value(f.type, 'value->' + f.name, 8)
+            lines.append('    }')
+    elif max_bitlen:
+        for f in fields:
+            lines += fill_value(f.type, 'value->' + (f.name or ''), 4)
+    else:
+        lines.append('    (void)value;')
+    lines.append('    (void)seed;')
+    lines.append('    (void)pool;')
+    lines.append('}')
+    return lines
+
+
+def run_function(name, max_size):
+    return '''static uint32_t run_%(n)s(uint32_t seed, HarnessStats* stats)
+{
+    static uint8_t payload[%(max)s + 1U];
+    static uint8_t reencoded[%(max)s + 1U];
+    %(n)s value;
+    %(n)s decoded;
+    uint8_t* pool = harnessSourcePool;
+    memset(&value, 0, sizeof(value));
+    fill_%(n)s(&value, &seed, &pool);
+
+    uint32_t len = 0;
+    uint64_t started = harnessNanoseconds();
+    for (uint32_t i = 0; i < HARNESS_REPEATS; i++)
+    {
+        len = %(n)s_encode(&value, payload);
+    }
+    stats->encode_ns += harnessNanoseconds() - started;
+
+    CanardRxTransfer transfer;
+    memset(&transfer, 0, sizeof(transfer));
+    transfer.payload_head = payload;
+    transfer.payload_len = (uint16_t)len;
+    int32_t ret = 0;
+    started = harnessNanoseconds();
+    for (uint32_t i = 0; i < HARNESS_REPEATS; i++)
+    {
+        // Decoded the way it was encoded, as the root item with the tail array optimization
+        uint8_t* dyn_arr_buf = harnessDecodedPool;
+        memset(&decoded, 0, sizeof(decoded));
+        ret = %(n)s_decode_internal(&transfer, (uint16_t)len, &decoded, &dyn_arr_buf, 0, CANARD_INTERNAL_ENABLE_TAO);
+    }
+    stats->decode_ns += harnessNanoseconds() - started;
+
+    stats->bytes += len;
+    stats->max_bytes = (len > stats->max_bytes) ? len : stats->max_bytes;
+    if (ret < 0)
+    {
+        return 1U;
+    }
+    const uint32_t reencoded_len = %(n)s_encode(&decoded, reencoded);
+    return ((reencoded_len != len) || (memcmp(payload, reencoded, len) != 0)) ? 1U : 0U;
+}
+''' % {'n': name, 'max': max_size}
+
+
+MAIN_FUNCTION = '''static uint64_t harnessNanoseconds(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char** argv)
+{
+    const unsigned long arg = (argc > 1) ? strtoul(argv[1], NULL, 10) : 0UL;
+    const uint32_t iterations = (arg > 0UL) ? (uint32_t)arg : HARNESS_DEFAULT_ITERATIONS;
+    const char* const filter = (argc > 2) ? argv[2] : NULL;
+
+    printf("%-56s %8s %8s %11s %11s\\n", "type", "bytes", "max", "encode ns", "decode ns");
+    uint32_t failed_types = 0;
+    for (size_t i = 0; i < sizeof(harnessTypes) / sizeof(harnessTypes[0]); i++)
+    {
+        if ((filter != NULL) && (strstr(harnessTypes[i].name, filter) == NULL))
+        {
+            continue;
+        }
+        HarnessStats stats;
+        memset(&stats, 0, sizeof(stats));
+        uint32_t mismatches = 0;
+        for (uint32_t seed = 1; seed <= iterations; seed++)
+        {
+            mismatches += harnessTypes[i].run(seed, &stats);
+        }
+        const double ops = (double)iterations * HARNESS_REPEATS;
+        printf("%-56s %8.1f %8u %11.1f %11.1f%s\\n",
+               harnessTypes[i].name,
+               (double)stats.bytes / (double)iterations,
+               (unsigned)stats.max_bytes,
+               (double)stats.encode_ns / ops,
+               (double)stats.decode_ns / ops,
+               (mismatches > 0U) ? "  ROUND TRIP FAILED" : "");
+        failed_types += (mismatches > 0U) ? 1U : 0U;
+    }
+    if (failed_types > 0U)
+    {
+        fprintf(stderr, "%u type(s) failed the round trip\\n", (unsigned)failed_types);
+        return 1;
+    }
+    return 0;
+}
+'''
+
+
+def harness_source(types, header_filename):
+    structs = structs_of(types)
+    out = ['/*',
+           ' * Benchmark and round-trip harness of the generated types.',
+           ' *',
+           ' * Autogenerated by libcanard_dsdlc --emit_harness, do not edit.',
+           ' *',
+           ' * Usage: canard_dsdl_harness [iterations per type] [substring of the type names to run]',
+           ' */',
+           '',
+           '#define _POSIX_C_SOURCE 199309L',
+           '',
+           '#include <stdio.h>',
+           '#include <stdlib.h>',
+           '#include <string.h>',
+           '#include <time.h>',
+           '#include "canard.h"']
+    out += ['#include "%s"' % header_filename(t) for t in sorted(types, key=lambda x: x.full_name)]
+    out += ['',
+            '#ifndef CANARD_INTERNAL_ENABLE_TAO',
+            '#define CANARD_INTERNAL_ENABLE_TAO  ((uint8_t) 1)',
+            '#endif',
+            '',
+            '#define HARNESS_DEFAULT_ITERATIONS  1000U',
+            '#define HARNESS_REPEATS             16U         ///< Encodings and decodings timed per value',
+            '#define HARNESS_POOL_SIZE           65536U      ///< Memory for the dynamic arrays of one structure',
+            '',
+            'typedef struct',
+            '{',
+            '    uint64_t encode_ns;',
+            '    uint64_t decode_ns;',
+            '    uint64_t bytes;',
+            '    uint32_t max_bytes;',
+            '} HarnessStats;',
+            '',
+            'typedef struct',
+            '{',
+            '    const char* name;',
+            '    uint32_t (*run)(uint32_t seed, HarnessStats* stats);    ///< Returns 1 if the round trip failed',
+            '} HarnessType;',
+            '',
+            'static uint8_t harnessSourcePool[HARNESS_POOL_SIZE] __attribute__((aligned(8)));',
+            'static uint8_t harnessDecodedPool[HARNESS_POOL_SIZE] __attribute__((aligned(8)));',
+            '',
+            'static uint64_t harnessNanoseconds(void);',
+            '',
+            RANDOM_SUPPORT]
+    out += ['static void fill_%s(%s* value, uint32_t* seed, uint8_t** pool);' % (s[0], s[0]) for s in structs]
+    out.append('')
+    for name, _, _, max_size, fields, union, max_bitlen in structs:
+        out += fill_function(name, fields, union, max_bitlen)
+        out.append('')
+        out.append(run_function(name, max_size))
+    out.append('static const HarnessType harnessTypes[] =')
+    out.append('{')
+    out += ['    { "%s", &run_%s },' % (full_name, name) for name, full_name, _, _, _, _, _ in structs]
+    out.append('};')
+    out.append('')
+    out.append(MAIN_FUNCTION)
+    return '\n'.join(out)
+
+
+def harness_cmake(header_only):
+    sources = '' if header_only else '''
+file(GLOB_RECURSE generated_sources ${CMAKE_CURRENT_SOURCE_DIR}/*.c)
+list(REMOVE_ITEM generated_sources ${CMAKE_CURRENT_SOURCE_DIR}/%s)''' % HARNESS_SOURCE_FILENAME
+    return '''#
+# Autogenerated by libcanard_dsdlc --emit_harness, do not edit.
+#
+# cmake -S <this directory> -B <build directory> -DCMAKE_BUILD_TYPE=Release
+# cmake --build <build directory> && <build directory>/canard_dsdl_harness
+#
+
+cmake_minimum_required(VERSION 3.1)
+project(canard_dsdl_harness C)
+
+set(LIBCANARD_DIR "%s" CACHE PATH "Directory of canard.c")
+%s
+add_executable(canard_dsdl_harness
+               %s
+               ${LIBCANARD_DIR}/canard.c
+               ${generated_sources})
+target_include_directories(canard_dsdl_harness
+                           PUBLIC ${CMAKE_CURRENT_SOURCE_DIR} ${LIBCANARD_DIR})
+set_property(TARGET canard_dsdl_harness PROPERTY C_STANDARD 99)
+
+# The memory blocks of the library hold 32-bit pointers
+if (CMAKE_SIZEOF_VOID_P EQUAL 8)
+    target_compile_definitions(canard_dsdl_harness
+                               PUBLIC CANARD_MEM_BLOCK_SIZE=64U)
+endif ()
+''' % (LIBCANARD_DIR.replace(os.path.sep, '/'), sources, HARNESS_SOURCE_FILENAME)
@@ -0,0 +1,320 @@
+#
+# UAVCAN DSDL compiler for libcanard
+#
+# Copyright (c) 2018 UAVCAN Team
+#
+
+'''
+Compilation of constant transfers into prebuilt CAN frames (libcanard_dsdlc --prebuild).
+
+The transfers are declared in a JSON file, a list of objects like this one:
+
+    {
+        "name": "node_info",                        C name of the CanardPrebuiltTransfer
+        "type": "uavcan.protocol.GetNodeInfo",      Full name of the data type
+        "kind": "response",                         "request" or "response", services only
+        "data_type_id": 1,                          Optional, the default data type ID otherwise
+        "values": {                                 Field values, missing fields are zero
+            "software_version": {"major": 1, "minor": 2},
+            "name": "org.example.node"
+        },
+        "variable": ["status"]                      Fields supplied when the transfer is sent
+    }
+
+Arrays are given as lists, arrays of bytes also as strings; the selected field of a union is the only key of its
+object, and integer fields can name a constant of their type. Variable fields must start on a byte boundary and have
+a constant length of whole bytes. The payload is laid out exactly like the generated C encoder does it, so sending the
+prebuilt transfer puts the same frames on the bus as encoding the structure and calling canardBroadcast() or
+canardRequestOrRespond().
+'''
+
+from __future__ import division, absolute_import, print_function, unicode_literals
+import json
+import os
+import re
+import struct
+
+CRC_POLYNOMIAL = 0x1021
+FRAME_PAYLOAD = 7           # Bytes of payload per frame, the tail byte excluded
+
+try:
+    STRING_TYPES = (str, unicode)   # Python 2.7
+except NameError:
+    STRING_TYPES = (str,)
+
+
+class PrebuildException(Exception):
+    pass
+
+
+def crc_add(crc, data):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ CRC_POLYNOMIAL) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def crc_shift(num_bytes):
+    '''x^(8 * num_bytes) modulo the CRC polynomial, see crcMultiply() in canard.c'''
+    value = 1
+    for _ in range(8 * num_bytes):
+        value <<= 1
+        if value & 0x10000:
+            value ^= 0x10000 | CRC_POLYNOMIAL
+    return value
+
+
+class BitStream(object):
+    def __init__(self):
+        self.bits = []
+        self.fields = {}                # Dotted field path -> (first bit, bit past the end, constant length)
+
+    def put(self, value, bitlen):
+        '''Puts the bytes of the value starting from the least significant one, like canardEncodeScalar() does'''
+        for shift in range(0, bitlen, 8):
+            width = min(8, bitlen - shift)
+            byte = (value >> shift) & ((1 << width) - 1)
+            self.bits += [(byte >> i) & 1 for i in reversed(range(width))]
+
+    def to_bytes(self):
+        padded = self.bits + [0] * (-len(self.bits) % 8)
+        return bytearray(int(''.join(str(b) for b in padded[i:i + 8]), 2) for i in range(0, len(padded), 8))
+
+
+def union_tag_bits(fields):
+    return len(fields).bit_length()     # Same as the C backend
+
+
+def integer_bits(t, value):
+    lo, hi = (-(1 << (t.bitlen - 1)), (1 << (t.bitlen - 1)) - 1) if t.kind == t.KIND_SIGNED_INT else \
+             (0, (1 << t.bitlen) - 1)
+    if t.cast_mode == t.CAST_MODE_SATURATED:
+        value = max(lo, min(hi, value))
+    return value & ((1 << t.bitlen) - 1)
+
+
+def float_bits(bitlen, value):
+    fmt = {16: ('<e', '<H'), 32: ('<f', '<I'), 64: ('<d', '<Q')}[bitlen]
+    try:
+        return struct.unpack(fmt[1], struct.pack(fmt[0], value))[0]
+    except OverflowError:
+        return 0xFC00 if value < 0 else 0x7C00       # float16 infinity, like canardConvertNativeFloatToFloat16()
+
+
+class Encoder(object):
+    def __init__(self, constants):
+        self.constants = constants
+
+    def primitive(self, stream, t, value, path):
+        if isinstance(value, STRING_TYPES):
+            if value not in self.constants:
+                raise PrebuildException('%s: unknown constant %s' % (path, value))
+            value = self.constants[value]
+        if t.kind == t.KIND_BOOLEAN:
+            stream.put(1 if value else 0, 1)
+        elif t.kind == t.KIND_FLOAT:
+            stream.put(float_bits(t.bitlen, float(value)), t.bitlen)
+        else:
+            if isinstance(value, float) and not value.is_integer():
+                raise PrebuildException('%s: integer expected' % path)
+            stream.put(integer_bits(t, int(value)), t.bitlen)
+
+    def array(self, stream, t, value, path, tail):
+        if isinstance(value, STRING_TYPES):
+            value = list(bytearray(value.encode('utf-8')))
+        value = list(value or [])
+        if len(value) > t.max_size:
+            raise PrebuildException('%s: %d items, at most %d allowed' % (path, len(value), t.max_size))
+        if t.mode == t.MODE_STATIC:
+            value += [None] * (t.max_size - len(value))
+        else:
+            item_bitlen = t.value_type.get_max_bitlen()
+            if not (tail and item_bitlen > 7):                      # Tail array optimization of the C backend
+                stream.put(len(value), t.max_size.bit_length())
+        for index, item in enumerate(value):
+            self.value(stream, t.value_type, item, '%s[%d]' % (path, index))
+
+    def compound(self, stream, fields, union, constants, value, path, root):
+        value = dict(value or {})
+        names = [f.name for f in fields if f.type.category != f.type.CATEGORY_VOID]
+        unknown = [k for k in value if k not in names]
+        if unknown:
+            raise PrebuildException('%s: no field %s' % (path or 'root', ', '.join(unknown)))
+        saved, self.constants = self.constants, dict((c.name, c.value) for c in constants)
+        if union:
+            if len(value) > 1:
+                raise PrebuildException('%s: a union holds one field' % (path or 'root'))
+            tag = names.index(list(value)[0]) if value else 0
+            stream.put(tag, union_tag_bits(fields))
+            selected = [fields[tag]]
+        else:
+            selected = fields
+        for f in selected:
+            field_path = (path + '.' + f.name) if path else f.name
+            begin = len(stream.bits)
+            if f.type.category == f.type.CATEGORY_VOID:
+                stream.put(0, f.type.bitlen)
+            elif f.type.category == f.type.CATEGORY_ARRAY:
+                self.array(stream, f.type, value.get(f.name), field_path, root and f is fields[-1])
+            else:
+                self.value(stream, f.type, value.get(f.name), field_path)
+            if f.type.category != f.type.CATEGORY_VOID:
+                fixed = f.type.get_min_bitlen() == f.type.get_max_bitlen()
+                stream.fields[field_path] = (begin, len(stream.bits), fixed)
+        self.constants = saved
+
+    def value(self, stream, t, value, path):
+        if t.category == t.CATEGORY_PRIMITIVE:
+            self.primitive(stream, t, 0 if value is None else value, path)
+        elif t.category == t.CATEGORY_COMPOUND:
+            self.compound(stream, t.fields, t.union, t.constants, value, path, False)
+        else:
+            raise PrebuildException('%s: arrays of arrays are not supported' % path)
+
+
+def frames_of(payload, crc):
+    '''Splits the payload into CAN frames the way libcanard does it, with the transfer ID bits zeroed'''
+    if len(payload) <= FRAME_PAYLOAD:
+        return [bytearray(payload) + bytearray([0xC0])]
+    stream = bytearray([crc & 0xFF, crc >> 8]) + payload
+    chunks = [stream[i:i + FRAME_PAYLOAD] for i in range(0, len(stream), FRAME_PAYLOAD)]
+    return [chunk + bytearray([(0x80 if index == 0 else 0) |
+                               (0x40 if index == len(chunks) - 1 else 0) |
+                               ((index & 1) << 5)])
+            for index, chunk in enumerate(chunks)]
+
+
+class Transfer(object):
+    def __init__(self, decl, types):
+        self.name = decl.get('name', '')
+        if not re.match(r'^[A-Za-z_][A-Za-z0-9_]*$', self.name):
+            raise PrebuildException('Invalid transfer name %r' % self.name)
+        t = types.get(decl.get('type'))
+        if t is None:
+            raise PrebuildException('%s: unknown data type %s' % (self.name, decl.get('type')))
+        kind = decl.get('kind')
+        if t.kind == t.KIND_SERVICE:
+            if kind not in ('request', 'response'):
+                raise PrebuildException('%s: the kind of a service transfer is "request" or "response"' % self.name)
+            fields = getattr(t, kind + '_fields')
+            union = getattr(t, kind + '_union')
+            constants = getattr(t, kind + '_constants')
+        else:
+            if kind is not None:
+                raise PrebuildException('%s: only service transfers have a kind' % self.name)
+            fields, union, constants = t.fields, t.union, t.constants
+        self.description = t.full_name + (' ' + kind if kind else '')
+
+        self.data_type_id = decl.get('data_type_id', t.default_dtid)
+        limit = 0xFF if t.kind == t.KIND_SERVICE else 0xFFFF
+        if self.data_type_id is None or not (0 <= self.data_type_id <= limit):
+            raise PrebuildException('%s: a data type ID from 0 to %d is needed' % (self.name, limit))
+
+        stream = BitStream()
+        Encoder({}).compound(stream, fields, union, constants, decl.get('values'), '', True)
+        self.payload = stream.to_bytes()
+        if len(self.payload) > 0xFFFF:
+            raise PrebuildException('%s: the payload is too long' % self.name)
+        crc = crc_add(crc_add(0xFFFF, struct.pack('<Q', t.get_data_type_signature())), self.payload)
+        self.frames = frames_of(self.payload, crc)
+        if len(self.frames) > 0xFF:
+            raise PrebuildException('%s: too many frames' % self.name)
+
+        self.fields = []
+        for path in decl.get('variable', []):
+            if path not in stream.fields:
+                raise PrebuildException('%s: no field %s' % (self.name, path))
+            begin, end, fixed = stream.fields[path]
+            if not fixed or begin % 8 or (end - begin) % 8 or begin == end:
+                raise PrebuildException('%s: the variable field %s must be whole bytes of constant length' %
+                                        (self.name, path))
+            offset, length = begin // 8, (end - begin) // 8
+            self.fields.append((path, offset, length, crc_shift(len(self.payload) - offset - length)))
+        self.fields.sort(key=lambda f: f[1])
+        for previous, following in zip(self.fields, self.fields[1:]):
+            if previous[1] + previous[2] > following[1]:
+                raise PrebuildException('%s: the variable fields %s and %s overlap' %
+                                        (self.name, previous[0], following[0]))
+
+    def declarations(self):
+        prefix = self.name.upper()
+        lines = ['/// %s: %d bytes in %d frame%s' % (self.description, len(self.payload), len(self.frames),
+                                                     's' if len(self.frames) > 1 else '')]
+        if self.fields:
+            lines.append('#define %-47s %dU' % (prefix + '_VARIABLE_SIZE', sum(f[2] for f in self.fields)))
+            index = 0
+            for path, offset, length, _ in self.fields:
+                lines.append('#define %-47s %dU     ///< %d bytes at payload offset %d' %
+                             ('%s_%s_INDEX' % (prefix, path.replace('.', '_').upper()), index, length, offset))
+                index += length
+        return lines
+
+    def definitions(self):
+        lines = ['static const uint8_t %s_frames[%dU * CANARD_CAN_FRAME_MAX_DATA_LEN] =' %
+                 (self.name, len(self.frames)), '{']
+        for frame in self.frames:
+            padded = frame + bytearray(8 - len(frame))
+            lines.append('    ' + ', '.join('0x%02X' % b for b in padded) + ',')
+        lines.append('};')
+        fields = 'NULL'
+        if self.fields:
+            lines += ['', 'static const CanardPrebuiltField %s_fields[%dU] =' % (self.name, len(self.fields)), '{']
+            lines += ['    { %dU, %dU, 0x%04XU },     // %s' % (offset, length, shift, path)
+                      for path, offset, length, shift in self.fields]
+            lines.append('};')
+            fields = '%s_fields' % self.name
+        lines += ['',
+                  '%sconst CanardPrebuiltTransfer %s =' % (self.storage, self.name),
+                  '{',
+                  '    %s_frames, %s, %dU, %dU, %dU, %dU' % (self.name, fields, self.data_type_id, len(self.payload),
+                                                          len(self.frames), len(self.fields)),
+                  '};']
+        return lines
+
+
+def guard_of(stem):
+    return re.sub(r'[^A-Za-z0-9]', '_', stem).upper() + '_H'
+
+
+def prebuild(spec_filename, types, header_only):
+    '''Returns {output filename: text} for the transfers declared in the spec file'''
+    with open(spec_filename) as f:
+        decls = json.load(f)
+    if not isinstance(decls, list):
+        raise PrebuildException('%s: a list of transfers expected' % spec_filename)
+    by_name = dict((t.full_name, t) for t in types)
+    transfers = [Transfer(d, by_name) for d in decls]
+    names = [t.name for t in transfers]
+    if len(set(names)) != len(names):
+        raise PrebuildException('%s: the transfer names must be unique' % spec_filename)
+
+    stem = os.path.splitext(os.path.basename(spec_filename))[0]
+    banner = ['/*',
+              ' * Prebuilt CAN frames of constant transfers, see canardBroadcastPrebuilt().',
+              ' *',
+              ' * Autogenerated by libcanard_dsdlc from %s, do not edit.' % os.path.basename(spec_filename),
+              ' */',
+              '']
+    header = banner + ['#ifndef %s' % guard_of(stem), '#define %s' % guard_of(stem), '',
+                       '#include "canard.h"', '',
+                       '#ifdef __cplusplus', 'extern "C"', '{', '#endif', '']
+    for t in transfers:
+        header += t.declarations()
+        if header_only:
+            t.storage = 'static '
+            header += t.definitions()
+        else:
+            t.storage = ''
+            header.append('extern const CanardPrebuiltTransfer %s;' % t.name)
+        header.append('')
+    header += ['#ifdef __cplusplus', '}', '#endif', '#endif']
+    out = {stem + '.h': '\n'.join(header) + '\n'}
+
+    if not header_only:
+        code = banner + ['#include "%s.h"' % stem, '']
+        for t in transfers:
+            code += t.definitions() + ['']
+        out[stem + '.c'] = '\n'.join(code[:-1]) + '\n'
+    return out
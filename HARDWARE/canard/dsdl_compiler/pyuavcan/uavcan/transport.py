@@ -16,6 +16,11 @@ import struct
 import functools
 import collections
 
+try:
+    from collections.abc import MutableSequence     # Python 3.3+; the alias in collections was removed in 3.10
+except ImportError:
+    from collections import MutableSequence
+
 import uavcan
 import uavcan.dsdl as dsdl
 import uavcan.dsdl.common as common
@@ -317,7 +322,7 @@ class PrimitiveValue(BaseValue):
 
 
 # noinspection PyProtectedMember
-class ArrayValue(BaseValue, collections.MutableSequence):
+class ArrayValue(BaseValue, MutableSequence):
     def __init__(self, _uavcan_type, *args, **kwargs):
         super(ArrayValue, self).__init__(_uavcan_type, *args, **kwargs)
 
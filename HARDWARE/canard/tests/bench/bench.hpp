@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * Minimal micro-benchmark harness with no dependencies. A benchmark is a function that runs the measured operation
+ * in batches for as long as State::run() asks for more; work that must not be measured is put between
+ * State::pause() and State::resume(). Every benchmark is repeated several times, and the results are written as JSON:
+ *
+ *   {
+ *     "context": { "compiler": "...", "build_type": "Release", "host": "...", "cpu": "...", "git_hash": "...", ... },
+ *     "benchmarks": [
+ *       { "name": "tx/broadcast/single_frame", "unit": "transfer", "bytes_per_op": 7, "repetitions": 5,
+ *         "iterations": 1234567, "median_ns": 51.2, "mad_ns": 0.2, "min_ns": 50.9, "max_ns": 53.0,
+ *         "samples_ns": [ ... ] },
+ *       ...
+ *     ]
+ *   }
+ *
+ * The times are per operation, the unit of which is given by the benchmark; mad_ns is the median absolute deviation of
+ * the samples. The context records the machine and the commit, so that a stored report can serve as the baseline of
+ * bench_compare (see compare.hpp).
+ */
+
+#ifndef CANARD_BENCH_HPP
+#define CANARD_BENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include "canard.h"
+
+#ifndef CANARD_BENCH_BUILD_TYPE
+# define CANARD_BENCH_BUILD_TYPE ""
+#endif
+
+#ifndef CANARD_BENCH_GIT_HASH
+# define CANARD_BENCH_GIT_HASH ""
+#endif
+
+namespace bench
+{
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Prevents the compiler from optimizing away the computation of the value.
+ */
+template <typename T>
+inline void keep(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Measurement state of one repetition of a benchmark.
+ */
+class State
+{
+    const Clock::duration min_time_;
+    Clock::time_point started_at_;
+    Clock::duration elapsed_ = Clock::duration::zero();
+    uint64_t iterations_ = 0;
+    uint32_t pending_ = 0;
+    bool running_ = false;
+
+public:
+    explicit State(Clock::duration min_time) : min_time_(min_time) { }
+
+    /**
+     * Accounts the previous batch and returns true if another batch of the given number of operations must be run.
+     * The clock runs from the first call to the last one, except between pause() and resume().
+     */
+    bool run(uint32_t batch)
+    {
+        const Clock::time_point now = Clock::now();
+        if (running_)
+        {
+            elapsed_ += now - started_at_;
+            iterations_ += pending_;
+        }
+        if ((iterations_ > 0) && (elapsed_ >= min_time_))
+        {
+            running_ = false;
+            return false;
+        }
+        pending_ = batch;
+        running_ = true;
+        started_at_ = Clock::now();
+        return true;
+    }
+
+    void pause()
+    {
+        elapsed_ += Clock::now() - started_at_;
+    }
+
+    void resume()
+    {
+        started_at_ = Clock::now();
+    }
+
+    uint64_t iterations() const { return iterations_; }
+
+    double nanosecondsPerOperation() const
+    {
+        return std::chrono::duration<double, std::nano>(elapsed_).count() / double(iterations_);
+    }
+};
+
+struct Benchmark
+{
+    const char* name;           ///< Slash-separated, e.g. "rx/single_frame"
+    const char* unit;           ///< What one operation is, e.g. "frame" or "call"
+    uint32_t bytes_per_op;      ///< Payload bytes processed per operation, zero if not applicable
+    void (*function)(State& state);
+};
+
+struct Options
+{
+    std::string filter;
+    std::string output;
+    unsigned repetitions = 5;
+    unsigned min_time_ms = 100;
+};
+
+/**
+ * Median of the samples; the vector is sorted in place.
+ */
+inline double median(std::vector<double>& samples)
+{
+    if (samples.empty())
+    {
+        return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    const size_t n = samples.size();
+    return ((n % 2U) != 0U) ? samples[n / 2U] : ((samples[n / 2U - 1U] + samples[n / 2U]) / 2.0);
+}
+
+/**
+ * Median absolute deviation of the samples from their median: a spread that, unlike the standard deviation, is not
+ * thrown off by the odd repetition interrupted by the OS.
+ */
+inline double medianAbsoluteDeviation(const std::vector<double>& samples, double center)
+{
+    std::vector<double> deviations;
+    for (double sample : samples)
+    {
+        deviations.push_back((sample > center) ? (sample - center) : (center - sample));
+    }
+    return median(deviations);
+}
+
+inline void writeJsonString(std::FILE* out, const std::string& text)
+{
+    std::fputc('"', out);
+    for (char c : text)
+    {
+        if ((c == '"') || (c == '\\'))
+        {
+            std::fprintf(out, "\\%c", c);
+        }
+        else if (static_cast<unsigned char>(c) < 0x20U)
+        {
+            std::fprintf(out, "\\u%04x", unsigned(static_cast<unsigned char>(c)));
+        }
+        else
+        {
+            std::fputc(c, out);
+        }
+    }
+    std::fputc('"', out);
+}
+
+/**
+ * Model of the CPU from /proc/cpuinfo, or an empty string where there is none.
+ */
+inline std::string getCpuModel()
+{
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line))
+    {
+        const size_t colon = line.find(':');
+        if ((line.compare(0, 10, "model name") == 0) && (colon != std::string::npos))
+        {
+            const size_t begin = line.find_first_not_of(" \t", colon + 1U);
+            return (begin != std::string::npos) ? line.substr(begin) : std::string();
+        }
+    }
+    return std::string();
+}
+
+inline void writeContext(std::FILE* out, const Options& options)
+{
+    char host[256] = "";
+    (void)gethostname(host, sizeof(host) - 1U);
+    struct utsname system;
+    std::memset(&system, 0, sizeof(system));
+    (void)uname(&system);
+    char timestamp[32] = "";
+    const std::time_t now = std::time(nullptr);
+    (void)std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    std::fprintf(out, "{\n  \"context\": {\n");
+    std::fprintf(out, "    \"library\": \"libcanard\",\n");
+#if defined(__clang__)
+    std::fprintf(out, "    \"compiler\": \"clang %s\",\n", __clang_version__);
+#elif defined(__GNUC__)
+    std::fprintf(out, "    \"compiler\": \"gcc %s\",\n", __VERSION__);
+#endif
+    std::fprintf(out, "    \"build_type\": \"%s\",\n", CANARD_BENCH_BUILD_TYPE);
+    std::fprintf(out, "    \"pointer_size\": %u,\n", unsigned(sizeof(void*)));
+    std::fprintf(out, "    \"mem_block_size\": %u,\n", unsigned(CANARD_MEM_BLOCK_SIZE));
+    std::fprintf(out, "    \"host\": ");
+    writeJsonString(out, host);
+    std::fprintf(out, ",\n    \"cpu\": ");
+    writeJsonString(out, getCpuModel());
+    std::fprintf(out, ",\n    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+    std::fprintf(out, "    \"kernel\": ");
+    writeJsonString(out, std::string(system.sysname) + " " + system.release + " " + system.machine);
+    std::fprintf(out, ",\n    \"git_hash\": \"%s\",\n", CANARD_BENCH_GIT_HASH);
+    std::fprintf(out, "    \"timestamp\": \"%s\",\n", timestamp);
+    std::fprintf(out, "    \"repetitions\": %u,\n", options.repetitions);
+    std::fprintf(out, "    \"min_time_ms\": %u\n", options.min_time_ms);
+    std::fprintf(out, "  },\n  \"benchmarks\": [");
+}
+
+inline void printUsage(const char* program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [--filter <substring>] [--repetitions <n>] [--min-time <ms>] [--output <file.json>]\n"
+                 "The results are written as JSON to the output file, or to stdout if none is given.\n",
+                 program);
+}
+
+inline bool parseOptions(int argc, char** argv, Options& out_options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if ((arg == "--help") || (arg == "-h") || (i + 1 >= argc))
+        {
+            return false;
+        }
+        const char* const value = argv[++i];
+        if (arg == "--filter")
+        {
+            out_options.filter = value;
+        }
+        else if (arg == "--output")
+        {
+            out_options.output = value;
+        }
+        else if ((arg == "--repetitions") || (arg == "--min-time"))
+        {
+            char* end = nullptr;
+            const unsigned long number = std::strtoul(value, &end, 10);
+            if ((*end != '\0') || (number == 0) || (number > 100000UL))
+            {
+                return false;
+            }
+            ((arg == "--repetitions") ? out_options.repetitions : out_options.min_time_ms) = unsigned(number);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Runs the benchmarks selected by the command line options and writes the JSON report.
+ * Progress goes to stderr. Returns the exit status of the program.
+ */
+inline int runBenchmarks(const Benchmark* benchmarks, size_t count, int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::FILE* const out = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "w");
+    if (out == nullptr)
+    {
+        std::perror(options.output.c_str());
+        return 1;
+    }
+
+    writeContext(out, options);
+
+    bool first = true;
+    for (size_t i = 0; i < count; i++)
+    {
+        const Benchmark& b = benchmarks[i];
+        if (std::strstr(b.name, options.filter.c_str()) == nullptr)
+        {
+            continue;
+        }
+
+        std::vector<double> samples;
+        uint64_t iterations = 0;
+        for (unsigned r = 0; r < options.repetitions; r++)
+        {
+            State state(std::chrono::milliseconds(options.min_time_ms));
+            b.function(state);
+            samples.push_back(state.nanosecondsPerOperation());
+            iterations += state.iterations();
+        }
+        std::vector<double> sorted = samples;
+        const double center = median(sorted);
+
+        std::fprintf(stderr, "%-44s %12.1f ns/%s\n", b.name, center, b.unit);
+
+        std::fprintf(out, "%s\n    {\n", first ? "" : ",");
+        first = false;
+        std::fprintf(out, "      \"name\": \"%s\",\n", b.name);
+        std::fprintf(out, "      \"unit\": \"%s\",\n", b.unit);
+        std::fprintf(out, "      \"bytes_per_op\": %u,\n", unsigned(b.bytes_per_op));
+        std::fprintf(out, "      \"repetitions\": %u,\n", options.repetitions);
+        std::fprintf(out, "      \"iterations\": %llu,\n", static_cast<unsigned long long>(iterations));
+        std::fprintf(out, "      \"median_ns\": %.3f,\n", center);
+        std::fprintf(out, "      \"mad_ns\": %.3f,\n", medianAbsoluteDeviation(samples, center));
+        std::fprintf(out, "      \"min_ns\": %.3f,\n", sorted.front());
+        std::fprintf(out, "      \"max_ns\": %.3f,\n", sorted.back());
+        std::fprintf(out, "      \"samples_ns\": [");
+        for (size_t k = 0; k < samples.size(); k++)
+        {
+            std::fprintf(out, "%s%.3f", (k == 0) ? "" : ", ", samples[k]);
+        }
+        std::fprintf(out, "]\n    }");
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout)
+    {
+        std::fclose(out);
+    }
+    return 0;
+}
+
+}
+
+#endif
@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * Micro-benchmarks of the hot paths of the library: transmission, the TX queue, reception of single-frame,
+ * multi-frame and interleaved transfers from many nodes, the scalar codecs, bit copying, the transfer CRC and the
+ * memory pool. See bench.hpp for the command line options and the format of the report.
+ * The numbers are only meaningful in an optimized build (CMAKE_BUILD_TYPE=Release).
+ */
+
+#include <vector>
+#include "bench.hpp"
+#include "canard.h"
+#include "canard_internals.h"
+
+#if CANARD_ENABLE_STATIC_CAPACITY || CANARD_ENABLE_CONCURRENCY
+# error "The benchmarks are written for the default configuration of the library"
+#endif
+
+namespace
+{
+
+const uint16_t DataTypeID = 1000;
+const uint64_t DataTypeSignature = 0x0123456789ABCDEFULL;
+const uint8_t LocalNodeID = 42;
+const uint16_t MultiFramePayloadLength = 64;
+
+uint32_t g_received = 0;
+
+bool shouldAcceptTransfer(const CanardInstance*,
+                          uint64_t* out_data_type_signature,
+                          uint16_t,
+                          CanardTransferType,
+                          uint8_t)
+{
+    *out_data_type_signature = DataTypeSignature;
+    return true;
+}
+
+void onTransferReception(CanardInstance*, CanardRxTransfer* transfer)
+{
+    g_received += transfer->payload_len;
+}
+
+/**
+ * Library instance with its own memory pool.
+ */
+struct Node
+{
+    std::vector<CanardPoolAllocatorBlock> arena;
+    CanardInstance ins;
+
+    explicit Node(uint8_t node_id, size_t blocks = 512) : arena(blocks)
+    {
+        canardInit(&ins, arena.data(), arena.size() * sizeof(CanardPoolAllocatorBlock),
+                   &onTransferReception, &shouldAcceptTransfer, nullptr);
+        canardSetLocalNodeID(&ins, node_id);
+    }
+
+    void drain()
+    {
+        for (const CanardCANFrame* frame = canardPeekTxQueue(&ins); frame != nullptr; frame = canardPeekTxQueue(&ins))
+        {
+            canardPopTxQueue(&ins);
+        }
+    }
+};
+
+uint32_t nextRandom(uint32_t& seed)
+{
+    seed = seed * 1664525U + 1013904223U;
+    return seed >> 8U;
+}
+
+std::vector<uint8_t> makePayload(uint16_t length)
+{
+    std::vector<uint8_t> payload(length);
+    for (uint16_t i = 0; i < length; i++)
+    {
+        payload[i] = uint8_t(i * 37U + 11U);
+    }
+    return payload;
+}
+
+/**
+ * Frames of count consecutive transfers of the given payload length, sent by the given node.
+ * The count should be a multiple of 32, so that replaying the frames in a loop keeps the transfer IDs in sequence.
+ */
+std::vector<CanardCANFrame> makeFrames(uint8_t source_node_id, uint16_t payload_len, unsigned count)
+{
+    Node sender(source_node_id);
+    const std::vector<uint8_t> payload = makePayload(payload_len);
+    std::vector<CanardCANFrame> frames;
+    uint8_t transfer_id = 0;
+    for (unsigned i = 0; i < count; i++)
+    {
+        (void) canardBroadcast(&sender.ins, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                               payload.data(), payload_len);
+        for (const CanardCANFrame* f = canardPeekTxQueue(&sender.ins); f != nullptr; f = canardPeekTxQueue(&sender.ins))
+        {
+            frames.push_back(*f);
+            canardPopTxQueue(&sender.ins);
+        }
+    }
+    return frames;
+}
+
+/*
+ * Transmission
+ */
+void benchBroadcast(bench::State& state, uint16_t payload_len, uint32_t batch)
+{
+    Node node(LocalNodeID);
+    const std::vector<uint8_t> payload = makePayload(payload_len);
+    uint8_t transfer_id = 0;
+    while (state.run(batch))
+    {
+        for (uint32_t i = 0; i < batch; i++)
+        {
+            bench::keep(canardBroadcast(&node.ins, DataTypeSignature, DataTypeID, &transfer_id,
+                                        CANARD_TRANSFER_PRIORITY_LOW, payload.data(), payload_len));
+        }
+        state.pause();
+        node.drain();
+        state.resume();
+    }
+}
+
+void benchBroadcastSingleFrame(bench::State& state)
+{
+    benchBroadcast(state, 7, 64);
+}
+
+void benchBroadcastMultiFrame(bench::State& state)
+{
+    benchBroadcast(state, MultiFramePayloadLength, 16);
+}
+
+/**
+ * Builds a TX queue of 64 frames with random priorities, one insertion per operation.
+ */
+void benchPushTxQueue(bench::State& state)
+{
+    static const uint32_t Depth = 64;
+    Node node(LocalNodeID);
+    CanardTxQueueItem items[Depth];
+    uint32_t seed = 1;
+    for (auto& item : items)
+    {
+        item = CanardTxQueueItem();
+        item.frame.id = uint32_t((nextRandom(seed) & CANARD_CAN_EXT_ID_MASK) | CANARD_CAN_FRAME_EFF);
+        item.frame.data_len = 8;
+    }
+    while (state.run(Depth))
+    {
+        for (auto& item : items)
+        {
+            pushTxQueue(&node.ins, &item);
+        }
+        state.pause();
+        bench::keep(node.ins.tx_queue);
+        node.ins.tx_queue = nullptr;
+        for (auto& item : items)
+        {
+            item.next = nullptr;
+        }
+        state.resume();
+    }
+}
+
+/*
+ * Reception
+ */
+void replayFrames(bench::State& state, const std::vector<CanardCANFrame>& frames, uint32_t transfers)
+{
+    Node node(LocalNodeID);
+    uint64_t timestamp_usec = 1000000;
+    while (state.run(transfers))
+    {
+        for (const auto& frame : frames)
+        {
+            canardHandleRxFrame(&node.ins, &frame, timestamp_usec);
+            timestamp_usec += 10U;
+        }
+    }
+    bench::keep(g_received);
+}
+
+void benchRxSingleFrame(bench::State& state)
+{
+    replayFrames(state, makeFrames(10, 7, 32), 32);
+}
+
+void benchRxMultiFrame(bench::State& state)
+{
+    replayFrames(state, makeFrames(10, MultiFramePayloadLength, 32), 32);
+}
+
+/**
+ * 32 nodes send multi-frame transfers at the same time; the frames of their transfers are interleaved,
+ * so the receiver holds 32 RX states and looks one up for every frame.
+ */
+void benchRxManySessions(bench::State& state)
+{
+    static const unsigned Sessions = 32;
+    static const unsigned Rounds = 32;
+    std::vector<std::vector<CanardCANFrame>> per_node;
+    for (unsigned i = 0; i < Sessions; i++)
+    {
+        per_node.push_back(makeFrames(uint8_t(i + 1U), MultiFramePayloadLength, Rounds));
+    }
+    const size_t frames_per_transfer = per_node[0].size() / Rounds;
+    std::vector<CanardCANFrame> frames;
+    for (unsigned round = 0; round < Rounds; round++)
+    {
+        for (size_t k = 0; k < frames_per_transfer; k++)
+        {
+            for (const auto& node_frames : per_node)
+            {
+                frames.push_back(node_frames[round * frames_per_transfer + k]);
+            }
+        }
+    }
+    replayFrames(state, frames, Sessions * Rounds);
+}
+
+/*
+ * Scalar codecs and bit copying
+ */
+void benchDecodeScalar(bench::State& state, uint8_t bit_length, uint32_t bit_step)
+{
+    uint8_t head[CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE];
+    std::vector<CanardPoolAllocatorBlock> blocks(4);
+    CanardPoolAllocator allocator;
+    initPoolAllocator(&allocator, blocks.data(), uint16_t(blocks.size()));
+    CanardBufferBlock* const middle_a = createBufferBlock(&allocator);
+    CanardBufferBlock* const middle_b = createBufferBlock(&allocator);
+    middle_a->next = middle_b;
+    uint8_t tail[7];
+    const std::vector<uint8_t> payload = makePayload(sizeof(head) + CANARD_BUFFER_BLOCK_DATA_SIZE * 2U + sizeof(tail));
+    std::memcpy(head, &payload[0], sizeof(head));
+    std::memcpy(middle_a->data, &payload[sizeof(head)], CANARD_BUFFER_BLOCK_DATA_SIZE);
+    std::memcpy(middle_b->data, &payload[sizeof(head) + CANARD_BUFFER_BLOCK_DATA_SIZE], CANARD_BUFFER_BLOCK_DATA_SIZE);
+    std::memcpy(tail, &payload[payload.size() - sizeof(tail)], sizeof(tail));
+
+    CanardRxTransfer transfer = CanardRxTransfer();
+    transfer.payload_head = head;
+    transfer.payload_middle = middle_a;
+    transfer.payload_tail = tail;
+    transfer.payload_len = uint16_t(payload.size());
+
+    const uint32_t batch = (transfer.payload_len * 8U - bit_length) / bit_step + 1U;
+    while (state.run(batch))
+    {
+        for (uint32_t offset = 0; offset + bit_length <= transfer.payload_len * 8U; offset += bit_step)
+        {
+            uint32_t value = 0;
+            bench::keep(canardDecodeScalar(&transfer, offset, bit_length, false, &value));
+            bench::keep(value);
+        }
+    }
+}
+
+void benchDecodeScalar13(bench::State& state)
+{
+    benchDecodeScalar(state, 13, 13);
+}
+
+void benchDecodeScalar32Aligned(bench::State& state)
+{
+    benchDecodeScalar(state, 32, 32);
+}
+
+void benchEncodeScalar(bench::State& state, uint8_t bit_length, uint32_t bit_step)
+{
+    static const uint32_t BufferBits = 64U * 8U;
+    uint8_t buffer[BufferBits / 8U] = {};
+    const uint32_t batch = (BufferBits - bit_length) / bit_step + 1U;
+    uint32_t value = 0x5A5A5A5AU;
+    while (state.run(batch))
+    {
+        for (uint32_t offset = 0; offset + bit_length <= BufferBits; offset += bit_step)
+        {
+            canardEncodeScalar(buffer, offset, bit_length, &value);
+            value++;
+        }
+        bench::keep(buffer);
+    }
+}
+
+void benchEncodeScalar13(bench::State& state)
+{
+    benchEncodeScalar(state, 13, 13);
+}
+
+void benchEncodeScalar32Aligned(bench::State& state)
+{
+    benchEncodeScalar(state, 32, 32);
+}
+
+void benchCopyBitArray(bench::State& state, uint32_t src_offset, uint32_t dst_offset)
+{
+    const std::vector<uint8_t> src = makePayload(65);
+    uint8_t dst[65] = {};
+    while (state.run(64))
+    {
+        for (unsigned i = 0; i < 64; i++)
+        {
+            copyBitArray(src.data(), src_offset, 64U * 8U, dst, dst_offset);
+        }
+        bench::keep(dst);
+    }
+}
+
+void benchCopyBitArrayAligned(bench::State& state)
+{
+    benchCopyBitArray(state, 0, 0);
+}
+
+void benchCopyBitArrayUnaligned(bench::State& state)
+{
+    benchCopyBitArray(state, 3, 5);
+}
+
+/*
+ * Transfer CRC and memory pool
+ */
+void benchCrcAdd(bench::State& state)
+{
+    const std::vector<uint8_t> payload = makePayload(MultiFramePayloadLength);
+    uint16_t crc = 0xFFFFU;
+    while (state.run(64))
+    {
+        for (unsigned i = 0; i < 64; i++)
+        {
+            crc = crcAdd(crc, payload.data(), payload.size());
+        }
+        bench::keep(crc);
+    }
+}
+
+void benchCrcAddSignature(bench::State& state)
+{
+    uint64_t signature = DataTypeSignature;
+    while (state.run(64))
+    {
+        for (unsigned i = 0; i < 64; i++)
+        {
+            bench::keep(crcAddSignature(0xFFFFU, signature));
+            signature++;
+        }
+    }
+}
+
+void benchAllocateFree(bench::State& state)
+{
+    std::vector<CanardPoolAllocatorBlock> blocks(64);
+    CanardPoolAllocator allocator;
+    initPoolAllocator(&allocator, blocks.data(), uint16_t(blocks.size()));
+    void* allocated[16];
+    while (state.run(16))
+    {
+        for (auto& block : allocated)
+        {
+            block = allocateBlock(&allocator, CanardPoolOwnerTxFrame);
+        }
+        for (auto& block : allocated)
+        {
+            freeBlock(&allocator, CanardPoolOwnerTxFrame, block);
+        }
+        bench::keep(allocated);
+    }
+}
+
+const bench::Benchmark Benchmarks[] =
+{
+    { "tx/broadcast/single_frame",          "transfer", 7,                       &benchBroadcastSingleFrame },
+    { "tx/broadcast/multi_frame_64B",       "transfer", MultiFramePayloadLength, &benchBroadcastMultiFrame },
+    { "tx/push_tx_queue/64_frames",         "frame",    0,                       &benchPushTxQueue },
+    { "rx/single_frame",                    "transfer", 7,                       &benchRxSingleFrame },
+    { "rx/multi_frame_64B",                 "transfer", MultiFramePayloadLength, &benchRxMultiFrame },
+    { "rx/multi_frame_64B/32_sessions",     "transfer", MultiFramePayloadLength, &benchRxManySessions },
+    { "codec/decode_scalar/13_bit",         "call",     0,                       &benchDecodeScalar13 },
+    { "codec/decode_scalar/32_bit_aligned", "call",     4,                       &benchDecodeScalar32Aligned },
+    { "codec/encode_scalar/13_bit",         "call",     0,                       &benchEncodeScalar13 },
+    { "codec/encode_scalar/32_bit_aligned", "call",     4,                       &benchEncodeScalar32Aligned },
+    { "bits/copy_bit_array/64B_aligned",    "call",     64,                      &benchCopyBitArrayAligned },
+    { "bits/copy_bit_array/64B_unaligned",  "call",     64,                      &benchCopyBitArrayUnaligned },
+    { "crc/add/64B",                        "call",     MultiFramePayloadLength, &benchCrcAdd },
+    { "crc/add_signature",                  "call",     8,                       &benchCrcAddSignature },
+    { "alloc/allocate_free",                "block",    0,                       &benchAllocateFree },
+};
+
+}
+
+int main(int argc, char** argv)
+{
+    return bench::runBenchmarks(Benchmarks, sizeof(Benchmarks) / sizeof(Benchmarks[0]), argc, argv);
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * Compares a benchmark report with its baseline and prints a table of the changes per benchmark; see compare.hpp for
+ * the statistics. Exits with 1 if a benchmark regressed, so that it can gate a change:
+ *
+ *   bench --output baseline.json               # On the base of the change
+ *   bench --output candidate.json              # With the change
+ *   bench_compare baseline.json candidate.json --threshold 5 --threshold-for crc/=2
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "compare.hpp"
+
+namespace
+{
+
+bool readReport(const char* path, bench::Report& out_report)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::fprintf(stderr, "Failed to open '%s'\n", path);
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    std::string error;
+    if (!bench::parseReport(text.str(), out_report, error))
+    {
+        std::fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string getContext(const bench::Report& report, const std::string& key)
+{
+    for (const auto& entry : report.context)
+    {
+        if (entry.first == key)
+        {
+            return entry.second;
+        }
+    }
+    return "?";
+}
+
+std::string formatValue(const bench::Result& result)
+{
+    char buffer[64];
+    if (result.num_samples == 0)
+    {
+        return "-";
+    }
+    if (result.mad > 0.0)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.1f +-%.1f", result.median, result.mad);
+    }
+    else
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.1f", result.median);
+    }
+    return buffer;
+}
+
+bool parsePercent(const char* text, double& out)
+{
+    char* end = nullptr;
+    out = std::strtod(text, &end);
+    return (end != text) && (*end == '\0') && (out >= 0.0);
+}
+
+int printUsage(const char* program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s <baseline.json> <candidate.json> [--threshold <percent>] [--threshold-for <name>=<percent>]\n"
+                 "       [--noise-factor <k>] [--filter <substring>]\n"
+                 "A benchmark regresses when its median grows by more than the threshold, 5%% by default, and by more\n"
+                 "than k (3 by default) times the combined spread of the two runs. --threshold-for applies to the\n"
+                 "benchmarks whose name contains the given string. Exits with 1 on a regression, 2 on an error.\n",
+                 program);
+    return 2;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        return printUsage(argv[0]);
+    }
+
+    bench::Thresholds thresholds;
+    std::string filter;
+    for (int i = 3; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            return printUsage(argv[0]);
+        }
+        const char* const value = argv[++i];
+        if (arg == "--threshold")
+        {
+            if (!parsePercent(value, thresholds.percent))
+            {
+                return printUsage(argv[0]);
+            }
+        }
+        else if (arg == "--threshold-for")
+        {
+            const std::string spec = value;
+            const size_t equals = spec.rfind('=');
+            double percent = 0.0;
+            if ((equals == std::string::npos) || (equals == 0) || !parsePercent(spec.c_str() + equals + 1, percent))
+            {
+                return printUsage(argv[0]);
+            }
+            thresholds.overrides.push_back(std::make_pair(spec.substr(0, equals), percent));
+        }
+        else if (arg == "--noise-factor")
+        {
+            if (!parsePercent(value, thresholds.noise_factor))
+            {
+                return printUsage(argv[0]);
+            }
+        }
+        else if (arg == "--filter")
+        {
+            filter = value;
+        }
+        else
+        {
+            return printUsage(argv[0]);
+        }
+    }
+
+    bench::Report baseline;
+    bench::Report candidate;
+    if (!readReport(argv[1], baseline) || !readReport(argv[2], candidate))
+    {
+        return 2;
+    }
+
+    std::printf("Baseline:  %s, commit %s, %s\n", argv[1], getContext(baseline, "git_hash").c_str(),
+                getContext(baseline, "timestamp").c_str());
+    std::printf("Candidate: %s, commit %s, %s\n", argv[2], getContext(candidate, "git_hash").c_str(),
+                getContext(candidate, "timestamp").c_str());
+    for (const std::string& difference : bench::getEnvironmentDifferences(baseline, candidate))
+    {
+        std::printf("WARNING: the environments differ, %s\n", difference.c_str());
+    }
+
+    std::printf("\n%-40s %22s %22s %9s %7s  %s\n", "benchmark", "baseline", "candidate", "change", "limit", "verdict");
+    unsigned regressions = 0;
+    for (const bench::Comparison& c : bench::compareReports(baseline, candidate, thresholds))
+    {
+        if (c.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        const bench::Result& any = (c.verdict == bench::Verdict::Added) ? c.candidate : c.baseline;
+        const std::string unit = any.metric + "/" + any.unit;
+        const bool compared = (c.verdict != bench::Verdict::Missing) && (c.verdict != bench::Verdict::Added);
+        char change[16] = "";
+        char limit[16] = "";
+        if (compared)
+        {
+            std::snprintf(change, sizeof(change), "%+.1f%%", c.change_percent);
+            std::snprintf(limit, sizeof(limit), "%.1f%%", c.threshold_percent);
+        }
+        std::printf("%-40s %22s %22s %9s %7s  %s (%s)\n", c.name.c_str(), formatValue(c.baseline).c_str(),
+                    formatValue(c.candidate).c_str(), change, limit, bench::getVerdictName(c.verdict), unit.c_str());
+        regressions += (c.verdict == bench::Verdict::Regressed) ? 1U : 0U;
+    }
+
+    if (regressions > 0)
+    {
+        std::printf("\n%u benchmark(s) regressed\n", regressions);
+        return 1;
+    }
+    std::printf("\nNo regressions\n");
+    return 0;
+}
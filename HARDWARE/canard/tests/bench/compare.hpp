@@ -0,0 +1,588 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * Comparison of two benchmark reports, a baseline and a candidate, for bench_compare. The reports are those of the
+ * host benchmarks (bench.hpp), compared by the median time per operation, or those of the Cortex-M3 instruction counts
+ * (tests/mcu), compared by instructions per operation.
+ *
+ * A benchmark regresses when its median grows by more than its threshold, in percent, and the growth is also larger
+ * than the noise: the noise factor times the combined spread of the two runs, where the spread of a run is its median
+ * absolute deviation scaled to estimate the standard deviation. A change past the threshold that is within the noise
+ * is reported as noisy and does not fail; more repetitions narrow the spread. Instruction counts have no spread.
+ */
+
+#ifndef CANARD_BENCH_COMPARE_HPP
+#define CANARD_BENCH_COMPARE_HPP
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bench.hpp"
+
+namespace bench
+{
+namespace json
+{
+
+/**
+ * Parsed JSON value; enough of JSON for the reports, which are written by the tools of this repository.
+ */
+struct Value
+{
+    enum Type { Null, Boolean, Number, String, Array, Object };
+
+    Type type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<Value> array;
+    std::vector<std::pair<std::string, Value> > object;
+
+    /**
+     * Returns the member with the given key, or nullptr if this is not an object or has no such member.
+     */
+    const Value* find(const std::string& key) const
+    {
+        for (const auto& member : object)
+        {
+            if (member.first == key)
+            {
+                return &member.second;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Text of a scalar for the comparison of the contexts.
+     */
+    std::string toString() const
+    {
+        switch (type)
+        {
+        case Boolean:
+            return boolean ? "true" : "false";
+        case Number:
+        {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%g", number);
+            return buffer;
+        }
+        case String:
+            return string;
+        case Null:
+        case Array:
+        case Object:
+        default:
+            return "";
+        }
+    }
+};
+
+class Parser
+{
+    const std::string& text_;
+    size_t pos_ = 0;
+    std::string error_;
+
+    void skipSpace()
+    {
+        while ((pos_ < text_.size()) &&
+               ((text_[pos_] == ' ') || (text_[pos_] == '\t') || (text_[pos_] == '\n') || (text_[pos_] == '\r')))
+        {
+            pos_++;
+        }
+    }
+
+    bool fail(const char* what)
+    {
+        if (error_.empty())
+        {
+            error_ = std::string(what) + " at offset " + std::to_string(pos_);
+        }
+        return false;
+    }
+
+    bool consume(char c)
+    {
+        skipSpace();
+        if ((pos_ < text_.size()) && (text_[pos_] == c))
+        {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseLiteral(const char* literal)
+    {
+        const size_t len = std::strlen(literal);
+        if (text_.compare(pos_, len, literal) != 0)
+        {
+            return fail("invalid literal");
+        }
+        pos_ += len;
+        return true;
+    }
+
+    bool parseString(std::string& out)
+    {
+        if (!consume('"'))
+        {
+            return fail("expected a string");
+        }
+        while (pos_ < text_.size())
+        {
+            const char c = text_[pos_++];
+            if (c == '"')
+            {
+                return true;
+            }
+            if (c != '\\')
+            {
+                out.push_back(c);
+                continue;
+            }
+            if (pos_ >= text_.size())
+            {
+                break;
+            }
+            const char escaped = text_[pos_++];
+            switch (escaped)
+            {
+            case 'n':
+                out.push_back('\n');
+                break;
+            case 't':
+                out.push_back('\t');
+                break;
+            case 'r':
+                out.push_back('\r');
+                break;
+            case 'b':
+                out.push_back('\b');
+                break;
+            case 'f':
+                out.push_back('\f');
+                break;
+            case 'u':
+            {
+                if ((pos_ + 4U) > text_.size())
+                {
+                    return fail("truncated escape");
+                }
+                const unsigned long code = std::strtoul(text_.substr(pos_, 4).c_str(), nullptr, 16);
+                out.push_back((code < 0x80UL) ? static_cast<char>(code) : '?');    // The reports are ASCII
+                pos_ += 4U;
+                break;
+            }
+            default:
+                out.push_back(escaped);
+                break;
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    bool parseNumber(double& out)
+    {
+        const char* const begin = text_.c_str() + pos_;
+        char* end = nullptr;
+        out = std::strtod(begin, &end);
+        if (end == begin)
+        {
+            return fail("invalid number");
+        }
+        pos_ += static_cast<size_t>(end - begin);
+        return true;
+    }
+
+    bool parseValue(Value& out, unsigned depth)
+    {
+        skipSpace();
+        if ((pos_ >= text_.size()) || (depth > 32U))
+        {
+            return fail("unexpected end of input");
+        }
+        const char c = text_[pos_];
+        if (c == '{')
+        {
+            out.type = Value::Object;
+            pos_++;
+            if (consume('}'))
+            {
+                return true;
+            }
+            do
+            {
+                std::pair<std::string, Value> member;
+                skipSpace();
+                if (!parseString(member.first) || !consume(':') || !parseValue(member.second, depth + 1U))
+                {
+                    return fail("invalid object member");
+                }
+                out.object.push_back(member);
+            }
+            while (consume(','));
+            return consume('}') || fail("expected '}'");
+        }
+        if (c == '[')
+        {
+            out.type = Value::Array;
+            pos_++;
+            if (consume(']'))
+            {
+                return true;
+            }
+            do
+            {
+                out.array.push_back(Value());
+                if (!parseValue(out.array.back(), depth + 1U))
+                {
+                    return false;
+                }
+            }
+            while (consume(','));
+            return consume(']') || fail("expected ']'");
+        }
+        if (c == '"')
+        {
+            out.type = Value::String;
+            return parseString(out.string);
+        }
+        if ((c == 't') || (c == 'f'))
+        {
+            out.type = Value::Boolean;
+            out.boolean = (c == 't');
+            return parseLiteral(out.boolean ? "true" : "false");
+        }
+        if (c == 'n')
+        {
+            out.type = Value::Null;
+            return parseLiteral("null");
+        }
+        out.type = Value::Number;
+        return parseNumber(out.number);
+    }
+
+public:
+    explicit Parser(const std::string& text) : text_(text) { }
+
+    bool parse(Value& out)
+    {
+        if (!parseValue(out, 0))
+        {
+            return false;
+        }
+        skipSpace();
+        return (pos_ == text_.size()) || fail("trailing characters");
+    }
+
+    const std::string& error() const { return error_; }
+};
+
+}
+
+/**
+ * One benchmark of a report, reduced to the compared metric.
+ */
+struct Result
+{
+    std::string name;
+    std::string unit;
+    std::string metric;         ///< "ns" or "instructions"
+    double median = 0.0;
+    double mad = 0.0;           ///< Zero for instruction counts
+    size_t num_samples = 0;
+};
+
+struct Report
+{
+    std::vector<std::pair<std::string, std::string> > context;
+    std::vector<Result> results;
+
+    const Result* find(const std::string& name) const
+    {
+        for (const Result& r : results)
+        {
+            if (r.name == name)
+            {
+                return &r;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * Reads a report from its JSON text. The median and the spread are recomputed from samples_ns when the report has
+ * them, so that reports written before mad_ns was added compare as well.
+ * Returns false with a message if the text is not a report.
+ */
+inline bool parseReport(const std::string& text, Report& out, std::string& out_error)
+{
+    json::Value root;
+    json::Parser parser(text);
+    if (!parser.parse(root))
+    {
+        out_error = parser.error();
+        return false;
+    }
+    const json::Value* const benchmarks = root.find("benchmarks");
+    if ((root.type != json::Value::Object) || (benchmarks == nullptr) || (benchmarks->type != json::Value::Array))
+    {
+        out_error = "no benchmarks array";
+        return false;
+    }
+
+    const json::Value* const context = root.find("context");
+    if (context != nullptr)
+    {
+        for (const auto& member : context->object)
+        {
+            out.context.push_back(std::make_pair(member.first, member.second.toString()));
+        }
+    }
+
+    for (const json::Value& b : benchmarks->array)
+    {
+        const json::Value* const name = b.find("name");
+        const json::Value* const unit = b.find("unit");
+        const json::Value* const median_ns = b.find("median_ns");
+        const json::Value* const mad_ns = b.find("mad_ns");
+        const json::Value* const samples_ns = b.find("samples_ns");
+        const json::Value* const instructions = b.find("instructions_per_op");
+        if ((name == nullptr) || (name->type != json::Value::String))
+        {
+            out_error = "benchmark without a name";
+            return false;
+        }
+
+        Result result;
+        result.name = name->string;
+        result.unit = (unit != nullptr) ? unit->string : "";
+        if ((samples_ns != nullptr) && (samples_ns->type == json::Value::Array) && !samples_ns->array.empty())
+        {
+            std::vector<double> samples;
+            for (const json::Value& sample : samples_ns->array)
+            {
+                samples.push_back(sample.number);
+            }
+            result.metric = "ns";
+            result.num_samples = samples.size();
+            result.median = median(samples);
+            result.mad = medianAbsoluteDeviation(samples, result.median);
+        }
+        else if ((median_ns != nullptr) && (median_ns->type == json::Value::Number))
+        {
+            result.metric = "ns";
+            result.num_samples = 1;
+            result.median = median_ns->number;
+            result.mad = ((mad_ns != nullptr) && (mad_ns->type == json::Value::Number)) ? mad_ns->number : 0.0;
+        }
+        else if ((instructions != nullptr) && (instructions->type == json::Value::Number))
+        {
+            result.metric = "instructions";
+            result.num_samples = 1;
+            result.median = instructions->number;
+        }
+        else
+        {
+            out_error = "benchmark '" + result.name + "' has neither median_ns nor instructions_per_op";
+            return false;
+        }
+        out.results.push_back(result);
+    }
+    return true;
+}
+
+/**
+ * Scales the median absolute deviation to the standard deviation of normally distributed samples.
+ */
+static const double MadToStandardDeviation = 1.4826;
+
+struct Thresholds
+{
+    double percent = 5.0;                                           ///< Default for every benchmark
+    std::vector<std::pair<std::string, double> > overrides;         ///< Name substring, percent; the last match wins
+    double noise_factor = 3.0;
+
+    double percentFor(const std::string& name) const
+    {
+        double result = percent;
+        for (const auto& o : overrides)
+        {
+            if (name.find(o.first) != std::string::npos)
+            {
+                result = o.second;
+            }
+        }
+        return result;
+    }
+};
+
+enum class Verdict
+{
+    Unchanged,          ///< Within the threshold
+    Noisy,              ///< Past the threshold but within the noise
+    Improved,
+    Regressed,
+    Missing,            ///< In the baseline only
+    Added               ///< In the candidate only
+};
+
+inline const char* getVerdictName(Verdict verdict)
+{
+    switch (verdict)
+    {
+    case Verdict::Unchanged:
+        return "ok";
+    case Verdict::Noisy:
+        return "noisy";
+    case Verdict::Improved:
+        return "improved";
+    case Verdict::Regressed:
+        return "REGRESSED";
+    case Verdict::Missing:
+        return "missing";
+    case Verdict::Added:
+        return "new";
+    default:
+        return "?";
+    }
+}
+
+struct Comparison
+{
+    std::string name;
+    std::string metric;
+    Result baseline;
+    Result candidate;
+    double change_percent = 0.0;
+    double threshold_percent = 0.0;
+    double noise = 0.0;                 ///< Smallest significant difference, in the unit of the metric
+    Verdict verdict = Verdict::Unchanged;
+};
+
+inline Comparison compareResults(const Result& baseline, const Result& candidate, const Thresholds& thresholds)
+{
+    Comparison c;
+    c.name = baseline.name;
+    c.metric = baseline.metric;
+    c.baseline = baseline;
+    c.candidate = candidate;
+    c.threshold_percent = thresholds.percentFor(baseline.name);
+
+    const double difference = candidate.median - baseline.median;
+    c.change_percent = (baseline.median > 0.0) ? (100.0 * difference / baseline.median) : 0.0;
+    c.noise = thresholds.noise_factor * MadToStandardDeviation *
+              std::sqrt((baseline.mad * baseline.mad) + (candidate.mad * candidate.mad));
+
+    if (std::fabs(c.change_percent) <= c.threshold_percent)
+    {
+        c.verdict = Verdict::Unchanged;
+    }
+    else if (std::fabs(difference) <= c.noise)
+    {
+        c.verdict = Verdict::Noisy;
+    }
+    else
+    {
+        c.verdict = (difference > 0.0) ? Verdict::Regressed : Verdict::Improved;
+    }
+    return c;
+}
+
+/**
+ * Compares the benchmarks of the candidate with those of the same name in the baseline, in the order of the baseline,
+ * followed by those only in the candidate. Benchmarks measured with different metrics are reported as missing.
+ */
+inline std::vector<Comparison> compareReports(const Report& baseline, const Report& candidate,
+                                              const Thresholds& thresholds)
+{
+    std::vector<Comparison> comparisons;
+    for (const Result& b : baseline.results)
+    {
+        const Result* const c = candidate.find(b.name);
+        if ((c != nullptr) && (c->metric == b.metric))
+        {
+            comparisons.push_back(compareResults(b, *c, thresholds));
+        }
+        else
+        {
+            Comparison missing;
+            missing.name = b.name;
+            missing.metric = b.metric;
+            missing.baseline = b;
+            missing.verdict = Verdict::Missing;
+            comparisons.push_back(missing);
+        }
+    }
+    for (const Result& c : candidate.results)
+    {
+        if (baseline.find(c.name) == nullptr)
+        {
+            Comparison added;
+            added.name = c.name;
+            added.metric = c.metric;
+            added.candidate = c;
+            added.verdict = Verdict::Added;
+            comparisons.push_back(added);
+        }
+    }
+    return comparisons;
+}
+
+/**
+ * Returns the context entries that describe the machine or the build and differ between the reports, as
+ * "key: baseline -> candidate". The commit, the time and the run options are expected to differ.
+ */
+inline std::vector<std::string> getEnvironmentDifferences(const Report& baseline, const Report& candidate)
+{
+    static const char* const Ignored[] = { "git_hash", "timestamp", "repetitions", "min_time_ms", "iterations" };
+    std::vector<std::string> differences;
+    for (const auto& b : baseline.context)
+    {
+        bool ignored = false;
+        for (const char* key : Ignored)
+        {
+            ignored = ignored || (b.first == key);
+        }
+        for (const auto& c : candidate.context)
+        {
+            if (!ignored && (c.first == b.first) && (c.second != b.second))
+            {
+                differences.push_back(b.first + ": " + b.second + " -> " + c.second);
+            }
+        }
+    }
+    return differences;
+}
+
+}
+
+#endif
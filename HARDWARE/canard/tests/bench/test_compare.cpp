@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+/*
+ * Tests of the benchmark report comparison of bench_compare.
+ */
+
+#include <catch.hpp>
+#include <string>
+#include "compare.hpp"
+
+static std::string makeReport(const std::string& cpu, const std::string& benchmarks)
+{
+    return "{\n  \"context\": { \"library\": \"libcanard\", \"cpu\": \"" + cpu + "\", \"git_hash\": \"0123abcd\", "
+           "\"timestamp\": \"2018-01-01T00:00:00Z\", \"pointer_size\": 4 },\n  \"benchmarks\": [" + benchmarks +
+           "]\n}\n";
+}
+
+static std::string makeBenchmark(const std::string& name, const std::string& samples)
+{
+    return "{ \"name\": \"" + name + "\", \"unit\": \"call\", \"median_ns\": 0, \"samples_ns\": [" + samples + "] }";
+}
+
+TEST_CASE("BenchCompare, Statistics")
+{
+    std::vector<double> samples = { 10.0, 11.0, 100.0, 9.0, 10.5 };
+    const double center = bench::median(samples);
+    REQUIRE(center == Approx(10.5));
+    REQUIRE(bench::medianAbsoluteDeviation(samples, center) == Approx(0.5));    // The outlier does not count
+
+    std::vector<double> even = { 4.0, 1.0, 3.0, 2.0 };
+    REQUIRE(bench::median(even) == Approx(2.5));
+
+    std::vector<double> none;
+    REQUIRE(bench::median(none) == Approx(0.0));
+}
+
+TEST_CASE("BenchCompare, Parse")
+{
+    bench::Report report;
+    std::string error;
+    REQUIRE(bench::parseReport(makeReport("Some \\\"CPU\\\" \\u0041", makeBenchmark("rx/single_frame", "3, 1, 2") +
+                                          ", { \"name\": \"tx\", \"unit\": \"frame\", \"instructions_per_op\": 412.5 }"),
+                               report, error));
+    REQUIRE(report.results.size() == 2);
+    REQUIRE(report.results[0].name == "rx/single_frame");
+    REQUIRE(report.results[0].metric == "ns");
+    REQUIRE(report.results[0].median == Approx(2.0));     // From the samples, not from median_ns
+    REQUIRE(report.results[0].mad == Approx(1.0));
+    REQUIRE(report.results[0].num_samples == 3);
+    REQUIRE(report.results[1].metric == "instructions");
+    REQUIRE(report.results[1].median == Approx(412.5));
+    REQUIRE(report.results[1].mad == Approx(0.0));
+
+    bool found = false;
+    for (const auto& entry : report.context)
+    {
+        if (entry.first == "cpu")
+        {
+            REQUIRE(entry.second == "Some \"CPU\" A");
+            found = true;
+        }
+        if (entry.first == "pointer_size")
+        {
+            REQUIRE(entry.second == "4");
+        }
+    }
+    REQUIRE(found);
+
+    // Malformed
+    bench::Report bad;
+    REQUIRE_FALSE(bench::parseReport("{ \"benchmarks\": [ { \"name\": \"x\" ", bad, error));
+    REQUIRE_FALSE(error.empty());
+    REQUIRE_FALSE(bench::parseReport("{ \"context\": {} }", bad, error));
+    REQUIRE_FALSE(bench::parseReport("{ \"benchmarks\": [ { \"name\": \"x\", \"unit\": \"call\" } ] }", bad, error));
+    REQUIRE_FALSE(bench::parseReport("[] []", bad, error));
+}
+
+TEST_CASE("BenchCompare, Verdicts")
+{
+    bench::Report baseline;
+    bench::Report candidate;
+    std::string error;
+    REQUIRE(bench::parseReport(makeReport("A", makeBenchmark("rx/quiet", "100, 100.5, 99.5, 100, 100") + ", " +
+                                               makeBenchmark("rx/faster", "100, 100.5, 99.5, 100, 100") + ", " +
+                                               makeBenchmark("rx/noisy", "100, 80, 120, 90, 110") + ", " +
+                                               makeBenchmark("crc/add", "100, 100.5, 99.5, 100, 100") + ", " +
+                                               makeBenchmark("gone", "1")),
+                               baseline, error));
+    REQUIRE(bench::parseReport(makeReport("B", makeBenchmark("rx/quiet", "110, 110.5, 109.5, 110, 110") + ", " +
+                                               makeBenchmark("rx/faster", "80, 80.5, 79.5, 80, 80") + ", " +
+                                               makeBenchmark("rx/noisy", "110, 90, 130, 100, 120") + ", " +
+                                               makeBenchmark("crc/add", "103, 103.5, 102.5, 103, 103") + ", " +
+                                               makeBenchmark("added", "1")),
+                               candidate, error));
+
+    bench::Thresholds thresholds;
+    thresholds.overrides.push_back(std::make_pair(std::string("crc/"), 2.0));
+
+    const std::vector<bench::Comparison> c = bench::compareReports(baseline, candidate, thresholds);
+    REQUIRE(c.size() == 6);
+    REQUIRE(c[0].name == "rx/quiet");
+    REQUIRE(c[0].change_percent == Approx(10.0));
+    REQUIRE(c[0].verdict == bench::Verdict::Regressed);
+    REQUIRE(c[1].verdict == bench::Verdict::Improved);
+    REQUIRE(c[2].verdict == bench::Verdict::Noisy);       // +10%, but the spread is 20 ns
+    REQUIRE(c[3].threshold_percent == Approx(2.0));
+    REQUIRE(c[3].verdict == bench::Verdict::Regressed);   // +3% is past the threshold of crc/
+    REQUIRE(c[4].name == "gone");
+    REQUIRE(c[4].verdict == bench::Verdict::Missing);
+    REQUIRE(c[5].name == "added");
+    REQUIRE(c[5].verdict == bench::Verdict::Added);
+
+    thresholds.percent = 15.0;
+    thresholds.overrides.clear();
+    REQUIRE(bench::compareResults(baseline.results[0], candidate.results[0], thresholds).verdict ==
+            bench::Verdict::Unchanged);
+
+    // Instruction counts have no spread, so any change past the threshold counts
+    bench::Result before;
+    before.name = "tx";
+    before.metric = "instructions";
+    before.median = 1000.0;
+    before.num_samples = 1;
+    bench::Result after = before;
+    after.median = 1001.0;
+    thresholds.percent = 0.0;
+    REQUIRE(bench::compareResults(before, after, thresholds).verdict == bench::Verdict::Regressed);
+
+    // The commit and the time are expected to differ, the CPU is not
+    const std::vector<std::string> differences = bench::getEnvironmentDifferences(baseline, candidate);
+    REQUIRE(differences.size() == 1);
+    REQUIRE(differences[0] == "cpu: A -> B");
+}
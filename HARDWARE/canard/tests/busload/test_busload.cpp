@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * Tests of the bus load accounting (CANARD_ENABLE_BUSLOAD), built with a short window and a small data type table.
+ */
+
+#include <catch.hpp>
+#include <cstring>
+#include <vector>
+#include "canard.h"
+
+#if !CANARD_ENABLE_BUSLOAD || (CANARD_BUSLOAD_SLOT_USEC != 100000UL) || (CANARD_BUSLOAD_NUM_SLOTS != 4U) || \
+    (CANARD_BUSLOAD_MAX_DATA_TYPES != 3U)
+# error "This test must be built with CANARD_ENABLE_BUSLOAD=1, CANARD_BUSLOAD_SLOT_USEC=100000UL, " \
+        "CANARD_BUSLOAD_NUM_SLOTS=4U, CANARD_BUSLOAD_MAX_DATA_TYPES=3U"
+#endif
+
+static const uint64_t MessageSignature = 0x1122334455667788ULL;
+static const uint32_t BitRate = 500000;
+static const uint64_t Start = 300000;                  // Within the first window
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t,
+                                 CanardTransferType,
+                                 uint8_t)
+{
+    *out_data_type_signature = MessageSignature;
+    return true;
+}
+
+static void onTransferReception(CanardInstance*, CanardRxTransfer*) { }
+
+struct BusLoadFixture
+{
+    uint8_t arena[1024];
+    CanardInstance ins;
+    uint8_t transfer_id = 0;
+
+    BusLoadFixture()
+    {
+        canardInit(&ins, arena, sizeof(arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+        canardSetLocalNodeID(&ins, 42);
+        canardUpdateBusLoad(&ins, Start);
+    }
+
+    /// Sends a single-frame message through the TX queue and returns the bits it took
+    uint32_t transmit(uint16_t data_type_id, uint8_t priority, uint16_t payload_len)
+    {
+        const uint8_t payload[7] = { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE };
+        REQUIRE(payload_len <= sizeof(payload));
+        REQUIRE(1 == canardBroadcast(&ins, MessageSignature, data_type_id, &transfer_id, priority,
+                                     payload, payload_len));
+        const uint32_t bits = canardGetFrameBitLength(canardPeekTxQueue(&ins));
+        canardPopTxQueue(&ins);
+        return bits;
+    }
+};
+
+static uint16_t permille(uint32_t bits, uint32_t window_usec)
+{
+    return uint16_t((uint64_t(bits) * 1000000000ULL + uint64_t(BitRate) * window_usec / 2U) /
+                    (uint64_t(BitRate) * window_usec));
+}
+
+
+TEST_CASE("BusLoad, FrameBitLength")
+{
+    // Figures of the classic worst-case analysis: 55 + 10 * n bits for base frames, 80 + 10 * n for extended ones
+    REQUIRE(canardGetWorstCaseFrameBitLength(0, false) == 55);
+    REQUIRE(canardGetWorstCaseFrameBitLength(8, false) == 135);
+    REQUIRE(canardGetWorstCaseFrameBitLength(0, true) == 80);
+    REQUIRE(canardGetWorstCaseFrameBitLength(8, true) == 160);
+    REQUIRE(canardGetWorstCaseFrameBitLength(15, true) == 160);
+
+    // All dominant: 34 bits from the start of frame to the CRC, stuffed after every fifth one
+    CanardCANFrame frame;
+    std::memset(&frame, 0, sizeof(frame));
+    REQUIRE(canardGetFrameBitLength(&frame) == 34U + 6U + CANARD_CAN_FRAME_TRAILER_BITS);
+
+    // Remote frames have no data field
+    frame.id = 0x555U | CANARD_CAN_FRAME_RTR;
+    frame.data_len = 8;
+    const uint16_t remote = canardGetFrameBitLength(&frame);
+    REQUIRE(remote >= 34U + CANARD_CAN_FRAME_TRAILER_BITS);
+    REQUIRE(remote <= canardGetWorstCaseFrameBitLength(0, false));
+
+    uint32_t state = 12345U;
+    for (unsigned i = 0; i < 10000U; i++)
+    {
+        state = state * 1103515245U + 12345U;
+        const bool extended = (state & 1U) != 0U;
+        frame.id = extended ? ((state & CANARD_CAN_EXT_ID_MASK) | CANARD_CAN_FRAME_EFF) : (state & CANARD_CAN_STD_ID_MASK);
+        frame.data_len = uint8_t((state >> 1U) % 9U);
+        for (uint8_t k = 0; k < frame.data_len; k++)
+        {
+            state = state * 1103515245U + 12345U;
+            frame.data[k] = uint8_t(state >> 24U);
+        }
+        const uint16_t length = canardGetFrameBitLength(&frame);
+        REQUIRE(length >= (extended ? 54U : 34U) + 8U * frame.data_len + CANARD_CAN_FRAME_TRAILER_BITS);
+        REQUIRE(length <= canardGetWorstCaseFrameBitLength(frame.data_len, extended));
+    }
+}
+
+TEST_CASE("BusLoad, Accounting")
+{
+    BusLoadFixture f;
+    const uint32_t tx_bits = f.transmit(1000, CANARD_TRANSFER_PRIORITY_MEDIUM, 7);
+
+    // A frame of another node
+    CanardCANFrame frame;
+    std::memset(&frame, 0, sizeof(frame));
+    frame.id = CANARD_CAN_FRAME_EFF | (uint32_t(CANARD_TRANSFER_PRIORITY_HIGH) << 24U) | (2000U << 8U) | 7U;
+    frame.data[0] = 0xC0;
+    frame.data_len = 1;
+    const uint32_t rx_bits = canardGetFrameBitLength(&frame);
+    canardHandleRxFrame(&f.ins, &frame, Start + 10000);
+
+    // Not UAVCAN
+    frame.id = 0x123;
+    const uint32_t other_bits = canardGetFrameBitLength(&frame);
+    canardHandleRxFrame(&f.ins, &frame, Start + 20000);
+
+    canardUpdateBusLoad(&f.ins, Start + 50000);
+    const CanardBusLoadStatistics stats = canardGetBusLoadStatistics(&f.ins, BitRate);
+    REQUIRE(stats.window_usec == 50000);
+    REQUIRE(stats.tx_bits == tx_bits);
+    REQUIRE(stats.rx_bits == rx_bits + other_bits);
+    REQUIRE(stats.load_permille == permille(tx_bits + rx_bits + other_bits, 50000));
+    REQUIRE(stats.tx_load_permille == permille(tx_bits, 50000));
+    REQUIRE(stats.rx_load_permille == permille(rx_bits + other_bits, 50000));
+    REQUIRE(stats.priority_band_load_permille[0] == 0);
+    REQUIRE(stats.priority_band_load_permille[1] == permille(rx_bits, 50000));
+    REQUIRE(stats.priority_band_load_permille[2] == permille(tx_bits, 50000));
+    REQUIRE(stats.priority_band_load_permille[3] == 0);
+    REQUIRE(stats.untracked_load_permille == permille(other_bits, 50000));
+
+    REQUIRE(stats.num_data_types == 2);
+    REQUIRE(stats.data_types[0].data_type_id == 1000);          // Heaviest first
+    REQUIRE_FALSE(stats.data_types[0].service);
+    REQUIRE(stats.data_types[0].bits == tx_bits);
+    REQUIRE(stats.data_types[1].data_type_id == 2000);
+    REQUIRE(stats.data_types[1].bits == rx_bits);
+    REQUIRE(stats.data_types[1].load_permille == permille(rx_bits, 50000));
+
+    // No bit rate, no load
+    REQUIRE(canardGetBusLoadStatistics(&f.ins, 0).load_permille == 0);
+}
+
+TEST_CASE("BusLoad, SlidingWindow")
+{
+    BusLoadFixture f;
+    const uint32_t first = f.transmit(1000, CANARD_TRANSFER_PRIORITY_LOW, 1);
+
+    canardUpdateBusLoad(&f.ins, Start + 150000);                // Second slot
+    const uint32_t second = f.transmit(1000, CANARD_TRANSFER_PRIORITY_LOW, 7);
+
+    canardUpdateBusLoad(&f.ins, Start + 350000);                // Fourth slot, the window is full
+    CanardBusLoadStatistics stats = canardGetBusLoadStatistics(&f.ins, BitRate);
+    REQUIRE(stats.window_usec == 350000);
+    REQUIRE(stats.tx_bits == first + second);
+
+    canardUpdateBusLoad(&f.ins, Start + 450000);                // The first slot is reused
+    stats = canardGetBusLoadStatistics(&f.ins, BitRate);
+    REQUIRE(stats.window_usec == 350000);
+    REQUIRE(stats.tx_bits == second);
+    REQUIRE(stats.data_types[0].bits == second);
+
+    canardUpdateBusLoad(&f.ins, Start + 440000);                // Earlier times are ignored
+    REQUIRE(canardGetBusLoadStatistics(&f.ins, BitRate).window_usec == 350000);
+
+    canardUpdateBusLoad(&f.ins, Start + 2000000);               // Idle for longer than the window
+    stats = canardGetBusLoadStatistics(&f.ins, BitRate);
+    REQUIRE(stats.window_usec == 0);
+    REQUIRE(stats.tx_bits == 0);
+    REQUIRE(stats.num_data_types == 0);
+}
+
+TEST_CASE("BusLoad, DataTypeTable")
+{
+    BusLoadFixture f;
+    uint32_t bits[4];
+    for (uint16_t i = 0; i < 4; i++)
+    {
+        bits[i] = f.transmit(uint16_t(100 + i), CANARD_TRANSFER_PRIORITY_LOW, uint16_t(i + 1));
+    }
+    canardUpdateBusLoad(&f.ins, Start + 100000);
+    CanardBusLoadStatistics stats = canardGetBusLoadStatistics(&f.ins, BitRate);
+    REQUIRE(stats.num_data_types == 3);
+    REQUIRE(stats.untracked_load_permille == permille(bits[3], 100000));
+    REQUIRE(stats.data_types[0].data_type_id == 102);
+    REQUIRE(stats.data_types[2].data_type_id == 100);
+
+    // Data type 101 leaves the window after its only frame; the entries of 100 and 102 are kept busy
+    canardUpdateBusLoad(&f.ins, Start + 350000);
+    f.transmit(100, CANARD_TRANSFER_PRIORITY_LOW, 1);
+    f.transmit(102, CANARD_TRANSFER_PRIORITY_LOW, 1);
+    canardUpdateBusLoad(&f.ins, Start + 400000);
+    const uint32_t late = f.transmit(103, CANARD_TRANSFER_PRIORITY_LOW, 4);
+    stats = canardGetBusLoadStatistics(&f.ins, BitRate);
+    REQUIRE(stats.num_data_types == 3);
+    REQUIRE(stats.untracked_load_permille == 0);
+    bool found = false;
+    for (uint8_t i = 0; i < stats.num_data_types; i++)
+    {
+        REQUIRE(stats.data_types[i].data_type_id != 101);
+        if (stats.data_types[i].data_type_id == 103)
+        {
+            found = true;
+            REQUIRE(stats.data_types[i].bits == late);
+        }
+    }
+    REQUIRE(found);
+}
+
+TEST_CASE("BusLoad, Services")
+{
+    BusLoadFixture f;
+    uint8_t payload[3] = { 1, 2, 3 };
+    REQUIRE(1 == canardRequestOrRespond(&f.ins, 43, MessageSignature, 55, &f.transfer_id,
+                                        CANARD_TRANSFER_PRIORITY_HIGHEST, CanardRequest, payload, sizeof(payload)));
+    const uint32_t bits = canardGetFrameBitLength(canardPeekTxQueue(&f.ins));
+    canardPopTxQueue(&f.ins);
+
+    canardUpdateBusLoad(&f.ins, Start + 1000);
+    const CanardBusLoadStatistics stats = canardGetBusLoadStatistics(&f.ins, BitRate);
+    REQUIRE(stats.num_data_types == 1);
+    REQUIRE(stats.data_types[0].data_type_id == 55);
+    REQUIRE(stats.data_types[0].service);
+    REQUIRE(stats.priority_band_load_permille[0] == permille(bits, 1000));
+}
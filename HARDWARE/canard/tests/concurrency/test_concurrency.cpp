@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * Stress test and throughput benchmark for the concurrency mode (CANARD_ENABLE_CONCURRENCY).
+ * Several producer threads submit transfers, one TX thread drains the TX queue and loops the frames back to one
+ * RX thread, which reassembles them on the same instance. Run under ThreadSanitizer with -DCANARD_TSAN=ON.
+ */
+
+#include <catch.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "canard.h"
+
+#if !CANARD_ENABLE_CONCURRENCY
+# error "This test must be built with CANARD_ENABLE_CONCURRENCY=1"
+#endif
+
+
+static const unsigned NumProducers = 4;
+static const uint16_t BaseDataTypeID = 100;
+static const uint64_t BaseDataTypeSignature = 0x0123456789ABCDEFULL;
+static const uint8_t LocalNodeID = 42;
+
+namespace
+{
+/**
+ * Loopback channel between the TX thread and the RX thread; stands in for the CAN interface.
+ */
+class FrameChannel
+{
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<CanardCANFrame> frames_;
+    bool closed_ = false;
+
+public:
+    void push(const CanardCANFrame& frame)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            frames_.push_back(frame);
+        }
+        cv_.notify_one();
+    }
+
+    bool pop(CanardCANFrame& out_frame)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return closed_ || !frames_.empty(); });
+        if (frames_.empty())
+        {
+            return false;
+        }
+        out_frame = frames_.front();
+        frames_.pop_front();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+};
+
+/**
+ * Reception state; accessed only from the RX thread until it is joined.
+ */
+struct RxContext
+{
+    unsigned received[NumProducers] = {};
+    unsigned order_violations = 0;
+    unsigned payload_errors = 0;
+};
+
+/**
+ * Serializes every library call with one mutex; this is the baseline the concurrency mode is meant to replace.
+ */
+std::mutex g_global_lock;
+bool g_use_global_lock = false;
+
+class OptionalLock
+{
+    bool locked_;
+
+public:
+    OptionalLock() : locked_(g_use_global_lock)
+    {
+        if (locked_)
+        {
+            g_global_lock.lock();
+        }
+    }
+
+    ~OptionalLock()
+    {
+        if (locked_)
+        {
+            g_global_lock.unlock();
+        }
+    }
+};
+}
+
+static uint8_t makePayloadByte(unsigned producer, unsigned seq, unsigned index)
+{
+    return uint8_t(producer * 31U + seq + index);
+}
+
+static uint16_t makePayloadLength(unsigned seq)
+{
+    return uint16_t(2U + (seq % 40U));         // Mix of single-frame and multi-frame transfers
+}
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t)
+{
+    if ((transfer_type == CanardTransferTypeBroadcast) &&
+        (data_type_id >= BaseDataTypeID) && (data_type_id < BaseDataTypeID + NumProducers))
+    {
+        *out_data_type_signature = BaseDataTypeSignature + (data_type_id - BaseDataTypeID);
+        return true;
+    }
+    return false;
+}
+
+static void onTransferReception(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    RxContext* const ctx = static_cast<RxContext*>(canardGetUserReference(ins));
+    const unsigned producer = unsigned(transfer->data_type_id - BaseDataTypeID);
+
+    uint16_t seq = 0;
+    (void) canardDecodeScalar(transfer, 0, 16, false, &seq);
+    if (seq != ctx->received[producer])
+    {
+        ctx->order_violations++;
+    }
+    ctx->received[producer] = unsigned(seq) + 1U;
+
+    if (transfer->payload_len != makePayloadLength(seq))
+    {
+        ctx->payload_errors++;
+        return;
+    }
+    for (unsigned i = 2; i < transfer->payload_len; i++)
+    {
+        uint8_t byte = 0;
+        (void) canardDecodeScalar(transfer, i * 8U, 8, false, &byte);
+        if (byte != makePayloadByte(producer, seq, i))
+        {
+            ctx->payload_errors++;
+            return;
+        }
+    }
+}
+
+/**
+ * Runs the producers, one TX thread and one RX thread against a single instance.
+ * Returns the elapsed time in seconds.
+ */
+static double runLoopback(unsigned transfers_per_producer,
+                          RxContext& ctx,
+                          CanardPoolAllocatorStatistics& out_stats,
+                          unsigned& out_unexpected_errors)
+{
+    static std::uint8_t memory_arena[CANARD_MEM_BLOCK_SIZE * 1024U];
+
+    CanardInstance ins;
+    canardInit(&ins, memory_arena, sizeof(memory_arena), &onTransferReception, &shouldAcceptTransfer, &ctx);
+    canardSetLocalNodeID(&ins, LocalNodeID);
+
+    FrameChannel channel;
+    std::atomic<unsigned> producers_running(NumProducers);
+    std::atomic<unsigned> unexpected_errors(0);
+
+    const auto started_at = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> producers;
+    for (unsigned p = 0; p < NumProducers; p++)
+    {
+        producers.emplace_back([&, p]()
+        {
+            uint8_t transfer_id = 0;
+            uint8_t payload[64];
+            for (unsigned seq = 0; seq < transfers_per_producer; seq++)
+            {
+                const uint16_t len = makePayloadLength(seq);
+                payload[0] = uint8_t(seq & 0xFFU);
+                payload[1] = uint8_t(seq >> 8U);
+                for (unsigned i = 2; i < len; i++)
+                {
+                    payload[i] = makePayloadByte(p, seq, i);
+                }
+
+                for (;;)
+                {
+                    // Backpressure: leave half of the pool for RX reassembly
+                    const CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&ins);
+                    if (stats.current_usage_blocks > (stats.capacity_blocks / 2U))
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    int16_t res = 0;
+                    {
+                        OptionalLock lock;
+                        res = canardBroadcast(&ins, BaseDataTypeSignature + p, uint16_t(BaseDataTypeID + p),
+                                              &transfer_id, CANARD_TRANSFER_PRIORITY_MEDIUM, payload, len);
+                    }
+                    if (res > 0)
+                    {
+                        break;
+                    }
+                    if (res != -CANARD_ERROR_OUT_OF_MEMORY)
+                    {
+                        unexpected_errors++;
+                        break;
+                    }
+                    // The transfer was dropped as a whole, so it is retried with the same transfer ID
+                    transfer_id = uint8_t((transfer_id + 31U) % 32U);
+                }
+            }
+            producers_running--;
+        });
+    }
+
+    std::thread tx_thread([&]()
+    {
+        for (;;)
+        {
+            const bool producers_done = producers_running.load() == 0;
+            CanardCANFrame frame;
+            bool have_frame = false;
+            {
+                OptionalLock lock;
+                const CanardCANFrame* const txf = canardPeekTxQueue(&ins);
+                if (txf != nullptr)
+                {
+                    frame = *txf;
+                    canardPopTxQueue(&ins);
+                    have_frame = true;
+                }
+            }
+            if (have_frame)
+            {
+                channel.push(frame);
+            }
+            else if (producers_done)
+            {
+                break;          // Producers were done before the queue was found empty, nothing can arrive anymore
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+        channel.close();
+    });
+
+    std::thread rx_thread([&]()
+    {
+        CanardCANFrame frame;
+        uint64_t timestamp_usec = 1;
+        while (channel.pop(frame))
+        {
+            OptionalLock lock;
+            canardHandleRxFrame(&ins, &frame, timestamp_usec++);
+        }
+    });
+
+    for (auto& t : producers)
+    {
+        t.join();
+    }
+    tx_thread.join();
+    rx_thread.join();
+
+    const auto elapsed = std::chrono::steady_clock::now() - started_at;
+
+    out_stats = canardGetPoolAllocatorStatistics(&ins);
+    out_unexpected_errors = unexpected_errors.load();
+    return std::chrono::duration<double>(elapsed).count();
+}
+
+static void checkLoopback(unsigned transfers_per_producer,
+                          const RxContext& ctx,
+                          const CanardPoolAllocatorStatistics& stats,
+                          unsigned unexpected_errors)
+{
+    REQUIRE(unexpected_errors == 0);
+    REQUIRE(ctx.order_violations == 0);
+    REQUIRE(ctx.payload_errors == 0);
+    for (unsigned p = 0; p < NumProducers; p++)
+    {
+        REQUIRE(ctx.received[p] == transfers_per_producer);
+    }
+    // Only the RX states are left allocated; all TX frames and RX buffers have been returned to the pool
+    REQUIRE(stats.current_usage_blocks == NumProducers);
+}
+
+
+TEST_CASE("Concurrency, Stress")
+{
+    const unsigned TransfersPerProducer = 2000;
+
+    RxContext ctx;
+    CanardPoolAllocatorStatistics stats;
+    unsigned unexpected_errors = 0;
+
+    g_use_global_lock = false;
+    (void) runLoopback(TransfersPerProducer, ctx, stats, unexpected_errors);
+    checkLoopback(TransfersPerProducer, ctx, stats, unexpected_errors);
+}
+
+/*
+ * Hidden by default; run explicitly with: run_concurrency_tests "[bench]"
+ */
+TEST_CASE("Concurrency, Throughput", "[.][bench]")
+{
+    const unsigned TransfersPerProducer = 50000;
+    const double total_transfers = double(TransfersPerProducer * NumProducers);
+
+    for (bool global_lock : { true, false })
+    {
+        RxContext ctx;
+        CanardPoolAllocatorStatistics stats;
+        unsigned unexpected_errors = 0;
+
+        g_use_global_lock = global_lock;
+        const double elapsed = runLoopback(TransfersPerProducer, ctx, stats, unexpected_errors);
+        g_use_global_lock = false;
+
+        checkLoopback(TransfersPerProducer, ctx, stats, unexpected_errors);
+
+        std::printf("%-24s %u producers: %8.0f transfers/s, peak pool usage %u of %u blocks\n",
+                    global_lock ? "single global mutex:" : "concurrency mode:",
+                    NumProducers, total_transfers / elapsed,
+                    unsigned(stats.peak_usage_blocks), unsigned(stats.capacity_blocks));
+    }
+}
@@ -52,6 +52,27 @@
 
 #define UNIQUE_ID_LENGTH_BYTES                                      16
 
+/*
+ * Vendor-specific message reporting the memory pool usage, see dsdl/canard/20100.PoolStatus.uavcan
+ */
+#define CANARD_POOL_STATUS_MESSAGE_SIZE                             24
+#define CANARD_POOL_STATUS_DATA_TYPE_ID                             20100
+#define CANARD_POOL_STATUS_DATA_TYPE_SIGNATURE                      0xf720e4c9cf2b53fb
+
+/*
+ * Vendor-specific message reporting the bus load, see dsdl/canard/20101.BusLoad.uavcan.
+ * Its size depends on the number of data types it lists.
+ */
+#define CANARD_BUS_LOAD_MESSAGE_MAX_SIZE                            52
+#define CANARD_BUS_LOAD_DATA_TYPE_ID                                20101
+#define CANARD_BUS_LOAD_DATA_TYPE_SIGNATURE                         0xe3c1c64a870692c5
+#define CANARD_BUS_LOAD_MAX_DATA_TYPES                              8
+
+/*
+ * Bit rate of the interface, which SocketCAN does not tell; the bus load is computed against it.
+ */
+#define CAN_BIT_RATE                                                1000000
+
 /*
  * Library instance.
  * In simple applications it makes sense to make it static, but it is not necessary.
@@ -84,6 +105,51 @@ static uint64_t getMonotonicTimestampUSec(void)
     return (uint64_t)(ts.tv_sec * 1000000LL + ts.tv_nsec / 1000LL);
 }
 
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS || (CANARD_ENABLE_PROFILING && !CANARD_PROF_USE_TSC)
+/**
+ * Monotonic clock of the latency histograms and of the profiling counters, at CANARD_TRACE_TIMESTAMP_HZ.
+ */
+uint32_t canardTraceGetTimestamp(void)
+{
+    struct timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * CANARD_TRACE_TIMESTAMP_HZ +
+                      (uint64_t)ts.tv_nsec * CANARD_TRACE_TIMESTAMP_HZ / 1000000000ULL);
+}
+#endif
+
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+
+static void printLatency(const char* name, CanardLatencyPath path)
+{
+    const CanardLatencyStatistics stats = canardGetLatencyStatistics((uint8_t)path);
+    printf("  %-12s: p50 %llu us, p99 %llu us, max %llu us (%u samples)\n", name,
+           (unsigned long long)stats.p50 * 1000000ULL / CANARD_LATENCY_TIMESTAMP_HZ,
+           (unsigned long long)stats.p99 * 1000000ULL / CANARD_LATENCY_TIMESTAMP_HZ,
+           (unsigned long long)stats.max * 1000000ULL / CANARD_LATENCY_TIMESTAMP_HZ,
+           stats.count);
+}
+#endif
+
+#if CANARD_ENABLE_PROFILING
+static void printProf(const char* name, CanardProfSite site)
+{
+    const CanardProfStatistics stats = canardGetProfStatistics((uint8_t)site);
+    const unsigned long long avg = (stats.count > 0U) ? (unsigned long long)(stats.total / stats.count) : 0ULL;
+# if CANARD_PROF_USE_TSC
+    printf("  %-16s: min %u, avg %llu, max %u TSC ticks (%u passes)\n", name, stats.min, avg, stats.max,
+           stats.count);
+# else
+    printf("  %-16s: min %llu ns, avg %llu ns, max %llu ns (%u passes)\n", name,
+           (unsigned long long)stats.min * 1000000000ULL / CANARD_PROF_TIMESTAMP_HZ,
+           avg * 1000000000ULL / CANARD_PROF_TIMESTAMP_HZ,
+           (unsigned long long)stats.max * 1000000000ULL / CANARD_PROF_TIMESTAMP_HZ,
+           stats.count);
+# endif
+}
+#endif
+
 
 /**
  * Returns a pseudo random float in the range [0, 1].
@@ -135,6 +201,60 @@ static void makeNodeStatusMessage(uint8_t buffer[UAVCAN_NODE_STATUS_MESSAGE_SIZE
 }
 
 
+static void makePoolStatusMessage(uint8_t buffer[CANARD_POOL_STATUS_MESSAGE_SIZE])
+{
+    memset(buffer, 0, CANARD_POOL_STATUS_MESSAGE_SIZE);
+
+    const CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&canard);
+    canardEncodeScalar(buffer,  0, 16, &stats.capacity_blocks);
+    canardEncodeScalar(buffer, 16, 16, &stats.current_usage_blocks);
+    canardEncodeScalar(buffer, 32, 16, &stats.peak_usage_blocks);
+
+    for (uint32_t i = 0; i < CANARD_NUM_POOL_OWNERS; i++)
+    {
+        const CanardPoolOwnerStatistics owner = canardGetPoolOwnerStatistics(&canard, (CanardPoolOwner)i);
+        canardEncodeScalar(buffer,  48 + i * 16U, 16, &owner.current_usage_blocks);
+        canardEncodeScalar(buffer,  96 + i * 16U, 16, &owner.peak_usage_blocks);
+        canardEncodeScalar(buffer, 144 + i * 16U, 16, &owner.allocation_failures);
+    }
+}
+
+
+#if CANARD_ENABLE_BUSLOAD
+/**
+ * Returns the size of the message, which ends with one entry per data type.
+ */
+static uint16_t makeBusLoadMessage(const CanardBusLoadStatistics* stats,
+                                   uint8_t buffer[CANARD_BUS_LOAD_MESSAGE_MAX_SIZE])
+{
+    memset(buffer, 0, CANARD_BUS_LOAD_MESSAGE_MAX_SIZE);
+
+    const uint32_t bit_rate = CAN_BIT_RATE;
+    const uint16_t window_ms = (uint16_t)(stats->window_usec / 1000U);
+    canardEncodeScalar(buffer,   0, 32, &bit_rate);
+    canardEncodeScalar(buffer,  32, 16, &window_ms);
+    canardEncodeScalar(buffer,  48, 16, &stats->tx_load_permille);
+    canardEncodeScalar(buffer,  64, 16, &stats->rx_load_permille);
+    for (uint32_t i = 0; i < CANARD_BUSLOAD_NUM_PRIORITY_BANDS; i++)
+    {
+        canardEncodeScalar(buffer, 80 + i * 16U, 16, &stats->priority_band_load_permille[i]);
+    }
+    canardEncodeScalar(buffer, 144, 16, &stats->untracked_load_permille);
+
+    // The array is the last field, so its length is implied by the size of the message
+    uint32_t offset = 160;
+    for (uint32_t i = 0; (i < stats->num_data_types) && (i < CANARD_BUS_LOAD_MAX_DATA_TYPES); i++)
+    {
+        canardEncodeScalar(buffer, offset, 16, &stats->data_types[i].data_type_id);
+        canardEncodeScalar(buffer, offset + 16U, 1, &stats->data_types[i].service);
+        canardEncodeScalar(buffer, offset + 17U, 15, &stats->data_types[i].load_permille);
+        offset += 32U;
+    }
+    return (uint16_t)(offset / 8U);
+}
+#endif
+
+
 /**
  * This callback is invoked by the library when a new message or request or response is received.
  */
@@ -329,12 +449,105 @@ static void process1HzTasks(uint64_t timestamp_usec)
 
         /*
          * The recommended way to establish the minimal size of the memory pool is to stress-test the application and
-         * record the worst case memory usage.
+         * record the worst case memory usage. The tool pool_advisor does that on recorded traffic: it replays a log
+         * against a description of the node and finds the smallest pool without allocation failures.
          */
         if (peak_percent > 70)
         {
             puts("WARNING: ENLARGE MEMORY POOL");
         }
+
+        /*
+         * The usage by owner tells what the memory is spent on: a growing TX backlog means that the interface cannot
+         * keep up, stale RX states mean that the cleanup runs too rarely, large RX buffers mean long transfers.
+         */
+        static const char* const OwnerNames[CANARD_NUM_POOL_OWNERS] = { "TX frames", "RX states", "RX buffers" };
+        for (int i = 0; i < CANARD_NUM_POOL_OWNERS; i++)
+        {
+            const CanardPoolOwnerStatistics owner = canardGetPoolOwnerStatistics(&canard, (CanardPoolOwner)i);
+            printf("  %-10s: usage %u blocks, peak usage %u blocks, allocation failures %u\n", OwnerNames[i],
+                   owner.current_usage_blocks, owner.peak_usage_blocks, owner.allocation_failures);
+        }
+    }
+
+#if CANARD_ENABLE_BUSLOAD
+    /*
+     * Printing and reporting the bus load; the figures cover the frames this node sends and receives.
+     */
+    {
+        const CanardBusLoadStatistics stats = canardGetBusLoadStatistics(&canard, CAN_BIT_RATE);
+        printf("Bus load: %u.%u%% (TX %u.%u%%, RX %u.%u%%) over %u ms\n",
+               stats.load_permille / 10U, stats.load_permille % 10U,
+               stats.tx_load_permille / 10U, stats.tx_load_permille % 10U,
+               stats.rx_load_permille / 10U, stats.rx_load_permille % 10U, (unsigned)(stats.window_usec / 1000U));
+        for (uint8_t i = 0; i < stats.num_data_types; i++)
+        {
+            printf("  %s %-5u: %u.%u%%\n", stats.data_types[i].service ? "service" : "message",
+                   stats.data_types[i].data_type_id,
+                   stats.data_types[i].load_permille / 10U, stats.data_types[i].load_permille % 10U);
+        }
+
+        uint8_t buffer[CANARD_BUS_LOAD_MESSAGE_MAX_SIZE];
+        const uint16_t size = makeBusLoadMessage(&stats, buffer);
+
+        static uint8_t transfer_id;
+
+        const int16_t bc_res = canardBroadcast(&canard,
+                                               CANARD_BUS_LOAD_DATA_TYPE_SIGNATURE,
+                                               CANARD_BUS_LOAD_DATA_TYPE_ID,
+                                               &transfer_id,
+                                               CANARD_TRANSFER_PRIORITY_LOWEST,
+                                               buffer,
+                                               size);
+        if (bc_res <= 0)
+        {
+            (void)fprintf(stderr, "Could not broadcast bus load; error %d\n", bc_res);
+        }
+    }
+#endif
+
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+    /*
+     * Printing the latency percentiles; the TX completion is not visible through SocketCAN, so it stays empty.
+     */
+    puts("Latency:");
+    printLatency("RX", CanardLatencyPathRx);
+    printLatency("TX queue", CanardLatencyPathTxQueue);
+    printLatency("TX complete", CanardLatencyPathTxComplete);
+#endif
+
+#if CANARD_ENABLE_PROFILING
+    /*
+     * Printing the profiling counters since the start; the clock resolution of the host limits the minimums.
+     */
+    puts("Profile:");
+    printProf("handle RX frame", CanardProfSiteHandleRxFrame);
+    printProf("TX transfer", CanardProfSiteTxTransfer);
+    printProf("cleanup", CanardProfSiteCleanup);
+    printProf("socket sendmmsg", CanardProfSiteDriverTransmit);
+    printProf("socket recvmmsg", CanardProfSiteDriverReceive);
+#endif
+
+    /*
+     * Reporting the memory pressure to the other nodes.
+     */
+    {
+        uint8_t buffer[CANARD_POOL_STATUS_MESSAGE_SIZE];
+        makePoolStatusMessage(buffer);
+
+        static uint8_t transfer_id;
+
+        const int16_t bc_res = canardBroadcast(&canard,
+                                               CANARD_POOL_STATUS_DATA_TYPE_SIGNATURE,
+                                               CANARD_POOL_STATUS_DATA_TYPE_ID,
+                                               &transfer_id,
+                                               CANARD_TRANSFER_PRIORITY_LOWEST,
+                                               buffer,
+                                               CANARD_POOL_STATUS_MESSAGE_SIZE);
+        if (bc_res <= 0)
+        {
+            (void)fprintf(stderr, "Could not broadcast pool status; error %d\n", bc_res);
+        }
     }
 
     /*
@@ -364,44 +577,58 @@ static void process1HzTasks(uint64_t timestamp_usec)
 
 
 /**
- * Transmits all frames from the TX queue, receives up to one frame.
+ * Transmits all frames from the TX queue, receives whatever has arrived; both in batches of one syscall each.
+ * The frames are popped from the TX queue into a staging batch, whose frames left over when the socket buffer is
+ * full go out first on the next call; so a new frame of higher priority waits for at most one batch.
  */
 static void processTxRxOnce(SocketCANInstance* socketcan, int32_t timeout_msec)
 {
+    static CanardCANFrame tx_batch[SOCKETCAN_BATCH_MAX_FRAMES];
+    static uint16_t tx_batch_len = 0;
+
     // Transmitting
-    for (const CanardCANFrame* txf = NULL; (txf = canardPeekTxQueue(&canard)) != NULL;)
+    for (;;)
     {
-        const int16_t tx_res = socketcanTransmit(socketcan, txf, 0);
-        if (tx_res < 0)         // Failure - drop the frame and report
+        for (const CanardCANFrame* txf = NULL;
+             (tx_batch_len < SOCKETCAN_BATCH_MAX_FRAMES) && ((txf = canardPeekTxQueue(&canard)) != NULL);)
         {
+            tx_batch[tx_batch_len++] = *txf;
             canardPopTxQueue(&canard);
-            (void)fprintf(stderr, "Transmit error %d, frame dropped, errno '%s'\n", tx_res, strerror(errno));
         }
-        else if (tx_res > 0)    // Success - just drop the frame
+        if (tx_batch_len == 0)
         {
-            canardPopTxQueue(&canard);
+            break;
         }
-        else                    // Timeout - just exit and try again later
+
+        int16_t tx_res = socketcanTransmitBatch(socketcan, tx_batch, tx_batch_len, 0);
+        if (tx_res < 0)         // Failure - drop the first frame and report
+        {
+            (void)fprintf(stderr, "Transmit error %d, frame dropped, errno '%s'\n", tx_res, strerror(errno));
+            tx_res = 1;
+        }
+        else if (tx_res == 0)   // Timeout - just exit and try again later
         {
             break;
         }
+        else
+        {
+            ;                   // Success - drop the frames that went out
+        }
+        tx_batch_len = (uint16_t)(tx_batch_len - (uint16_t)tx_res);
+        memmove(&tx_batch[0], &tx_batch[tx_res], sizeof(tx_batch[0]) * tx_batch_len);
     }
 
     // Receiving
-    CanardCANFrame rx_frame;
+    CanardCANFrame rx_frames[SOCKETCAN_BATCH_MAX_FRAMES];
+    const int16_t rx_res = socketcanReceiveBatch(socketcan, rx_frames, SOCKETCAN_BATCH_MAX_FRAMES, timeout_msec);
     const uint64_t timestamp = getMonotonicTimestampUSec();
-    const int16_t rx_res = socketcanReceive(socketcan, &rx_frame, timeout_msec);
     if (rx_res < 0)             // Failure - report
     {
         (void)fprintf(stderr, "Receive error %d, errno '%s'\n", rx_res, strerror(errno));
     }
-    else if (rx_res > 0)        // Success - process the frame
-    {
-        canardHandleRxFrame(&canard, &rx_frame, timestamp);
-    }
-    else
+    for (int16_t i = 0; i < rx_res; i++)
     {
-        ;                       // Timeout - nothing to do
+        canardHandleRxFrame(&canard, &rx_frames[i], timestamp);
     }
 }
 
@@ -519,6 +746,9 @@ int main(int argc, char** argv)
         processTxRxOnce(&socketcan, 10);
 
         const uint64_t ts = getMonotonicTimestampUSec();
+#if CANARD_ENABLE_BUSLOAD
+        canardUpdateBusLoad(&canard, ts);
+#endif
 
         if (ts >= next_1hz_service_at)
         {
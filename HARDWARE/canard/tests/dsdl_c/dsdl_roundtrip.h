@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+#ifndef DSDL_ROUNDTRIP_H
+#define DSDL_ROUNDTRIP_H
+
+#include <stdint.h>
+#include "canard.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// Memory for the dynamic arrays of one structure, both before encoding and after decoding
+#define DSDL_ROUND_TRIP_POOL_SIZE       65536U
+
+/**
+ * One entry per data type (or per request and response of a service); the table is generated by
+ * generate_roundtrip.py from the bundled DSDL definitions.
+ */
+typedef struct
+{
+    const char* name;
+    uint64_t signature;
+    uint16_t max_size;                          ///< Size of the payload buffers, in bytes
+
+    /// Fills the structure with values derived from the seed and encodes it. Returns the payload length.
+    uint16_t (*make)(uint32_t seed, uint8_t* payload);
+
+    /// Fills the structure like make() does and returns its encoded size in bytes, computed without encoding it.
+    uint32_t (*encoded_size)(uint32_t seed);
+
+    /// Decodes the transfer (with the tail array optimization) and encodes the result again.
+    /// Returns the payload length, or negative error code if the transfer could not be decoded.
+    int32_t (*reencode)(const CanardRxTransfer* transfer, uint8_t* payload);
+
+    /// Fills the structure like make() does and streams it into the started transfer; see canardBeginBroadcast().
+    /// Returns the result of canardFinishTransfer().
+    int16_t (*stream)(uint32_t seed, CanardBitWriter* writer);
+
+    /// Decodes the transfer (with the tail array optimization) and reads every field again through the view.
+    /// Returns the number of fields the view reads differently, or negative error code if it could not be decoded.
+    int32_t (*check_view)(const CanardRxTransfer* transfer);
+} DsdlRoundTripType;
+
+extern const DsdlRoundTripType dsdlRoundTripTypes[];
+extern const uint16_t dsdlRoundTripTypeCount;
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2018 UAVCAN Team
+#
+# Generates the round-trip test table of the C backend of the DSDL compiler (see dsdl_roundtrip.h).
+# For every data type found in the given DSDL namespaces it emits a function that fills the C structure with
+# pseudo-random values and encodes it, a function that computes the encoded size of the same values, a function that
+# decodes a received transfer and encodes the result again, and a function that streams the same values into TX frames.
+# Every field read through the views is compared with the decoded structure. The fill functions are shared with the
+# harness of the compiler (libcanard_dsdlc --emit_harness).
+# The headers of the types are expected to be generated with: libcanard_dsdlc --header_only
+#
+# Usage: generate_roundtrip.py <DSDL namespace directory> <output C file>
+#
+
+import os
+import sys
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+DSDLC_DIR = os.path.join(SCRIPT_DIR, '..', '..', 'dsdl_compiler')
+sys.path.insert(0, DSDLC_DIR)
+sys.path.insert(0, os.path.join(DSDLC_DIR, 'pyuavcan'))
+
+from uavcan import dsdl                                                                 # noqa: E402
+from libcanard_dsdl_compiler import type_output_filename, type_to_c_type               # noqa: E402
+from libcanard_dsdl_compiler.harness import RANDOM_SUPPORT, c_name, fill_function, structs_of  # noqa: E402
+
+
+def check_value(t, value, getter, indent):
+    """Returns the lines that count the mismatches between a decoded value and the view getter of the DSDL type t."""
+    pad = ' ' * indent
+    if t.category == t.CATEGORY_PRIMITIVE:
+        c_type = type_to_c_type(t)['cpp_type']
+        return [pad + '{',
+                pad + '    const %s got = %s;' % (c_type, getter % ''),
+                pad + '    errors += (memcmp(&got, &%s, sizeof(got)) != 0) ? 1U : 0U;' % value,
+                pad + '}']
+    # Compound
+    return [pad + '{',
+            pad + '    %s_view item;' % c_name(t),
+            pad + '    ' + (getter % ', &item') + ';',
+            pad + '    errors += view_check_%s(&%s, &item);' % (c_name(t), value),
+            pad + '}']
+
+
+def check_field(view, f, indent):
+    pad = ' ' * indent
+    t = f.type
+    getter = '%s_view_get_%s(view%%s)' % (view, f.name)
+    if t.category != t.CATEGORY_ARRAY:
+        return check_value(t, 'value->' + f.name, getter, indent)
+    item_getter = '%s_view_get_%s(view, (uint16_t)i%%s)' % (view, f.name)
+    if t.mode == t.MODE_STATIC:
+        return [pad + 'for (uint32_t i = 0; i < %dU; i++)' % t.max_size, pad + '{'] + \
+               check_value(t.value_type, 'value->%s[i]' % f.name, item_getter, indent + 4) + [pad + '}']
+    return [pad + 'if (%s_view_get_%s_len(view) != value->%s.len)' % (view, f.name, f.name),
+            pad + '{',
+            pad + '    errors++;',
+            pad + '}',
+            pad + 'for (uint32_t i = 0; i < value->%s.len; i++)' % f.name,
+            pad + '{'] + \
+           check_value(t.value_type, 'value->%s.data[i]' % f.name, item_getter, indent + 4) + [pad + '}']
+
+
+def view_check_function(name, fields, union):
+    lines = ['static uint32_t view_check_%s(const %s* value, %s_view* view)' % (name, name, name),
+             '{',
+             '    uint32_t errors = 0;']
+    if union:
+        lines += ['    if ((uint32_t)%s_view_get_union_tag(view) != (uint32_t)value->union_tag)' % name,
+                  '    {',
+                  '        return 1;',
+                  '    }']
+        for index, f in enumerate(fields):
+            lines.append('    %s (value->union_tag == %d)' % ('if' if index == 0 else 'else if', index))
+            lines.append('    {')
+            lines += check_field(name, f, 8)
+            lines.append('    }')
+    else:
+        for f in fields:
+            if f.type.category != f.type.CATEGORY_VOID:
+                lines += check_field(name, f, 4)
+    lines += ['    (void)value;', '    (void)view;', '    return errors;', '}']
+    return lines
+
+
+def entry_functions(name):
+    return '''static uint16_t make_%(n)s(uint32_t seed, uint8_t* payload)
+{
+    %(n)s value;
+    uint8_t* pool = roundTripSourcePool;
+    memset(&value, 0, sizeof(value));
+    fill_%(n)s(&value, &seed, &pool);
+    return (uint16_t)%(n)s_encode(&value, payload);
+}
+
+static uint32_t size_%(n)s(uint32_t seed)
+{
+    %(n)s value;
+    uint8_t* pool = roundTripSourcePool;
+    memset(&value, 0, sizeof(value));
+    fill_%(n)s(&value, &seed, &pool);
+    return %(n)s_encoded_size(&value);
+}
+
+static int32_t reencode_%(n)s(const CanardRxTransfer* transfer, uint8_t* payload)
+{
+    %(n)s value;
+    uint8_t* dyn_arr_buf = roundTripDecodedPool;
+    memset(&value, 0, sizeof(value));
+    const int32_t ret = %(n)s_decode_internal(transfer, transfer->payload_len, &value, &dyn_arr_buf, 0,
+                                              CANARD_INTERNAL_ENABLE_TAO);
+    if (ret < 0)
+    {
+        return ret;
+    }
+    return (int32_t)%(n)s_encode(&value, payload);
+}
+
+static int32_t view_%(n)s(const CanardRxTransfer* transfer)
+{
+    %(n)s value;
+    uint8_t* dyn_arr_buf = roundTripDecodedPool;
+    memset(&value, 0, sizeof(value));
+    const int32_t ret = %(n)s_decode_internal(transfer, transfer->payload_len, &value, &dyn_arr_buf, 0,
+                                              CANARD_INTERNAL_ENABLE_TAO);
+    if (ret < 0)
+    {
+        return ret;
+    }
+    CanardRxPayloadReader reader;
+    canardInitRxPayloadReader(&reader, transfer);
+    %(n)s_view view;
+    %(n)s_view_init(&view, &reader, 0, CANARD_INTERNAL_ENABLE_TAO);
+    uint32_t errors = view_check_%(n)s(&value, &view);
+    if (%(n)s_view_end(&view) != (uint32_t)ret)
+    {
+        errors++;
+    }
+    return (int32_t)errors;
+}
+
+static int16_t stream_%(n)s(uint32_t seed, CanardBitWriter* writer)
+{
+    %(n)s value;
+    uint8_t* pool = roundTripSourcePool;
+    memset(&value, 0, sizeof(value));
+    fill_%(n)s(&value, &seed, &pool);
+    %(n)s_encode_writer(&value, writer, 1);
+    return canardFinishTransfer(writer);
+}
+''' % {'n': name}
+
+
+def main(source_dir, output_file):
+    types = dsdl.parse_namespaces([source_dir], [])
+    structs = structs_of(types)
+
+    out = ['/*',
+           ' * Round-trip test table of the C backend of the DSDL compiler.',
+           ' *',
+           ' * Autogenerated by generate_roundtrip.py, do not edit.',
+           ' */',
+           '',
+           '#include "dsdl_roundtrip.h"',
+           '#include <string.h>']
+    out += ['#include "%s"' % type_output_filename(t) for t in sorted(types, key=lambda x: x.full_name)]
+    out += ['',
+            'static uint8_t roundTripSourcePool[DSDL_ROUND_TRIP_POOL_SIZE] __attribute__((aligned(8)));',
+            'static uint8_t roundTripDecodedPool[DSDL_ROUND_TRIP_POOL_SIZE] __attribute__((aligned(8)));',
+            '',
+            RANDOM_SUPPORT]
+    out += ['static void fill_%s(%s* value, uint32_t* seed, uint8_t** pool);' % (s[0], s[0]) for s in structs]
+    out.append('')
+    out += ['static uint32_t view_check_%s(const %s* value, %s_view* view);' % (s[0], s[0], s[0]) for s in structs]
+    out.append('')
+    for name, _, _, _, fields, union, max_bitlen in structs:
+        out += fill_function(name, fields, union, max_bitlen)
+        out.append('')
+        out += view_check_function(name, fields, union)
+        out.append('')
+        out.append(entry_functions(name))
+    out.append('const DsdlRoundTripType dsdlRoundTripTypes[] =')
+    out.append('{')
+    for name, full_name, signature, max_size, _, _, _ in structs:
+        out.append('    { "%s", 0x%016XULL, %s, &make_%s, &size_%s, &reencode_%s, &stream_%s, &view_%s },' %
+                   (full_name, signature, max_size, name, name, name, name, name))
+    out.append('};')
+    out.append('')
+    out.append('const uint16_t dsdlRoundTripTypeCount = (uint16_t)(sizeof(dsdlRoundTripTypes) / '
+               'sizeof(dsdlRoundTripTypes[0]));')
+
+    with open(output_file, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        print('Usage: %s <DSDL namespace directory> <output C file>' % sys.argv[0], file=sys.stderr)
+        sys.exit(1)
+    main(sys.argv[1], sys.argv[2])
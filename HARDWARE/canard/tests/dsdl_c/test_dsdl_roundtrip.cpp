@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * Round trips through the C backend of the DSDL compiler for every bundled data type: a structure filled with
+ * pseudo-random values is encoded, the payload is decoded, and the result is encoded again; both payloads must match.
+ * The encoded sizes computed by the generated code must match the payloads.
+ * The decoders are exercised on contiguous payloads and on payloads scattered over the head, the middle blocks and
+ * the tail of a multi-frame transfer. Every field is also read through the generated views of the same transfers.
+ */
+
+#include <catch.hpp>
+#include <cstring>
+#include <vector>
+#include "canard.h"
+#include "dsdl_roundtrip.h"
+
+static const unsigned RoundTripsPerType = 50;
+
+static std::vector<uint8_t> makePayload(const DsdlRoundTripType& type, uint32_t seed)
+{
+    std::vector<uint8_t> payload(type.max_size + 1U, 0);
+    const uint16_t len = type.make(seed, payload.data());
+    REQUIRE(len <= type.max_size);
+    payload.resize(len);
+    return payload;
+}
+
+static CanardRxTransfer makeContiguousTransfer(const std::vector<uint8_t>& payload)
+{
+    CanardRxTransfer transfer;
+    std::memset(&transfer, 0, sizeof(transfer));
+    transfer.payload_head = payload.data();
+    transfer.payload_len = uint16_t(payload.size());
+    return transfer;
+}
+
+TEST_CASE("DsdlRoundTrip, Contiguous")
+{
+    REQUIRE(dsdlRoundTripTypeCount > 0);
+    for (uint16_t i = 0; i < dsdlRoundTripTypeCount; i++)
+    {
+        const DsdlRoundTripType& type = dsdlRoundTripTypes[i];
+        INFO(type.name);
+        for (uint32_t seed = 1; seed <= RoundTripsPerType; seed++)
+        {
+            INFO(seed);
+            const std::vector<uint8_t> payload = makePayload(type, seed);
+            const CanardRxTransfer transfer = makeContiguousTransfer(payload);
+            REQUIRE(type.encoded_size(seed) == payload.size());
+
+            std::vector<uint8_t> reencoded(type.max_size + 1U, 0);
+            REQUIRE(type.reencode(&transfer, reencoded.data()) == int32_t(payload.size()));
+            reencoded.resize(payload.size());
+            REQUIRE(reencoded == payload);
+            REQUIRE(type.check_view(&transfer) == 0);
+        }
+    }
+}
+
+TEST_CASE("DsdlRoundTrip, Truncated")
+{
+    // Cutting off the last byte of a payload without a tail array must be detected
+    for (uint16_t i = 0; i < dsdlRoundTripTypeCount; i++)
+    {
+        const DsdlRoundTripType& type = dsdlRoundTripTypes[i];
+        if (std::strcmp(type.name, "uavcan.protocol.NodeStatus") != 0)
+        {
+            continue;
+        }
+        std::vector<uint8_t> payload = makePayload(type, 1);
+        payload.pop_back();
+        const CanardRxTransfer transfer = makeContiguousTransfer(payload);
+        std::vector<uint8_t> reencoded(type.max_size + 1U, 0);
+        REQUIRE(type.reencode(&transfer, reencoded.data()) < 0);
+        return;
+    }
+    FAIL("uavcan.protocol.NodeStatus is not in the table");
+}
+
+TEST_CASE("DsdlRoundTrip, Garbage")
+{
+    // Arbitrary payloads must never make the decoders write outside of the structure or the dynamic array buffer
+    uint32_t state = 42;
+    for (uint16_t i = 0; i < dsdlRoundTripTypeCount; i++)
+    {
+        const DsdlRoundTripType& type = dsdlRoundTripTypes[i];
+        INFO(type.name);
+        for (unsigned iteration = 0; iteration < 20; iteration++)
+        {
+            std::vector<uint8_t> payload(iteration % 2 == 0 ? type.max_size : (state % (type.max_size + 1U)), 0);
+            for (uint8_t& byte : payload)
+            {
+                state = state * 1103515245U + 12345U;
+                byte = uint8_t(state >> 16);
+            }
+            const CanardRxTransfer transfer = makeContiguousTransfer(payload);
+            std::vector<uint8_t> reencoded(type.max_size + 1U, 0);
+            REQUIRE(type.reencode(&transfer, reencoded.data()) <= int32_t(type.max_size));
+        }
+    }
+}
+
+static const DsdlRoundTripType* g_type;
+static std::vector<uint8_t> g_reencoded;
+static int32_t g_reencode_result;
+static int32_t g_view_result;
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t,
+                                 CanardTransferType,
+                                 uint8_t)
+{
+    *out_data_type_signature = g_type->signature;
+    return true;
+}
+
+static void onTransferReception(CanardInstance*, CanardRxTransfer* transfer)
+{
+    g_reencoded.assign(g_type->max_size + 1U, 0);
+    g_reencode_result = g_type->reencode(transfer, g_reencoded.data());
+    g_view_result = g_type->check_view(transfer);
+}
+
+TEST_CASE("DsdlRoundTrip, MultiFrameTransfer")
+{
+    static uint8_t tx_arena[CANARD_MEM_BLOCK_SIZE * 512U];
+    static uint8_t rx_arena[CANARD_MEM_BLOCK_SIZE * 512U];
+    CanardInstance tx_ins;
+    CanardInstance rx_ins;
+    canardInit(&tx_ins, tx_arena, sizeof(tx_arena), &onTransferReception, &shouldAcceptTransfer, NULL);
+    canardInit(&rx_ins, rx_arena, sizeof(rx_arena), &onTransferReception, &shouldAcceptTransfer, NULL);
+    canardSetLocalNodeID(&tx_ins, 42);
+    canardSetLocalNodeID(&rx_ins, 43);
+
+    uint8_t transfer_id = 0;
+    uint64_t timestamp = 1000;
+    for (uint16_t i = 0; i < dsdlRoundTripTypeCount; i++)
+    {
+        g_type = &dsdlRoundTripTypes[i];
+        INFO(g_type->name);
+        for (uint32_t seed = 1; seed <= RoundTripsPerType / 5U; seed++)
+        {
+            INFO(seed);
+            const std::vector<uint8_t> payload = makePayload(*g_type, seed);
+            if (payload.size() < CANARD_CAN_FRAME_MAX_DATA_LEN)
+            {
+                continue;   // Covered by the contiguous test
+            }
+            REQUIRE(canardBroadcast(&tx_ins, g_type->signature, 20000, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                    payload.data(), uint16_t(payload.size())) > 0);
+
+            g_reencode_result = -1;
+            g_view_result = -1;
+            for (const CanardCANFrame* frame = canardPeekTxQueue(&tx_ins); frame != NULL;
+                 frame = canardPeekTxQueue(&tx_ins))
+            {
+                canardHandleRxFrame(&rx_ins, frame, timestamp++);
+                canardPopTxQueue(&tx_ins);
+            }
+            REQUIRE(g_reencode_result == int32_t(payload.size()));
+            g_reencoded.resize(payload.size());
+            REQUIRE(g_reencoded == payload);
+            REQUIRE(g_view_result == 0);
+        }
+    }
+}
+
+TEST_CASE("DsdlRoundTrip, StreamingWriter")
+{
+    // The generated writers must enqueue the same frames as the buffer encoders followed by canardBroadcast()
+    static uint8_t reference_arena[CANARD_MEM_BLOCK_SIZE * 512U];
+    static uint8_t streamed_arena[CANARD_MEM_BLOCK_SIZE * 512U];
+    CanardInstance reference;
+    CanardInstance streamed;
+    canardInit(&reference, reference_arena, sizeof(reference_arena), &onTransferReception, &shouldAcceptTransfer,
+               NULL);
+    canardInit(&streamed, streamed_arena, sizeof(streamed_arena), &onTransferReception, &shouldAcceptTransfer,
+               NULL);
+    canardSetLocalNodeID(&reference, 42);
+    canardSetLocalNodeID(&streamed, 42);
+
+    uint8_t reference_tid = 0;
+    uint8_t streamed_tid = 0;
+    for (uint16_t i = 0; i < dsdlRoundTripTypeCount; i++)
+    {
+        const DsdlRoundTripType& type = dsdlRoundTripTypes[i];
+        INFO(type.name);
+        for (uint32_t seed = 1; seed <= RoundTripsPerType / 5U; seed++)
+        {
+            INFO(seed);
+            const std::vector<uint8_t> payload = makePayload(type, seed);
+            const int16_t expected = canardBroadcast(&reference, type.signature, 20000, &reference_tid,
+                                                     CANARD_TRANSFER_PRIORITY_LOW, payload.data(),
+                                                     uint16_t(payload.size()));
+            REQUIRE(expected > 0);
+
+            CanardBitWriter writer;
+            REQUIRE(0 == canardBeginBroadcast(&streamed, &writer, type.signature, 20000, &streamed_tid,
+                                              CANARD_TRANSFER_PRIORITY_LOW));
+            REQUIRE(expected == type.stream(seed, &writer));
+
+            for (int16_t frame = 0; frame < expected; frame++)
+            {
+                INFO(frame);
+                const CanardCANFrame* const a = canardPeekTxQueue(&reference);
+                const CanardCANFrame* const b = canardPeekTxQueue(&streamed);
+                REQUIRE(a != NULL);
+                REQUIRE(b != NULL);
+                REQUIRE(a->id == b->id);
+                REQUIRE(a->data_len == b->data_len);
+                REQUIRE(std::memcmp(a->data, b->data, a->data_len) == 0);
+                canardPopTxQueue(&reference);
+                canardPopTxQueue(&streamed);
+            }
+            REQUIRE(canardPeekTxQueue(&streamed) == NULL);
+        }
+    }
+}
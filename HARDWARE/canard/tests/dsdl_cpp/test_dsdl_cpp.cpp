@@ -0,0 +1,515 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * Tests and benchmarks of the C++ backend of the DSDL compiler (libcanard_dsdlc --cpp).
+ * The generated C++ code is checked against the C backend and against a reference built with canardEncodeScalar().
+ * The benchmarks are hidden by default; run them with: run_dsdl_cpp_tests "[bench]"
+ */
+
+#include <catch.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include "canard.h"
+
+#include "uavcan/equipment/ahrs/RawIMU.hpp"
+#include "uavcan/protocol/GetNodeInfo.hpp"
+#include "uavcan/protocol/param/Value.hpp"
+
+#include "uavcan/equipment/ahrs/RawIMU.h"
+#include "uavcan/protocol/GetNodeInfo.h"
+#include "uavcan/protocol/param/Value.h"
+
+
+using CppRawIMU = uavcan::equipment::ahrs::RawIMU;
+using CppNodeInfo = uavcan::protocol::GetNodeInfo::Response;
+using CppValue = uavcan::protocol::param::Value;
+
+namespace
+{
+/**
+ * A GetNodeInfo response filled with random values, in both representations.
+ */
+struct NodeInfoSample
+{
+    CppNodeInfo cpp;
+    uavcan_protocol_GetNodeInfoResponse c;
+    uint8_t name[80];
+    uint8_t coa[255];
+
+    explicit NodeInfoSample(std::mt19937& rng)
+    {
+        std::memset(&c, 0, sizeof(c));
+        cpp.status.uptime_sec = c.status.uptime_sec = uint32_t(rng());
+        cpp.status.health = c.status.health = uint8_t(rng() % 4U);
+        cpp.status.mode = c.status.mode = uint8_t(rng() % 8U);
+        cpp.status.sub_mode = c.status.sub_mode = uint8_t(rng() % 8U);
+        cpp.status.vendor_specific_status_code = c.status.vendor_specific_status_code = uint16_t(rng());
+
+        cpp.software_version.major = c.software_version.major = uint8_t(rng());
+        cpp.software_version.minor = c.software_version.minor = uint8_t(rng());
+        cpp.software_version.optional_field_flags = c.software_version.optional_field_flags = uint8_t(rng());
+        cpp.software_version.vcs_commit = c.software_version.vcs_commit = uint32_t(rng());
+        cpp.software_version.image_crc = c.software_version.image_crc = (uint64_t(rng()) << 32U) | rng();
+
+        cpp.hardware_version.major = c.hardware_version.major = uint8_t(rng());
+        cpp.hardware_version.minor = c.hardware_version.minor = uint8_t(rng());
+        for (unsigned i = 0; i < 16; i++)
+        {
+            cpp.hardware_version.unique_id[i] = c.hardware_version.unique_id[i] = uint8_t(rng());
+        }
+
+        c.hardware_version.certificate_of_authenticity.len = uint8_t(rng() % 40U);
+        c.hardware_version.certificate_of_authenticity.data = coa;
+        cpp.hardware_version.certificate_of_authenticity.len = c.hardware_version.certificate_of_authenticity.len;
+        for (unsigned i = 0; i < c.hardware_version.certificate_of_authenticity.len; i++)
+        {
+            coa[i] = cpp.hardware_version.certificate_of_authenticity[i] = uint8_t(rng());
+        }
+
+        c.name.len = uint8_t(1U + (rng() % 80U));
+        c.name.data = name;
+        cpp.name.len = c.name.len;
+        for (unsigned i = 0; i < c.name.len; i++)
+        {
+            name[i] = cpp.name[i] = uint8_t('a' + (rng() % 26U));
+        }
+    }
+};
+
+/**
+ * Contiguous payload wrapped into a transfer, as it is seen by the decoders of a single-frame transfer.
+ */
+CanardRxTransfer makeTransfer(const uint8_t* payload, uint16_t payload_len)
+{
+    CanardRxTransfer transfer;
+    std::memset(&transfer, 0, sizeof(transfer));
+    transfer.payload_head = payload;
+    transfer.payload_len = payload_len;
+    return transfer;
+}
+
+/**
+ * RawIMU as the wire format defines it, serialized field by field with canardEncodeScalar()
+ */
+uint16_t encodeRawIMUReference(const CppRawIMU& msg, uint8_t* buf)
+{
+    std::memset(buf, 0, CppRawIMU::MaxSize);
+    uint32_t offset = 0;
+    canardEncodeScalar(buf, offset, 56, &msg.timestamp.usec);
+    offset += 56;
+    canardEncodeScalar(buf, offset, 32, &msg.integration_interval);
+    offset += 32;
+    const std::array<float, 3>* const latest[2] = { &msg.rate_gyro_latest, &msg.accelerometer_latest };
+    const std::array<float, 3>* const integral[2] = { &msg.rate_gyro_integral, &msg.accelerometer_integral };
+    for (unsigned k = 0; k < 2; k++)
+    {
+        for (float x : *latest[k])
+        {
+            const uint16_t h = canardConvertNativeFloatToFloat16(x);
+            canardEncodeScalar(buf, offset, 16, &h);
+            offset += 16;
+        }
+        for (float x : *integral[k])
+        {
+            canardEncodeScalar(buf, offset, 32, &x);
+            offset += 32;
+        }
+    }
+    for (float x : msg.covariance)      // Tail array optimization: no length prefix
+    {
+        const uint16_t h = canardConvertNativeFloatToFloat16(x);
+        canardEncodeScalar(buf, offset, 16, &h);
+        offset += 16;
+    }
+    return uint16_t((offset + 7U) / 8U);
+}
+
+CppRawIMU makeRawIMU(std::mt19937& rng, unsigned covariance_len)
+{
+    std::uniform_real_distribution<float> value(-100.0F, 100.0F);
+    CppRawIMU msg;
+    msg.timestamp.usec = ((uint64_t(rng()) << 32U) | rng()) & 0x00FFFFFFFFFFFFFFULL;
+    msg.integration_interval = value(rng);
+    for (unsigned i = 0; i < 3; i++)
+    {
+        // Float16-representable values survive the round trip unchanged
+        msg.rate_gyro_latest[i] = canardConvertFloat16ToNativeFloat(canardConvertNativeFloatToFloat16(value(rng)));
+        msg.accelerometer_latest[i] =
+            canardConvertFloat16ToNativeFloat(canardConvertNativeFloatToFloat16(value(rng)));
+        msg.rate_gyro_integral[i] = value(rng);
+        msg.accelerometer_integral[i] = value(rng);
+    }
+    for (unsigned i = 0; i < covariance_len; i++)
+    {
+        REQUIRE(msg.covariance.push_back(
+            canardConvertFloat16ToNativeFloat(canardConvertNativeFloatToFloat16(value(rng)))));
+    }
+    return msg;
+}
+
+bool isSame(const CppNodeInfo& a, const CppNodeInfo& b)
+{
+    return (a.status.uptime_sec == b.status.uptime_sec) &&
+           (a.status.health == b.status.health) &&
+           (a.status.mode == b.status.mode) &&
+           (a.status.sub_mode == b.status.sub_mode) &&
+           (a.status.vendor_specific_status_code == b.status.vendor_specific_status_code) &&
+           (a.software_version.major == b.software_version.major) &&
+           (a.software_version.minor == b.software_version.minor) &&
+           (a.software_version.optional_field_flags == b.software_version.optional_field_flags) &&
+           (a.software_version.vcs_commit == b.software_version.vcs_commit) &&
+           (a.software_version.image_crc == b.software_version.image_crc) &&
+           (a.hardware_version.major == b.hardware_version.major) &&
+           (a.hardware_version.minor == b.hardware_version.minor) &&
+           (a.hardware_version.unique_id == b.hardware_version.unique_id) &&
+           std::equal(a.hardware_version.certificate_of_authenticity.begin(),
+                      a.hardware_version.certificate_of_authenticity.end(),
+                      b.hardware_version.certificate_of_authenticity.begin(),
+                      b.hardware_version.certificate_of_authenticity.end()) &&
+           std::equal(a.name.begin(), a.name.end(), b.name.begin(), b.name.end());
+}
+
+bool bitwiseEqual(float a, float b)
+{
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+bool isSame(const CppRawIMU& a, const CppRawIMU& b)
+{
+    bool equal = (a.timestamp.usec == b.timestamp.usec) &&
+                 bitwiseEqual(a.integration_interval, b.integration_interval) &&
+                 (a.covariance.size() == b.covariance.size());
+    for (unsigned i = 0; i < 3; i++)
+    {
+        equal = equal && bitwiseEqual(a.rate_gyro_latest[i], b.rate_gyro_latest[i]) &&
+                bitwiseEqual(a.rate_gyro_integral[i], b.rate_gyro_integral[i]) &&
+                bitwiseEqual(a.accelerometer_latest[i], b.accelerometer_latest[i]) &&
+                bitwiseEqual(a.accelerometer_integral[i], b.accelerometer_integral[i]);
+    }
+    for (unsigned i = 0; equal && (i < a.covariance.size()); i++)
+    {
+        equal = bitwiseEqual(a.covariance[i], b.covariance[i]);
+    }
+    return equal;
+}
+
+template <typename Function>
+double measureNanosecondsPerCall(unsigned iterations, Function function)
+{
+    const auto started_at = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; i++)
+    {
+        function(i);
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - started_at;
+    return elapsed.count() / double(iterations);
+}
+
+volatile uint32_t g_sink;
+
+} // namespace
+
+
+TEST_CASE("DsdlCpp, Layout")
+{
+    // Offsets of the fields that precede the first variable-length field are compile-time constants
+    static_assert(CppRawIMU::Layout::timestamp.offset == 0U, "");
+    static_assert(CppRawIMU::Layout::integration_interval.offset == 56U, "");
+    static_assert(CppRawIMU::Layout::rate_gyro_latest.offset == 88U, "");
+    static_assert(CppRawIMU::Layout::rate_gyro_latest.width == 48U, "");
+    static_assert(CppRawIMU::Layout::accelerometer_integral.offset == 280U, "");
+    static_assert(CppRawIMU::Layout::covariance.offset == 376U, "");
+    static_assert(CppRawIMU::MaxBitLength == 376U + 6U + (36U * 16U), "");
+    static_assert(CppValue::Layout::union_tag.width == 3U, "");
+    static_assert(uavcan::protocol::GetNodeInfo::DefaultDataTypeID == UAVCAN_PROTOCOL_GETNODEINFO_ID, "");
+    static_assert(uavcan::protocol::GetNodeInfo::DataTypeSignature == UAVCAN_PROTOCOL_GETNODEINFO_SIGNATURE, "");
+    static_assert(CppNodeInfo::MaxSize == UAVCAN_PROTOCOL_GETNODEINFO_RESPONSE_MAX_SIZE, "");
+
+    // The encoder of a fixed-size type returns its end position as a compile-time constant
+    uint8_t buf[uavcan::protocol::NodeStatus::MaxSize];
+    const auto end = uavcan::protocol::NodeStatus().encodeInto<true>(buf, canard::dsdl::bits<0U>);
+    static_assert(std::decay_t<decltype(end)>::value == 56U, "");
+}
+
+TEST_CASE("DsdlCpp, MatchesCBackend")
+{
+    std::mt19937 rng(42);
+    for (unsigned iteration = 0; iteration < 200; iteration++)
+    {
+        NodeInfoSample sample(rng);
+
+        uint8_t c_buf[CppNodeInfo::MaxSize] = {};
+        uint8_t cpp_buf[CppNodeInfo::MaxSize];
+        const uint32_t c_len = uavcan_protocol_GetNodeInfoResponse_encode(&sample.c, c_buf);
+        const uint16_t cpp_len = sample.cpp.encode(cpp_buf);
+        REQUIRE(c_len == cpp_len);
+        REQUIRE(0 == std::memcmp(c_buf, cpp_buf, cpp_len));
+
+        CppNodeInfo decoded;
+        REQUIRE(decoded.decode(c_buf, cpp_len) > 0);
+        REQUIRE(isSame(decoded, sample.cpp));
+
+        const CanardRxTransfer transfer = makeTransfer(c_buf, cpp_len);
+        CppNodeInfo from_transfer;
+        REQUIRE(from_transfer.decode(transfer) > 0);
+        REQUIRE(isSame(from_transfer, sample.cpp));
+    }
+}
+
+TEST_CASE("DsdlCpp, UnionMatchesCBackend")
+{
+    uint8_t string_storage[128];
+    const char text[] = "parameter";
+
+    for (unsigned tag = 0; tag < 5; tag++)
+    {
+        uavcan_protocol_param_Value c;
+        std::memset(&c, 0, sizeof(c));
+        c.union_tag = uavcan_protocol_param_Value_ENUM(tag);
+        CppValue cpp;
+        cpp.union_tag = CppValue::Tag(tag);
+
+        if (tag == 1)
+        {
+            c.integer_value = cpp.integer_value = -1234567890123LL;
+        }
+        if (tag == 2)
+        {
+            c.real_value = cpp.real_value = 3.25F;
+        }
+        if (tag == 3)
+        {
+            c.boolean_value = cpp.boolean_value = 1;
+        }
+        if (tag == 4)
+        {
+            std::memcpy(string_storage, text, sizeof(text) - 1U);
+            c.string_value.len = uint8_t(sizeof(text) - 1U);
+            c.string_value.data = string_storage;
+            for (unsigned i = 0; i < sizeof(text) - 1U; i++)
+            {
+                cpp.string_value.push_back(uint8_t(text[i]));
+            }
+        }
+
+        uint8_t c_buf[CppValue::MaxSize] = {};
+        uint8_t cpp_buf[CppValue::MaxSize];
+        const uint32_t c_len = uavcan_protocol_param_Value_encode(&c, c_buf);
+        const uint16_t cpp_len = cpp.encode(cpp_buf);
+        REQUIRE(c_len == cpp_len);
+        REQUIRE(0 == std::memcmp(c_buf, cpp_buf, cpp_len));
+
+        CppValue decoded;
+        REQUIRE(decoded.decode(cpp_buf, cpp_len) >= 0);
+        REQUIRE(decoded.union_tag == cpp.union_tag);
+    }
+
+    // Tags past the last field are rejected
+    uint8_t bad_tag[1] = { 0xE0 };
+    CppValue decoded;
+    REQUIRE(decoded.decode(bad_tag, 1) < 0);
+}
+
+TEST_CASE("DsdlCpp, RawIMU")
+{
+    std::mt19937 rng(7);
+    for (unsigned covariance_len : { 0U, 1U, 9U, 36U })
+    {
+        const CppRawIMU msg = makeRawIMU(rng, covariance_len);
+
+        uint8_t reference[CppRawIMU::MaxSize];
+        uint8_t buf[CppRawIMU::MaxSize];
+        const uint16_t reference_len = encodeRawIMUReference(msg, reference);
+        const uint16_t len = msg.encode(buf);
+        REQUIRE(reference_len == len);
+        REQUIRE(0 == std::memcmp(reference, buf, len));
+
+        CppRawIMU decoded;
+        REQUIRE(decoded.decode(buf, len) > 0);
+        REQUIRE(isSame(decoded, msg));
+    }
+}
+
+TEST_CASE("DsdlCpp, MalformedPayload")
+{
+    std::mt19937 rng(1);
+    NodeInfoSample sample(rng);
+    uint8_t buf[CppNodeInfo::MaxSize];
+    const uint16_t len = sample.cpp.encode(buf);
+
+    // The certificate of authenticity is length-prefixed; a payload that ends within it is rejected
+    CppNodeInfo decoded;
+    REQUIRE(decoded.decode(buf, len) > 0);
+    REQUIRE(decoded.decode(buf, 30) < 0);
+
+    // A length prefix beyond the capacity is rejected; the string of a parameter value holds up to 128 bytes
+    uint8_t bad_length[CppValue::MaxSize] = {};
+    const uint8_t tag = uint8_t(CppValue::Tag::string_value);
+    const uint8_t too_long = 200;
+    canardEncodeScalar(bad_length, 0, 3, &tag);
+    canardEncodeScalar(bad_length, 3, 8, &too_long);
+    CppValue value;
+    REQUIRE(!value.decodeFrom<false>(bad_length, sizeof(bad_length) * 8U, canard::dsdl::bits<0U>).valid());
+}
+
+static CppNodeInfo g_received_node_info;
+static int32_t g_decode_result;
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t,
+                                 CanardTransferType,
+                                 uint8_t)
+{
+    *out_data_type_signature = uavcan::protocol::GetNodeInfo::DataTypeSignature;
+    return true;
+}
+
+static void onTransferReception(CanardInstance*, CanardRxTransfer* transfer)
+{
+    g_decode_result = g_received_node_info.decode(*transfer);
+}
+
+TEST_CASE("DsdlCpp, MultiFrameTransfer")
+{
+    uint8_t tx_arena[CANARD_MEM_BLOCK_SIZE * 32U];
+    uint8_t rx_arena[CANARD_MEM_BLOCK_SIZE * 32U];
+    CanardInstance tx_ins;
+    CanardInstance rx_ins;
+    canardInit(&tx_ins, tx_arena, sizeof(tx_arena), &onTransferReception, &shouldAcceptTransfer, NULL);
+    canardInit(&rx_ins, rx_arena, sizeof(rx_arena), &onTransferReception, &shouldAcceptTransfer, NULL);
+    canardSetLocalNodeID(&tx_ins, 42);
+    canardSetLocalNodeID(&rx_ins, 43);
+
+    std::mt19937 rng(3);
+    uint8_t transfer_id = 0;
+    for (unsigned iteration = 0; iteration < 20; iteration++)
+    {
+        NodeInfoSample sample(rng);
+        uint8_t buf[CppNodeInfo::MaxSize];
+        const uint16_t len = sample.cpp.encode(buf);
+        REQUIRE(canardBroadcast(&tx_ins, uavcan::protocol::GetNodeInfo::DataTypeSignature, 20000, &transfer_id,
+                                CANARD_TRANSFER_PRIORITY_LOW, buf, len) > 0);
+
+        // The payload is scattered over the head, the middle blocks and the tail of the received transfer
+        g_decode_result = 0;
+        for (const CanardCANFrame* frame = canardPeekTxQueue(&tx_ins); frame != NULL;
+             frame = canardPeekTxQueue(&tx_ins))
+        {
+            canardHandleRxFrame(&rx_ins, frame, 1000U + iteration);
+            canardPopTxQueue(&tx_ins);
+        }
+        REQUIRE(g_decode_result > 0);
+        REQUIRE(isSame(g_received_node_info, sample.cpp));
+    }
+}
+
+/*
+ * Encoding and decoding speed of the C++ backend against the C backend.
+ * Hidden by default; run explicitly with: run_dsdl_cpp_tests "[bench]"
+ */
+TEST_CASE("DsdlCpp, Benchmark", "[.][bench]")
+{
+    const unsigned Iterations = 1000000;
+    std::mt19937 rng(11);
+
+    {
+        const CppRawIMU cpp = makeRawIMU(rng, 9);
+        uavcan_equipment_ahrs_RawIMU c;
+        std::memset(&c, 0, sizeof(c));
+        float covariance[36];
+        c.timestamp.usec = cpp.timestamp.usec;
+        c.integration_interval = cpp.integration_interval;
+        for (unsigned i = 0; i < 3; i++)
+        {
+            c.rate_gyro_latest[i] = cpp.rate_gyro_latest[i];
+            c.rate_gyro_integral[i] = cpp.rate_gyro_integral[i];
+            c.accelerometer_latest[i] = cpp.accelerometer_latest[i];
+            c.accelerometer_integral[i] = cpp.accelerometer_integral[i];
+        }
+        c.covariance.len = uint8_t(cpp.covariance.size());
+        c.covariance.data = covariance;
+        std::copy(cpp.covariance.begin(), cpp.covariance.end(), covariance);
+
+        uint8_t buf[CppRawIMU::MaxSize] = {};
+        const double c_encode = measureNanosecondsPerCall(Iterations, [&](unsigned i) {
+            c.timestamp.usec = i;
+            g_sink = uavcan_equipment_ahrs_RawIMU_encode(&c, buf);
+        });
+        CppRawIMU mutable_cpp = cpp;
+        const double cpp_encode = measureNanosecondsPerCall(Iterations, [&](unsigned i) {
+            mutable_cpp.timestamp.usec = i;
+            g_sink = mutable_cpp.encode(buf);
+        });
+
+        const uint16_t len = cpp.encode(buf);
+        const CanardRxTransfer transfer = makeTransfer(buf, len);
+        uavcan_equipment_ahrs_RawIMU c_decoded;
+        float c_covariance[36];
+        const double c_decode = measureNanosecondsPerCall(Iterations, [&](unsigned) {
+            uint8_t* dyn_arr_buf = reinterpret_cast<uint8_t*>(c_covariance);
+            g_sink = uint32_t(uavcan_equipment_ahrs_RawIMU_decode(&transfer, len, &c_decoded, &dyn_arr_buf));
+        });
+        CppRawIMU cpp_decoded;
+        const double cpp_decode = measureNanosecondsPerCall(Iterations, [&](unsigned) {
+            g_sink = uint32_t(cpp_decoded.decode(transfer));
+        });
+
+        std::printf("RawIMU (%u bytes):                encode C %6.1f ns, C++ %6.1f ns; decode C %6.1f ns, C++ %6.1f ns\n",
+                    unsigned(len), c_encode, cpp_encode, c_decode, cpp_decode);
+    }
+
+    {
+        NodeInfoSample sample(rng);
+        uint8_t buf[CppNodeInfo::MaxSize] = {};
+        const double c_encode = measureNanosecondsPerCall(Iterations, [&](unsigned i) {
+            sample.c.status.uptime_sec = i;
+            g_sink = uavcan_protocol_GetNodeInfoResponse_encode(&sample.c, buf);
+        });
+        const double cpp_encode = measureNanosecondsPerCall(Iterations, [&](unsigned i) {
+            sample.cpp.status.uptime_sec = i;
+            g_sink = sample.cpp.encode(buf);
+        });
+
+        const uint16_t len = sample.cpp.encode(buf);
+        const CanardRxTransfer transfer = makeTransfer(buf, len);
+        uavcan_protocol_GetNodeInfoResponse c_decoded;
+        uint8_t dyn_arr[80 + 255];
+        const double c_decode = measureNanosecondsPerCall(Iterations, [&](unsigned) {
+            uint8_t* dyn_arr_buf = dyn_arr;
+            g_sink = uint32_t(uavcan_protocol_GetNodeInfoResponse_decode(&transfer, len, &c_decoded, &dyn_arr_buf));
+        });
+        CppNodeInfo cpp_decoded;
+        const double cpp_decode = measureNanosecondsPerCall(Iterations, [&](unsigned) {
+            g_sink = uint32_t(cpp_decoded.decode(transfer));
+        });
+
+        std::printf("GetNodeInfo.Response (%u bytes): encode C %6.1f ns, C++ %6.1f ns; decode C %6.1f ns, C++ %6.1f ns\n",
+                    unsigned(len), c_encode, cpp_encode, c_decode, cpp_decode);
+    }
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * The transfers declared in prebuilt_transfers.json are compiled into frames by libcanard_dsdlc --prebuild.
+ * Sending them must put exactly the same frames into the TX queue as encoding the equivalent structures with the
+ * generated C code and sending the payload with canardBroadcast() or canardRequestOrRespond(), whatever the values of
+ * the variable fields and the transfer ID are.
+ */
+
+#include <catch.hpp>
+#include <cstring>
+#include <vector>
+#include "canard.h"
+#include "prebuilt_transfers.h"
+#include "uavcan/protocol/GetNodeInfo.h"
+#include "uavcan/protocol/NodeStatus.h"
+#include "uavcan/protocol/param/GetSet.h"
+
+static const uint8_t LocalNodeID = 42;
+static const uint8_t RemoteNodeID = 7;
+
+static bool shouldAcceptTransfer(const CanardInstance*, uint64_t*, uint16_t, CanardTransferType, uint8_t)
+{
+    return false;
+}
+
+static void onTransferReception(CanardInstance*, CanardRxTransfer*) { }
+
+struct Node
+{
+    uint8_t arena[CANARD_MEM_BLOCK_SIZE * 32U];
+    CanardInstance ins;
+
+    explicit Node(size_t arena_size = sizeof(arena))
+    {
+        canardInit(&ins, arena, arena_size, &onTransferReception, &shouldAcceptTransfer, nullptr);
+        canardSetLocalNodeID(&ins, LocalNodeID);
+    }
+
+    std::vector<CanardCANFrame> drain()
+    {
+        std::vector<CanardCANFrame> frames;
+        for (const CanardCANFrame* frame = canardPeekTxQueue(&ins); frame != nullptr; frame = canardPeekTxQueue(&ins))
+        {
+            frames.push_back(*frame);
+            canardPopTxQueue(&ins);
+        }
+        return frames;
+    }
+};
+
+static void requireSameFrames(const std::vector<CanardCANFrame>& a, const std::vector<CanardCANFrame>& b)
+{
+    REQUIRE(a.size() == b.size());
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        INFO(i);
+        REQUIRE(a[i].id == b[i].id);
+        REQUIRE(a[i].data_len == b[i].data_len);
+        REQUIRE(std::memcmp(a[i].data, b[i].data, a[i].data_len) == 0);
+    }
+}
+
+TEST_CASE("Prebuilt, GetNodeInfoResponse")
+{
+    uint8_t certificate[] = { 170, 187 };
+    const char name[] = "org.example.stm32node";
+
+    uavcan_protocol_GetNodeInfoResponse response;
+    std::memset(&response, 0, sizeof(response));
+    response.software_version.major = 1;
+    response.software_version.minor = 2;
+    response.software_version.optional_field_flags = UAVCAN_PROTOCOL_SOFTWAREVERSION_OPTIONAL_FIELD_FLAG_VCS_COMMIT;
+    response.software_version.vcs_commit = 305419896U;
+    response.hardware_version.major = 3;
+    for (uint8_t i = 0; i < 16U; i++)
+    {
+        response.hardware_version.unique_id[i] = uint8_t(i + 1U);
+    }
+    response.hardware_version.certificate_of_authenticity.len = sizeof(certificate);
+    response.hardware_version.certificate_of_authenticity.data = certificate;
+    response.name.len = uint8_t(std::strlen(name));
+    response.name.data = reinterpret_cast<uint8_t*>(const_cast<char*>(name));
+
+    REQUIRE(node_info.num_frames == CANARD_TX_FRAMES(node_info.payload_len));
+    REQUIRE(node_info.data_type_id == UAVCAN_PROTOCOL_GETNODEINFO_ID);
+
+    for (uint32_t uptime = 0; uptime < 100000U; uptime += 9973U)
+    {
+        INFO(uptime);
+        response.status.uptime_sec = uptime;
+        response.status.health = uint8_t(uptime % 4U);
+        response.status.mode = uint8_t(uptime % 5U);
+        response.status.vendor_specific_status_code = uint16_t(uptime * 7U);
+
+        uint8_t payload[UAVCAN_PROTOCOL_GETNODEINFO_RESPONSE_MAX_SIZE];
+        const uint32_t len = uavcan_protocol_GetNodeInfoResponse_encode(&response, payload);
+        REQUIRE(len == node_info.payload_len);
+
+        uint8_t variable[NODE_INFO_VARIABLE_SIZE];
+        REQUIRE(uavcan_protocol_NodeStatus_encode(&response.status, &variable[NODE_INFO_STATUS_INDEX]) ==
+                NODE_INFO_VARIABLE_SIZE);
+
+        Node encoded;
+        Node prebuilt;
+        uint8_t transfer_id = uint8_t(uptime % 32U);
+        REQUIRE(canardRequestOrRespond(&encoded.ins, RemoteNodeID, UAVCAN_PROTOCOL_GETNODEINFO_SIGNATURE,
+                                       UAVCAN_PROTOCOL_GETNODEINFO_ID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                       CanardResponse, payload, uint16_t(len)) == node_info.num_frames);
+        REQUIRE(canardRequestOrRespondPrebuilt(&prebuilt.ins, RemoteNodeID, &node_info, &transfer_id,
+                                               CANARD_TRANSFER_PRIORITY_LOW, CanardResponse, variable) ==
+                node_info.num_frames);
+        requireSameFrames(encoded.drain(), prebuilt.drain());
+        REQUIRE(transfer_id == uint8_t(uptime % 32U));               // Responses keep the transfer ID
+    }
+}
+
+TEST_CASE("Prebuilt, NodeStatus")
+{
+    uavcan_protocol_NodeStatus status;
+    std::memset(&status, 0, sizeof(status));
+    status.health = UAVCAN_PROTOCOL_NODESTATUS_HEALTH_WARNING;
+    status.mode = UAVCAN_PROTOCOL_NODESTATUS_MODE_MAINTENANCE;
+    status.sub_mode = 5;
+
+    Node encoded;
+    Node prebuilt;
+    uint8_t encoded_transfer_id = 30;
+    uint8_t prebuilt_transfer_id = 30;
+    for (uint32_t uptime = 0; uptime < 40U; uptime++)                 // The transfer ID wraps around
+    {
+        INFO(uptime);
+        status.uptime_sec = uptime * 1000003U;
+        status.vendor_specific_status_code = uint16_t(uptime * 4099U);
+
+        uint8_t payload[UAVCAN_PROTOCOL_NODESTATUS_MAX_SIZE];
+        const uint32_t len = uavcan_protocol_NodeStatus_encode(&status, payload);
+        REQUIRE(len == node_status.payload_len);
+
+        uint8_t variable[NODE_STATUS_VARIABLE_SIZE];
+        std::memcpy(&variable[NODE_STATUS_UPTIME_SEC_INDEX], &payload[0], 4);
+        std::memcpy(&variable[NODE_STATUS_VENDOR_SPECIFIC_STATUS_CODE_INDEX], &payload[5], 2);
+
+        REQUIRE(canardBroadcast(&encoded.ins, UAVCAN_PROTOCOL_NODESTATUS_SIGNATURE, UAVCAN_PROTOCOL_NODESTATUS_ID,
+                                &encoded_transfer_id, CANARD_TRANSFER_PRIORITY_MEDIUM, payload, uint16_t(len)) == 1);
+        REQUIRE(canardBroadcastPrebuilt(&prebuilt.ins, &node_status, &prebuilt_transfer_id,
+                                        CANARD_TRANSFER_PRIORITY_MEDIUM, variable) == 1);
+        requireSameFrames(encoded.drain(), prebuilt.drain());
+        REQUIRE(prebuilt_transfer_id == encoded_transfer_id);
+    }
+}
+
+TEST_CASE("Prebuilt, ParamGetSetResponse")
+{
+    const char name[] = "esc.rpm_max";
+
+    uavcan_protocol_param_GetSetResponse response;
+    std::memset(&response, 0, sizeof(response));
+    response.value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
+    response.default_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_REAL_VALUE;
+    response.default_value.real_value = 0.5F;
+    response.max_value.union_tag = UAVCAN_PROTOCOL_PARAM_NUMERICVALUE_INTEGER_VALUE;
+    response.max_value.integer_value = 2000;
+    response.min_value.union_tag = UAVCAN_PROTOCOL_PARAM_NUMERICVALUE_EMPTY;
+    response.name.len = uint8_t(std::strlen(name));
+    response.name.data = reinterpret_cast<uint8_t*>(const_cast<char*>(name));
+
+    const int64_t values[] = { 1500, 0, -1, 0x123456789ABCDEF0LL, -32768 };
+    for (const int64_t value : values)
+    {
+        INFO(value);
+        response.value.integer_value = value;
+
+        uint8_t payload[UAVCAN_PROTOCOL_PARAM_GETSET_RESPONSE_MAX_SIZE] = {};     // The encoder skips the void fields
+        const uint32_t len = uavcan_protocol_param_GetSetResponse_encode(&response, payload);
+        REQUIRE(len == param_rpm_max.payload_len);
+
+        uint8_t variable[PARAM_RPM_MAX_VARIABLE_SIZE];
+        canardEncodeScalar(variable, PARAM_RPM_MAX_VALUE_INTEGER_VALUE_INDEX * 8U, 64, &value);
+
+        Node encoded;
+        Node prebuilt;
+        uint8_t transfer_id = 17;
+        REQUIRE(canardRequestOrRespond(&encoded.ins, RemoteNodeID, UAVCAN_PROTOCOL_PARAM_GETSET_SIGNATURE,
+                                       UAVCAN_PROTOCOL_PARAM_GETSET_ID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                       CanardResponse, payload, uint16_t(len)) == param_rpm_max.num_frames);
+        REQUIRE(canardRequestOrRespondPrebuilt(&prebuilt.ins, RemoteNodeID, &param_rpm_max, &transfer_id,
+                                               CANARD_TRANSFER_PRIORITY_LOW, CanardResponse, variable) ==
+                param_rpm_max.num_frames);
+        requireSameFrames(encoded.drain(), prebuilt.drain());
+    }
+}
+
+TEST_CASE("Prebuilt, Errors")
+{
+    uint8_t variable[NODE_INFO_VARIABLE_SIZE] = {};
+    uint8_t transfer_id = 0;
+
+    // Not enough memory: nothing is enqueued
+    Node small(CANARD_MEM_BLOCK_SIZE * 4U);
+    REQUIRE(canardRequestOrRespondPrebuilt(&small.ins, RemoteNodeID, &node_info, &transfer_id,
+                                           CANARD_TRANSFER_PRIORITY_LOW, CanardResponse, variable) ==
+            -CANARD_ERROR_OUT_OF_MEMORY);
+    REQUIRE(canardPeekTxQueue(&small.ins) == nullptr);
+    REQUIRE(canardGetPoolAllocatorStatistics(&small.ins).current_usage_blocks == 0);
+
+    Node node;
+    REQUIRE(canardBroadcastPrebuilt(&node.ins, nullptr, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW, nullptr) ==
+            -CANARD_ERROR_INVALID_ARGUMENT);
+
+    // Variable bytes are required when there are variable fields
+    REQUIRE(canardRequestOrRespondPrebuilt(&node.ins, RemoteNodeID, &node_info, &transfer_id,
+                                           CANARD_TRANSFER_PRIORITY_LOW, CanardResponse, nullptr) ==
+            -CANARD_ERROR_INVALID_ARGUMENT);
+
+    // Inconsistent tables are rejected before anything is allocated
+    CanardPrebuiltTransfer broken = node_info;
+    broken.num_frames = uint8_t(broken.num_frames - 1U);
+    REQUIRE(canardRequestOrRespondPrebuilt(&node.ins, RemoteNodeID, &broken, &transfer_id,
+                                           CANARD_TRANSFER_PRIORITY_LOW, CanardResponse, variable) ==
+            -CANARD_ERROR_INVALID_ARGUMENT);
+
+    const CanardPrebuiltField overlapping[] = { { 0, 4, 0 }, { 3, 2, 0 } };
+    broken = node_status;
+    broken.fields = overlapping;
+    REQUIRE(canardBroadcastPrebuilt(&node.ins, &broken, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW, variable) ==
+            -CANARD_ERROR_INVALID_ARGUMENT);
+    REQUIRE(canardPeekTxQueue(&node.ins) == nullptr);
+    REQUIRE(transfer_id == 0);
+
+    // Anonymous nodes cannot send multi-frame transfers
+    Node anonymous;
+    canardInit(&anonymous.ins, anonymous.arena, sizeof(anonymous.arena), &onTransferReception, &shouldAcceptTransfer,
+               nullptr);
+    broken = node_info;
+    broken.data_type_id = 1;
+    REQUIRE(canardBroadcastPrebuilt(&anonymous.ins, &broken, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW, variable) ==
+            -CANARD_ERROR_NODE_ID_NOT_SET);
+    REQUIRE(canardPeekTxQueue(&anonymous.ins) == nullptr);
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+/*
+ * Batch float16 conversions, built once per backend (see CANARD_FLOAT16_BACKEND). Every backend must be bit-exact
+ * with the scalar functions. The exhaustive check of all 2^32 floats and the benchmark are hidden, run them with:
+ *   run_float16_tests_<BACKEND> "[exhaustive]"
+ *   run_float16_tests_<BACKEND> "[bench]"
+ */
+
+#include <catch.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "canard.h"
+
+static const char* backendName()
+{
+    switch (CANARD_FLOAT16_BACKEND)
+    {
+    case CANARD_FLOAT16_BACKEND_TABLE: return "table";
+    case CANARD_FLOAT16_BACKEND_SSE2:  return "sse2";
+    case CANARD_FLOAT16_BACKEND_F16C:  return "f16c";
+    default:                           return "scalar";
+    }
+}
+
+static uint32_t floatBits(float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsToFloat(uint32_t bits)
+{
+    float value = 0;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/// Converts the floats in one batch and compares with the scalar function; returns the number of mismatches
+static unsigned checkFloatToHalf(const std::vector<float>& values)
+{
+    std::vector<uint16_t> batch(values.size());
+    canardConvertNativeFloatArrayToFloat16(values.data(), batch.data(), values.size());
+    unsigned mismatches = 0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        const uint16_t expected = canardConvertNativeFloatToFloat16(values[i]);
+        if (batch[i] != expected)
+        {
+            if (mismatches < 10)
+            {
+                std::printf("float %08x: expected %04x, got %04x\n", unsigned(floatBits(values[i])),
+                            unsigned(expected), unsigned(batch[i]));
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+TEST_CASE("Float16Batch, HalfToFloatExhaustive")
+{
+    INFO(backendName());
+    std::vector<uint16_t> values(65536U + 1U);
+    for (uint32_t i = 0; i < 65536U; i++)
+    {
+        values[i + 1U] = uint16_t(i);
+    }
+
+    // Both an aligned and a misaligned start, so that the vector code and the remainder are exercised
+    for (size_t start = 0; start < 2U; start++)
+    {
+        std::vector<float> batch(values.size() - start);
+        canardConvertFloat16ArrayToNativeFloat(&values[start], batch.data(), batch.size());
+        unsigned mismatches = 0;
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            const float expected = canardConvertFloat16ToNativeFloat(values[start + i]);
+            if (floatBits(batch[i]) != floatBits(expected))
+            {
+                mismatches++;
+            }
+        }
+        REQUIRE(mismatches == 0);
+    }
+}
+
+TEST_CASE("Float16Batch, FloatToHalf")
+{
+    INFO(backendName());
+
+    // Every sign, exponent and leading mantissa bits, with the low bits that decide the rounding
+    static const uint32_t LowBits[] = { 0x000U, 0x001U, 0x7FFU, 0x800U, 0x801U, 0xFFFU, 0x1800U, 0x1FFFU };
+    std::vector<float> values;
+    values.reserve(1U << 20U);
+    for (uint32_t low : LowBits)
+    {
+        values.clear();
+        for (uint32_t high = 0; high < (1U << 19U); high++)
+        {
+            values.push_back(bitsToFloat((high << 13U) | low));
+        }
+        INFO(low);
+        REQUIRE(checkFloatToHalf(values) == 0);
+    }
+
+    // Lengths that are not a multiple of the vector width
+    for (size_t count = 0; count < 20U; count++)
+    {
+        std::vector<float> short_values;
+        for (size_t i = 0; i < count; i++)
+        {
+            short_values.push_back(float(i) * 1234.5F - 10000.0F);
+        }
+        REQUIRE(checkFloatToHalf(short_values) == 0);
+    }
+}
+
+TEST_CASE("Float16Batch, FloatToHalfExhaustive", "[.][exhaustive]")
+{
+    INFO(backendName());
+    std::vector<float> values(1U << 16U);
+    unsigned mismatches = 0;
+    for (uint32_t high = 0; high < (1U << 16U); high++)
+    {
+        for (uint32_t low = 0; low < (1U << 16U); low++)
+        {
+            values[low] = bitsToFloat((high << 16U) | low);
+        }
+        mismatches += checkFloatToHalf(values);
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("Float16Batch, Throughput", "[.][bench]")
+{
+    const size_t Count = 4096;
+    const unsigned Rounds = 2000;
+    std::vector<uint16_t> halves(Count);
+    std::vector<float> floats(Count);
+    for (size_t i = 0; i < Count; i++)
+    {
+        // Normal finite values, like typical sensor data; denormals are much slower on x86 with every backend
+        halves[i] = uint16_t(0x0400U + ((i * 40503U) % 0x7800U) | ((i & 1U) << 15U));
+        floats[i] = float(i) * 0.37F - 700.0F;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    volatile uint32_t sink = 0;
+
+    auto measure = [&](const char* what, void (*run)(std::vector<uint16_t>&, std::vector<float>&)) {
+        const auto started = Clock::now();
+        for (unsigned r = 0; r < Rounds; r++)
+        {
+            run(halves, floats);
+            sink = sink + halves[r % Count] + floatBits(floats[r % Count]);
+        }
+        const double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+        std::printf("%-7s %-28s %8.1f Mvalues/s\n", backendName(), what, double(Count) * Rounds / elapsed / 1e6);
+    };
+
+    measure("float16 -> float, batch", [](std::vector<uint16_t>& h, std::vector<float>& f) {
+        canardConvertFloat16ArrayToNativeFloat(h.data(), f.data(), h.size());
+    });
+    measure("float16 -> float, scalar", [](std::vector<uint16_t>& h, std::vector<float>& f) {
+        for (size_t i = 0; i < h.size(); i++)
+        {
+            f[i] = canardConvertFloat16ToNativeFloat(h[i]);
+        }
+    });
+    measure("float -> float16, batch", [](std::vector<uint16_t>& h, std::vector<float>& f) {
+        canardConvertNativeFloatArrayToFloat16(f.data(), h.data(), f.size());
+    });
+    measure("float -> float16, scalar", [](std::vector<uint16_t>& h, std::vector<float>& f) {
+        for (size_t i = 0; i < f.size(); i++)
+        {
+            h[i] = canardConvertNativeFloatToFloat16(f[i]);
+        }
+    });
+}
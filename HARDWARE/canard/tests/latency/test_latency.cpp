@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+/*
+ * Tests of the latency histograms (CANARD_ENABLE_LATENCY_HISTOGRAMS), built with a narrow range so that the
+ * clamping is tested. The clock is injected through canardTraceGetTimestamp().
+ */
+
+#include <catch.hpp>
+#include <vector>
+#include "canard.h"
+
+#if !CANARD_ENABLE_LATENCY_HISTOGRAMS || (CANARD_LATENCY_SUB_BUCKET_BITS != 2U) || (CANARD_LATENCY_RANGE_BITS != 16U)
+# error "This test must be built with CANARD_ENABLE_LATENCY_HISTOGRAMS=1, CANARD_LATENCY_SUB_BUCKET_BITS=2U, " \
+        "CANARD_LATENCY_RANGE_BITS=16U"
+#endif
+
+static const uint16_t MessageDataTypeID = 20000;
+static const uint64_t MessageSignature = 0x1122334455667788ULL;
+
+static uint32_t g_timestamp = 0;
+static uint32_t g_timestamp_step = 0;          ///< Added after every read, so that the library sees time passing
+static unsigned g_num_received = 0;
+
+extern "C" uint32_t canardTraceGetTimestamp(void)
+{
+    const uint32_t out = g_timestamp;
+    g_timestamp += g_timestamp_step;
+    return out;
+}
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t)
+{
+    *out_data_type_signature = MessageSignature;
+    return (transfer_type == CanardTransferTypeBroadcast) && (data_type_id == MessageDataTypeID);
+}
+
+static void onTransferReception(CanardInstance*, CanardRxTransfer*)
+{
+    g_num_received++;
+}
+
+struct LatencyFixture
+{
+    uint8_t tx_arena[1024];
+    uint8_t rx_arena[1024];
+    CanardInstance tx;
+    CanardInstance rx;
+    uint8_t transfer_id = 0;
+
+    LatencyFixture()
+    {
+        canardInit(&tx, tx_arena, sizeof(tx_arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+        canardInit(&rx, rx_arena, sizeof(rx_arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+        canardSetLocalNodeID(&tx, 42);
+        canardSetLocalNodeID(&rx, 43);
+        canardLatencyReset();
+        g_timestamp = 1000;
+        g_timestamp_step = 0;
+        g_num_received = 0;
+    }
+
+    void broadcast(uint16_t payload_len)
+    {
+        uint8_t payload[64] = { 0 };
+        REQUIRE(canardBroadcast(&tx, MessageSignature, MessageDataTypeID, &transfer_id,
+                                CANARD_TRANSFER_PRIORITY_MEDIUM, payload, payload_len) > 0);
+    }
+};
+
+
+TEST_CASE("Latency, Percentiles")
+{
+    canardLatencyReset();
+    REQUIRE(canardGetLatencyStatistics(CanardLatencyPathTxComplete).count == 0);
+    REQUIRE(canardGetLatencyPercentile(CanardLatencyPathTxComplete, 500) == 0);
+
+    for (uint32_t i = 1; i <= 1000; i++)
+    {
+        canardLatencyRecord(CanardLatencyPathTxComplete, i);
+    }
+
+    // Four buckets per power of two: the percentiles are the upper bounds, at most 25% above the true values
+    const CanardLatencyStatistics stats = canardGetLatencyStatistics(CanardLatencyPathTxComplete);
+    REQUIRE(stats.count == 1000);
+    REQUIRE(stats.p50 == 511);
+    REQUIRE(stats.p99 == 1000);         // The upper bound 1023 of the bucket is clamped to the maximum
+    REQUIRE(stats.max == 1000);
+    REQUIRE(canardGetLatencyPercentile(CanardLatencyPathTxComplete, 0) == 1);
+    REQUIRE(canardGetLatencyPercentile(CanardLatencyPathTxComplete, 5) == 5);       // Values below 8 are exact
+    REQUIRE(canardGetLatencyPercentile(CanardLatencyPathTxComplete, 10) == 11);
+    REQUIRE(canardGetLatencyPercentile(CanardLatencyPathTxComplete, 800) == 895);
+    REQUIRE(canardGetLatencyPercentile(CanardLatencyPathTxComplete, 1000) == 1000);
+
+    // The other paths are independent
+    REQUIRE(canardGetLatencyStatistics(CanardLatencyPathRx).count == 0);
+    REQUIRE(canardGetLatencyStatistics(CanardLatencyPathTxQueue).count == 0);
+
+    canardLatencyReset();
+    REQUIRE(canardGetLatencyStatistics(CanardLatencyPathTxComplete).count == 0);
+    REQUIRE(canardGetLatencyStatistics(CanardLatencyPathTxComplete).max == 0);
+}
+
+TEST_CASE("Latency, BucketBounds")
+{
+    // Every value below the last bucket must be reported as itself or as a larger value of the same power of two
+    for (uint32_t value = 0; value < (7UL << 13U); value += 1U + value / 64U)
+    {
+        canardLatencyReset();
+        canardLatencyRecord(CanardLatencyPathRx, value);
+        canardLatencyRecord(CanardLatencyPathRx, 0xFFFFFFFFUL);
+        const uint32_t reported = canardGetLatencyPercentile(CanardLatencyPathRx, 500);
+        REQUIRE(reported >= value);
+        REQUIRE(reported - value <= value / 4U);
+    }
+}
+
+TEST_CASE("Latency, OutOfRange")
+{
+    canardLatencyReset();
+    canardLatencyRecord(CanardLatencyPathRx, 100);
+    canardLatencyRecord(CanardLatencyPathRx, 70000);         // Above 2^16, into the last bucket
+    canardLatencyRecord(CanardLatencyPathRx, 0xFFFFFFFFUL);
+
+    const CanardLatencyStatistics stats = canardGetLatencyStatistics(CanardLatencyPathRx);
+    REQUIRE(stats.count == 3);
+    REQUIRE(stats.p50 == 0xFFFFFFFFUL);    // The last bucket only knows the maximum
+    REQUIRE(stats.max == 0xFFFFFFFFUL);
+    REQUIRE(canardGetLatencyPercentile(CanardLatencyPathRx, 300) == 111);
+}
+
+TEST_CASE("Latency, RxPath")
+{
+    LatencyFixture f;
+
+    // Single frame transfer: the clock is read when the frame arrives and right before on_reception
+    f.broadcast(5);
+    const CanardCANFrame single = *canardPeekTxQueue(&f.tx);
+    canardPopTxQueue(&f.tx);
+    g_timestamp_step = 7;
+    canardHandleRxFrame(&f.rx, &single, 1);
+    REQUIRE(g_num_received == 1);
+
+    // Multi-frame transfer: measured from the arrival of the last frame
+    f.broadcast(18);
+    std::vector<CanardCANFrame> frames;
+    g_timestamp_step = 0;
+    for (const CanardCANFrame* frame = canardPeekTxQueue(&f.tx); frame != nullptr; frame = canardPeekTxQueue(&f.tx))
+    {
+        frames.push_back(*frame);
+        canardPopTxQueue(&f.tx);
+    }
+    REQUIRE(frames.size() == 3);
+    g_timestamp_step = 3;
+    for (const CanardCANFrame& frame : frames)
+    {
+        canardHandleRxFrame(&f.rx, &frame, 2);
+    }
+    REQUIRE(g_num_received == 2);
+
+    // A frame that completes no transfer is not a sample
+    canardHandleRxFrame(&f.rx, &frames[1], 3);
+    REQUIRE(g_num_received == 2);
+
+    const CanardLatencyStatistics stats = canardGetLatencyStatistics(CanardLatencyPathRx);
+    REQUIRE(stats.count == 2);
+    REQUIRE(stats.p50 == 3);
+    REQUIRE(stats.max == 7);
+}
+
+TEST_CASE("Latency, TxQueuePath")
+{
+    LatencyFixture f;
+
+    g_timestamp = 100;
+    f.broadcast(18);                    // Three frames, all enqueued at 100
+    g_timestamp = 5000;
+    f.broadcast(5);                     // Enqueued at 5000, behind the others as the priority is the same
+
+    const uint32_t pop_times[] = { 250, 400, 10000, 5300 };
+    for (uint32_t t : pop_times)
+    {
+        REQUIRE(canardPeekTxQueue(&f.tx) != nullptr);
+        g_timestamp = t;
+        canardPopTxQueue(&f.tx);
+    }
+    REQUIRE(canardPeekTxQueue(&f.tx) == nullptr);
+
+    const CanardLatencyStatistics stats = canardGetLatencyStatistics(CanardLatencyPathTxQueue);
+    REQUIRE(stats.count == 4);
+    REQUIRE(stats.p50 == 319);          // The second smallest of 150, 300, 9900 and 300, in the bucket 256..319
+    REQUIRE(stats.max == 9900);
+    REQUIRE(canardGetLatencyStatistics(CanardLatencyPathRx).count == 0);
+}
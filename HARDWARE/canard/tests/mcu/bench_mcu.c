@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * Operations of the library run a given number of times, for counting the instructions they take on the target.
+ * The program is cross-compiled for the Cortex-M3 with semihosting and run under qemu-arm by count_instructions.py,
+ * once with few and once with many iterations of the same operation: the difference of the two instruction counts
+ * divided by the difference of the iterations is the cost of one operation, without the start-up and the set-up.
+ *
+ *   bench_mcu --list                       Prints the operations, one "<name> <unit>" per line
+ *   bench_mcu <operation> <iterations>     Sets the operation up and runs it; the iterations must be a multiple of 256
+ *
+ * The set-up depends only on the operation, not on the number of iterations. Received transfers are replayed from
+ * a cycle of 32 transfer IDs per node, so every replayed frame is accepted as in a real bus.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "canard.h"
+#include "canard_internals.h"
+
+#if CANARD_ENABLE_STATIC_CAPACITY || CANARD_ENABLE_CONCURRENCY
+# error "The benchmarks are written for the default configuration of the library"
+#endif
+
+#define DATA_TYPE_ID                1000U
+#define DATA_TYPE_SIGNATURE         0x0123456789ABCDEFULL
+#define LOCAL_NODE_ID               42U
+#define SINGLE_FRAME_PAYLOAD_LEN    7U
+#define MULTI_FRAME_PAYLOAD_LEN     64U
+#define TRANSFER_ID_CYCLE           32U
+#define MAX_SESSIONS                8U
+#define MAX_FRAMES                  (MAX_SESSIONS * TRANSFER_ID_CYCLE * CANARD_TX_FRAMES(MULTI_FRAME_PAYLOAD_LEN))
+#define ARENA_BLOCKS                128U
+
+typedef struct
+{
+    const char* name;
+    const char* unit;
+    void (*setup)(void);
+    void (*run)(uint32_t iterations);
+} Operation;
+
+static CanardPoolAllocatorBlock g_arena[ARENA_BLOCKS];
+static CanardInstance g_ins;
+
+static CanardCANFrame g_frames[MAX_FRAMES];
+static uint32_t g_num_frames;
+static uint32_t g_frames_per_transfer;
+
+static uint8_t g_payload[256];
+static uint8_t g_buffer[MULTI_FRAME_PAYLOAD_LEN + 1U];
+
+static uint8_t g_head[CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE];
+static uint8_t g_tail[7];
+static CanardRxTransfer g_transfer;
+
+static volatile uint32_t g_sink;
+
+
+static bool shouldAcceptTransfer(const CanardInstance* ins,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t source_node_id)
+{
+    (void) ins;
+    (void) data_type_id;
+    (void) transfer_type;
+    (void) source_node_id;
+    *out_data_type_signature = DATA_TYPE_SIGNATURE;
+    return true;
+}
+
+static void onTransferReception(CanardInstance* ins,
+                                CanardRxTransfer* transfer)
+{
+    (void) ins;
+    g_sink += transfer->payload_len;
+}
+
+static void initNode(CanardInstance* ins,
+                     CanardPoolAllocatorBlock* arena,
+                     size_t arena_blocks,
+                     uint8_t node_id)
+{
+    canardInit(ins, arena, arena_blocks * sizeof(CanardPoolAllocatorBlock),
+               &onTransferReception, &shouldAcceptTransfer, NULL);
+    canardSetLocalNodeID(ins, node_id);
+}
+
+static void drainTxQueue(CanardInstance* ins)
+{
+    while (canardPeekTxQueue(ins) != NULL)
+    {
+        canardPopTxQueue(ins);
+    }
+}
+
+/**
+ * Fills the frame table with a cycle of transfers from each of the given number of nodes. With several nodes, the
+ * frames of their transfers are interleaved, so that the receiver keeps one RX state per node.
+ */
+static void makeFrames(uint16_t payload_len,
+                       uint8_t sessions)
+{
+    static CanardPoolAllocatorBlock sender_arena[ARENA_BLOCKS];
+    const uint32_t frames_per_transfer = CANARD_TX_FRAMES(payload_len);
+    g_frames_per_transfer = frames_per_transfer;
+    g_num_frames = 0;
+
+    for (uint8_t s = 0; s < sessions; s++)
+    {
+        CanardInstance sender;
+        initNode(&sender, sender_arena, ARENA_BLOCKS, (uint8_t)(s + 1U));
+        uint8_t transfer_id = 0;
+        for (uint32_t t = 0; t < TRANSFER_ID_CYCLE; t++)
+        {
+            (void) canardBroadcast(&sender, DATA_TYPE_SIGNATURE, DATA_TYPE_ID, &transfer_id,
+                                   CANARD_TRANSFER_PRIORITY_LOW, g_payload, payload_len);
+            for (uint32_t k = 0; k < frames_per_transfer; k++)
+            {
+                // Round t of the transfers, frame k of the transfer, node s
+                const uint32_t index = (t * frames_per_transfer + k) * sessions + s;
+                g_frames[index] = *canardPeekTxQueue(&sender);
+                canardPopTxQueue(&sender);
+            }
+        }
+    }
+    g_num_frames = TRANSFER_ID_CYCLE * frames_per_transfer * sessions;
+}
+
+static void setupCommon(void)
+{
+    for (uint32_t i = 0; i < sizeof(g_payload); i++)
+    {
+        g_payload[i] = (uint8_t)(i * 37U + 11U);
+    }
+    initNode(&g_ins, g_arena, ARENA_BLOCKS, LOCAL_NODE_ID);
+}
+
+/*
+ * Transmission
+ */
+static void setupTx(void)
+{
+    setupCommon();
+}
+
+static void runTx(uint32_t iterations,
+                  uint16_t payload_len)
+{
+    uint8_t transfer_id = 0;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        (void) canardBroadcast(&g_ins, DATA_TYPE_SIGNATURE, DATA_TYPE_ID, &transfer_id,
+                               CANARD_TRANSFER_PRIORITY_LOW, g_payload, payload_len);
+        drainTxQueue(&g_ins);
+    }
+}
+
+static void runTxSingleFrame(uint32_t iterations)
+{
+    runTx(iterations, SINGLE_FRAME_PAYLOAD_LEN);
+}
+
+static void runTxMultiFrame(uint32_t iterations)
+{
+    runTx(iterations, MULTI_FRAME_PAYLOAD_LEN);
+}
+
+/*
+ * Reception
+ */
+static void setupRxSingleFrame(void)
+{
+    setupCommon();
+    makeFrames(SINGLE_FRAME_PAYLOAD_LEN, 1);
+}
+
+static void setupRxMultiFrame(void)
+{
+    setupCommon();
+    makeFrames(MULTI_FRAME_PAYLOAD_LEN, 1);
+}
+
+static void setupRxSessions(void)
+{
+    setupCommon();
+    makeFrames(MULTI_FRAME_PAYLOAD_LEN, MAX_SESSIONS);
+}
+
+/// One iteration takes the frames of one transfer from the cycle of the frame table
+static void runRx(uint32_t iterations)
+{
+    uint64_t timestamp_usec = 1000000U;
+    uint32_t next_frame = 0;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        for (uint32_t k = 0; k < g_frames_per_transfer; k++)
+        {
+            canardHandleRxFrame(&g_ins, &g_frames[next_frame], timestamp_usec);
+            timestamp_usec += 10U;
+            if (++next_frame >= g_num_frames)
+            {
+                next_frame = 0;
+            }
+        }
+    }
+}
+
+/*
+ * Scalar codecs and bit copying
+ */
+static void setupDecode(void)
+{
+    setupCommon();
+    CanardBufferBlock* const middle_a = createBufferBlock(&g_ins.allocator);
+    CanardBufferBlock* const middle_b = createBufferBlock(&g_ins.allocator);
+    middle_a->next = middle_b;
+
+    const uint32_t middle_len = (uint32_t)CANARD_BUFFER_BLOCK_DATA_SIZE;
+    uint32_t offset = 0;
+    memcpy(g_head, &g_payload[offset], sizeof(g_head));
+    offset += (uint32_t)sizeof(g_head);
+    memcpy(middle_a->data, &g_payload[offset], middle_len);
+    offset += middle_len;
+    memcpy(middle_b->data, &g_payload[offset], middle_len);
+    memcpy(g_tail, g_payload, sizeof(g_tail));
+
+    memset(&g_transfer, 0, sizeof(g_transfer));
+    g_transfer.payload_head = g_head;
+    g_transfer.payload_middle = middle_a;
+    g_transfer.payload_tail = g_tail;
+    g_transfer.payload_len = (uint16_t)(sizeof(g_head) + middle_len * 2U + sizeof(g_tail));
+}
+
+static void runDecode(uint32_t iterations,
+                      uint8_t bit_length,
+                      uint32_t bit_step)
+{
+    const uint32_t last_offset = g_transfer.payload_len * 8U - bit_length;
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        uint32_t value = 0;
+        (void) canardDecodeScalar(&g_transfer, offset, bit_length, false, &value);
+        g_sink += value;
+        offset += bit_step;
+        if (offset > last_offset)
+        {
+            offset = 0;
+        }
+    }
+}
+
+static void runDecode13(uint32_t iterations)
+{
+    runDecode(iterations, 13, 13);
+}
+
+static void runDecode32Aligned(uint32_t iterations)
+{
+    runDecode(iterations, 32, 32);
+}
+
+static void runEncode13(uint32_t iterations)
+{
+    const uint32_t last_offset = MULTI_FRAME_PAYLOAD_LEN * 8U - 13U;
+    uint32_t offset = 0;
+    uint16_t value = 0x1A5AU;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        canardEncodeScalar(g_buffer, offset, 13, &value);
+        value++;
+        offset += 13U;
+        if (offset > last_offset)
+        {
+            offset = 0;
+        }
+    }
+    g_sink += g_buffer[0];
+}
+
+static void runCopyBitArray(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        copyBitArray(g_payload, 3U, MULTI_FRAME_PAYLOAD_LEN * 8U, g_buffer, 5U);
+    }
+    g_sink += g_buffer[0];
+}
+
+/*
+ * Transfer CRC, memory pool and float16
+ */
+static void runCrcAdd(uint32_t iterations)
+{
+    uint16_t crc = 0xFFFFU;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        crc = crcAdd(crc, g_payload, MULTI_FRAME_PAYLOAD_LEN);
+    }
+    g_sink += crc;
+}
+
+static void runAllocateFree(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        void* const block = allocateBlock(&g_ins.allocator, CanardPoolOwnerTxFrame);
+        freeBlock(&g_ins.allocator, CanardPoolOwnerTxFrame, block);
+    }
+}
+
+static void runFloat16(uint32_t iterations)
+{
+    float value = 0.1F;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        g_sink += canardConvertNativeFloatToFloat16(value);
+        value += 0.37F;
+    }
+}
+
+static const Operation Operations[] =
+{
+    { "tx/broadcast/single_frame",          "transfer", &setupTx,            &runTxSingleFrame },
+    { "tx/broadcast/multi_frame_64B",       "transfer", &setupTx,            &runTxMultiFrame },
+    { "rx/single_frame",                    "transfer", &setupRxSingleFrame, &runRx },
+    { "rx/multi_frame_64B",                 "transfer", &setupRxMultiFrame,  &runRx },
+    { "rx/multi_frame_64B/8_sessions",      "transfer", &setupRxSessions,    &runRx },
+    { "codec/decode_scalar/13_bit",         "call",     &setupDecode,        &runDecode13 },
+    { "codec/decode_scalar/32_bit_aligned", "call",     &setupDecode,        &runDecode32Aligned },
+    { "codec/encode_scalar/13_bit",         "call",     &setupCommon,        &runEncode13 },
+    { "bits/copy_bit_array/64B_unaligned",  "call",     &setupCommon,        &runCopyBitArray },
+    { "crc/add/64B",                        "call",     &setupCommon,        &runCrcAdd },
+    { "alloc/allocate_free",                "block",    &setupCommon,        &runAllocateFree },
+    { "float16/from_native",                "call",     &setupCommon,        &runFloat16 },
+};
+
+int main(int argc, char** argv)
+{
+    const size_t count = sizeof(Operations) / sizeof(Operations[0]);
+    if ((argc == 2) && (strcmp(argv[1], "--list") == 0))
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            printf("%s %s\n", Operations[i].name, Operations[i].unit);
+        }
+        return 0;
+    }
+
+    if (argc == 3)
+    {
+        const unsigned long iterations = strtoul(argv[2], NULL, 10);
+        for (size_t i = 0; i < count; i++)
+        {
+            if ((strcmp(argv[1], Operations[i].name) == 0) && (iterations > 0) && ((iterations % 256U) == 0))
+            {
+                Operations[i].setup();
+                Operations[i].run((uint32_t)iterations);
+                return 0;
+            }
+        }
+    }
+
+    fprintf(stderr, "Usage: %s --list | <operation> <iterations, a multiple of 256>\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1,23 @@
+#
+# Copyright (c) 2018 UAVCAN Team
+#
+# Toolchain file for the STM32F103 core: Cortex-M3, Thumb-2, no FPU, with the arm-none-eabi GCC toolchain.
+# Programs are linked against newlib with semihosting (rdimon), so that they run under qemu-arm in user mode.
+#
+
+set(CMAKE_SYSTEM_NAME Generic)
+set(CMAKE_SYSTEM_PROCESSOR arm)
+
+set(CMAKE_C_COMPILER arm-none-eabi-gcc)
+set(CMAKE_CXX_COMPILER arm-none-eabi-g++)
+set(CMAKE_C_FLAGS_INIT "-mcpu=cortex-m3 -mthumb -mfloat-abi=soft")
+set(CMAKE_CXX_FLAGS_INIT "-mcpu=cortex-m3 -mthumb -mfloat-abi=soft")
+set(CMAKE_EXE_LINKER_FLAGS_INIT "--specs=rdimon.specs")
+
+# The compiler checks cannot run the test programs on the build machine
+set(CMAKE_TRY_COMPILE_TARGET_TYPE STATIC_LIBRARY)
+
+find_program(QEMU_ARM_EXECUTABLE NAMES qemu-arm)
+if (QEMU_ARM_EXECUTABLE)
+    set(CMAKE_CROSSCOMPILING_EMULATOR "${QEMU_ARM_EXECUTABLE};-cpu;cortex-m3")
+endif ()
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2018 UAVCAN Team
+#
+# Counts the instructions per operation of bench_mcu under qemu-arm with the instruction counting plugin of QEMU.
+# Every operation is run twice, with few and with many iterations; the difference of the instruction counts divided by
+# the difference of the iterations cancels the start-up of the program and the set-up of the operation.
+# The report is JSON, in the layout of the host benchmarks (tests/bench), with instructions instead of nanoseconds.
+#
+# Usage: count_instructions.py --plugin <libinsn.so> [--filter <substring>] [--output <file.json>]
+#                              -- <qemu-arm> [qemu options] <bench_mcu>
+#
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+FEW_ITERATIONS = 256
+MANY_ITERATIONS = 256 * 9
+
+
+def count_instructions(emulator, plugin, program, args):
+    """Runs the program under the emulator and returns the number of instructions it executed."""
+    with tempfile.NamedTemporaryFile(mode='r', suffix='.log') as log:
+        command = emulator[:1] + ['-plugin', plugin, '-d', 'plugin', '-D', log.name] + emulator[1:] + [program] + args
+        subprocess.check_call(command, stdout=subprocess.DEVNULL)
+        counts = re.findall(r'insns: (\d+)', log.read())
+    if not counts:
+        raise RuntimeError('The plugin reported no instruction count; is it libinsn.so?')
+    return int(counts[-1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--plugin', required=True, help='instruction counting plugin of QEMU (libinsn.so)')
+    parser.add_argument('--filter', default='', help='run only the operations whose name contains this string')
+    parser.add_argument('--output', help='JSON report, stdout if not given')
+    parser.add_argument('command', nargs=argparse.REMAINDER, help='-- <qemu-arm> [qemu options] <bench_mcu>')
+    args = parser.parse_args()
+
+    command = args.command[1:] if args.command[:1] == ['--'] else args.command
+    if len(command) < 2:
+        parser.error('the emulator and the program must be given after --')
+    emulator, program = command[:-1], command[-1]
+    if not os.path.isfile(args.plugin):
+        parser.error('plugin not found: %r' % args.plugin)
+
+    listing = subprocess.check_output(emulator + [program, '--list']).decode()
+    operations = [line.split() for line in listing.splitlines() if line.strip()]
+
+    benchmarks = []
+    for name, unit in operations:
+        if args.filter not in name:
+            continue
+        few = count_instructions(emulator, args.plugin, program, [name, str(FEW_ITERATIONS)])
+        many = count_instructions(emulator, args.plugin, program, [name, str(MANY_ITERATIONS)])
+        per_op = (many - few) / float(MANY_ITERATIONS - FEW_ITERATIONS)
+        print('%-44s %10.1f instructions/%s' % (name, per_op, unit), file=sys.stderr)
+        benchmarks.append({'name': name, 'unit': unit, 'instructions_per_op': round(per_op, 3)})
+
+    report = {
+        'context': {
+            'library': 'libcanard',
+            'target': 'cortex-m3',
+            'emulator': ' '.join(emulator),
+            'iterations': [FEW_ITERATIONS, MANY_ITERATIONS],
+        },
+        'benchmarks': benchmarks,
+    }
+    text = json.dumps(report, indent=2) + '\n'
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == '__main__':
+    main()
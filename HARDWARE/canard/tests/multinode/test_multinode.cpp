@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+#include <catch.hpp>
+#include <vector>
+#include "canard.h"
+
+#if !CANARD_ENABLE_MULTINODE
+# error "This test must be built with CANARD_ENABLE_MULTINODE=1"
+#endif
+
+static const uint16_t MessageDataTypeID = 20000;
+static const uint64_t MessageSignature = 0x1122334455667788ULL;
+static const uint8_t ServiceDataTypeID = 42;
+static const uint64_t ServiceSignature = 0x8877665544332211ULL;
+
+/// Every hosted node of these tests subscribes to the same message and serves the same service.
+struct NodeLog
+{
+    std::vector<CanardRxTransfer> transfers;
+    std::vector<std::vector<uint8_t>> payloads;
+    bool respond = false;
+    uint8_t response_transfer_id = 0;
+};
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t)
+{
+    if ((transfer_type == CanardTransferTypeBroadcast) && (data_type_id == MessageDataTypeID))
+    {
+        *out_data_type_signature = MessageSignature;
+        return true;
+    }
+    if ((transfer_type != CanardTransferTypeBroadcast) && (data_type_id == ServiceDataTypeID))
+    {
+        *out_data_type_signature = ServiceSignature;
+        return true;
+    }
+    return false;
+}
+
+static void onTransferReception(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    NodeLog* const log = static_cast<NodeLog*>(canardGetUserReference(ins));
+
+    std::vector<uint8_t> payload(transfer->payload_len);
+    for (uint16_t i = 0; i < transfer->payload_len; i++)
+    {
+        (void) canardDecodeScalar(transfer, i * 8U, 8, false, &payload[i]);
+    }
+    log->transfers.push_back(*transfer);
+    log->payloads.push_back(payload);
+
+    // Releasing must not affect the other nodes that receive the same transfer
+    canardReleaseRxTransferPayload(ins, transfer);
+
+    if (log->respond && (transfer->transfer_type == CanardTransferTypeRequest))
+    {
+        log->response_transfer_id = transfer->transfer_id;
+        REQUIRE(canardRequestOrRespond(ins, transfer->source_node_id, ServiceSignature, ServiceDataTypeID,
+                                       &log->response_transfer_id, transfer->priority, CanardResponse,
+                                       payload.data(), uint16_t(payload.size())) > 0);
+    }
+}
+
+static std::vector<uint8_t> makePayload(size_t size)
+{
+    std::vector<uint8_t> payload(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        payload[i] = uint8_t(i * 7U + 3U);
+    }
+    return payload;
+}
+
+/// Moves all bus-bound frames of the host to the returned list, looping them back as a real interface would.
+static std::vector<CanardCANFrame> transmitAll(CanardMultiNodeHost& host, uint64_t timestamp_usec)
+{
+    std::vector<CanardCANFrame> bus;
+    for (const CanardCANFrame* f = canardMultiNodeHostPeekTxQueue(&host, timestamp_usec);
+         f != nullptr;
+         f = canardMultiNodeHostPeekTxQueue(&host, timestamp_usec))
+    {
+        bus.push_back(*f);
+        canardMultiNodeHostPopTxQueue(&host, timestamp_usec);
+    }
+    return bus;
+}
+
+
+TEST_CASE("MultiNode, AddRemove")
+{
+    static std::uint8_t arena[CANARD_MEM_BLOCK_SIZE * 16U];
+    CanardMultiNodeHost host;
+    canardMultiNodeHostInit(&host, arena, sizeof(arena), nullptr);
+
+    CanardInstance a;
+    CanardInstance b;
+    REQUIRE(CANARD_OK == canardMultiNodeHostAddNode(&host, &a, 10, &onTransferReception, &shouldAcceptTransfer,
+                                                     nullptr));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            canardMultiNodeHostAddNode(&host, &b, 10, &onTransferReception, &shouldAcceptTransfer, nullptr));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            canardMultiNodeHostAddNode(&host, &b, 0, &onTransferReception, &shouldAcceptTransfer, nullptr));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            canardMultiNodeHostAddNode(&host, &b, 128, &onTransferReception, &shouldAcceptTransfer, nullptr));
+    REQUIRE(10 == canardGetLocalNodeID(&a));
+
+    canardMultiNodeHostRemoveNode(&host, &a);
+    REQUIRE(CANARD_OK == canardMultiNodeHostAddNode(&host, &b, 10, &onTransferReception, &shouldAcceptTransfer,
+                                                     nullptr));
+}
+
+TEST_CASE("MultiNode, BusTrafficIsParsedOnce")
+{
+    static const unsigned NumNodes = 30;
+    static std::uint8_t host_arena[CANARD_MEM_BLOCK_SIZE * 32U];
+    static std::uint8_t remote_arena[CANARD_MEM_BLOCK_SIZE * 32U];
+
+    CanardMultiNodeHost host;
+    canardMultiNodeHostInit(&host, host_arena, sizeof(host_arena), nullptr);
+
+    std::vector<CanardInstance> nodes(NumNodes);
+    std::vector<NodeLog> logs(NumNodes);
+    for (unsigned i = 0; i < NumNodes; i++)
+    {
+        REQUIRE(CANARD_OK == canardMultiNodeHostAddNode(&host, &nodes[i], uint8_t(10 + i), &onTransferReception,
+                                                         &shouldAcceptTransfer, &logs[i]));
+    }
+
+    // A real node on the bus
+    CanardInstance remote;
+    canardInit(&remote, remote_arena, sizeof(remote_arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&remote, 100);
+
+    const std::vector<uint8_t> payload = makePayload(50);
+    uint8_t transfer_id = 0;
+    REQUIRE(canardBroadcast(&remote, MessageSignature, MessageDataTypeID, &transfer_id,
+                            CANARD_TRANSFER_PRIORITY_LOW, payload.data(), uint16_t(payload.size())) > 1);
+
+    // Request to one of the hosted nodes; another one must not see it
+    uint8_t request_transfer_id = 5;
+    REQUIRE(canardRequestOrRespond(&remote, 15, ServiceSignature, ServiceDataTypeID, &request_transfer_id,
+                                   CANARD_TRANSFER_PRIORITY_HIGH, CanardRequest, payload.data(), 20) > 1);
+
+    uint16_t peak_rx_blocks = 0;
+    for (const CanardCANFrame* f = canardPeekTxQueue(&remote); f != nullptr; f = canardPeekTxQueue(&remote))
+    {
+        canardMultiNodeHostHandleRxFrame(&host, f, 1000);
+        canardPopTxQueue(&remote);
+        const uint16_t usage = canardGetPoolAllocatorStatistics(&nodes[0]).current_usage_blocks;
+        peak_rx_blocks = (usage > peak_rx_blocks) ? usage : peak_rx_blocks;
+    }
+
+    for (unsigned i = 0; i < NumNodes; i++)
+    {
+        const bool addressed = (10 + i) == 15;
+        REQUIRE(logs[i].transfers.size() == (addressed ? 2U : 1U));
+        REQUIRE(logs[i].payloads.back() == payload);
+        REQUIRE(logs[i].transfers.back().source_node_id == 100);
+        if (addressed)      // The request has higher priority, so it was received first
+        {
+            REQUIRE(logs[i].transfers.front().transfer_type == CanardTransferTypeRequest);
+            REQUIRE(logs[i].payloads.front() == std::vector<uint8_t>(payload.begin(), payload.begin() + 20));
+        }
+    }
+
+    // Two RX states, one per transfer descriptor, regardless of the number of nodes; buffers are all released
+    const CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&nodes[7]);
+    REQUIRE(stats.current_usage_blocks == 2);
+    REQUIRE(peak_rx_blocks < 6);
+}
+
+TEST_CASE("MultiNode, LocalLoopback")
+{
+    static std::uint8_t arena[CANARD_MEM_BLOCK_SIZE * 64U];
+    CanardMultiNodeHost host;
+    canardMultiNodeHostInit(&host, arena, sizeof(arena), nullptr);
+
+    CanardInstance a;
+    CanardInstance b;
+    CanardInstance c;
+    NodeLog log_a;
+    NodeLog log_b;
+    NodeLog log_c;
+    log_b.respond = true;
+    REQUIRE(CANARD_OK == canardMultiNodeHostAddNode(&host, &a, 1, &onTransferReception, &shouldAcceptTransfer,
+                                                     &log_a));
+    REQUIRE(CANARD_OK == canardMultiNodeHostAddNode(&host, &b, 2, &onTransferReception, &shouldAcceptTransfer,
+                                                     &log_b));
+    REQUIRE(CANARD_OK == canardMultiNodeHostAddNode(&host, &c, 3, &onTransferReception, &shouldAcceptTransfer,
+                                                     &log_c));
+
+    // Broadcast goes to the bus and is looped back to the other hosted nodes, but not to its source
+    const std::vector<uint8_t> payload = makePayload(30);
+    uint8_t message_transfer_id = 0;
+    REQUIRE(canardBroadcast(&a, MessageSignature, MessageDataTypeID, &message_transfer_id,
+                            CANARD_TRANSFER_PRIORITY_LOW, payload.data(), uint16_t(payload.size())) == 5);
+
+    std::vector<CanardCANFrame> bus = transmitAll(host, 2000);
+    REQUIRE(bus.size() == 5);
+    REQUIRE(log_a.transfers.empty());
+    REQUIRE(log_b.transfers.size() == 1);
+    REQUIRE(log_c.transfers.size() == 1);
+    REQUIRE(log_b.payloads[0] == payload);
+    REQUIRE(log_c.transfers[0].source_node_id == 1);
+
+    // Request from A to B and the response from B to A never reach the bus
+    uint8_t request_transfer_id = 0;
+    REQUIRE(canardRequestOrRespond(&a, 2, ServiceSignature, ServiceDataTypeID, &request_transfer_id,
+                                   CANARD_TRANSFER_PRIORITY_MEDIUM, CanardRequest, payload.data(), 12) == 2);
+
+    bus = transmitAll(host, 3000);
+    REQUIRE(bus.empty());
+    REQUIRE(log_b.transfers.size() == 2);
+    REQUIRE(log_b.transfers[1].transfer_type == CanardTransferTypeRequest);
+    REQUIRE(log_a.transfers.size() == 1);
+    REQUIRE(log_a.transfers[0].transfer_type == CanardTransferTypeResponse);
+    REQUIRE(log_a.transfers[0].source_node_id == 2);
+    REQUIRE(log_a.payloads[0] == std::vector<uint8_t>(payload.begin(), payload.begin() + 12));
+    REQUIRE(log_c.transfers.size() == 1);
+
+    // Request to a node that is not hosted goes to the bus
+    REQUIRE(canardRequestOrRespond(&c, 77, ServiceSignature, ServiceDataTypeID, &request_transfer_id,
+                                   CANARD_TRANSFER_PRIORITY_MEDIUM, CanardRequest, payload.data(), 4) == 1);
+    bus = transmitAll(host, 4000);
+    REQUIRE(bus.size() == 1);
+    REQUIRE(((bus[0].id >> 8U) & 0x7FU) == 77);
+
+    // Only the RX states remain allocated
+    REQUIRE(canardGetPoolAllocatorStatistics(&c).current_usage_blocks == 3);
+}
@@ -0,0 +1,816 @@
+/*
+ * This application is distributed under the terms of CC0 (public domain dedication).
+ * More info: https://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * Finds the smallest memory pool a node gets by with on recorded traffic. The frames of a candump log or of a binary
+ * trace dump are replayed into the library as the node described in a text file would receive them: it accepts the
+ * given data types, answers the given requests and publishes its messages periodically, while the bus drains its TX
+ * queue in the gaps between the recorded frames. The replay is repeated over a sweep of pool sizes to find the smallest
+ * one without allocation failures; the usage timeline and the transfers in flight at the peak are reported for it.
+ *
+ * The node description has one directive per line; '#' starts a comment:
+ *
+ *     node_id <id>
+ *     accept <message|request|response> <data type id> <signature>
+ *     respond <data type id> <payload length>
+ *     publish <data type id> <signature> <payload length> <period ms> [<priority>]
+ *
+ * A respond directive answers every accepted request of that data type with a response of the given length, sent with
+ * the priority of the request. Refer to pool_advisor_firmware.txt for the node in HARDWARE/uavcan.c.
+ */
+
+#include <canard.h>
+#include <canard_replay.h>  // Log replay driver, distributed with Libcanard
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CANARD_ENABLE_STATIC_CAPACITY
+# error "The pool sizing advisor is meant for the memory pool, which the static-capacity mode does not have"
+#endif
+
+#define USEC_PER_SEC                    1000000ULL
+
+#define MAX_SUBSCRIPTIONS               64U
+#define MAX_PUBLISHERS                  32U
+#define MAX_TX_DATA_TYPES               64U
+#define MAX_PEAK_RX_STATES              32U
+#define MAX_TIMELINE_INTERVALS          1000U
+#define MAX_POOL_SIZE                   (1024U * 1024U)
+#define TIMELINE_BAR_WIDTH              50U
+
+typedef struct
+{
+    uint16_t data_type_id;
+    uint8_t transfer_type;              ///< CanardTransferType
+    uint64_t signature;
+    bool respond;                       ///< Requests only
+    uint16_t response_len;
+} Subscription;
+
+typedef struct
+{
+    uint16_t data_type_id;
+    uint64_t signature;
+    uint16_t payload_len;
+    uint64_t period_usec;
+    uint8_t priority;
+    uint8_t transfer_id;
+    uint64_t next_usec;
+} Publisher;
+
+/// Frames of one data type waiting in the TX queue, which the library does not let the application walk
+typedef struct
+{
+    uint16_t data_type_id;
+    uint8_t transfer_type;
+    uint16_t frames;
+} TxBacklog;
+
+/// Reassembly session held at the peak
+typedef struct
+{
+    uint16_t data_type_id;
+    uint8_t transfer_type;
+    uint8_t source_node_id;
+    uint16_t blocks;
+    uint16_t payload_len;
+} RxInFlight;
+
+typedef struct
+{
+    uint64_t time_usec;                 ///< From the first frame of the log
+    uint16_t usage_blocks;
+    uint16_t owner_blocks[CANARD_NUM_POOL_OWNERS];
+    RxInFlight rx[MAX_PEAK_RX_STATES];
+    uint16_t num_rx;
+    uint16_t num_rx_omitted;
+    TxBacklog tx[MAX_TX_DATA_TYPES];
+    uint16_t num_tx;
+} PeakSnapshot;
+
+typedef struct
+{
+    uint16_t usage_blocks;
+    uint16_t owner_blocks[CANARD_NUM_POOL_OWNERS];
+} TimelineInterval;
+
+typedef struct
+{
+    uint32_t allocation_failures;       ///< Sum over the owners
+    uint16_t owner_failures[CANARD_NUM_POOL_OWNERS];
+    uint64_t transfers;
+    uint64_t responses;
+    uint64_t publications;
+    uint64_t own_frames;                ///< Frames of the node itself in the log, which are simulated instead
+    PeakSnapshot peak;
+} SimulationResult;
+
+static const char* const OwnerNames[CANARD_NUM_POOL_OWNERS] = { "TX frames", "RX states", "RX buffers" };
+
+/*
+ * The node
+ */
+static uint8_t node_id = 0;
+static Subscription subscriptions[MAX_SUBSCRIPTIONS];
+static unsigned num_subscriptions = 0;
+static Publisher publishers[MAX_PUBLISHERS];
+static unsigned num_publishers = 0;
+
+/*
+ * The simulation
+ */
+static union
+{
+    uint8_t bytes[MAX_POOL_SIZE];
+    uint64_t align_u64;
+    void* align_ptr;
+} canard_memory_pool;
+
+static CanardInstance canard;
+static CanardReplayInstance replay;
+static uint32_t bit_rate = 500000U;
+static uint64_t now_usec;
+static uint64_t start_usec;
+static uint64_t bus_free_usec;          ///< End of the last frame sent by the node
+static TxBacklog tx_backlog[MAX_TX_DATA_TYPES];
+static unsigned num_tx_backlog = 0;
+static SimulationResult result;
+
+static TimelineInterval timeline[MAX_TIMELINE_INTERVALS];
+static uint64_t timeline_interval_usec = USEC_PER_SEC;
+static bool record_timeline = false;
+
+
+static const char* getTransferTypeName(uint8_t transfer_type)
+{
+    switch (transfer_type)
+    {
+    case CanardTransferTypeResponse:
+        return "response";
+    case CanardTransferTypeRequest:
+        return "request";
+    default:
+        return "message";
+    }
+}
+
+static uint16_t getFrameTimeUsec(const CanardCANFrame* frame)
+{
+    const uint32_t bits = canardGetFrameBitLength(frame);
+    return (uint16_t)((bits * USEC_PER_SEC + bit_rate - 1U) / bit_rate);
+}
+
+static void decodeFrameID(uint32_t id, uint16_t* out_data_type_id, uint8_t* out_transfer_type)
+{
+    if (((id >> 7U) & 1U) != 0U)
+    {
+        *out_data_type_id = (uint16_t)((id >> 16U) & 0xFFU);
+        *out_transfer_type = (uint8_t)((((id >> 15U) & 1U) != 0U) ? CanardTransferTypeRequest :
+                                                                     CanardTransferTypeResponse);
+    }
+    else
+    {
+        const bool anonymous = (id & 0x7FU) == CANARD_BROADCAST_NODE_ID;
+        *out_data_type_id = (uint16_t)((id >> 8U) & (anonymous ? 0x3U : 0xFFFFU));
+        *out_transfer_type = (uint8_t)CanardTransferTypeBroadcast;
+    }
+}
+
+static TxBacklog* findTxBacklog(uint16_t data_type_id, uint8_t transfer_type)
+{
+    for (unsigned i = 0; i < num_tx_backlog; i++)
+    {
+        if ((tx_backlog[i].data_type_id == data_type_id) && (tx_backlog[i].transfer_type == transfer_type))
+        {
+            return &tx_backlog[i];
+        }
+    }
+    if (num_tx_backlog < MAX_TX_DATA_TYPES)
+    {
+        TxBacklog* const backlog = &tx_backlog[num_tx_backlog++];
+        backlog->data_type_id = data_type_id;
+        backlog->transfer_type = transfer_type;
+        backlog->frames = 0;
+        return backlog;
+    }
+    return NULL;
+}
+
+static uint16_t getTxUsage(void)
+{
+    return canardGetPoolOwnerStatistics(&canard, CanardPoolOwnerTxFrame).current_usage_blocks;
+}
+
+/**
+ * Credits the TX frames enqueued since the usage was read to the data type of the transfer.
+ */
+static void noteEnqueued(uint16_t data_type_id, uint8_t transfer_type, uint16_t tx_usage_before)
+{
+    const uint16_t tx_usage = getTxUsage();
+    TxBacklog* const backlog = findTxBacklog(data_type_id, transfer_type);
+    if ((backlog != NULL) && (tx_usage > tx_usage_before))
+    {
+        backlog->frames = (uint16_t)(backlog->frames + tx_usage - tx_usage_before);
+    }
+}
+
+static void takePeakSnapshot(const CanardPoolAllocatorStatistics* stats)
+{
+    PeakSnapshot* const peak = &result.peak;
+    peak->time_usec = now_usec - start_usec;
+    peak->usage_blocks = stats->current_usage_blocks;
+    for (int i = 0; i < CANARD_NUM_POOL_OWNERS; i++)
+    {
+        peak->owner_blocks[i] = canardGetPoolOwnerStatistics(&canard, (CanardPoolOwner)i).current_usage_blocks;
+    }
+
+    peak->num_rx = 0;
+    peak->num_rx_omitted = 0;
+    for (const CanardRxState* state = canard.rx_states; state != NULL; state = state->next)
+    {
+        if (peak->num_rx >= MAX_PEAK_RX_STATES)
+        {
+            peak->num_rx_omitted++;
+            continue;
+        }
+        RxInFlight* const rx = &peak->rx[peak->num_rx++];
+        rx->data_type_id = (uint16_t)(state->dtid_tt_snid_dnid & 0xFFFFU);
+        rx->transfer_type = (uint8_t)((state->dtid_tt_snid_dnid >> 16U) & 0x3U);
+        rx->source_node_id = (uint8_t)((state->dtid_tt_snid_dnid >> 18U) & 0x7FU);
+        rx->payload_len = (uint16_t)state->payload_len;
+        rx->blocks = 1;
+        for (const CanardBufferBlock* block = state->buffer_blocks; block != NULL; block = block->next)
+        {
+            rx->blocks++;
+        }
+    }
+
+    peak->num_tx = 0;
+    for (unsigned i = 0; i < num_tx_backlog; i++)
+    {
+        if (tx_backlog[i].frames > 0)
+        {
+            peak->tx[peak->num_tx++] = tx_backlog[i];
+        }
+    }
+}
+
+/**
+ * Called after every step that may allocate.
+ */
+static void sampleUsage(void)
+{
+    const CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&canard);
+    if (stats.current_usage_blocks > result.peak.usage_blocks)
+    {
+        takePeakSnapshot(&stats);
+    }
+
+    if (record_timeline)
+    {
+        uint64_t index = (now_usec - start_usec) / timeline_interval_usec;
+        index = (index < MAX_TIMELINE_INTERVALS) ? index : (MAX_TIMELINE_INTERVALS - 1U);
+        TimelineInterval* const interval = &timeline[index];
+        if (stats.current_usage_blocks > interval->usage_blocks)
+        {
+            interval->usage_blocks = stats.current_usage_blocks;
+            for (int i = 0; i < CANARD_NUM_POOL_OWNERS; i++)
+            {
+                interval->owner_blocks[i] =
+                    canardGetPoolOwnerStatistics(&canard, (CanardPoolOwner)i).current_usage_blocks;
+            }
+        }
+    }
+}
+
+/**
+ * Sends the frames of the TX queue that end on the bus before the given time, one after another from the later of
+ * the current time and the end of the previous one. The recorded frames always win the bus, so the backlog is
+ * pessimistic for the high priority transfers of the node.
+ */
+static void advanceTo(uint64_t time_usec)
+{
+    for (const CanardCANFrame* frame = canardPeekTxQueue(&canard);
+         frame != NULL;
+         frame = canardPeekTxQueue(&canard))
+    {
+        const uint64_t begin_usec = (bus_free_usec > now_usec) ? bus_free_usec : now_usec;
+        const uint64_t end_usec = begin_usec + getFrameTimeUsec(frame);
+        if (end_usec > time_usec)
+        {
+            break;
+        }
+
+        uint16_t data_type_id = 0;
+        uint8_t transfer_type = 0;
+        decodeFrameID(frame->id & CANARD_CAN_EXT_ID_MASK, &data_type_id, &transfer_type);
+        TxBacklog* const backlog = findTxBacklog(data_type_id, transfer_type);
+        if ((backlog != NULL) && (backlog->frames > 0))
+        {
+            backlog->frames--;
+        }
+
+        canardPopTxQueue(&canard);
+        bus_free_usec = end_usec;
+    }
+    now_usec = (time_usec > now_usec) ? time_usec : now_usec;
+}
+
+/**
+ * Publishes the messages due before the given time, in the order of their deadlines.
+ */
+static void publishUntil(uint64_t time_usec)
+{
+    static uint8_t payload[CANARD_TRANSFER_PAYLOAD_LEN_BITS > 10 ? 4096 : 1024];
+
+    for (;;)
+    {
+        Publisher* due = NULL;
+        for (unsigned i = 0; i < num_publishers; i++)
+        {
+            if ((publishers[i].next_usec <= time_usec) && ((due == NULL) || (publishers[i].next_usec < due->next_usec)))
+            {
+                due = &publishers[i];
+            }
+        }
+        if (due == NULL)
+        {
+            return;
+        }
+
+        advanceTo(due->next_usec);
+        const uint16_t tx_usage = getTxUsage();
+        (void)canardBroadcast(&canard, due->signature, due->data_type_id, &due->transfer_id, due->priority,
+                              payload, due->payload_len);
+        noteEnqueued(due->data_type_id, (uint8_t)CanardTransferTypeBroadcast, tx_usage);
+        result.publications++;
+        sampleUsage();
+        due->next_usec += due->period_usec;
+    }
+}
+
+static bool shouldAcceptTransfer(const CanardInstance* ins,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t source_node_id)
+{
+    (void)ins;
+    (void)source_node_id;
+
+    for (unsigned i = 0; i < num_subscriptions; i++)
+    {
+        if ((subscriptions[i].data_type_id == data_type_id) && (subscriptions[i].transfer_type == transfer_type))
+        {
+            *out_data_type_signature = subscriptions[i].signature;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void onTransferReceived(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    static uint8_t payload[CANARD_TRANSFER_PAYLOAD_LEN_BITS > 10 ? 4096 : 1024];
+
+    result.transfers++;
+    if (transfer->transfer_type != CanardTransferTypeRequest)
+    {
+        return;
+    }
+
+    /*
+     * Responding from the callback as the firmware does, while the request still holds its buffer blocks.
+     */
+    for (unsigned i = 0; i < num_subscriptions; i++)
+    {
+        const Subscription* const sub = &subscriptions[i];
+        if ((sub->transfer_type == CanardTransferTypeRequest) && (sub->data_type_id == transfer->data_type_id) &&
+            sub->respond)
+        {
+            const uint16_t tx_usage = getTxUsage();
+            (void)canardRequestOrRespond(ins, transfer->source_node_id, sub->signature, (uint8_t)sub->data_type_id,
+                                         &transfer->transfer_id, transfer->priority, CanardResponse,
+                                         payload, sub->response_len);
+            noteEnqueued(sub->data_type_id, (uint8_t)CanardTransferTypeResponse, tx_usage);
+            result.responses++;
+            sampleUsage();
+        }
+    }
+}
+
+/**
+ * Replays the whole log into a fresh instance with the given pool.
+ * Returns 0 on success, negative errno if the log is malformed.
+ */
+static int simulate(uint32_t pool_size)
+{
+    memset(&result, 0, sizeof(result));
+    memset(tx_backlog, 0, sizeof(tx_backlog));
+    num_tx_backlog = 0;
+    memset(timeline, 0, sizeof(timeline));
+
+    canardInit(&canard, canard_memory_pool.bytes, pool_size, onTransferReceived, shouldAcceptTransfer, NULL);
+    if (node_id != CANARD_BROADCAST_NODE_ID)
+    {
+        canardSetLocalNodeID(&canard, node_id);
+    }
+    canardReplayRewind(&replay);
+
+    bool started = false;
+    uint64_t next_cleanup_usec = 0;
+    CanardCANFrame frames[CANARD_REPLAY_BATCH_SIZE];
+    uint64_t timestamps[CANARD_REPLAY_BATCH_SIZE];
+    for (;;)
+    {
+        const int16_t num_frames = canardReplayRead(&replay, frames, timestamps, CANARD_REPLAY_BATCH_SIZE);
+        if (num_frames <= 0)
+        {
+            return num_frames;
+        }
+
+        for (int16_t i = 0; i < num_frames; i++)
+        {
+            const uint64_t timestamp_usec = timestamps[i];
+            if (!started)
+            {
+                started = true;
+                start_usec = timestamp_usec;
+                now_usec = timestamp_usec;
+                bus_free_usec = timestamp_usec;
+                next_cleanup_usec = timestamp_usec + CANARD_RECOMMENDED_STALE_TRANSFER_CLEANUP_INTERVAL_USEC;
+                for (unsigned k = 0; k < num_publishers; k++)
+                {
+                    publishers[k].next_usec = timestamp_usec;
+                    publishers[k].transfer_id = 0;
+                }
+            }
+            if (timestamp_usec < now_usec)
+            {
+                continue;                       // Out of order, as in logs merged from several interfaces
+            }
+
+            const uint32_t id = frames[i].id & CANARD_CAN_EXT_ID_MASK;
+            if ((node_id != CANARD_BROADCAST_NODE_ID) && ((id & 0x7FU) == node_id))
+            {
+                result.own_frames++;
+                continue;
+            }
+
+            const uint16_t frame_time_usec = getFrameTimeUsec(&frames[i]);
+            const uint64_t frame_begin_usec = (timestamp_usec > (start_usec + frame_time_usec)) ?
+                                              (timestamp_usec - frame_time_usec) : start_usec;
+            publishUntil(timestamp_usec);
+            advanceTo(frame_begin_usec);
+
+            now_usec = timestamp_usec;
+            bus_free_usec = (bus_free_usec > timestamp_usec) ? bus_free_usec : timestamp_usec;
+            (void)canardHandleRxFrame(&canard, &frames[i], timestamp_usec);
+            sampleUsage();
+
+            if (timestamp_usec >= next_cleanup_usec)
+            {
+                canardCleanupStaleTransfers(&canard, timestamp_usec);
+                next_cleanup_usec = timestamp_usec + CANARD_RECOMMENDED_STALE_TRANSFER_CLEANUP_INTERVAL_USEC;
+            }
+        }
+    }
+}
+
+static uint32_t getAllocationFailures(void)
+{
+    uint32_t failures = 0;
+    for (int i = 0; i < CANARD_NUM_POOL_OWNERS; i++)
+    {
+        result.owner_failures[i] = canardGetPoolOwnerStatistics(&canard, (CanardPoolOwner)i).allocation_failures;
+        failures += result.owner_failures[i];
+    }
+    return failures;
+}
+
+/**
+ * Runs one simulation and prints its outcome.
+ * Returns the number of allocation failures, or -1 if the log is malformed.
+ */
+static long probe(uint32_t pool_size)
+{
+    const int res = simulate(pool_size);
+    if (res < 0)
+    {
+        (void)fprintf(stderr, "Malformed log: %s\n", strerror(-res));
+        return -1;
+    }
+    result.allocation_failures = getAllocationFailures();
+
+    printf("%10u bytes (%5u blocks): peak %5u blocks, %u allocation failures",
+           pool_size, pool_size / CANARD_MEM_BLOCK_SIZE, result.peak.usage_blocks, result.allocation_failures);
+    if (result.allocation_failures > 0)
+    {
+        printf(" (%u TX, %u RX state, %u RX buffer)", result.owner_failures[CanardPoolOwnerTxFrame],
+               result.owner_failures[CanardPoolOwnerRxState], result.owner_failures[CanardPoolOwnerRxBuffer]);
+    }
+    printf("\n");
+    return (long)result.allocation_failures;
+}
+
+static void printPeak(void)
+{
+    const PeakSnapshot* const peak = &result.peak;
+    printf("\nPeak usage: %u blocks at %.3f s of the log:", peak->usage_blocks, (double)peak->time_usec / 1e6);
+    for (int i = 0; i < CANARD_NUM_POOL_OWNERS; i++)
+    {
+        printf("%s %u %s", (i == 0) ? "" : ",", peak->owner_blocks[i], OwnerNames[i]);
+    }
+    printf("\n");
+
+    for (uint16_t i = 0; i < peak->num_rx; i++)
+    {
+        const RxInFlight* const rx = &peak->rx[i];
+        printf("    RX %-8s %5u from node %3u: %3u blocks, %u bytes received\n",
+               getTransferTypeName(rx->transfer_type), rx->data_type_id, rx->source_node_id, rx->blocks,
+               rx->payload_len);
+    }
+    if (peak->num_rx_omitted > 0)
+    {
+        printf("    ... and %u more RX states\n", peak->num_rx_omitted);
+    }
+    for (uint16_t i = 0; i < peak->num_tx; i++)
+    {
+        const TxBacklog* const tx = &peak->tx[i];
+        printf("    TX %-8s %5u: %3u frames queued\n",
+               getTransferTypeName(tx->transfer_type), tx->data_type_id, tx->frames);
+    }
+}
+
+static void printTimeline(uint64_t log_span_usec, uint16_t capacity_blocks)
+{
+    const uint64_t num_intervals = (log_span_usec / timeline_interval_usec) + 1U;
+    printf("\nUsage timeline, peak per %.3f s of the log (blocks: total = TX frames + RX states + RX buffers):\n",
+           (double)timeline_interval_usec / 1e6);
+    for (uint64_t i = 0; (i < num_intervals) && (i < MAX_TIMELINE_INTERVALS); i++)
+    {
+        const TimelineInterval* const interval = &timeline[i];
+        printf("%10.3f s %5u = %5u + %5u + %5u  ", (double)(i * timeline_interval_usec) / 1e6,
+               interval->usage_blocks, interval->owner_blocks[CanardPoolOwnerTxFrame],
+               interval->owner_blocks[CanardPoolOwnerRxState], interval->owner_blocks[CanardPoolOwnerRxBuffer]);
+        const unsigned bar = (capacity_blocks > 0) ?
+                             (unsigned)((interval->usage_blocks * TIMELINE_BAR_WIDTH) / capacity_blocks) : 0U;
+        for (unsigned k = 0; k < bar; k++)
+        {
+            putchar('#');
+        }
+        putchar('\n');
+    }
+}
+
+/*
+ * Node description
+ */
+static int parseDescriptionLine(char* line)
+{
+    char* const comment = strchr(line, '#');
+    if (comment != NULL)
+    {
+        *comment = '\0';
+    }
+
+    char directive[16] = { 0 };
+    char kind[16] = { 0 };
+    unsigned id = 0;
+    unsigned long long signature = 0;
+    unsigned len = 0;
+    unsigned period_ms = 0;
+    unsigned priority = CANARD_TRANSFER_PRIORITY_LOW;
+
+    if (sscanf(line, "%15s", directive) != 1)
+    {
+        return 0;                               // Blank line
+    }
+    if (strcmp(directive, "node_id") == 0)
+    {
+        if ((sscanf(line, "%*s %u", &id) != 1) || (id < CANARD_MIN_NODE_ID) || (id > CANARD_MAX_NODE_ID))
+        {
+            return -EINVAL;
+        }
+        node_id = (uint8_t)id;
+        return 0;
+    }
+    if (strcmp(directive, "accept") == 0)
+    {
+        if ((sscanf(line, "%*s %15s %u %llx", kind, &id, &signature) != 3) ||
+            (num_subscriptions >= MAX_SUBSCRIPTIONS) || (id > 0xFFFFU))
+        {
+            return -EINVAL;
+        }
+        Subscription* const sub = &subscriptions[num_subscriptions];
+        memset(sub, 0, sizeof(*sub));
+        if (strcmp(kind, "message") == 0)
+        {
+            sub->transfer_type = (uint8_t)CanardTransferTypeBroadcast;
+        }
+        else if ((strcmp(kind, "request") == 0) && (id <= 0xFFU))
+        {
+            sub->transfer_type = (uint8_t)CanardTransferTypeRequest;
+        }
+        else if ((strcmp(kind, "response") == 0) && (id <= 0xFFU))
+        {
+            sub->transfer_type = (uint8_t)CanardTransferTypeResponse;
+        }
+        else
+        {
+            return -EINVAL;
+        }
+        sub->data_type_id = (uint16_t)id;
+        sub->signature = (uint64_t)signature;
+        num_subscriptions++;
+        return 0;
+    }
+    if (strcmp(directive, "respond") == 0)
+    {
+        if ((sscanf(line, "%*s %u %u", &id, &len) != 2) || (len > CANARD_MAX_TRANSFER_PAYLOAD_LEN))
+        {
+            return -EINVAL;
+        }
+        for (unsigned i = 0; i < num_subscriptions; i++)
+        {
+            if ((subscriptions[i].transfer_type == CanardTransferTypeRequest) && (subscriptions[i].data_type_id == id))
+            {
+                subscriptions[i].respond = true;
+                subscriptions[i].response_len = (uint16_t)len;
+                return 0;
+            }
+        }
+        return -ENOENT;                         // The request must be accepted first
+    }
+    if (strcmp(directive, "publish") == 0)
+    {
+        const int num_fields = sscanf(line, "%*s %u %llx %u %u %u", &id, &signature, &len, &period_ms, &priority);
+        if ((num_fields < 4) || (num_publishers >= MAX_PUBLISHERS) || (id > 0xFFFFU) || (period_ms == 0) ||
+            (len > CANARD_MAX_TRANSFER_PAYLOAD_LEN) || (priority > CANARD_TRANSFER_PRIORITY_LOWEST))
+        {
+            return -EINVAL;
+        }
+        Publisher* const pub = &publishers[num_publishers++];
+        memset(pub, 0, sizeof(*pub));
+        pub->data_type_id = (uint16_t)id;
+        pub->signature = (uint64_t)signature;
+        pub->payload_len = (uint16_t)len;
+        pub->period_usec = (uint64_t)period_ms * 1000U;
+        pub->priority = (uint8_t)priority;
+        return 0;
+    }
+    return -EINVAL;
+}
+
+static int readDescription(const char* path)
+{
+    FILE* const file = fopen(path, "r");
+    if (file == NULL)
+    {
+        (void)fprintf(stderr, "Failed to open node description '%s': %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    char line[256];
+    unsigned line_number = 0;
+    int res = 0;
+    while ((res == 0) && (fgets(line, sizeof(line), file) != NULL))
+    {
+        line_number++;
+        res = parseDescriptionLine(line);
+        if (res < 0)
+        {
+            (void)fprintf(stderr, "%s:%u: %s\n", path, line_number,
+                          (res == -ENOENT) ? "respond to a request that is not accepted" : "invalid directive");
+        }
+    }
+    (void)fclose(file);
+    return res;
+}
+
+static int printUsage(const char* name)
+{
+    (void)fprintf(stderr,
+                  "Usage:\n"
+                  "\t%s <log> <node description> [--bit-rate <bit/s>] [--max-size <bytes>] [--interval <ms>]\n"
+                  "\t\t[--headroom <percent>]\n"
+                  "The log is a candump -l log or a dump of canardTraceDump() with frame data. The largest pool\n"
+                  "tried is --max-size, 64 KiB by default; the bus runs at 500 kbit/s unless told otherwise.\n",
+                  name);
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        return printUsage(argv[0]);
+    }
+
+    unsigned long max_size = 64U * 1024U;
+    unsigned long interval_ms = 1000;
+    unsigned long headroom_percent = 25;
+    for (int i = 3; i < argc; i++)
+    {
+        const bool has_value = (i + 1) < argc;
+        if ((strcmp(argv[i], "--bit-rate") == 0) && has_value)
+        {
+            bit_rate = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if ((strcmp(argv[i], "--max-size") == 0) && has_value)
+        {
+            max_size = strtoul(argv[++i], NULL, 10);
+        }
+        else if ((strcmp(argv[i], "--interval") == 0) && has_value)
+        {
+            interval_ms = strtoul(argv[++i], NULL, 10);
+        }
+        else if ((strcmp(argv[i], "--headroom") == 0) && has_value)
+        {
+            headroom_percent = strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            return printUsage(argv[0]);
+        }
+    }
+    const unsigned long size_limit = (MAX_POOL_SIZE < (UINT16_MAX * CANARD_MEM_BLOCK_SIZE)) ?
+                                     MAX_POOL_SIZE : (UINT16_MAX * CANARD_MEM_BLOCK_SIZE);
+    if ((bit_rate == 0) || (interval_ms == 0) || (max_size < CANARD_MEM_BLOCK_SIZE) || (max_size > size_limit))
+    {
+        return printUsage(argv[0]);
+    }
+
+    if (readDescription(argv[2]) < 0)
+    {
+        return 1;
+    }
+
+    const int16_t res = canardReplayOpen(&replay, argv[1]);
+    if (res < 0)
+    {
+        (void)fprintf(stderr, "Failed to open log '%s': %s\n", argv[1], strerror(-res));
+        return 1;
+    }
+
+    /*
+     * As long as no allocation fails, the library takes the same blocks whatever the size of the pool, so the peak
+     * usage with the largest pool is the smallest pool without failures. The smaller sizes of the sweep show how the
+     * failures grow below it; the last run, with the smallest pool, records the timeline.
+     */
+    printf("Probing pool sizes:\n");
+    if (probe((uint32_t)((max_size / CANARD_MEM_BLOCK_SIZE) * CANARD_MEM_BLOCK_SIZE)) != 0)
+    {
+        if (result.allocation_failures > 0)
+        {
+            (void)fprintf(stderr, "Allocations fail even with the largest pool; raise --max-size\n");
+        }
+        (void)canardReplayClose(&replay);
+        return 1;
+    }
+    const uint32_t min_blocks = (result.peak.usage_blocks > 0) ? result.peak.usage_blocks : 1U;
+    const uint32_t sweep_blocks[] = { min_blocks / 2U, (min_blocks * 3U) / 4U, min_blocks - 1U };
+    for (unsigned i = 0; i < (sizeof(sweep_blocks) / sizeof(sweep_blocks[0])); i++)
+    {
+        const bool repeated = (i > 0) && (sweep_blocks[i] == sweep_blocks[i - 1U]);
+        if ((sweep_blocks[i] > 0) && !repeated && (probe(sweep_blocks[i] * CANARD_MEM_BLOCK_SIZE) < 0))
+        {
+            (void)canardReplayClose(&replay);
+            return 1;
+        }
+    }
+
+    const CanardReplayStatistics log_stats = canardReplayGetStatistics(&replay);
+    timeline_interval_usec = (uint64_t)interval_ms * 1000U;
+    if ((log_stats.log_span_usec / timeline_interval_usec) >= MAX_TIMELINE_INTERVALS)
+    {
+        timeline_interval_usec = (log_stats.log_span_usec / MAX_TIMELINE_INTERVALS) + 1U;
+    }
+    record_timeline = true;
+    const uint32_t min_size = min_blocks * CANARD_MEM_BLOCK_SIZE;
+    if (probe(min_size) != 0)
+    {
+        (void)canardReplayClose(&replay);
+        return 1;
+    }
+
+    printf("\nLog: %llu frames, %llu own frames ignored, %.3f s; the node received %llu transfers, "
+           "sent %llu responses and %llu messages\n",
+           (unsigned long long)log_stats.frames, (unsigned long long)result.own_frames,
+           (double)log_stats.log_span_usec / 1e6, (unsigned long long)result.transfers,
+           (unsigned long long)result.responses, (unsigned long long)result.publications);
+
+    const uint32_t headroom_blocks = (uint32_t)((min_blocks * headroom_percent + 99U) / 100U);
+    printf("Smallest pool without allocation failures: %u bytes (%u blocks of %u bytes)\n",
+           min_size, min_blocks, (unsigned)CANARD_MEM_BLOCK_SIZE);
+    printf("With %lu%% headroom: static uint8_t g_canard_memory_pool[%u];\n",
+           headroom_percent, (min_blocks + headroom_blocks) * CANARD_MEM_BLOCK_SIZE);
+
+    printPeak();
+    printTimeline(log_stats.log_span_usec, (uint16_t)min_blocks);
+
+    (void)canardReplayClose(&replay);
+    return 0;
+}
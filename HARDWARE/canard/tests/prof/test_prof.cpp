@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+
+/*
+ * Tests of the profiling counters (CANARD_ENABLE_PROFILING). The clock is injected through canardTraceGetTimestamp(),
+ * advancing by a fixed step on every read, so that every pass through a site takes exactly that step.
+ */
+
+#include <catch.hpp>
+#include "canard.h"
+
+#if !CANARD_ENABLE_PROFILING || (CANARD_PROF_USER_SITES != 2U)
+# error "This test must be built with CANARD_ENABLE_PROFILING=1, CANARD_PROF_USER_SITES=2U"
+#endif
+
+static const uint16_t MessageDataTypeID = 20000;
+static const uint64_t MessageSignature = 0x1122334455667788ULL;
+
+/// Application sites, an expression is fine behind a macro name
+#define PROF_SITE_APP_WORK      (CanardProfSiteUser + 1)
+
+static uint32_t g_timestamp = 0;
+static uint32_t g_timestamp_step = 0;
+static unsigned g_num_received = 0;
+
+extern "C" uint32_t canardTraceGetTimestamp(void)
+{
+    const uint32_t out = g_timestamp;
+    g_timestamp += g_timestamp_step;
+    return out;
+}
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t)
+{
+    *out_data_type_signature = MessageSignature;
+    return (transfer_type == CanardTransferTypeBroadcast) && (data_type_id == MessageDataTypeID);
+}
+
+static void onTransferReception(CanardInstance*, CanardRxTransfer*)
+{
+    g_num_received++;
+}
+
+struct ProfFixture
+{
+    uint8_t tx_arena[1024];
+    uint8_t rx_arena[1024];
+    CanardInstance tx;
+    CanardInstance rx;
+    uint8_t transfer_id = 0;
+
+    ProfFixture()
+    {
+        canardInit(&tx, tx_arena, sizeof(tx_arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+        canardInit(&rx, rx_arena, sizeof(rx_arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+        canardSetLocalNodeID(&tx, 42);
+        canardSetLocalNodeID(&rx, 43);
+        canardProfReset();
+        g_timestamp = 1000;
+        g_timestamp_step = 0;
+        g_num_received = 0;
+    }
+
+    int16_t broadcast(uint16_t payload_len)
+    {
+        uint8_t payload[64] = { 0 };
+        return canardBroadcast(&tx, MessageSignature, MessageDataTypeID, &transfer_id,
+                               CANARD_TRANSFER_PRIORITY_MEDIUM, payload, payload_len);
+    }
+
+    /// Delivers the TX queue of the transmitter to the receiver
+    void deliver()
+    {
+        for (const CanardCANFrame* frame = canardPeekTxQueue(&tx); frame != nullptr; frame = canardPeekTxQueue(&tx))
+        {
+            canardHandleRxFrame(&rx, frame, 1000);
+            canardPopTxQueue(&tx);
+        }
+    }
+};
+
+
+TEST_CASE("Prof, Counters")
+{
+    canardProfReset();
+    REQUIRE(canardGetProfStatistics(CanardProfSiteUser).count == 0);
+    REQUIRE(canardGetProfStatistics(CanardProfSiteUser).min == 0);
+
+    canardProfRecord(CanardProfSiteUser, 30);
+    canardProfRecord(CanardProfSiteUser, 10);
+    canardProfRecord(CanardProfSiteUser, 50);
+    canardProfRecord(CanardProfSiteUser, 0xFFFFFFFFUL);
+
+    const CanardProfStatistics stats = canardGetProfStatistics(CanardProfSiteUser);
+    REQUIRE(stats.count == 4);
+    REQUIRE(stats.min == 10);
+    REQUIRE(stats.max == 0xFFFFFFFFUL);
+    REQUIRE(stats.total == 90ULL + 0xFFFFFFFFULL);     // Does not wrap at 32 bits
+
+    // The other sites are independent
+    REQUIRE(canardGetProfStatistics(CanardProfSiteHandleRxFrame).count == 0);
+    REQUIRE(canardGetProfStatistics(PROF_SITE_APP_WORK).count == 0);
+
+    canardProfReset();
+    REQUIRE(canardGetProfStatistics(CanardProfSiteUser).count == 0);
+    REQUIRE(canardGetProfStatistics(CanardProfSiteUser).max == 0);
+    REQUIRE(canardGetProfStatistics(CanardProfSiteUser).total == 0);
+}
+
+TEST_CASE("Prof, UserSites")
+{
+    canardProfReset();
+    g_timestamp = 0xFFFFFFF0UL;         // The difference of the readings survives the wrap-around of the clock
+    g_timestamp_step = 0x20;
+    for (int i = 0; i < 3; i++)
+    {
+        CANARD_PROF_BEGIN(PROF_SITE_APP_WORK);
+        CANARD_PROF_END(PROF_SITE_APP_WORK);
+    }
+
+    const CanardProfStatistics stats = canardGetProfStatistics(PROF_SITE_APP_WORK);
+    REQUIRE(stats.count == 3);
+    REQUIRE(stats.min == 0x20);
+    REQUIRE(stats.max == 0x20);
+    REQUIRE(stats.total == 0x60);
+    REQUIRE(canardGetProfStatistics(CanardProfSiteUser).count == 0);
+}
+
+TEST_CASE_METHOD(ProfFixture, "Prof, LibrarySites")
+{
+    g_timestamp_step = 7;
+
+    // Single-frame and three-frame transfers: one pass per transfer on TX, one pass per frame on RX
+    REQUIRE(broadcast(4) == 1);
+    REQUIRE(broadcast(18) == 3);
+    CanardProfStatistics stats = canardGetProfStatistics(CanardProfSiteTxTransfer);
+    REQUIRE(stats.count == 2);
+    REQUIRE(stats.min == 7);
+    REQUIRE(stats.total == 14);
+
+    deliver();
+    REQUIRE(g_num_received == 2);
+    stats = canardGetProfStatistics(CanardProfSiteHandleRxFrame);
+    REQUIRE(stats.count == 4);
+    REQUIRE(stats.max == 7);
+    REQUIRE(stats.total == 28);
+
+    // Frames that are not UAVCAN take the early returns, which are counted as well
+    CanardCANFrame frame = {};
+    frame.id = 123;
+    frame.data_len = 1;
+    canardHandleRxFrame(&rx, &frame, 1000);
+    REQUIRE(canardGetProfStatistics(CanardProfSiteHandleRxFrame).count == 5);
+
+    canardCleanupStaleTransfers(&rx, 10000000);
+    REQUIRE(canardGetProfStatistics(CanardProfSiteCleanup).count == 1);
+
+    // Rejected arguments are not timed
+    uint8_t tid = 0;
+    REQUIRE(canardBroadcast(&tx, MessageSignature, MessageDataTypeID, &tid, 99, nullptr, 0) ==
+            -CANARD_ERROR_INVALID_ARGUMENT);
+    REQUIRE(canardGetProfStatistics(CanardProfSiteTxTransfer).count == 2);
+
+    // Nothing in this build calls the driver sites
+    REQUIRE(canardGetProfStatistics(CanardProfSiteDriverTransmit).count == 0);
+    REQUIRE(canardGetProfStatistics(CanardProfSiteDriverReceive).count == 0);
+}
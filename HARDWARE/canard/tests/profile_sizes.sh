@@ -0,0 +1,55 @@
+#!/bin/bash
+#
+# Copyright (c) 2018 UAVCAN Team
+#
+# Compares the footprint of canard.c built with the compile-time profiles from canard_config.h.
+# Flash is the text section of the object file; RAM is its static data (data + bss) plus sizeof(CanardInstance).
+# By default the Cortex-M3 cross toolchain is used; override CC, SIZE and CFLAGS to use another one, e.g.:
+#   CC=gcc SIZE=size CFLAGS="-Os -DCANARD_MEM_BLOCK_SIZE=64" ./profile_sizes.sh
+#
+
+CC=${CC:-arm-none-eabi-gcc}
+SIZE=${SIZE:-arm-none-eabi-size}
+CFLAGS=${CFLAGS:-"-mcpu=cortex-m3 -mthumb -Os"}
+
+SRC_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+TMP_DIR="$(mktemp -d)"
+trap 'rm -rf "$TMP_DIR"' EXIT
+
+# The instance is the only RAM the library needs besides the memory arena supplied by the application
+echo '#include "canard.h"'          >  "$TMP_DIR/instance.c"
+echo 'CanardInstance probe_instance;' >> "$TMP_DIR/instance.c"
+
+PROFILES=(
+    "FULL:"
+    "SINGLE_FRAME_ONLY:-DCANARD_PROFILE_SINGLE_FRAME_ONLY"
+    "NO_ANONYMOUS:-DCANARD_PROFILE_NO_ANONYMOUS"
+    "NO_SERVICE_CLIENT:-DCANARD_PROFILE_NO_SERVICE_CLIENT"
+    "NO_FLOAT16:-DCANARD_PROFILE_NO_FLOAT16"
+    "FIRMWARE:-DCANARD_ENABLE_MULTI_FRAME_RX=0 -DCANARD_PROFILE_NO_ANONYMOUS -DCANARD_PROFILE_NO_SERVICE_CLIENT \
+-DCANARD_PROFILE_NO_FLOAT16"
+    "ALL:-DCANARD_PROFILE_SINGLE_FRAME_ONLY -DCANARD_PROFILE_NO_ANONYMOUS -DCANARD_PROFILE_NO_SERVICE_CLIENT \
+-DCANARD_PROFILE_NO_FLOAT16"
+)
+
+# Prints "text data bss" of an object file
+sizes()
+{
+    "$SIZE" "$1" | awk 'NR == 2 { print $1, $2, $3 }'
+}
+
+printf "%-20s %10s %10s %10s\n" "Profile" "Flash" "RAM" "Flash diff"
+full_text=""
+for entry in "${PROFILES[@]}"; do
+    name="${entry%%:*}"
+    defs="${entry#*:}"
+
+    $CC -std=c99 $CFLAGS -DNDEBUG $defs -I"$SRC_DIR" -c "$SRC_DIR/canard.c" -o "$TMP_DIR/canard.o" || exit 1
+    $CC -std=c99 $CFLAGS -DNDEBUG $defs -I"$SRC_DIR" -c "$TMP_DIR/instance.c" -o "$TMP_DIR/instance.o" || exit 1
+
+    read -r text data bss <<< "$(sizes "$TMP_DIR/canard.o")"
+    read -r _ _ instance <<< "$(sizes "$TMP_DIR/instance.o")"
+
+    full_text=${full_text:-$text}
+    printf "%-20s %10u %10u %+10d\n" "$name" "$text" $((data + bss + instance)) $((text - full_text))
+done
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+/*
+ * Tests of the log replay driver: candump logs and binary trace dumps, from memory and from a mapped file.
+ */
+
+#include <catch.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "canard.h"
+#include "canard_replay.h"
+
+static const uint16_t MessageDataTypeID = 20000;
+static const uint64_t MessageSignature = 0x1122334455667788ULL;
+
+static uint32_t g_received = 0;
+static uint16_t g_last_payload_len = 0;
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t)
+{
+    *out_data_type_signature = MessageSignature;
+    return (transfer_type == CanardTransferTypeBroadcast) && (data_type_id == MessageDataTypeID);
+}
+
+static void onTransferReception(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    g_received++;
+    g_last_payload_len = transfer->payload_len;
+    canardReleaseRxTransferPayload(ins, transfer);
+}
+
+/// Broadcasts a transfer from node 42 and returns its frames.
+static std::vector<CanardCANFrame> makeTransfer(uint16_t payload_len, uint8_t transfer_id)
+{
+    static uint8_t arena[1024];
+    CanardInstance ins;
+    canardInit(&ins, arena, sizeof(arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 42);
+
+    uint8_t payload[64];
+    for (uint16_t i = 0; i < payload_len; i++)
+    {
+        payload[i] = uint8_t(i * 3U);
+    }
+    REQUIRE(canardBroadcast(&ins, MessageSignature, MessageDataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_MEDIUM,
+                            payload, payload_len) > 0);
+    std::vector<CanardCANFrame> frames;
+    for (const CanardCANFrame* f = canardPeekTxQueue(&ins); f != nullptr; f = canardPeekTxQueue(&ins))
+    {
+        frames.push_back(*f);
+        canardPopTxQueue(&ins);
+    }
+    return frames;
+}
+
+static bool isSameFrame(const CanardCANFrame& a, const CanardCANFrame& b)
+{
+    return (a.id == b.id) && (a.data_len == b.data_len) && (std::memcmp(a.data, b.data, a.data_len) == 0);
+}
+
+static std::string formatCandumpLine(uint64_t timestamp_usec, const CanardCANFrame& frame)
+{
+    char line[96];
+    int len = std::snprintf(line, sizeof(line), "(%llu.%06llu) can0 %08X#",
+                            static_cast<unsigned long long>(timestamp_usec / 1000000U),
+                            static_cast<unsigned long long>(timestamp_usec % 1000000U),
+                            unsigned(frame.id & CANARD_CAN_EXT_ID_MASK));
+    for (uint8_t i = 0; i < frame.data_len; i++)
+    {
+        len += std::snprintf(&line[len], sizeof(line) - size_t(len), "%02X", frame.data[i]);
+    }
+    return std::string(line) + "\n";
+}
+
+struct ReplayFixture
+{
+    uint8_t arena[4096];
+    CanardInstance rx;
+    CanardReplayInstance replay;
+
+    ReplayFixture()
+    {
+        canardInit(&rx, arena, sizeof(arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+        canardSetLocalNodeID(&rx, 43);
+        g_received = 0;
+        g_last_payload_len = 0;
+    }
+};
+
+
+TEST_CASE("Replay, Candump")
+{
+    ReplayFixture f;
+
+    std::string log = "# Comment lines and unsupported frames are skipped\n\n";
+    uint64_t timestamp_usec = 1436509052249713ULL;
+    for (uint8_t tid = 0; tid < 10; tid++)
+    {
+        for (const CanardCANFrame& frame : makeTransfer(uint16_t(5U + tid * 4U), tid))
+        {
+            log += formatCandumpLine(timestamp_usec, frame);
+            timestamp_usec += 250;
+        }
+    }
+    log += "(1436509052.900000) can0 123#DEADBEEF\n";               // Base frame, not UAVCAN
+    log += "(1436509052.900001) can0 20000080#0000000000000000\n";  // Error frame
+    log += "(1436509052.900002) can0 123##1112233\n";               // CAN FD
+    log += "(1436509052.900003) can0 0C7D55#01020\n";               // Odd number of digits
+    log += "(1436509052.900004) can0 123#R";                        // Remote frame, without a newline
+
+    REQUIRE(canardReplayOpenMemory(&f.replay, log.data(), log.size()) == 0);
+    REQUIRE(canardReplayRun(&f.replay, &f.rx, 0.0F, 0) == 0);
+
+    const CanardReplayStatistics stats = canardReplayGetStatistics(&f.replay);
+    REQUIRE(g_received == 10);
+    REQUIRE(g_last_payload_len == 41);
+    REQUIRE(stats.transfers == 10);
+    REQUIRE(stats.skipped == 4);
+    REQUIRE(stats.frames > 20);
+    REQUIRE(stats.log_span_usec == 1436509052900004ULL - 1436509052249713ULL);
+    REQUIRE(stats.elapsed_nsec > 0);
+    REQUIRE(stats.frames_per_sec > 0);
+
+    // The on_reception callback of the instance is restored
+    REQUIRE(f.rx.on_reception == &onTransferReception);
+
+    // The frames are parsed with their flags and their timestamps
+    canardReplayRewind(&f.replay);
+    REQUIRE(canardReplayGetStatistics(&f.replay).frames == 0);
+    CanardCANFrame frames[CANARD_REPLAY_BATCH_SIZE];
+    uint64_t timestamps[CANARD_REPLAY_BATCH_SIZE];
+    REQUIRE(canardReplayRead(&f.replay, frames, timestamps, 1) == 1);
+    REQUIRE(timestamps[0] == 1436509052249713ULL);
+    REQUIRE(isSameFrame(frames[0], makeTransfer(5, 0)[0]));
+
+    int16_t count = 0;
+    uint16_t total = 1;
+    CanardCANFrame last;
+    while ((count = canardReplayRead(&f.replay, frames, timestamps, CANARD_REPLAY_BATCH_SIZE)) > 0)
+    {
+        total = uint16_t(total + count);
+        last = frames[count - 1];
+    }
+    REQUIRE(count == 0);
+    REQUIRE(total == canardReplayGetStatistics(&f.replay).frames);
+    REQUIRE(last.id == (0x123U | CANARD_CAN_FRAME_RTR));
+    REQUIRE(last.data_len == 0);
+
+    REQUIRE(canardReplayClose(&f.replay) == 0);
+}
+
+TEST_CASE("Replay, MaxFramesAndPacing")
+{
+    ReplayFixture f;
+
+    // A single-frame transfer every 10 ms, over 40 ms
+    std::string log;
+    for (uint8_t tid = 0; tid < 5; tid++)
+    {
+        log += formatCandumpLine(1000000U + tid * 10000U, makeTransfer(4, tid)[0]);
+    }
+    REQUIRE(canardReplayOpenMemory(&f.replay, log.data(), log.size()) == 0);
+
+    REQUIRE(canardReplayRun(&f.replay, &f.rx, 0.0F, 2) == 0);
+    REQUIRE(canardReplayGetStatistics(&f.replay).frames == 2);
+    REQUIRE(g_received == 2);
+
+    // The remaining 20 ms of the log take at least 10 ms at twice the recorded rate
+    const uint64_t elapsed_before = canardReplayGetStatistics(&f.replay).elapsed_nsec;
+    REQUIRE(canardReplayRun(&f.replay, &f.rx, 2.0F, 0) == 0);
+    REQUIRE(canardReplayGetStatistics(&f.replay).elapsed_nsec - elapsed_before >= 10000000U);
+    REQUIRE(g_received == 5);
+    REQUIRE(canardReplayGetStatistics(&f.replay).transfers == 5);
+}
+
+static void putLittleEndian32(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        out.push_back(uint8_t(value >> (8U * i)));
+    }
+}
+
+static void putTraceEvent(std::vector<uint8_t>& out, uint32_t timestamp, uint8_t event, const CanardCANFrame& frame)
+{
+    putLittleEndian32(out, timestamp);
+    putLittleEndian32(out, frame.id);
+    out.push_back(event);
+    out.push_back(0);
+    out.push_back(frame.data_len);
+    out.push_back(frame.data[frame.data_len - 1U]);
+    out.insert(out.end(), frame.data, frame.data + CANARD_CAN_FRAME_MAX_DATA_LEN);
+}
+
+static void putTraceHeader(std::vector<uint8_t>& out, uint16_t count, uint8_t entry_size)
+{
+    const uint8_t header[8] = { 'C', 'T', 'R', 'C', 1, entry_size, uint8_t(count), uint8_t(count >> 8U) };
+    out.insert(out.end(), header, header + sizeof(header));
+    putLittleEndian32(out, 1000000U);       // Timestamps in microseconds
+    putLittleEndian32(out, 0);
+}
+
+TEST_CASE("Replay, TraceFile")
+{
+    ReplayFixture f;
+
+    // Two records, as canardTraceDump() writes them; the timestamp wraps around in the second one
+    const std::vector<CanardCANFrame> frames = makeTransfer(20, 3);
+    REQUIRE(frames.size() == 4);
+    std::vector<uint8_t> dump;
+    putTraceHeader(dump, 3, 20);
+    putTraceEvent(dump, 0xFFFFFF00UL, 0, frames[0]);       // TX enqueue, skipped
+    putTraceEvent(dump, 0xFFFFFF10UL, 2, frames[0]);
+    putTraceEvent(dump, 0xFFFFFFF0UL, 2, frames[1]);
+    putTraceHeader(dump, 2, 20);
+    putTraceEvent(dump, 0x00000010UL, 2, frames[2]);
+    putTraceEvent(dump, 0x00000110UL, 2, frames[3]);
+
+    char path[] = "/tmp/canard_replay_test_XXXXXX";
+    const int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+    REQUIRE(write(fd, dump.data(), dump.size()) == ssize_t(dump.size()));
+    REQUIRE(close(fd) == 0);
+
+    REQUIRE(canardReplayOpen(&f.replay, path) == 0);
+    CanardCANFrame read_frames[8];
+    uint64_t timestamps[8];
+    REQUIRE(canardReplayRead(&f.replay, read_frames, timestamps, 8) == 4);
+    REQUIRE(isSameFrame(read_frames[3], frames[3]));
+    REQUIRE(timestamps[0] == 0x10U);                        // From the first event of the dump
+    REQUIRE(timestamps[2] == 0x110U);
+    REQUIRE(timestamps[3] == 0x210U);
+    REQUIRE(canardReplayRead(&f.replay, read_frames, timestamps, 8) == 0);
+    REQUIRE(canardReplayGetStatistics(&f.replay).skipped == 1);
+
+    canardReplayRewind(&f.replay);
+    REQUIRE(canardReplayRun(&f.replay, &f.rx, 0.0F, 0) == 0);
+    REQUIRE(g_received == 1);
+    REQUIRE(g_last_payload_len == 20);
+    REQUIRE(canardReplayClose(&f.replay) == 0);
+
+    // A dump without the frame data cannot be replayed, neither can a truncated one
+    std::vector<uint8_t> bad;
+    putTraceHeader(bad, 1, 12);
+    putLittleEndian32(bad, 0);
+    REQUIRE(canardReplayOpenMemory(&f.replay, bad.data(), bad.size()) == 0);
+    REQUIRE(canardReplayRead(&f.replay, read_frames, timestamps, 8) == -EINVAL);
+    dump.resize(dump.size() - 1U);
+    REQUIRE(canardReplayOpenMemory(&f.replay, dump.data(), dump.size()) == 0);
+    REQUIRE(canardReplayRun(&f.replay, &f.rx, 0.0F, 0) == -EINVAL);
+
+    REQUIRE(unlink(path) == 0);
+    REQUIRE(canardReplayOpen(&f.replay, path) == -ENOENT);
+}
@@ -0,0 +1,154 @@
+/*
+ * This application is distributed under the terms of CC0 (public domain dedication).
+ * More info: https://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * Measures the throughput of the receive path on a recorded traffic mix: the frames of a candump log or of a binary
+ * trace dump are fed to one library instance, as fast as possible or at a multiple of the recorded rate, and the
+ * rates are printed. Every transfer is accepted; multi-frame transfers pass their CRC check only if the signature of
+ * their data type is given with -s, the others still run through the whole reassembly.
+ */
+
+#include <canard.h>
+#include <canard_replay.h>  // Log replay driver, distributed with Libcanard
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SIGNATURES                  64U
+
+typedef struct
+{
+    uint16_t data_type_id;
+    uint64_t signature;
+} DataTypeSignature;
+
+static DataTypeSignature signatures[MAX_SIGNATURES];
+static unsigned num_signatures = 0;
+
+static uint8_t canard_memory_pool[1024 * 1024];
+
+
+static bool shouldAcceptTransfer(const CanardInstance* ins,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t source_node_id)
+{
+    (void)ins;
+    (void)transfer_type;
+    (void)source_node_id;
+
+    *out_data_type_signature = 0;
+    for (unsigned i = 0; i < num_signatures; i++)
+    {
+        if (signatures[i].data_type_id == data_type_id)
+        {
+            *out_data_type_signature = signatures[i].signature;
+        }
+    }
+    return true;
+}
+
+static void onTransferReceived(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    canardReleaseRxTransferPayload(ins, transfer);
+}
+
+static int printUsage(const char* name)
+{
+    (void)fprintf(stderr,
+                  "Usage:\n"
+                  "\t%s <log> [--speed <factor>] [--repeat <n>] [--node-id <id>] [-s <data type id>:<signature>]...\n"
+                  "The log is a candump -l log or a dump of canardTraceDump() with frame data. A speed of 0, the\n"
+                  "default, replays as fast as possible. Services are received only with a node ID.\n",
+                  name);
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        return printUsage(argv[0]);
+    }
+
+    float speed = 0.0F;
+    unsigned long repeat = 1;
+    unsigned long node_id = 0;
+    for (int i = 2; i < argc; i++)
+    {
+        const bool has_value = (i + 1) < argc;
+        if ((strcmp(argv[i], "--speed") == 0) && has_value)
+        {
+            speed = strtof(argv[++i], NULL);
+        }
+        else if ((strcmp(argv[i], "--repeat") == 0) && has_value)
+        {
+            repeat = strtoul(argv[++i], NULL, 10);
+        }
+        else if ((strcmp(argv[i], "--node-id") == 0) && has_value)
+        {
+            node_id = strtoul(argv[++i], NULL, 10);
+        }
+        else if ((strcmp(argv[i], "-s") == 0) && has_value && (num_signatures < MAX_SIGNATURES))
+        {
+            char* separator = NULL;
+            signatures[num_signatures].data_type_id = (uint16_t)strtoul(argv[++i], &separator, 10);
+            if (*separator != ':')
+            {
+                return printUsage(argv[0]);
+            }
+            signatures[num_signatures].signature = strtoull(separator + 1, NULL, 16);
+            num_signatures++;
+        }
+        else
+        {
+            return printUsage(argv[0]);
+        }
+    }
+
+    CanardReplayInstance replay;
+    int16_t res = canardReplayOpen(&replay, argv[1]);
+    if (res < 0)
+    {
+        (void)fprintf(stderr, "Failed to open log '%s': %s\n", argv[1], strerror(-res));
+        return 1;
+    }
+
+    CanardInstance canard;
+    canardInit(&canard, canard_memory_pool, sizeof(canard_memory_pool), onTransferReceived, shouldAcceptTransfer, NULL);
+    if ((node_id >= CANARD_MIN_NODE_ID) && (node_id <= CANARD_MAX_NODE_ID))
+    {
+        canardSetLocalNodeID(&canard, (uint8_t)node_id);
+    }
+
+    /*
+     * Every pass replays the whole log into the same instance; the rates are those of the last pass, whose code and
+     * data are warm.
+     */
+    CanardReplayStatistics stats;
+    memset(&stats, 0, sizeof(stats));
+    for (unsigned long pass = 0; pass < repeat; pass++)
+    {
+        canardReplayRewind(&replay);
+        res = canardReplayRun(&replay, &canard, speed, 0);
+        if (res < 0)
+        {
+            (void)fprintf(stderr, "Malformed log: %s\n", strerror(-res));
+            (void)canardReplayClose(&replay);
+            return 1;
+        }
+        stats = canardReplayGetStatistics(&replay);
+    }
+
+    printf("%llu frames, %llu transfers, %llu skipped, %.3f s of log replayed in %.3f s\n",
+           (unsigned long long)stats.frames, (unsigned long long)stats.transfers, (unsigned long long)stats.skipped,
+           (double)stats.log_span_usec / 1e6, (double)stats.elapsed_nsec / 1e9);
+    printf("%u frames/s, %u transfers/s\n", stats.frames_per_sec, stats.transfers_per_sec);
+
+    const CanardPoolAllocatorStatistics pool = canardGetPoolAllocatorStatistics(&canard);
+    printf("Memory pool: %u of %u blocks at peak\n", pool.peak_usage_blocks, pool.capacity_blocks);
+
+    (void)canardReplayClose(&replay);
+    return 0;
+}
@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+#include <catch.hpp>
+#include <cstring>
+#include <vector>
+#include "canard.h"
+#include "canard_sim.h"
+
+static const uint16_t MessageDataTypeID = 341;
+static const uint64_t MessageSignature = 0x0F0868D0C1A7C6F1ULL;
+static const uint8_t ServiceDataTypeID = 42;
+static const uint64_t ServiceSignature = 0x8877665544332211ULL;
+
+struct SimNodeLog
+{
+    uint32_t transfers = 0;
+    uint16_t last_payload_len = 0;
+};
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t)
+{
+    if ((transfer_type == CanardTransferTypeBroadcast) && (data_type_id == MessageDataTypeID))
+    {
+        *out_data_type_signature = MessageSignature;
+        return true;
+    }
+    if ((transfer_type == CanardTransferTypeRequest) && (data_type_id == ServiceDataTypeID))
+    {
+        *out_data_type_signature = ServiceSignature;
+        return true;
+    }
+    return false;
+}
+
+static void onTransferReception(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    SimNodeLog* const log = static_cast<SimNodeLog*>(canardGetUserReference(ins));
+    log->transfers++;
+    log->last_payload_len = transfer->payload_len;
+    canardReleaseRxTransferPayload(ins, transfer);
+}
+
+/// A library instance with its own memory pool, connected to a simulated bus.
+struct SimNode
+{
+    uint8_t arena[4096];      // Room for the RX states of 50 sources
+    CanardInstance ins;
+    CanardSimNode sim;
+    SimNodeLog log;
+    uint8_t transfer_id = 0;
+
+    SimNode(CanardSimBus& bus, uint8_t node_id, uint32_t poll_interval_usec,
+            uint8_t num_mailboxes = CANARD_SIM_MAX_TX_MAILBOXES,
+            uint8_t rx_fifo_depth = CANARD_SIM_MAX_RX_FIFO_DEPTH)
+    {
+        canardInit(&ins, arena, sizeof(arena), &onTransferReception, &shouldAcceptTransfer, &log);
+        canardSetLocalNodeID(&ins, node_id);
+        REQUIRE(0 == canardSimAddNode(&bus, &sim, &ins, num_mailboxes, rx_fifo_depth, poll_interval_usec));
+    }
+
+    int16_t broadcast(CanardSimBus& bus, uint8_t priority, uint16_t payload_len = 7)
+    {
+        uint8_t payload[64] = {};
+        return canardSimBroadcast(&bus, &sim, MessageSignature, MessageDataTypeID, &transfer_id, priority,
+                                  payload, payload_len);
+    }
+};
+
+struct SentTransfer
+{
+    const CanardSimNode* node;
+    uint64_t latency_nsec;
+};
+
+static std::vector<SentTransfer> g_sent;
+
+static void onTransferSent(CanardSimBus*, CanardSimNode* node, uint32_t, uint8_t, uint64_t latency_nsec)
+{
+    g_sent.push_back(SentTransfer{ node, latency_nsec });
+}
+
+static CanardCANFrame makeFrame(uint32_t id, uint8_t data_len, uint8_t fill)
+{
+    CanardCANFrame frame;
+    std::memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.data_len = data_len;
+    std::memset(frame.data, fill, data_len);
+    return frame;
+}
+
+
+TEST_CASE("Sim, FrameBitLength")
+{
+    // All dominant: 34 bits from SOF to CRC, stuffed after every fifth one, plus the trailer
+    CanardCANFrame frame = makeFrame(0, 0, 0);
+    REQUIRE(canardSimGetFrameBitLength(&frame) == 34U + 6U + CANARD_SIM_FRAME_TRAILER_BITS);
+
+    // Unstuffed lengths are 47 + 8 * n and 67 + 8 * n bits; stuffing adds at most one bit per four after the first
+    uint32_t state = 12345U;
+    for (unsigned i = 0; i < 10000U; i++)
+    {
+        state = state * 1103515245U + 12345U;
+        const bool extended = (state & 1U) != 0U;
+        const uint8_t dlc = uint8_t((state >> 1U) % 9U);
+        frame = makeFrame(extended ? ((state & CANARD_CAN_EXT_ID_MASK) | CANARD_CAN_FRAME_EFF) :
+                                     (state & CANARD_CAN_STD_ID_MASK), dlc, 0);
+        for (uint8_t k = 0; k < dlc; k++)
+        {
+            state = state * 1103515245U + 12345U;
+            frame.data[k] = uint8_t(state >> 24U);
+        }
+        const uint32_t unstuffed = (extended ? 54U : 34U) + 8U * dlc;
+        const uint32_t length = canardSimGetFrameBitLength(&frame);
+        REQUIRE(length >= unstuffed + CANARD_SIM_FRAME_TRAILER_BITS);
+        REQUIRE(length <= unstuffed + (unstuffed - 1U) / 4U + CANARD_SIM_FRAME_TRAILER_BITS);
+    }
+}
+
+TEST_CASE("Sim, InvalidArguments")
+{
+    CanardSimBus bus;
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardSimInit(&bus, 0));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardSimInit(&bus, 1000001U));
+    REQUIRE(0 == canardSimInit(&bus, 1000000U));
+
+    CanardInstance ins;
+    uint8_t arena[512];
+    canardInit(&ins, arena, sizeof(arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+    CanardSimNode node;
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardSimAddNode(&bus, &node, &ins, 0, 1, 0));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            canardSimAddNode(&bus, &node, &ins, CANARD_SIM_MAX_TX_MAILBOXES + 1U, 1, 0));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            canardSimAddNode(&bus, &node, &ins, 1, CANARD_SIM_MAX_RX_FIFO_DEPTH + 1U, 0));
+}
+
+TEST_CASE("Sim, Arbitration")
+{
+    CanardSimBus bus;
+    REQUIRE(0 == canardSimInit(&bus, 1000000U));
+    canardSimSetOnTransferSent(&bus, &onTransferSent);
+    g_sent.clear();
+
+    SimNode low(bus, 10, 0);
+    SimNode high(bus, 20, 0);
+    REQUIRE(1 == low.broadcast(bus, CANARD_TRANSFER_PRIORITY_LOWEST));
+    REQUIRE(1 == high.broadcast(bus, CANARD_TRANSFER_PRIORITY_HIGHEST));
+    canardSimRunUntil(&bus, 1000);
+
+    // Both frames are loaded at once; the higher priority wins although it was submitted last
+    REQUIRE(g_sent.size() == 2);
+    REQUIRE(g_sent[0].node == &high.sim);
+    REQUIRE(g_sent[1].node == &low.sim);
+    REQUIRE(g_sent[1].latency_nsec > g_sent[0].latency_nsec);
+    REQUIRE(canardSimGetNodeStatistics(&low.sim).tx_lost_arbitration == 1);
+    REQUIRE(canardSimGetNodeStatistics(&high.sim).tx_lost_arbitration == 0);
+
+    // The first frame starts at zero, so its latency is its own length
+    REQUIRE(canardSimGetBusStatistics(&bus).latency.min_nsec == g_sent[0].latency_nsec);
+    REQUIRE(g_sent[0].latency_nsec % 1000U == 0);
+
+    REQUIRE(low.log.transfers == 1);
+    REQUIRE(high.log.transfers == 1);
+    canardSimSetOnTransferSent(&bus, nullptr);
+}
+
+TEST_CASE("Sim, FiftyNodes")
+{
+    CanardSimBus bus;
+    REQUIRE(0 == canardSimInit(&bus, 1000000U));
+
+    std::vector<SimNode*> nodes;
+    for (uint8_t i = 0; i < 50; i++)
+    {
+        nodes.push_back(new SimNode(bus, uint8_t(i + 1U), 0));
+    }
+    for (unsigned round = 0; round < 10; round++)
+    {
+        for (SimNode* n : nodes)
+        {
+            REQUIRE(1 == n->broadcast(bus, CANARD_TRANSFER_PRIORITY_MEDIUM));
+        }
+        canardSimRunUntil(&bus, (round + 1U) * 10000ULL);
+    }
+
+    const CanardSimBusStatistics stats = canardSimGetBusStatistics(&bus);
+    REQUIRE(stats.elapsed_nsec == 100000000ULL);
+    REQUIRE(stats.frames == 500);
+    REQUIRE(stats.error_frames == 0);
+    REQUIRE(stats.busy_nsec == stats.frame_bits * 1000U);
+    REQUIRE(stats.latency.count == 500);
+    REQUIRE(stats.latency.max_nsec <= 50U * 160U * 1000U);
+    REQUIRE(stats.latency.max_nsec >= 50U * 111U * 1000U);
+
+    // 50 single-frame transfers of roughly 120 bits every 10 ms
+    const float load = canardSimGetBusLoad(&bus);
+    REQUIRE(load > 0.5F);
+    REQUIRE(load < 0.8F);
+
+    for (SimNode* n : nodes)
+    {
+        const CanardSimNodeStatistics node_stats = canardSimGetNodeStatistics(&n->sim);
+        REQUIRE(node_stats.tx_frames == 10);
+        REQUIRE(node_stats.rx_frames == 490);
+        REQUIRE(node_stats.rx_overruns == 0);
+        REQUIRE(n->log.transfers == 490);
+        delete n;
+    }
+}
+
+TEST_CASE("Sim, RxOverrun")
+{
+    CanardSimBus bus;
+    REQUIRE(0 == canardSimInit(&bus, 1000000U));
+
+    SimNode sender(bus, 1, 0);
+    SimNode slow(bus, 2, 5000, 1, 3);
+    for (unsigned i = 0; i < 10; i++)
+    {
+        REQUIRE(1 == sender.broadcast(bus, CANARD_TRANSFER_PRIORITY_MEDIUM));
+    }
+
+    // The receiver polls at 0 and 5 ms, the ten frames arrive in between
+    canardSimRunUntil(&bus, 4000);
+    const CanardSimNodeStatistics stats = canardSimGetNodeStatistics(&slow.sim);
+    REQUIRE(stats.rx_frames == 3);
+    REQUIRE(stats.rx_overruns == 7);
+    REQUIRE(slow.log.transfers == 0);
+
+    canardSimRunUntil(&bus, 6000);
+    REQUIRE(slow.log.transfers == 3);
+}
+
+TEST_CASE("Sim, MultiFrameRequest")
+{
+    CanardSimBus bus;
+    REQUIRE(0 == canardSimInit(&bus, 500000U));
+
+    SimNode client(bus, 1, 0);
+    SimNode server(bus, 2, 100);
+    uint8_t payload[40] = {};
+    const int16_t frames = canardSimRequestOrRespond(&bus, &client.sim, 2, ServiceSignature, ServiceDataTypeID,
+                                                     &client.transfer_id, CANARD_TRANSFER_PRIORITY_MEDIUM,
+                                                     CanardRequest, payload, sizeof(payload));
+    REQUIRE(frames == 6);
+    canardSimRunUntil(&bus, 5000);
+
+    const CanardSimBusStatistics stats = canardSimGetBusStatistics(&bus);
+    REQUIRE(stats.frames == 6);
+    REQUIRE(stats.latency.count == 1);
+    REQUIRE(stats.latency.min_nsec * 500000U == stats.frame_bits * 1000000000ULL);
+    REQUIRE(server.log.transfers == 1);
+    REQUIRE(server.log.last_payload_len == sizeof(payload));
+}
+
+TEST_CASE("Sim, InjectedError")
+{
+    CanardSimBus bus;
+    REQUIRE(0 == canardSimInit(&bus, 1000000U));
+
+    SimNode sender(bus, 1, 0);
+    SimNode receiver(bus, 2, 0);
+    canardSimInjectErrors(&bus, 1);
+    REQUIRE(1 == sender.broadcast(bus, CANARD_TRANSFER_PRIORITY_MEDIUM));
+    canardSimRunUntil(&bus, 1000);
+
+    // The destroyed frame is retransmitted and delivered once
+    const CanardSimBusStatistics stats = canardSimGetBusStatistics(&bus);
+    REQUIRE(stats.error_frames == 1);
+    REQUIRE(stats.frames == 1);
+    REQUIRE(stats.busy_nsec > stats.frame_bits * 1000U);
+    REQUIRE(stats.latency.min_nsec == stats.busy_nsec);
+    REQUIRE(canardSimGetNodeStatistics(&sender.sim).tx_errors == 1);
+    REQUIRE(canardSimGetNodeStatistics(&receiver.sim).rx_frames == 1);
+    REQUIRE(receiver.log.transfers == 1);
+}
+
+static CanardSimBusStatistics runWithErrors(uint32_t seed)
+{
+    CanardSimBus bus;
+    REQUIRE(0 == canardSimInit(&bus, 250000U));
+    canardSimSetErrorRate(&bus, 100000U, seed);
+
+    SimNode a(bus, 1, 0);
+    SimNode b(bus, 2, 200);
+    SimNode c(bus, 3, 0, 1, 1);
+    for (unsigned round = 0; round < 20; round++)
+    {
+        REQUIRE(a.broadcast(bus, CANARD_TRANSFER_PRIORITY_HIGH, 30) > 0);
+        REQUIRE(b.broadcast(bus, CANARD_TRANSFER_PRIORITY_LOW, 7) > 0);
+        REQUIRE(c.broadcast(bus, CANARD_TRANSFER_PRIORITY_MEDIUM, 12) > 0);
+        canardSimRunUntil(&bus, (round + 1U) * 5000ULL);
+    }
+    canardSimRunUntil(&bus, 150000);            // Retransmissions may have delayed the last round
+    REQUIRE(a.log.transfers == 40);
+    REQUIRE(b.log.transfers == 40);
+    REQUIRE(c.log.transfers == 40);
+    return canardSimGetBusStatistics(&bus);
+}
+
+TEST_CASE("Sim, Determinism")
+{
+    const CanardSimBusStatistics first = runWithErrors(42);
+    const CanardSimBusStatistics second = runWithErrors(42);
+    const CanardSimBusStatistics other = runWithErrors(43);
+
+    REQUIRE(first.error_frames > 0);
+    REQUIRE(first.frames == 20U * (5U + 1U + 2U));
+    REQUIRE(first.error_frames == second.error_frames);
+    REQUIRE(first.busy_nsec == second.busy_nsec);
+    REQUIRE(first.latency.total_nsec == second.latency.total_nsec);
+    REQUIRE(first.latency.max_nsec == second.latency.max_nsec);
+    REQUIRE(other.frames == first.frames);
+    REQUIRE(other.busy_nsec != first.busy_nsec);
+}
@@ -0,0 +1,213 @@
+/*
+ * This application is distributed under the terms of CC0 (public domain dedication).
+ * More info: https://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * Measures the frame rate of the SocketCAN driver on a virtual CAN interface: one socket transmits, another one on
+ * the same interface receives the local echo, first frame by frame with socketcanTransmit()/socketcanReceive(), then
+ * in batches with socketcanTransmitBatch()/socketcanReceiveBatch(). The interface is set up with:
+ *   ip link add dev vcan0 type vcan && ip link set up vcan0
+ */
+
+// This is needed to enable necessary declarations in sys/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
+#include <canard.h>
+#include <socketcan.h>      // CAN backend driver for SocketCAN, distributed with Libcanard
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/// Frames in flight at most, so that the receive buffer of the socket never overflows
+#define MAX_FRAMES_IN_FLIGHT            256U
+
+/// A frame that has not arrived within this time is lost
+#define RECEIVE_TIMEOUT_MSEC            100
+
+typedef struct
+{
+    unsigned long frames_sent;
+    unsigned long frames_received;
+    unsigned long calls;                ///< Of the transmit and receive functions that moved at least one frame
+    double elapsed_sec;
+} Result;
+
+static double getMonotonicTimestampSec(void)
+{
+    struct timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void makeFrame(unsigned long index, CanardCANFrame* out_frame)
+{
+    memset(out_frame, 0, sizeof(*out_frame));
+    out_frame->id = 0x1001234UL | CANARD_CAN_FRAME_EFF;
+    out_frame->data_len = 8;
+    memcpy(out_frame->data, &index, sizeof(index));     // Tells the frames apart, for a look with candump
+}
+
+/**
+ * Moves the frames from the transmitter to the receiver, batch_size at a time; a batch size of 1 uses the
+ * frame-by-frame functions. Returns negative on error.
+ */
+static int runTransfer(SocketCANInstance* tx,
+                       SocketCANInstance* rx,
+                       unsigned long num_frames,
+                       uint16_t batch_size,
+                       Result* out_result)
+{
+    memset(out_result, 0, sizeof(*out_result));
+    CanardCANFrame frames[SOCKETCAN_BATCH_MAX_FRAMES];
+
+    const double started_at = getMonotonicTimestampSec();
+    while (out_result->frames_received < num_frames)
+    {
+        // Transmitting, without running too far ahead of the receiver
+        const unsigned long in_flight = out_result->frames_sent - out_result->frames_received;
+        unsigned long to_send = num_frames - out_result->frames_sent;
+        if (to_send > (MAX_FRAMES_IN_FLIGHT - in_flight))
+        {
+            to_send = MAX_FRAMES_IN_FLIGHT - in_flight;
+        }
+        if (to_send > batch_size)
+        {
+            to_send = batch_size;
+        }
+        if (to_send > 0)
+        {
+            int16_t tx_res = 0;
+            if (batch_size == 1)
+            {
+                makeFrame(out_result->frames_sent, &frames[0]);
+                tx_res = socketcanTransmit(tx, &frames[0], 0);
+            }
+            else
+            {
+                for (unsigned long i = 0; i < to_send; i++)
+                {
+                    makeFrame(out_result->frames_sent + i, &frames[i]);
+                }
+                tx_res = socketcanTransmitBatch(tx, frames, (uint16_t)to_send, 0);
+            }
+            if (tx_res < 0)
+            {
+                (void)fprintf(stderr, "Transmit error %d\n", tx_res);
+                return tx_res;
+            }
+            if (tx_res > 0)
+            {
+                out_result->frames_sent += (unsigned long)tx_res;
+                out_result->calls++;
+            }
+        }
+
+        // Receiving; waiting only if there is nothing to transmit
+        const int32_t timeout_msec = (out_result->frames_sent < num_frames) ? 0 : RECEIVE_TIMEOUT_MSEC;
+        const int16_t rx_res = (batch_size == 1) ?
+                               socketcanReceive(rx, &frames[0], timeout_msec) :
+                               socketcanReceiveBatch(rx, frames, batch_size, timeout_msec);
+        if (rx_res < 0)
+        {
+            (void)fprintf(stderr, "Receive error %d\n", rx_res);
+            return rx_res;
+        }
+        if (rx_res > 0)
+        {
+            out_result->frames_received += (unsigned long)rx_res;
+            out_result->calls++;
+        }
+        else if (timeout_msec > 0)
+        {
+            break;              // The rest is lost
+        }
+        else
+        {
+            ;
+        }
+    }
+    out_result->elapsed_sec = getMonotonicTimestampSec() - started_at;
+    return 0;
+}
+
+static void printResult(const char* name, const Result* result)
+{
+    const unsigned long calls = (result->calls > 0) ? result->calls : 1UL;
+    printf("%-12s: %.0f frames/s, %.1f frames per call, %lu of %lu frames lost\n", name,
+           (double)result->frames_received / result->elapsed_sec,
+           (double)(result->frames_sent + result->frames_received) / (double)calls,
+           result->frames_sent - result->frames_received, result->frames_sent);
+}
+
+static int printUsage(const char* name)
+{
+    (void)fprintf(stderr,
+                  "Usage:\n"
+                  "\t%s <can iface name> [--frames <n>] [--batch <n>]\n"
+                  "The interface should be virtual (vcan), since the frames are transmitted at full speed.\n"
+                  "The batch size is up to %u, the default.\n",
+                  name, SOCKETCAN_BATCH_MAX_FRAMES);
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        return printUsage(argv[0]);
+    }
+
+    unsigned long num_frames = 1000000UL;
+    unsigned long batch_size = SOCKETCAN_BATCH_MAX_FRAMES;
+    for (int i = 2; i < argc; i++)
+    {
+        const bool has_value = (i + 1) < argc;
+        if ((strcmp(argv[i], "--frames") == 0) && has_value)
+        {
+            num_frames = strtoul(argv[++i], NULL, 10);
+        }
+        else if ((strcmp(argv[i], "--batch") == 0) && has_value)
+        {
+            batch_size = strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            return printUsage(argv[0]);
+        }
+    }
+    if ((num_frames == 0) || (batch_size < 2) || (batch_size > SOCKETCAN_BATCH_MAX_FRAMES))
+    {
+        return printUsage(argv[0]);
+    }
+
+    SocketCANInstance tx;
+    SocketCANInstance rx;
+    if (socketcanInit(&tx, argv[1]) < 0)
+    {
+        (void)fprintf(stderr, "Failed to open CAN iface '%s'\n", argv[1]);
+        return 1;
+    }
+    if (socketcanInit(&rx, argv[1]) < 0)
+    {
+        (void)fprintf(stderr, "Failed to open CAN iface '%s'\n", argv[1]);
+        (void)socketcanClose(&tx);
+        return 1;
+    }
+
+    Result per_frame;
+    Result batched;
+    const int res = runTransfer(&tx, &rx, num_frames, 1, &per_frame);
+    if ((res == 0) && (runTransfer(&tx, &rx, num_frames, (uint16_t)batch_size, &batched) == 0))
+    {
+        printResult("per frame", &per_frame);
+        printResult("batched", &batched);
+        printf("Speedup: %.2f\n", per_frame.elapsed_sec / batched.elapsed_sec);
+    }
+
+    (void)socketcanClose(&rx);
+    (void)socketcanClose(&tx);
+    return ((res == 0) && (batched.frames_received == num_frames)) ? 0 : 1;
+}
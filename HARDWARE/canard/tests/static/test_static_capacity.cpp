@@ -0,0 +1,483 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * Tests of the static-capacity mode (CANARD_ENABLE_STATIC_CAPACITY).
+ * A simulated ESC node receives a saturated bus replay: several nodes publish multi-frame messages and several
+ * clients call a service at the same time, with their frames interleaved as tightly as possible. The capacities
+ * defined at compile time must hold without dropping anything.
+ */
+
+#include <catch.hpp>
+#include <cstring>
+#include <deque>
+#include <vector>
+#include "canard.h"
+
+#if !CANARD_ENABLE_STATIC_CAPACITY
+# error "This test must be built with CANARD_ENABLE_STATIC_CAPACITY=1"
+#endif
+
+
+static const uint16_t CommandDataTypeID = 1030;
+static const uint64_t CommandSignature = 0x217F5C87D7EC951DULL;
+static const uint16_t CommandMaxPayloadLen = 24;
+
+static const uint8_t ParamDataTypeID = 11;
+static const uint64_t ParamSignature = 0xA7B622F939D1A4D5ULL;
+static const uint16_t ParamMaxPayloadLen = 40;
+
+static const uint16_t StatusDataTypeID = 341;
+static const uint64_t StatusSignature = 0x0F0868D0C1A7C6F1ULL;
+
+static const uint8_t EscNodeID = 10;
+static const unsigned NumCommandSources = 4;
+static const unsigned NumParamClients = 2;
+
+/*
+ * Storage of the ESC node, sized for exactly the traffic of the replay
+ */
+CANARD_STATIC_SUBSCRIPTION(esc_command, CommandMaxPayloadLen, NumCommandSources);
+CANARD_STATIC_SUBSCRIPTION(esc_param, ParamMaxPayloadLen, NumParamClients);
+CANARD_STATIC_PUBLISHER(esc_status, CANARD_STATIC_TX_SLOTS(7, 1));
+CANARD_STATIC_PUBLISHER(esc_param_response, CANARD_STATIC_TX_SLOTS(ParamMaxPayloadLen, NumParamClients));
+
+static CanardStaticSubscription g_esc_subscriptions[] = {
+    CANARD_STATIC_SUBSCRIPTION_ENTRY(esc_command, CommandDataTypeID, CanardTransferTypeBroadcast,
+                                     CommandMaxPayloadLen, NumCommandSources),
+    CANARD_STATIC_SUBSCRIPTION_ENTRY(esc_param, ParamDataTypeID, CanardTransferTypeRequest,
+                                     ParamMaxPayloadLen, NumParamClients)
+};
+
+static CanardStaticPublisher g_esc_publishers[] = {
+    CANARD_STATIC_PUBLISHER_ENTRY(esc_status, StatusDataTypeID, CanardTransferTypeBroadcast,
+                                  CANARD_STATIC_TX_SLOTS(7, 1)),
+    CANARD_STATIC_PUBLISHER_ENTRY(esc_param_response, ParamDataTypeID, CanardTransferTypeResponse,
+                                  CANARD_STATIC_TX_SLOTS(ParamMaxPayloadLen, NumParamClients))
+};
+
+/*
+ * Storage of the remote nodes; one publisher each. The fifth command source is used only by the overload test.
+ */
+CANARD_STATIC_PUBLISHER(command_0, CANARD_STATIC_TX_SLOTS(CommandMaxPayloadLen + 8U, 1));
+CANARD_STATIC_PUBLISHER(command_1, CANARD_STATIC_TX_SLOTS(CommandMaxPayloadLen + 8U, 1));
+CANARD_STATIC_PUBLISHER(command_2, CANARD_STATIC_TX_SLOTS(CommandMaxPayloadLen + 8U, 1));
+CANARD_STATIC_PUBLISHER(command_3, CANARD_STATIC_TX_SLOTS(CommandMaxPayloadLen + 8U, 1));
+CANARD_STATIC_PUBLISHER(command_4, CANARD_STATIC_TX_SLOTS(CommandMaxPayloadLen + 8U, 1));
+CANARD_STATIC_PUBLISHER(param_0, CANARD_STATIC_TX_SLOTS(ParamMaxPayloadLen, 1));
+CANARD_STATIC_PUBLISHER(param_1, CANARD_STATIC_TX_SLOTS(ParamMaxPayloadLen, 1));
+
+#define COMMAND_PUBLISHER(name) \
+    CANARD_STATIC_PUBLISHER_ENTRY(name, CommandDataTypeID, CanardTransferTypeBroadcast, \
+                                  CANARD_STATIC_TX_SLOTS(CommandMaxPayloadLen + 8U, 1))
+#define PARAM_PUBLISHER(name) \
+    CANARD_STATIC_PUBLISHER_ENTRY(name, ParamDataTypeID, CanardTransferTypeRequest, \
+                                  CANARD_STATIC_TX_SLOTS(ParamMaxPayloadLen, 1))
+
+static CanardStaticPublisher g_remote_publishers[] = {
+    COMMAND_PUBLISHER(command_0),
+    COMMAND_PUBLISHER(command_1),
+    COMMAND_PUBLISHER(command_2),
+    COMMAND_PUBLISHER(command_3),
+    COMMAND_PUBLISHER(command_4),
+    PARAM_PUBLISHER(param_0),
+    PARAM_PUBLISHER(param_1)
+};
+
+static const unsigned NumRemoteNodes = sizeof(g_remote_publishers) / sizeof(g_remote_publishers[0]);
+
+
+namespace
+{
+/**
+ * Reception log of the ESC node
+ */
+struct EscContext
+{
+    unsigned commands[NumRemoteNodes] = {};
+    unsigned requests[NumRemoteNodes] = {};
+    unsigned payload_errors = 0;
+    unsigned unexpected_errors = 0;
+    unsigned responses = 0;
+};
+
+/**
+ * One remote node, which transmits through its own static instance
+ */
+struct RemoteNode
+{
+    CanardInstance ins;
+    uint8_t node_id = 0;
+    bool is_client = false;
+    uint8_t transfer_id = 0;
+    unsigned seq = 0;
+};
+}
+
+static uint8_t makePayloadByte(uint8_t node_id, unsigned seq, unsigned index)
+{
+    return uint8_t(node_id * 7U + seq * 3U + index);
+}
+
+static uint16_t makePayloadLength(unsigned seq, uint16_t max_len)
+{
+    return uint16_t(1U + (seq * 5U) % max_len);      // Mix of single-frame and multi-frame transfers
+}
+
+static bool checkPayload(const CanardRxTransfer* transfer, uint16_t max_len)
+{
+    // The sequence number is the first byte; the whole payload is contiguous in this mode
+    const unsigned seq = transfer->payload_head[0];
+    if (transfer->payload_len != makePayloadLength(seq, max_len))
+    {
+        return false;
+    }
+    for (unsigned i = 1; i < transfer->payload_len; i++)
+    {
+        if (transfer->payload_head[i] != makePayloadByte(transfer->source_node_id, seq, i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool escShouldAccept(const CanardInstance*,
+                            uint64_t* out_data_type_signature,
+                            uint16_t data_type_id,
+                            CanardTransferType transfer_type,
+                            uint8_t)
+{
+    if ((transfer_type == CanardTransferTypeBroadcast) && (data_type_id == CommandDataTypeID))
+    {
+        *out_data_type_signature = CommandSignature;
+        return true;
+    }
+    if ((transfer_type == CanardTransferTypeRequest) && (data_type_id == ParamDataTypeID))
+    {
+        *out_data_type_signature = ParamSignature;
+        return true;
+    }
+    return false;
+}
+
+static void escOnReception(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    EscContext* const ctx = static_cast<EscContext*>(canardGetUserReference(ins));
+    const unsigned remote_index = transfer->source_node_id - 20U;
+    REQUIRE(remote_index < NumRemoteNodes);
+
+    if (transfer->transfer_type == CanardTransferTypeBroadcast)
+    {
+        ctx->commands[remote_index]++;
+        ctx->payload_errors += checkPayload(transfer, CommandMaxPayloadLen) ? 0U : 1U;
+        return;
+    }
+
+    ctx->requests[remote_index]++;
+    ctx->payload_errors += checkPayload(transfer, ParamMaxPayloadLen) ? 0U : 1U;
+
+    // Echo the request back, as a parameter server would reply with the value
+    uint8_t response[ParamMaxPayloadLen];
+    std::memcpy(response, transfer->payload_head, transfer->payload_len);
+    const int16_t res = canardRequestOrRespond(ins, transfer->source_node_id, ParamSignature, ParamDataTypeID,
+                                               &transfer->transfer_id, transfer->priority, CanardResponse,
+                                               response, transfer->payload_len);
+    if (res > 0)
+    {
+        ctx->responses++;
+    }
+    else
+    {
+        ctx->unexpected_errors++;
+    }
+}
+
+static bool remoteShouldAccept(const CanardInstance*, uint64_t*, uint16_t, CanardTransferType, uint8_t)
+{
+    return false;
+}
+
+static void remoteOnReception(CanardInstance*, CanardRxTransfer*) { }
+
+static void initRemoteNodes(std::vector<RemoteNode>& nodes, unsigned num_command_sources)
+{
+    nodes.resize(num_command_sources + NumParamClients);
+    for (unsigned i = 0; i < nodes.size(); i++)
+    {
+        // Remote node i transmits through g_remote_publishers[publisher_index]; its node ID is 20 + publisher_index
+        const unsigned publisher_index = (i < num_command_sources) ? i : (NumCommandSources + 1U + i -
+                                                                          num_command_sources);
+        RemoteNode& node = nodes[i];
+        canardInitStatic(&node.ins, nullptr, 0, &g_remote_publishers[publisher_index], 1,
+                         &remoteOnReception, &remoteShouldAccept, nullptr);
+        node.node_id = uint8_t(20U + publisher_index);
+        node.is_client = i >= num_command_sources;
+        canardSetLocalNodeID(&node.ins, node.node_id);
+    }
+}
+
+static void publish(RemoteNode& node, uint16_t max_len)
+{
+    uint8_t payload[64];
+    const uint16_t len = makePayloadLength(node.seq, max_len);
+    payload[0] = uint8_t(node.seq);
+    for (unsigned i = 1; i < len; i++)
+    {
+        payload[i] = makePayloadByte(node.node_id, node.seq, i);
+    }
+
+    int16_t res = 0;
+    if (node.is_client)
+    {
+        res = canardRequestOrRespond(&node.ins, EscNodeID, ParamSignature, ParamDataTypeID, &node.transfer_id,
+                                     CANARD_TRANSFER_PRIORITY_MEDIUM, CanardRequest, payload, len);
+    }
+    else
+    {
+        res = canardBroadcast(&node.ins, CommandSignature, CommandDataTypeID, &node.transfer_id,
+                              CANARD_TRANSFER_PRIORITY_HIGH, payload, len);
+    }
+    REQUIRE(res > 0);
+    node.seq = (node.seq + 1U) % 256U;
+}
+
+/**
+ * Every remote node publishes one transfer, then the frames are fed to the ESC one frame per node at a time,
+ * so that all reassembly sessions are active at once. Returns the number of frames the ESC transmitted.
+ */
+static unsigned runRound(std::vector<RemoteNode>& nodes, CanardInstance& esc, uint64_t& timestamp_usec)
+{
+    for (RemoteNode& node : nodes)
+    {
+        publish(node, node.is_client ? ParamMaxPayloadLen : CommandMaxPayloadLen);
+    }
+
+    bool pending = true;
+    while (pending)
+    {
+        pending = false;
+        for (RemoteNode& node : nodes)
+        {
+            const CanardCANFrame* const frame = canardPeekTxQueue(&node.ins);
+            if (frame != nullptr)
+            {
+                canardHandleRxFrame(&esc, frame, timestamp_usec);
+                timestamp_usec += 100;
+                canardPopTxQueue(&node.ins);
+                pending = true;
+            }
+        }
+    }
+
+    unsigned transmitted = 0;
+    while (canardPeekTxQueue(&esc) != nullptr)
+    {
+        canardPopTxQueue(&esc);
+        transmitted++;
+    }
+    return transmitted;
+}
+
+
+TEST_CASE("StaticCapacity, SaturatedReplay")
+{
+    const unsigned NumRounds = 2000;
+
+    EscContext ctx;
+    CanardInstance esc;
+    canardInitStatic(&esc, g_esc_subscriptions, 2, g_esc_publishers, 2, &escOnReception, &escShouldAccept, &ctx);
+    canardSetLocalNodeID(&esc, EscNodeID);
+
+    std::vector<RemoteNode> nodes;
+    initRemoteNodes(nodes, NumCommandSources);
+
+    uint64_t timestamp_usec = 1000;
+    for (unsigned round = 0; round < NumRounds; round++)
+    {
+        (void) runRound(nodes, esc, timestamp_usec);
+    }
+
+    REQUIRE(ctx.payload_errors == 0);
+    REQUIRE(ctx.unexpected_errors == 0);
+    for (const RemoteNode& node : nodes)
+    {
+        const unsigned index = node.node_id - 20U;
+        REQUIRE((node.is_client ? ctx.requests[index] : ctx.commands[index]) == NumRounds);
+    }
+    REQUIRE(ctx.responses == NumRounds * NumParamClients);
+
+    // The capacities held, and all of them were needed
+    REQUIRE(g_esc_subscriptions[0].rejected_transfers == 0);
+    REQUIRE(g_esc_subscriptions[1].rejected_transfers == 0);
+    REQUIRE(g_esc_subscriptions[0].peak_sessions == NumCommandSources);
+    REQUIRE(g_esc_subscriptions[1].peak_sessions == NumParamClients);
+    REQUIRE(g_esc_publishers[1].rejected_transfers == 0);
+    REQUIRE(g_esc_publishers[1].peak_used_slots == g_esc_publishers[1].num_slots);
+    REQUIRE(g_esc_publishers[1].used_slots == 0);
+}
+
+TEST_CASE("StaticCapacity, Overload")
+{
+    EscContext ctx;
+    CanardInstance esc;
+    canardInitStatic(&esc, g_esc_subscriptions, 2, g_esc_publishers, 2, &escOnReception, &escShouldAccept, &ctx);
+    canardSetLocalNodeID(&esc, EscNodeID);
+
+    // One command source more than the subscription has sessions for
+    std::vector<RemoteNode> nodes;
+    initRemoteNodes(nodes, NumCommandSources + 1U);
+
+    uint64_t timestamp_usec = 1000;
+    for (unsigned round = 0; round < 100; round++)
+    {
+        (void) runRound(nodes, esc, timestamp_usec);
+    }
+
+    // Sessions are held by their nodes, so the extra source is dropped, while everything else still gets through
+    REQUIRE(ctx.payload_errors == 0);
+    REQUIRE(g_esc_subscriptions[0].peak_sessions == NumCommandSources);
+    REQUIRE(g_esc_subscriptions[0].rejected_transfers == 100);
+    REQUIRE(ctx.commands[NumCommandSources] == 0);
+    for (unsigned i = 0; i < NumCommandSources; i++)
+    {
+        REQUIRE(ctx.commands[i] == 100);
+    }
+
+    // Once the other sources fall silent, their sessions time out and are reused
+    timestamp_usec += 3000000;
+    canardCleanupStaleTransfers(&esc, timestamp_usec);
+    nodes.erase(nodes.begin(), nodes.begin() + NumCommandSources);
+    (void) runRound(nodes, esc, timestamp_usec);
+    REQUIRE(ctx.commands[NumCommandSources] == 1);
+}
+
+TEST_CASE("StaticCapacity, TransferLongerThanBuffer")
+{
+    EscContext ctx;
+    CanardInstance esc;
+    canardInitStatic(&esc, g_esc_subscriptions, 2, g_esc_publishers, 2, &escOnReception, &escShouldAccept, &ctx);
+    canardSetLocalNodeID(&esc, EscNodeID);
+
+    std::vector<RemoteNode> nodes;
+    initRemoteNodes(nodes, 1);
+
+    uint8_t payload[CommandMaxPayloadLen + 8U] = {};
+    REQUIRE(canardBroadcast(&nodes[0].ins, CommandSignature, CommandDataTypeID, &nodes[0].transfer_id,
+                            CANARD_TRANSFER_PRIORITY_HIGH, payload, sizeof(payload)) > 0);
+
+    for (const CanardCANFrame* frame = canardPeekTxQueue(&nodes[0].ins); frame != nullptr;
+         frame = canardPeekTxQueue(&nodes[0].ins))
+    {
+        canardHandleRxFrame(&esc, frame, 1000);
+        canardPopTxQueue(&nodes[0].ins);
+    }
+
+    REQUIRE(ctx.commands[0] == 0);
+    REQUIRE(g_esc_subscriptions[0].rejected_transfers == 1);
+}
+
+TEST_CASE("StaticCapacity, TxAllOrNothing")
+{
+    CanardInstance ins;
+    canardInitStatic(&ins, nullptr, 0, &g_remote_publishers[0], 1, &remoteOnReception, &remoteShouldAccept, nullptr);
+    canardSetLocalNodeID(&ins, 20);
+
+    CanardStaticPublisher& pub = g_remote_publishers[0];
+    REQUIRE(pub.num_slots == 5);                // 32 bytes of payload and 2 bytes of CRC take 5 frames
+
+    uint8_t transfer_id = 0;
+    uint8_t payload[CommandMaxPayloadLen] = {};
+
+    // 24 bytes take 4 frames; the second transfer does not fit and nothing of it is enqueued
+    REQUIRE(4 == canardBroadcast(&ins, CommandSignature, CommandDataTypeID, &transfer_id,
+                                 CANARD_TRANSFER_PRIORITY_HIGH, payload, sizeof(payload)));
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == canardBroadcast(&ins, CommandSignature, CommandDataTypeID, &transfer_id,
+                                                           CANARD_TRANSFER_PRIORITY_HIGH, payload, sizeof(payload)));
+    REQUIRE(pub.rejected_transfers == 1);
+    REQUIRE(pub.peak_used_slots == 4);
+
+    // A single frame still fits
+    REQUIRE(1 == canardBroadcast(&ins, CommandSignature, CommandDataTypeID, &transfer_id,
+                                 CANARD_TRANSFER_PRIORITY_HIGH, payload, 7));
+    REQUIRE(pub.used_slots == 0x1FU);
+
+    // No storage for this data type
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardBroadcast(&ins, StatusSignature, StatusDataTypeID, &transfer_id,
+                                                              CANARD_TRANSFER_PRIORITY_LOW, payload, 7));
+
+    unsigned frames = 0;
+    while (canardPeekTxQueue(&ins) != nullptr)
+    {
+        canardPopTxQueue(&ins);
+        frames++;
+    }
+    REQUIRE(frames == 5);
+    REQUIRE(pub.used_slots == 0);
+}
+
+TEST_CASE("StaticCapacity, TxBitWriter")
+{
+    CanardInstance ins;
+    canardInitStatic(&ins, nullptr, 0, &g_remote_publishers[1], 1, &remoteOnReception, &remoteShouldAccept, nullptr);
+    canardSetLocalNodeID(&ins, 21);
+
+    CanardStaticPublisher& pub = g_remote_publishers[1];
+    const uint16_t rejected = pub.rejected_transfers;
+    uint8_t transfer_id = 0;
+    CanardBitWriter writer;
+
+    // The frames are taken from the publisher slots as the payload grows
+    REQUIRE(0 == canardBeginBroadcast(&ins, &writer, CommandSignature, CommandDataTypeID, &transfer_id,
+                                      CANARD_TRANSFER_PRIORITY_HIGH));
+    canardWritePadding(&writer, CommandMaxPayloadLen * 8U);
+    REQUIRE(pub.used_slots == 0x0FU);
+    REQUIRE(4 == canardFinishTransfer(&writer));
+
+    // Out of slots: the transfer is rejected and its slots are given back
+    REQUIRE(0 == canardBeginBroadcast(&ins, &writer, CommandSignature, CommandDataTypeID, &transfer_id,
+                                      CANARD_TRANSFER_PRIORITY_HIGH));
+    canardWritePadding(&writer, CommandMaxPayloadLen * 8U);
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == canardFinishTransfer(&writer));
+    REQUIRE(pub.rejected_transfers == rejected + 1);
+    REQUIRE(pub.used_slots == 0x0FU);
+
+    // Up to 7 bytes take one slot only
+    REQUIRE(0 == canardBeginBroadcast(&ins, &writer, CommandSignature, CommandDataTypeID, &transfer_id,
+                                      CANARD_TRANSFER_PRIORITY_HIGH));
+    canardWritePadding(&writer, 7 * 8U);
+    REQUIRE(1 == canardFinishTransfer(&writer));
+    REQUIRE(pub.used_slots == 0x1FU);
+    REQUIRE(pub.peak_used_slots == 5);
+
+    // No storage for this data type
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardBeginBroadcast(&ins, &writer, StatusSignature, StatusDataTypeID,
+                                                                   &transfer_id, CANARD_TRANSFER_PRIORITY_LOW));
+
+    while (canardPeekTxQueue(&ins) != nullptr)
+    {
+        canardPopTxQueue(&ins);
+    }
+    REQUIRE(pub.used_slots == 0);
+}
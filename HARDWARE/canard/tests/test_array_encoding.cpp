@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <catch.hpp>
+#include "canard_internals.h"
+
+/*
+ * The bulk array functions must produce exactly the same bits as one canardEncodeScalar() or canardDecodeScalar()
+ * call per element, for every bit length, aligned or not, and on payloads scattered over a multi-frame transfer.
+ */
+
+static uint32_t g_random_state = 1;
+
+static uint8_t randomByte()
+{
+    g_random_state = g_random_state * 1103515245U + 12345U;
+    return uint8_t(g_random_state >> 16);
+}
+
+static uint8_t elementSize(uint8_t bit_length)
+{
+    return (bit_length == 1) ? uint8_t(sizeof(bool)) :
+           (bit_length <= 8) ? 1 : (bit_length <= 16) ? 2 : (bit_length <= 32) ? 4 : 8;
+}
+
+/// Random values that fit into bit_length bits; the unused bits of the elements are left at zero
+static std::vector<uint8_t> makeValues(uint8_t bit_length, uint16_t count)
+{
+    const uint8_t size = elementSize(bit_length);
+    std::vector<uint8_t> values(size_t(count) * size, 0);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        uint64_t value = 0;
+        for (uint8_t k = 0; k < 8; k++)
+        {
+            value = (value << 8U) | randomByte();
+        }
+        if (bit_length < 64)
+        {
+            value &= (uint64_t(1) << bit_length) - 1U;
+        }
+        if (bit_length == 1)
+        {
+            values[i] = uint8_t(value != 0);
+        }
+        else
+        {
+            std::memcpy(&values[size_t(i) * size], &value, size);     // Little-endian host
+        }
+    }
+    return values;
+}
+
+TEST_CASE("ArrayEncode, MatchesScalar")
+{
+    for (uint8_t bit_length = 1; bit_length <= 64; bit_length++)
+    {
+        for (uint32_t bit_offset = 0; bit_offset < 24; bit_offset++)
+        {
+            INFO(unsigned(bit_length));
+            INFO(bit_offset);
+            const uint16_t count = uint16_t(1U + (randomByte() % 20U));
+            const std::vector<uint8_t> values = makeValues(bit_length, count);
+            const uint8_t size = elementSize(bit_length);
+
+            // Garbage around the array must be preserved
+            std::vector<uint8_t> expected(bit_offset / 8U + count * 8U + 2U);
+            std::generate(expected.begin(), expected.end(), randomByte);
+            std::vector<uint8_t> actual = expected;
+
+            for (uint16_t i = 0; i < count; i++)
+            {
+                canardEncodeScalar(expected.data(), bit_offset + uint32_t(i) * bit_length, bit_length,
+                                   &values[size_t(i) * size]);
+            }
+            canardEncodeArray(actual.data(), bit_offset, bit_length, count, values.data());
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+static CanardRxTransfer makeContiguousTransfer(const std::vector<uint8_t>& payload)
+{
+    CanardRxTransfer transfer;
+    std::memset(&transfer, 0, sizeof(transfer));
+    transfer.payload_head = payload.data();
+    transfer.payload_len = uint16_t(payload.size());
+    return transfer;
+}
+
+TEST_CASE("ArrayDecode, MatchesScalar")
+{
+    std::vector<uint8_t> payload(100);
+    for (uint8_t bit_length = 1; bit_length <= 64; bit_length++)
+    {
+        for (uint32_t bit_offset = 0; bit_offset < 24; bit_offset++)
+        {
+            for (int value_is_signed = 0; value_is_signed < ((bit_length > 1) ? 2 : 1); value_is_signed++)
+            {
+                INFO(unsigned(bit_length));
+                INFO(bit_offset);
+                INFO(value_is_signed);
+                std::generate(payload.begin(), payload.end(), randomByte);
+                const CanardRxTransfer transfer = makeContiguousTransfer(payload);
+                const uint8_t size = elementSize(bit_length);
+
+                // Asking for more elements than there are; only the whole ones are decoded
+                const uint16_t available = uint16_t((payload.size() * 8U - bit_offset) / bit_length);
+                std::vector<uint8_t> expected(size_t(available + 5U) * size, 0xAA);
+                std::vector<uint8_t> actual = expected;
+                for (uint16_t i = 0; i < available; i++)
+                {
+                    REQUIRE(canardDecodeScalar(&transfer, bit_offset + uint32_t(i) * bit_length, bit_length,
+                                               value_is_signed != 0, &expected[size_t(i) * size]) == bit_length);
+                }
+                REQUIRE(canardDecodeArray(&transfer, bit_offset, bit_length, value_is_signed != 0,
+                                          uint16_t(available + 5U), actual.data()) == available);
+                REQUIRE(actual == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("ArrayDecode, InvalidArguments")
+{
+    std::vector<uint8_t> payload(8, 0);
+    const CanardRxTransfer transfer = makeContiguousTransfer(payload);
+    uint8_t out[8] = {};
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardDecodeArray(NULL, 0, 8, false, 1, out));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardDecodeArray(&transfer, 0, 8, false, 1, NULL));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardDecodeArray(&transfer, 0, 0, false, 1, out));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardDecodeArray(&transfer, 0, 65, false, 1, out));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardDecodeArray(&transfer, 0, 1, true, 1, out));
+    REQUIRE(0 == canardDecodeArray(&transfer, 64, 8, false, 1, out));
+    REQUIRE(0 == canardDecodeArray(&transfer, 0, 8, false, 0, NULL));
+}
+
+TEST_CASE("ArrayDecode, MultiFrame")
+{
+    CanardPoolAllocatorBlock allocator_blocks[8];
+    CanardPoolAllocator allocator;
+    initPoolAllocator(&allocator, &allocator_blocks[0], 8);
+
+    // Head, three middle blocks and a tail of five bytes
+    const size_t tail_size = 5;
+    std::vector<uint8_t> payload(CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE + CANARD_BUFFER_BLOCK_DATA_SIZE * 3U + tail_size);
+    std::generate(payload.begin(), payload.end(), randomByte);
+
+    CanardBufferBlock* middle[3];
+    for (size_t i = 0; i < 3; i++)
+    {
+        middle[i] = createBufferBlock(&allocator);
+        REQUIRE(middle[i] != NULL);
+        std::memcpy(&middle[i]->data[0], &payload[CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE + i * CANARD_BUFFER_BLOCK_DATA_SIZE],
+                    CANARD_BUFFER_BLOCK_DATA_SIZE);
+        middle[i]->next = NULL;
+        if (i > 0)
+        {
+            middle[i - 1]->next = middle[i];
+        }
+    }
+
+    CanardRxTransfer scattered;
+    std::memset(&scattered, 0, sizeof(scattered));
+    scattered.payload_head = payload.data();
+    scattered.payload_middle = middle[0];
+    scattered.payload_tail = &payload[payload.size() - tail_size];
+    scattered.payload_len = uint16_t(payload.size());
+
+    const CanardRxTransfer contiguous = makeContiguousTransfer(payload);
+
+    for (uint8_t bit_length = 1; bit_length <= 64; bit_length++)
+    {
+        for (uint32_t bit_offset = 0; bit_offset < 16; bit_offset++)
+        {
+            INFO(unsigned(bit_length));
+            INFO(bit_offset);
+            const bool value_is_signed = bit_length > 1;
+            const uint16_t count = uint16_t((payload.size() * 8U - bit_offset) / bit_length);
+            const size_t size = elementSize(bit_length);
+
+            std::vector<uint8_t> expected(count * size, 0);
+            std::vector<uint8_t> actual(count * size, 0);
+            REQUIRE(canardDecodeArray(&contiguous, bit_offset, bit_length, value_is_signed, count,
+                                      expected.data()) == count);
+            REQUIRE(canardDecodeArray(&scattered, bit_offset, bit_length, value_is_signed, count,
+                                      actual.data()) == count);
+            REQUIRE(actual == expected);
+
+            // The same reader can be reused for consecutive arrays
+            CanardRxPayloadReader reader;
+            canardInitRxPayloadReader(&reader, &scattered);
+            const uint16_t first = uint16_t(count / 2U);
+            std::fill(actual.begin(), actual.end(), 0);
+            REQUIRE(canardReadRxArray(&reader, bit_offset, bit_length, value_is_signed, first,
+                                      actual.data()) == first);
+            REQUIRE(canardReadRxArray(&reader, bit_offset + uint32_t(first) * bit_length, bit_length,
+                                      value_is_signed, uint16_t(count - first), &actual[first * size]) ==
+                    count - first);
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("ArrayFloat16, RoundTrip")
+{
+    const float values[] = { 0.0F, 1.0F, -2.5F, 65504.0F, 0.000061035156F, -1024.0F, 3.140625F };
+    const uint16_t count = uint16_t(sizeof(values) / sizeof(values[0]));
+    for (uint32_t bit_offset = 0; bit_offset < 16; bit_offset++)
+    {
+        INFO(bit_offset);
+        std::vector<uint8_t> expected(2U + count * 2U);
+        std::generate(expected.begin(), expected.end(), randomByte);
+        std::vector<uint8_t> actual = expected;
+        for (uint16_t i = 0; i < count; i++)
+        {
+            const uint16_t raw = canardConvertNativeFloatToFloat16(values[i]);
+            canardEncodeScalar(expected.data(), bit_offset + i * 16U, 16, &raw);
+        }
+        canardEncodeFloat16Array(actual.data(), bit_offset, count, values);
+        REQUIRE(actual == expected);
+
+        const CanardRxTransfer transfer = makeContiguousTransfer(actual);
+        float decoded[count] = {};
+        REQUIRE(canardDecodeFloat16Array(&transfer, bit_offset, count, decoded) == count);
+        for (uint16_t i = 0; i < count; i++)
+        {
+            REQUIRE(decoded[i] == values[i]);
+        }
+    }
+}
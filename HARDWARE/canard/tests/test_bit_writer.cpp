@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <catch.hpp>
+#include "canard.h"
+
+/*
+ * The streaming writer must put exactly the same frames into the TX queue as canardBroadcast() and
+ * canardRequestOrRespond() do with the equivalent payload, whatever the field boundaries are.
+ */
+
+static const uint16_t DataTypeID = 20000;
+static const uint64_t DataTypeSignature = 0x0F0868D0C1A7C6F1ULL;
+
+static uint32_t g_random_state = 1;
+
+static uint64_t randomValue()
+{
+    uint64_t value = 0;
+    for (uint8_t k = 0; k < 4; k++)
+    {
+        g_random_state = g_random_state * 1103515245U + 12345U;
+        value = (value << 16U) | ((g_random_state >> 8U) & 0xFFFFU);
+    }
+    return value;
+}
+
+static bool shouldAcceptTransfer(const CanardInstance*, uint64_t*, uint16_t, CanardTransferType, uint8_t)
+{
+    return false;
+}
+
+static void onTransferReception(CanardInstance*, CanardRxTransfer*) { }
+
+struct Node
+{
+    uint8_t arena[CANARD_MEM_BLOCK_SIZE * 64U];
+    CanardInstance ins;
+
+    explicit Node(uint8_t node_id, size_t arena_size = sizeof(arena))
+    {
+        canardInit(&ins, arena, arena_size, &onTransferReception, &shouldAcceptTransfer, nullptr);
+        if (node_id != 0)
+        {
+            canardSetLocalNodeID(&ins, node_id);
+        }
+    }
+
+    std::vector<CanardCANFrame> drain()
+    {
+        std::vector<CanardCANFrame> frames;
+        for (const CanardCANFrame* frame = canardPeekTxQueue(&ins); frame != nullptr; frame = canardPeekTxQueue(&ins))
+        {
+            frames.push_back(*frame);
+            canardPopTxQueue(&ins);
+        }
+        return frames;
+    }
+
+    uint16_t usedBlocks()
+    {
+        return canardGetPoolAllocatorStatistics(&ins).current_usage_blocks;
+    }
+};
+
+static void requireSameFrames(const std::vector<CanardCANFrame>& a, const std::vector<CanardCANFrame>& b)
+{
+    REQUIRE(a.size() == b.size());
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        INFO(i);
+        REQUIRE(a[i].id == b[i].id);
+        REQUIRE(a[i].data_len == b[i].data_len);
+        REQUIRE(std::memcmp(a[i].data, b[i].data, a[i].data_len) == 0);
+    }
+}
+
+/// Random fields of random bit lengths, written both into a buffer and into the writer
+struct Field
+{
+    uint8_t bit_length;
+    uint64_t value;
+};
+
+static std::vector<Field> makeFields(uint32_t total_bits)
+{
+    std::vector<Field> fields;
+    while (total_bits > 0)
+    {
+        Field field;
+        field.bit_length = uint8_t(std::min<uint64_t>(total_bits, 1U + randomValue() % 64U));
+        field.value = randomValue();
+        if (field.bit_length == 1)
+        {
+            field.value &= 1U;      // Read as bool
+        }
+        fields.push_back(field);
+        total_bits -= field.bit_length;
+    }
+    return fields;
+}
+
+static std::vector<uint8_t> encodeFields(const std::vector<Field>& fields)
+{
+    std::vector<uint8_t> payload(300, 0);
+    uint32_t offset = 0;
+    for (const Field& field : fields)
+    {
+        canardEncodeScalar(payload.data(), offset, field.bit_length, &field.value);     // Little-endian host
+        offset += field.bit_length;
+    }
+    payload.resize((offset + 7U) / 8U);
+    return payload;
+}
+
+static void writeFields(CanardBitWriter* writer, const std::vector<Field>& fields)
+{
+    for (const Field& field : fields)
+    {
+        canardWriteScalar(writer, field.bit_length, &field.value);
+    }
+}
+
+TEST_CASE("BitWriter, MatchesBroadcast")
+{
+    Node reference(42);
+    Node streamed(42);
+    uint8_t reference_tid = 30;
+    uint8_t streamed_tid = 30;
+
+    for (uint32_t bits = 0; bits <= 100U * 8U; bits += 1U + (bits / 64U))
+    {
+        INFO(bits);
+        const std::vector<Field> fields = makeFields(bits);
+        const std::vector<uint8_t> payload = encodeFields(fields);
+
+        const int16_t expected = canardBroadcast(&reference.ins, DataTypeSignature, DataTypeID, &reference_tid,
+                                                 CANARD_TRANSFER_PRIORITY_LOW, payload.data(),
+                                                 uint16_t(payload.size()));
+        REQUIRE(expected > 0);
+
+        CanardBitWriter writer;
+        REQUIRE(0 == canardBeginBroadcast(&streamed.ins, &writer, DataTypeSignature, DataTypeID, &streamed_tid,
+                                          CANARD_TRANSFER_PRIORITY_LOW));
+        writeFields(&writer, fields);
+        REQUIRE(expected == canardFinishTransfer(&writer));
+
+        REQUIRE(streamed_tid == reference_tid);
+        requireSameFrames(streamed.drain(), reference.drain());
+        REQUIRE(streamed.usedBlocks() == 0);
+    }
+}
+
+TEST_CASE("BitWriter, RequestOrRespond")
+{
+    Node reference(42);
+    Node streamed(42);
+
+    static const uint16_t Lengths[] = { 0, 7, 8, 40 };
+    for (uint16_t len : Lengths)
+    {
+        INFO(len);
+        const std::vector<Field> fields = makeFields(len * 8U);
+        const std::vector<uint8_t> payload = encodeFields(fields);
+
+        for (CanardRequestResponse kind : { CanardRequest, CanardResponse })
+        {
+            uint8_t reference_tid = 5;
+            uint8_t streamed_tid = 5;
+            REQUIRE(0 < canardRequestOrRespond(&reference.ins, 17, DataTypeSignature, 200, &reference_tid,
+                                               CANARD_TRANSFER_PRIORITY_HIGH, kind, payload.data(), len));
+
+            CanardBitWriter writer;
+            REQUIRE(0 == canardBeginRequestOrRespond(&streamed.ins, &writer, 17, DataTypeSignature, 200,
+                                                     &streamed_tid, CANARD_TRANSFER_PRIORITY_HIGH, kind));
+            writeFields(&writer, fields);
+            REQUIRE(0 < canardFinishTransfer(&writer));
+
+            REQUIRE(streamed_tid == ((kind == CanardRequest) ? 6 : 5));
+            REQUIRE(streamed_tid == reference_tid);
+            requireSameFrames(streamed.drain(), reference.drain());
+        }
+    }
+
+    CanardBitWriter writer;
+    uint8_t tid = 0;
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            canardBeginRequestOrRespond(&streamed.ins, &writer, 17, DataTypeSignature, 200, &tid, 32, CanardRequest));
+}
+
+TEST_CASE("BitWriter, Anonymous")
+{
+    Node reference(0);
+    Node streamed(0);
+    uint8_t reference_tid = 0;
+    uint8_t streamed_tid = 0;
+
+    for (uint16_t len = 0; len <= 7; len++)
+    {
+        INFO(len);
+        const std::vector<Field> fields = makeFields(len * 8U);
+        const std::vector<uint8_t> payload = encodeFields(fields);
+        REQUIRE(1 == canardBroadcast(&reference.ins, DataTypeSignature, 3, &reference_tid,
+                                     CANARD_TRANSFER_PRIORITY_LOW, payload.data(), len));
+
+        CanardBitWriter writer;
+        REQUIRE(0 == canardBeginBroadcast(&streamed.ins, &writer, DataTypeSignature, 3, &streamed_tid,
+                                          CANARD_TRANSFER_PRIORITY_LOW));
+        writeFields(&writer, fields);
+        REQUIRE(1 == canardFinishTransfer(&writer));
+        requireSameFrames(streamed.drain(), reference.drain());
+    }
+
+    // Anonymous transfers are single frame; the data type ID must fit into the anonymous message format
+    CanardBitWriter writer;
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            canardBeginBroadcast(&streamed.ins, &writer, DataTypeSignature, 4, &streamed_tid,
+                                 CANARD_TRANSFER_PRIORITY_LOW));
+    REQUIRE(0 == canardBeginBroadcast(&streamed.ins, &writer, DataTypeSignature, 3, &streamed_tid,
+                                      CANARD_TRANSFER_PRIORITY_LOW));
+    const uint64_t value = 0x0102030405060708ULL;
+    canardWriteScalar(&writer, 64, &value);
+    REQUIRE(-CANARD_ERROR_NODE_ID_NOT_SET == canardFinishTransfer(&writer));
+    REQUIRE(canardPeekTxQueue(&streamed.ins) == nullptr);
+    REQUIRE(streamed.usedBlocks() == 0);
+}
+
+TEST_CASE("BitWriter, ArraysAndPadding")
+{
+    Node reference(42);
+    Node streamed(42);
+    uint8_t reference_tid = 0;
+    uint8_t streamed_tid = 0;
+
+    static const uint8_t BitLengths[] = { 1, 3, 8, 12, 16, 31, 32, 64 };
+    for (uint8_t bit_length : BitLengths)
+    {
+        for (uint8_t lead_bits = 0; lead_bits < 8; lead_bits++)
+        {
+            INFO(unsigned(bit_length) << " " << unsigned(lead_bits));
+            const uint16_t count = 13;
+            std::vector<uint64_t> values(count);
+            std::vector<uint8_t> bytes(count * 8U, 0);
+            for (uint16_t i = 0; i < count; i++)
+            {
+                values[i] = (bit_length < 64) ? (randomValue() & ((uint64_t(1) << bit_length) - 1U)) : randomValue();
+            }
+            // Packed the way canardEncodeArray() expects, see canardEncodeScalar()
+            const size_t size = (bit_length <= 8) ? 1 : (bit_length <= 16) ? 2 : (bit_length <= 32) ? 4 : 8;
+            for (uint16_t i = 0; i < count; i++)
+            {
+                std::memcpy(&bytes[i * size], &values[i], size);
+            }
+
+            std::vector<uint8_t> payload(200, 0);
+            canardEncodeArray(payload.data(), lead_bits, bit_length, count, bytes.data());
+            payload.resize((lead_bits + uint32_t(count) * bit_length + 7U) / 8U);
+            REQUIRE(0 < canardBroadcast(&reference.ins, DataTypeSignature, DataTypeID, &reference_tid,
+                                        CANARD_TRANSFER_PRIORITY_LOW, payload.data(), uint16_t(payload.size())));
+
+            CanardBitWriter writer;
+            REQUIRE(0 == canardBeginBroadcast(&streamed.ins, &writer, DataTypeSignature, DataTypeID, &streamed_tid,
+                                              CANARD_TRANSFER_PRIORITY_LOW));
+            canardWritePadding(&writer, lead_bits);
+            canardWriteArray(&writer, bit_length, count, bytes.data());
+            REQUIRE(0 < canardFinishTransfer(&writer));
+            requireSameFrames(streamed.drain(), reference.drain());
+        }
+    }
+
+    // Padding longer than one scalar
+    std::vector<uint8_t> zeros(20, 0);
+    REQUIRE(0 < canardBroadcast(&reference.ins, DataTypeSignature, DataTypeID, &reference_tid,
+                                CANARD_TRANSFER_PRIORITY_LOW, zeros.data(), uint16_t(zeros.size())));
+    CanardBitWriter writer;
+    REQUIRE(0 == canardBeginBroadcast(&streamed.ins, &writer, DataTypeSignature, DataTypeID, &streamed_tid,
+                                      CANARD_TRANSFER_PRIORITY_LOW));
+    canardWritePadding(&writer, 20 * 8);
+    REQUIRE(0 < canardFinishTransfer(&writer));
+    requireSameFrames(streamed.drain(), reference.drain());
+}
+
+#if CANARD_ENABLE_FLOAT16
+TEST_CASE("BitWriter, Float16Array")
+{
+    Node reference(42);
+    Node streamed(42);
+    uint8_t reference_tid = 0;
+    uint8_t streamed_tid = 0;
+
+    const float values[] = { 0.0F, 1.0F, -2.5F, 65504.0F, 1e-5F, 3.14159F, -0.0F, 100.0F, 7.0F };
+    const uint16_t count = uint16_t(sizeof(values) / sizeof(values[0]));
+    for (uint8_t lead_bits = 0; lead_bits < 8; lead_bits++)
+    {
+        std::vector<uint8_t> payload(40, 0);
+        canardEncodeFloat16Array(payload.data(), lead_bits, count, values);
+        payload.resize((lead_bits + count * 16U + 7U) / 8U);
+        REQUIRE(0 < canardBroadcast(&reference.ins, DataTypeSignature, DataTypeID, &reference_tid,
+                                    CANARD_TRANSFER_PRIORITY_LOW, payload.data(), uint16_t(payload.size())));
+
+        CanardBitWriter writer;
+        REQUIRE(0 == canardBeginBroadcast(&streamed.ins, &writer, DataTypeSignature, DataTypeID, &streamed_tid,
+                                          CANARD_TRANSFER_PRIORITY_LOW));
+        canardWritePadding(&writer, lead_bits);
+        canardWriteFloat16Array(&writer, count, values);
+        REQUIRE(0 < canardFinishTransfer(&writer));
+        requireSameFrames(streamed.drain(), reference.drain());
+    }
+}
+#endif
+
+TEST_CASE("BitWriter, OutOfMemory")
+{
+    Node node(42, CANARD_MEM_BLOCK_SIZE * 4U);
+    const uint16_t capacity = canardGetPoolAllocatorStatistics(&node.ins).capacity_blocks;
+    uint8_t tid = 0;
+
+    // More frames than there are blocks: nothing is enqueued, the blocks are returned, the transfer ID is consumed
+    CanardBitWriter writer;
+    REQUIRE(0 == canardBeginBroadcast(&node.ins, &writer, DataTypeSignature, DataTypeID, &tid,
+                                      CANARD_TRANSFER_PRIORITY_LOW));
+    canardWritePadding(&writer, uint16_t((capacity * 7U + 3U) * 8U));
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == canardFinishTransfer(&writer));
+    REQUIRE(tid == 1);
+    REQUIRE(canardPeekTxQueue(&node.ins) == nullptr);
+    REQUIRE(node.usedBlocks() == 0);
+
+    // An aborted transfer returns its blocks and leaves the transfer ID alone
+    REQUIRE(0 == canardBeginBroadcast(&node.ins, &writer, DataTypeSignature, DataTypeID, &tid,
+                                      CANARD_TRANSFER_PRIORITY_LOW));
+    canardWritePadding(&writer, 100);
+    REQUIRE(node.usedBlocks() > 0);
+    canardAbortTransfer(&writer);
+    REQUIRE(tid == 1);
+    REQUIRE(node.usedBlocks() == 0);
+
+    // The largest transfer that fits
+    REQUIRE(0 == canardBeginBroadcast(&node.ins, &writer, DataTypeSignature, DataTypeID, &tid,
+                                      CANARD_TRANSFER_PRIORITY_LOW));
+    canardWritePadding(&writer, uint16_t((capacity * 7U - 2U) * 8U));
+    REQUIRE(int16_t(capacity) == canardFinishTransfer(&writer));
+    REQUIRE(node.drain().size() == capacity);
+}
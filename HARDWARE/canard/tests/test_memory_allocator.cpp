@@ -53,7 +53,7 @@ TEST_CASE("MemoryAllocatorTestGroup, CanAllocateBlock")
     CanardPoolAllocatorBlock buffer[AVAILABLE_BLOCKS];
     initPoolAllocator(&allocator, buffer, AVAILABLE_BLOCKS);
 
-    void* block = allocateBlock(&allocator);
+    void* block = allocateBlock(&allocator, CanardPoolOwnerTxFrame);
 
     // Check that the first free memory block was used and that the next block is ready.
     REQUIRE(&buffer[0] == block);
@@ -74,11 +74,11 @@ TEST_CASE("MemoryAllocatorTestGroup, ReturnsNullIfThereIsNoBlockLeft")
     // First exhaust all availables block
     for (int i = 0; i < AVAILABLE_BLOCKS; ++i)
     {
-        allocateBlock(&allocator);
+        allocateBlock(&allocator, CanardPoolOwnerTxFrame);
     }
 
     // Try to allocate one extra block
-    void* block = allocateBlock(&allocator);
+    void* block = allocateBlock(&allocator, CanardPoolOwnerTxFrame);
     REQUIRE(NULL == block);
 
     // Check statistics
@@ -93,9 +93,9 @@ TEST_CASE("MemoryAllocatorTestGroup, CanFreeBlock")
     CanardPoolAllocatorBlock buffer[AVAILABLE_BLOCKS];
     initPoolAllocator(&allocator, buffer, AVAILABLE_BLOCKS);
 
-    void* block = allocateBlock(&allocator);
+    void* block = allocateBlock(&allocator, CanardPoolOwnerTxFrame);
 
-    freeBlock(&allocator, block);
+    freeBlock(&allocator, CanardPoolOwnerTxFrame, block);
 
     // Check that the block was added back to the beginning
     REQUIRE(&buffer[0] == allocator.free_list);
@@ -106,3 +106,147 @@ TEST_CASE("MemoryAllocatorTestGroup, CanFreeBlock")
     REQUIRE(0 ==                allocator.statistics.current_usage_blocks);
     REQUIRE(1 ==                allocator.statistics.peak_usage_blocks);
 }
+
+TEST_CASE("MemoryAllocatorTestGroup, AttributesUsageToOwners")
+{
+    CanardPoolAllocator allocator;
+    CanardPoolAllocatorBlock buffer[AVAILABLE_BLOCKS];
+    initPoolAllocator(&allocator, buffer, AVAILABLE_BLOCKS);
+
+    void* tx = allocateBlock(&allocator, CanardPoolOwnerTxFrame);
+    void* state = allocateBlock(&allocator, CanardPoolOwnerRxState);
+    void* rx = allocateBlock(&allocator, CanardPoolOwnerRxBuffer);
+
+    // The pool is exhausted; the failure is charged to the owner that asked
+    REQUIRE(NULL == allocateBlock(&allocator, CanardPoolOwnerRxBuffer));
+    REQUIRE(NULL == allocateBlock(&allocator, CanardPoolOwnerRxBuffer));
+
+    freeBlock(&allocator, CanardPoolOwnerTxFrame, tx);
+    freeBlock(&allocator, CanardPoolOwnerRxBuffer, rx);
+
+    // Check statistics
+    const CanardPoolOwnerStatistics& tx_stats = allocator.owner_statistics[CanardPoolOwnerTxFrame];
+    const CanardPoolOwnerStatistics& state_stats = allocator.owner_statistics[CanardPoolOwnerRxState];
+    const CanardPoolOwnerStatistics& rx_stats = allocator.owner_statistics[CanardPoolOwnerRxBuffer];
+
+    REQUIRE(0 == tx_stats.current_usage_blocks);
+    REQUIRE(1 == tx_stats.peak_usage_blocks);
+    REQUIRE(0 == tx_stats.allocation_failures);
+
+    REQUIRE(1 == state_stats.current_usage_blocks);
+    REQUIRE(1 == state_stats.peak_usage_blocks);
+    REQUIRE(0 == state_stats.allocation_failures);
+
+    REQUIRE(0 == rx_stats.current_usage_blocks);
+    REQUIRE(1 == rx_stats.peak_usage_blocks);
+    REQUIRE(2 == rx_stats.allocation_failures);
+
+    REQUIRE(1 == allocator.statistics.current_usage_blocks);
+
+    freeBlock(&allocator, CanardPoolOwnerRxState, state);
+}
+
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t,
+                                 CanardTransferType,
+                                 uint8_t)
+{
+    *out_data_type_signature = 0x0123456789ABCDEFULL;
+    return true;
+}
+
+static void onTransferReception(CanardInstance*, CanardRxTransfer*) { }
+
+TEST_CASE("MemoryAllocatorTestGroup, OwnerStatisticsOfInstance")
+{
+    uint8_t tx_arena[CANARD_MEM_BLOCK_SIZE * 10U];
+    uint8_t rx_arena[CANARD_MEM_BLOCK_SIZE * 16U];
+    CanardInstance tx_ins;
+    CanardInstance rx_ins;
+    canardInit(&tx_ins, tx_arena, sizeof(tx_arena), &onTransferReception, &shouldAcceptTransfer, NULL);
+    canardInit(&rx_ins, rx_arena, sizeof(rx_arena), &onTransferReception, &shouldAcceptTransfer, NULL);
+    canardSetLocalNodeID(&tx_ins, 42);
+    canardSetLocalNodeID(&rx_ins, 43);
+
+    // 10 frames of TX backlog fill the pool
+    uint8_t payload[68] = {};
+    uint8_t transfer_id = 0;
+    REQUIRE(10 == canardBroadcast(&tx_ins, 0x0123456789ABCDEFULL, 20100, &transfer_id,
+                                  CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload)));
+
+    CanardPoolOwnerStatistics stats = canardGetPoolOwnerStatistics(&tx_ins, CanardPoolOwnerTxFrame);
+    REQUIRE(10 == stats.current_usage_blocks);
+    REQUIRE(10 == stats.peak_usage_blocks);
+    REQUIRE(0 == stats.allocation_failures);
+
+    // The next transfer does not fit; the failure is charged to the TX frames
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == canardBroadcast(&tx_ins, 0x0123456789ABCDEFULL, 20100, &transfer_id,
+                                                           CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload)));
+    stats = canardGetPoolOwnerStatistics(&tx_ins, CanardPoolOwnerTxFrame);
+    REQUIRE(1 == stats.allocation_failures);
+    REQUIRE(0 == canardGetPoolOwnerStatistics(&tx_ins, CanardPoolOwnerRxState).allocation_failures);
+
+    // Everything but the last frame is delivered, so the transfer stays in reassembly on the receiving side
+    uint64_t timestamp_usec = 1000;
+    for (unsigned i = 0; i < 9; i++)
+    {
+        const CanardCANFrame* const frame = canardPeekTxQueue(&tx_ins);
+        REQUIRE(frame != NULL);
+        canardHandleRxFrame(&rx_ins, frame, timestamp_usec);
+        canardPopTxQueue(&tx_ins);
+    }
+
+    const CanardPoolOwnerStatistics rx_state = canardGetPoolOwnerStatistics(&rx_ins, CanardPoolOwnerRxState);
+    const CanardPoolOwnerStatistics rx_buffer = canardGetPoolOwnerStatistics(&rx_ins, CanardPoolOwnerRxBuffer);
+    REQUIRE(1 == rx_state.current_usage_blocks);
+    REQUIRE(rx_buffer.current_usage_blocks > 0);
+    REQUIRE(0 == canardGetPoolOwnerStatistics(&rx_ins, CanardPoolOwnerTxFrame).peak_usage_blocks);
+    REQUIRE(canardGetPoolAllocatorStatistics(&rx_ins).current_usage_blocks ==
+            rx_state.current_usage_blocks + rx_buffer.current_usage_blocks);
+
+    // The stale transfer is purged, the peaks are kept
+    canardCleanupStaleTransfers(&rx_ins, timestamp_usec + 10000000U);
+    REQUIRE(0 == canardGetPoolOwnerStatistics(&rx_ins, CanardPoolOwnerRxState).current_usage_blocks);
+    REQUIRE(0 == canardGetPoolOwnerStatistics(&rx_ins, CanardPoolOwnerRxBuffer).current_usage_blocks);
+    REQUIRE(rx_buffer.current_usage_blocks ==
+            canardGetPoolOwnerStatistics(&rx_ins, CanardPoolOwnerRxBuffer).peak_usage_blocks);
+
+    canardPopTxQueue(&tx_ins);
+    REQUIRE(0 == canardGetPoolOwnerStatistics(&tx_ins, CanardPoolOwnerTxFrame).current_usage_blocks);
+}
+
+TEST_CASE("MemoryAllocatorTestGroup, TransferIsEnqueuedWholeOrNotAtAll")
+{
+    REQUIRE(1 == CANARD_TX_FRAMES(0));
+    REQUIRE(1 == CANARD_TX_FRAMES(7));
+    REQUIRE(2 == CANARD_TX_FRAMES(8));
+    REQUIRE(2 == CANARD_TX_FRAMES(12));
+    REQUIRE(3 == CANARD_TX_FRAMES(13));
+    REQUIRE(5 == CANARD_TX_FRAMES(33));
+
+    uint8_t arena[CANARD_MEM_BLOCK_SIZE * 5U];
+    CanardInstance ins;
+    canardInit(&ins, arena, sizeof(arena), &onTransferReception, &shouldAcceptTransfer, NULL);
+    canardSetLocalNodeID(&ins, 42);
+    const uint16_t capacity = canardGetPoolAllocatorStatistics(&ins).capacity_blocks;
+
+    // One frame more than there are blocks: nothing is enqueued
+    uint8_t payload[CANARD_CAN_FRAME_MAX_DATA_LEN * 8U] = {};
+    const uint16_t too_long = uint16_t(capacity * 7U - 1U);
+    REQUIRE(too_long <= sizeof(payload));
+    REQUIRE(CANARD_TX_FRAMES(too_long) == capacity + 1U);
+    uint8_t transfer_id = 0;
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == canardBroadcast(&ins, 0x0123456789ABCDEFULL, 20100, &transfer_id,
+                                                           CANARD_TRANSFER_PRIORITY_LOW, payload, too_long));
+    REQUIRE(canardPeekTxQueue(&ins) == NULL);
+    REQUIRE(0 == canardGetPoolAllocatorStatistics(&ins).current_usage_blocks);
+    REQUIRE(1 == canardGetPoolOwnerStatistics(&ins, CanardPoolOwnerTxFrame).allocation_failures);
+
+    // The longest payload that fits takes all blocks
+    const uint16_t fits = uint16_t(capacity * 7U - 2U);
+    REQUIRE(int16_t(capacity) == canardBroadcast(&ins, 0x0123456789ABCDEFULL, 20100, &transfer_id,
+                                                 CANARD_TRANSFER_PRIORITY_LOW, payload, fits));
+    REQUIRE(capacity == canardGetPoolAllocatorStatistics(&ins).current_usage_blocks);
+}
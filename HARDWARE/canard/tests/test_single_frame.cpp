@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+#include <catch.hpp>
+#include "canard.h"
+
+
+static const uint16_t DataTypeID = 341;
+static const uint64_t DataTypeSignature = 0x0F0868D0C1A7C6F1ULL;
+
+static unsigned g_received = 0;
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType,
+                                 uint8_t)
+{
+    *out_data_type_signature = DataTypeSignature;
+    return data_type_id == DataTypeID;
+}
+
+static void onTransferReception(CanardInstance*, CanardRxTransfer*)
+{
+    g_received++;
+}
+
+TEST_CASE("SingleFrame, Broadcast")
+{
+    uint8_t memory_arena[CANARD_MEM_BLOCK_SIZE * 8U];
+    CanardInstance ins;
+    canardInit(&ins, memory_arena, sizeof(memory_arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+
+    const uint8_t payload[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t transfer_id = 0;
+
+    // Anonymous nodes are not supported
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            singleCanardBroadcast(&ins, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW, payload, 7));
+
+    canardSetLocalNodeID(&ins, 42);
+
+    // Does not fit into one frame; the transfer ID is left untouched
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            singleCanardBroadcast(&ins, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW, payload, 8));
+    REQUIRE(transfer_id == 0);
+    REQUIRE(canardPeekTxQueue(&ins) == nullptr);
+
+    REQUIRE(1 == singleCanardBroadcast(&ins, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW, payload, 7));
+    REQUIRE(transfer_id == 1);
+
+    const CanardCANFrame* const frame = canardPeekTxQueue(&ins);
+    REQUIRE(frame != nullptr);
+    REQUIRE(frame->id == (CANARD_CAN_FRAME_EFF | (uint32_t(CANARD_TRANSFER_PRIORITY_LOW) << 24U) |
+                          (uint32_t(DataTypeID) << 8U) | 42U));
+    REQUIRE(frame->data_len == 8);
+    REQUIRE(frame->data[7] == 0xC0);        // Start and end of transfer, transfer ID 0
+    canardPopTxQueue(&ins);
+}
+
+TEST_CASE("SingleFrame, HandleRxFrame")
+{
+    uint8_t memory_arena[CANARD_MEM_BLOCK_SIZE * 8U];
+    CanardInstance ins;
+    canardInit(&ins, memory_arena, sizeof(memory_arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 42);
+
+    CanardCANFrame frame = CanardCANFrame();
+    frame.id = CANARD_CAN_FRAME_EFF | (uint32_t(DataTypeID) << 8U) | 10U;
+
+    // First frame of a multi-frame transfer is ignored, no RX state is allocated for it
+    frame.data_len = 8;
+    frame.data[7] = 0x80;
+    g_received = 0;
+    singleCanardHandleRxFrame(&ins, &frame, 1000);
+    REQUIRE(g_received == 0);
+    REQUIRE(canardGetPoolAllocatorStatistics(&ins).current_usage_blocks == 0);
+
+    // Single-frame transfer
+    frame.data_len = 3;
+    frame.data[2] = 0xC1;
+    singleCanardHandleRxFrame(&ins, &frame, 2000);
+    REQUIRE(g_received == 1);
+
+    // Frames without the tail byte are ignored
+    frame.data_len = 0;
+    singleCanardHandleRxFrame(&ins, &frame, 3000);
+    REQUIRE(g_received == 1);
+}
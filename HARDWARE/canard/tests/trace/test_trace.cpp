@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * Tests of the binary event trace (CANARD_ENABLE_TRACE), built with a small ring and the frame data.
+ */
+
+#include <catch.hpp>
+#include <cstring>
+#include <vector>
+#include "canard.h"
+
+#if !CANARD_ENABLE_TRACE || !CANARD_TRACE_FRAME_DATA || (CANARD_TRACE_CAPACITY != 16U)
+# error "This test must be built with CANARD_ENABLE_TRACE=1, CANARD_TRACE_FRAME_DATA=1, CANARD_TRACE_CAPACITY=16U"
+#endif
+
+static const uint16_t MessageDataTypeID = 20000;
+static const uint64_t MessageSignature = 0x1122334455667788ULL;
+
+static uint32_t g_timestamp = 0;
+
+extern "C" uint32_t canardTraceGetTimestamp(void)
+{
+    return g_timestamp;
+}
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t)
+{
+    *out_data_type_signature = MessageSignature;
+    return (transfer_type == CanardTransferTypeBroadcast) && (data_type_id == MessageDataTypeID);
+}
+
+static void onTransferReception(CanardInstance*, CanardRxTransfer*) { }
+
+static std::vector<CanardTraceEntry> readAll()
+{
+    std::vector<CanardTraceEntry> entries(CANARD_TRACE_CAPACITY);
+    entries.resize(canardTraceRead(entries.data(), uint16_t(entries.size()), nullptr));
+    return entries;
+}
+
+/// Enqueues the transfer on the sender and returns its frames, emptying the TX queue.
+static std::vector<CanardCANFrame> broadcast(CanardInstance& ins, uint8_t& transfer_id, uint16_t payload_len)
+{
+    uint8_t payload[64];
+    for (uint16_t i = 0; i < payload_len; i++)
+    {
+        payload[i] = uint8_t(i + 1U);
+    }
+    REQUIRE(canardBroadcast(&ins, MessageSignature, MessageDataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_MEDIUM,
+                            payload, payload_len) > 0);
+    std::vector<CanardCANFrame> frames;
+    for (const CanardCANFrame* f = canardPeekTxQueue(&ins); f != nullptr; f = canardPeekTxQueue(&ins))
+    {
+        frames.push_back(*f);
+        canardPopTxQueue(&ins);
+    }
+    return frames;
+}
+
+struct TraceFixture
+{
+    uint8_t tx_arena[1024];
+    uint8_t rx_arena[1024];
+    CanardInstance tx;
+    CanardInstance rx;
+    uint8_t transfer_id = 0;
+
+    TraceFixture()
+    {
+        canardInit(&tx, tx_arena, sizeof(tx_arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+        canardInit(&rx, rx_arena, sizeof(rx_arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+        canardSetLocalNodeID(&tx, 42);
+        canardSetLocalNodeID(&rx, 43);
+        canardTraceReset();
+        g_timestamp = 1000;
+    }
+};
+
+
+TEST_CASE("Trace, TransferLifecycle")
+{
+    TraceFixture f;
+    const std::vector<CanardCANFrame> frames = broadcast(f.tx, f.transfer_id, 5);
+    REQUIRE(frames.size() == 1);
+
+    g_timestamp = 2000;
+    canardTraceRecord(CanardTraceEventTxMailbox, 2, &frames[0]);
+    g_timestamp = 3000;
+    canardHandleRxFrame(&f.rx, &frames[0], 1);
+
+    const std::vector<CanardTraceEntry> entries = readAll();
+    REQUIRE(entries.size() == 4);
+    REQUIRE(entries[0].event == CanardTraceEventTxEnqueue);
+    REQUIRE(entries[0].timestamp == 1000);
+    REQUIRE(entries[1].event == CanardTraceEventTxMailbox);
+    REQUIRE(entries[1].detail == 2);
+    REQUIRE(entries[2].event == CanardTraceEventRxFrame);
+    REQUIRE(entries[3].event == CanardTraceEventRxTransfer);
+    REQUIRE(entries[3].timestamp == 3000);
+    for (const CanardTraceEntry& e : entries)
+    {
+        REQUIRE(e.can_id == frames[0].id);
+        REQUIRE(e.data_len == 6);
+        REQUIRE(e.tail_byte == 0xC0);
+        REQUIRE(0 == std::memcmp(e.data, frames[0].data, 6));
+    }
+    REQUIRE(readAll().empty());
+}
+
+static std::vector<uint8_t> getDropReasons(const std::vector<CanardTraceEntry>& entries)
+{
+    std::vector<uint8_t> reasons;
+    for (const CanardTraceEntry& e : entries)
+    {
+        if (e.event == CanardTraceEventDrop)
+        {
+            reasons.push_back(e.detail);
+        }
+    }
+    return reasons;
+}
+
+TEST_CASE("Trace, DropReasons")
+{
+    TraceFixture f;
+    std::vector<CanardCANFrame> frames = broadcast(f.tx, f.transfer_id, 16);
+    REQUIRE(frames.size() == 3);
+    canardTraceReset();
+
+    CanardCANFrame standard = frames[0];
+    standard.id = 0x123;
+    canardHandleRxFrame(&f.rx, &standard, 1);
+
+    CanardCANFrame other = frames[0];
+    other.id ^= uint32_t(1U << 8U);                         // Another data type
+    canardHandleRxFrame(&f.rx, &other, 1);
+
+    std::vector<CanardTraceEntry> entries = readAll();
+    REQUIRE(entries.size() == 4);
+    REQUIRE(entries[0].event == CanardTraceEventRxFrame);
+    REQUIRE(entries[2].event == CanardTraceEventRxFrame);
+    REQUIRE(getDropReasons(entries) ==
+            (std::vector<uint8_t>{ CanardTraceDropNotUavcan, CanardTraceDropNotAccepted }));
+
+    frames[1].data[0] ^= 0xFFU;
+    for (const CanardCANFrame& frame : frames)
+    {
+        canardHandleRxFrame(&f.rx, &frame, 2);
+    }
+    entries = readAll();
+    REQUIRE(entries.size() == 4);
+    REQUIRE(entries[3].can_id == frames[2].id);
+    REQUIRE(getDropReasons(entries) == std::vector<uint8_t>{ CanardTraceDropBadCrc });
+}
+
+TEST_CASE("Trace, ToggleAndState")
+{
+    TraceFixture f;
+    const std::vector<CanardCANFrame> frames = broadcast(f.tx, f.transfer_id, 20);
+    canardTraceReset();
+
+    canardHandleRxFrame(&f.rx, &frames[1], 1);
+    canardHandleRxFrame(&f.rx, &frames[0], 1);
+    canardHandleRxFrame(&f.rx, &frames[2], 1);
+
+    const std::vector<CanardTraceEntry> entries = readAll();
+    REQUIRE(entries.size() == 5);
+    REQUIRE(entries[1].event == CanardTraceEventDrop);
+    REQUIRE(entries[1].detail == CanardTraceDropNoState);
+    REQUIRE(entries[2].event == CanardTraceEventRxFrame);
+    REQUIRE(entries[4].event == CanardTraceEventDrop);
+    REQUIRE(entries[4].detail == CanardTraceDropWrongToggle);
+}
+
+TEST_CASE("Trace, TxOutOfMemory")
+{
+    uint8_t arena[CANARD_MEM_BLOCK_SIZE * 2U];
+    CanardInstance ins;
+    canardInit(&ins, arena, sizeof(arena), &onTransferReception, &shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 42);
+    canardTraceReset();
+
+    uint8_t transfer_id = 7;
+    uint8_t payload[40] = {};
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == canardBroadcast(&ins, MessageSignature, MessageDataTypeID, &transfer_id,
+                                                           CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload)));
+    const std::vector<CanardTraceEntry> entries = readAll();
+    REQUIRE(entries.size() == 1);
+    REQUIRE(entries[0].event == CanardTraceEventDrop);
+    REQUIRE(entries[0].detail == CanardTraceDropTxOutOfMemory);
+    REQUIRE(((entries[0].can_id >> 8U) & 0xFFFFU) == MessageDataTypeID);
+    REQUIRE((entries[0].tail_byte & 0x1FU) == 7);
+
+    // The bit writer path records the ID of the dropped transfer as well, not the incremented one
+    canardTraceReset();
+    CanardBitWriter writer;
+    REQUIRE(canardBeginBroadcast(&ins, &writer, MessageSignature, MessageDataTypeID, &transfer_id,
+                                 CANARD_TRANSFER_PRIORITY_LOW) == 0);
+    for (uint8_t i = 0; i < sizeof(payload); i++)
+    {
+        canardWriteScalar(&writer, 8, &payload[i]);
+    }
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == canardFinishTransfer(&writer));
+    REQUIRE(transfer_id == 9);
+    const std::vector<CanardTraceEntry> writer_entries = readAll();
+    REQUIRE(writer_entries.size() == 1);
+    REQUIRE(writer_entries[0].detail == CanardTraceDropTxOutOfMemory);
+    REQUIRE((writer_entries[0].tail_byte & 0x1FU) == 8);
+}
+
+TEST_CASE("Trace, Overwrite")
+{
+    canardTraceReset();
+    CanardCANFrame frame;
+    std::memset(&frame, 0, sizeof(frame));
+    frame.data_len = 1;
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        frame.id = i;
+        canardTraceRecord(CanardTraceEventRxFrame, 0, &frame);
+    }
+
+    CanardTraceEntry entries[CANARD_TRACE_CAPACITY];
+    uint32_t lost = 0;
+    REQUIRE(canardTraceRead(entries, 10, &lost) == 10);
+    REQUIRE(lost == 4);
+    REQUIRE(entries[0].can_id == 4);
+    REQUIRE(canardTraceRead(entries, 10, &lost) == 6);
+    REQUIRE(lost == 0);
+    REQUIRE(entries[5].can_id == 19);
+    REQUIRE(canardTraceRead(entries, 10, &lost) == 0);
+}
+
+static void appendBytes(void* user_reference, const uint8_t* bytes, uint16_t len)
+{
+    static_cast<std::vector<uint8_t>*>(user_reference)->insert(
+        static_cast<std::vector<uint8_t>*>(user_reference)->end(), bytes, bytes + len);
+}
+
+static uint32_t getWord(const std::vector<uint8_t>& bytes, size_t offset)
+{
+    return uint32_t(bytes[offset]) | (uint32_t(bytes[offset + 1]) << 8U) |
+           (uint32_t(bytes[offset + 2]) << 16U) | (uint32_t(bytes[offset + 3]) << 24U);
+}
+
+TEST_CASE("Trace, Dump")
+{
+    canardTraceReset();
+    std::vector<uint8_t> dump;
+    canardTraceDump(&appendBytes, &dump);
+    REQUIRE(dump.size() == 16);                             // The header alone tells that nothing was lost
+    REQUIRE(0 == std::memcmp(dump.data(), "CTRC", 4));
+    REQUIRE(dump[4] == 1);
+    REQUIRE(dump[5] == 20);
+    REQUIRE(dump[6] == 0);
+    REQUIRE(getWord(dump, 8) == CANARD_TRACE_TIMESTAMP_HZ);
+
+    CanardCANFrame frame;
+    std::memset(&frame, 0, sizeof(frame));
+    frame.id = 0x1234567U | CANARD_CAN_FRAME_EFF;
+    frame.data_len = 3;
+    frame.data[0] = 0xAA;
+    frame.data[2] = 0xC5;
+    for (uint32_t i = 0; i < 18; i++)
+    {
+        g_timestamp = 0xFFFFFFF0U + i;
+        canardTraceRecord(CanardTraceEventDrop, CanardTraceDropRxOverrun, &frame);
+    }
+
+    dump.clear();
+    canardTraceDump(&appendBytes, &dump);
+    REQUIRE(dump.size() == 16U + 8U * 20U + 16U + 8U * 20U);    // Two full records of the 16 events left
+    REQUIRE(dump[6] == 8);
+    REQUIRE(getWord(dump, 12) == 2);                        // The two oldest events were overwritten
+
+    const size_t event = 16;
+    REQUIRE(getWord(dump, event) == 0xFFFFFFF2U);
+    REQUIRE(getWord(dump, event + 4) == frame.id);
+    REQUIRE(dump[event + 8] == CanardTraceEventDrop);
+    REQUIRE(dump[event + 9] == CanardTraceDropRxOverrun);
+    REQUIRE(dump[event + 10] == 3);
+    REQUIRE(dump[event + 11] == 0xC5);
+    REQUIRE(dump[event + 12] == 0xAA);
+
+    const size_t second = 16U + 8U * 20U;
+    REQUIRE(0 == std::memcmp(&dump[second], "CTRC", 4));
+    REQUIRE(dump[second + 6] == 8);
+    REQUIRE(getWord(dump, second + 12) == 0);
+}
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2018 UAVCAN Team
+#
+# Decodes the binary event trace of libcanard (see CANARD_ENABLE_TRACE and canardTraceDump()) into a candump log and a
+# pcapng file for Wireshark, with every event annotated. The input is either the binary dump, e.g. written to a file
+# on Linux, or a UART capture in which the dump was printed as "TRC:<hex>" lines, as uavcanTraceDump() does; other
+# lines of the capture are ignored.
+#
+# The timestamps of the trace wrap around at 32 bits; they are unwrapped assuming that no two consecutive events are
+# further apart than that (about 59 seconds with the cycle counter of a 72 MHz core).
+#
+# Usage: trace_decode.py <dump> [--candump <file.log>] [--pcap <file.pcapng>] [--interface <name>]
+# Without an output, the events are listed on stdout. A summary of the drops goes to stderr.
+#
+
+import argparse
+import binascii
+import collections
+import struct
+import sys
+
+MAGIC = b'CTRC'
+HEADER = struct.Struct('<4sBBHII')
+ENTRY = struct.Struct('<IIBBBB')
+
+CAN_FRAME_EFF = 1 << 31
+CAN_FRAME_RTR = 1 << 30
+CAN_FRAME_ERR = 1 << 29
+CAN_EXT_ID_MASK = 0x1FFFFFFF
+CAN_STD_ID_MASK = 0x7FF
+
+LINKTYPE_CAN_SOCKETCAN = 227
+
+EVENTS = ['tx-enqueue', 'tx-mailbox', 'rx-frame', 'rx-transfer', 'drop']
+DROP_REASONS = ['not-uavcan', 'address-mismatch', 'disabled-feature', 'not-accepted', 'out-of-memory', 'no-state',
+                'missed-start', 'wrong-toggle', 'unexpected-transfer-id', 'short-frame', 'bad-crc', 'too-long',
+                'tx-out-of-memory', 'rx-overrun']
+
+Event = collections.namedtuple('Event', 'time_ns event detail can_id data lost_before')
+
+
+def name_of(names, index):
+    return names[index] if index < len(names) else 'unknown-%d' % index
+
+
+def load_dump(path):
+    """Returns the binary dump in the file, extracting it from the TRC lines of a text capture if needed."""
+    with open(path, 'rb') as f:
+        raw = f.read()
+    if raw.startswith(MAGIC):
+        return raw
+    chunks = []
+    for line in raw.splitlines():
+        line = line.strip()
+        position = line.find(b'TRC:')
+        if position >= 0:
+            chunks.append(binascii.unhexlify(line[position + 4:].strip()))
+    return b''.join(chunks)
+
+
+def parse(dump):
+    """Parses the records of the dump into events with unwrapped timestamps in nanoseconds."""
+    events = []
+    offset = 0
+    last_raw = None
+    ticks = 0
+    lost_pending = 0
+    while offset < len(dump):
+        if len(dump) - offset < HEADER.size:
+            raise ValueError('truncated record header at offset %d' % offset)
+        magic, version, entry_size, count, hz, lost = HEADER.unpack_from(dump, offset)
+        if magic != MAGIC or version != 1 or entry_size < ENTRY.size or hz == 0:
+            raise ValueError('invalid record header at offset %d' % offset)
+        offset += HEADER.size
+        lost_pending += lost
+        if len(dump) - offset < count * entry_size:
+            raise ValueError('truncated record at offset %d' % offset)
+        for _ in range(count):
+            timestamp, can_id, event, detail, data_len, tail = ENTRY.unpack_from(dump, offset)
+            if entry_size >= ENTRY.size + 8:
+                data = bytes(dump[offset + ENTRY.size:offset + ENTRY.size + min(data_len, 8)])
+            else:
+                # Only the tail byte is known without CANARD_TRACE_FRAME_DATA; the rest is zero-filled
+                data = bytes(max(data_len - 1, 0)) + bytes([tail]) if data_len > 0 else b''
+            offset += entry_size
+            if last_raw is not None:
+                ticks += (timestamp - last_raw) & 0xFFFFFFFF
+            last_raw = timestamp
+            events.append(Event(ticks * 1000000000 // hz, event, detail, can_id, data, lost_pending))
+            lost_pending = 0
+    return events, lost_pending
+
+
+def annotation(e):
+    text = name_of(EVENTS, e.event)
+    if e.event == 1:
+        text += ' %d' % e.detail
+    elif e.event == 4:
+        text += ': ' + name_of(DROP_REASONS, e.detail)
+    if e.data:
+        tail = e.data[-1]
+        text += ' (tid %d%s%s%s)' % (tail & 0x1F, ' start' if tail & 0x80 else '', ' end' if tail & 0x40 else '',
+                                     ' toggle' if tail & 0x20 else '')
+    if e.lost_before:
+        text += '; %d events lost before this one' % e.lost_before
+    return text
+
+
+def format_can_id(can_id):
+    if can_id & CAN_FRAME_EFF:
+        return '%08X' % (can_id & CAN_EXT_ID_MASK)
+    return '%03X' % (can_id & CAN_STD_ID_MASK)
+
+
+def write_candump(path, events, interface, has_data):
+    """Frames that went over the bus become log lines; the other events become comment lines."""
+    with open(path, 'w') as f:
+        f.write('# libcanard trace, %s\n' % ('with frame data' if has_data else
+                                               'frame data not traced: only the tail bytes are real'))
+        for e in events:
+            seconds = '(%d.%06d)' % (e.time_ns // 1000000000, (e.time_ns % 1000000000) // 1000)
+            if e.event in (1, 2):
+                payload = 'R' if e.can_id & CAN_FRAME_RTR else binascii.hexlify(e.data).decode().upper()
+                f.write('%s %s %s#%s\n' % (seconds, interface, format_can_id(e.can_id), payload))
+            f.write('# %s %s %s\n' % (seconds, format_can_id(e.can_id), annotation(e)))
+
+
+def pcapng_block(block_type, body):
+    body += bytes(-len(body) % 4)
+    length = len(body) + 12
+    return struct.pack('<II', block_type, length) + body + struct.pack('<I', length)
+
+
+def pcapng_option(code, value):
+    return struct.pack('<HH', code, len(value)) + value + bytes(-len(value) % 4)
+
+
+def write_pcap(path, events, interface):
+    """Every event becomes a SocketCAN packet, annotated with a packet comment (frame.comment in Wireshark)."""
+    with open(path, 'wb') as f:
+        f.write(pcapng_block(0x0A0D0D0A, struct.pack('<IHHq', 0x1A2B3C4D, 1, 0, -1) +
+                             pcapng_option(4, b'libcanard trace_decode.py') + pcapng_option(0, b'')))
+        f.write(pcapng_block(0x00000001, struct.pack('<HHI', LINKTYPE_CAN_SOCKETCAN, 0, 16) +
+                             pcapng_option(2, interface.encode()) +
+                             pcapng_option(9, b'\x09') +                       # Nanosecond timestamps
+                             pcapng_option(0, b'')))
+        for e in events:
+            packet = struct.pack('>IBBBB', e.can_id, len(e.data), 0, 0, 0) + e.data
+            body = struct.pack('<IIIII', 0, e.time_ns >> 32, e.time_ns & 0xFFFFFFFF, len(packet), len(packet))
+            body += packet + bytes(-len(packet) % 4)
+            body += pcapng_option(1, annotation(e).encode()) + pcapng_option(0, b'')
+            f.write(pcapng_block(0x00000006, body))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decodes a libcanard event trace.')
+    parser.add_argument('dump', help='binary dump, or a UART capture with TRC: lines')
+    parser.add_argument('--candump', help='candump log to write')
+    parser.add_argument('--pcap', help='pcapng file to write')
+    parser.add_argument('--interface', default='can0', help='interface name in the outputs, can0 by default')
+    args = parser.parse_args()
+
+    dump = load_dump(args.dump)
+    if not dump:
+        parser.error('no trace found in %r' % args.dump)
+    has_data = HEADER.unpack_from(dump)[2] >= ENTRY.size + 8
+    events, lost_at_end = parse(dump)
+
+    if args.candump:
+        write_candump(args.candump, events, args.interface, has_data)
+    if args.pcap:
+        write_pcap(args.pcap, events, args.interface)
+    if not args.candump and not args.pcap:
+        for e in events:
+            print('%14.6f  %-10s %s' % (e.time_ns / 1e9, format_can_id(e.can_id), annotation(e)))
+
+    counts = collections.Counter(name_of(EVENTS, e.event) for e in events)
+    drops = collections.Counter(name_of(DROP_REASONS, e.detail) for e in events if e.event == 4)
+    lost = sum(e.lost_before for e in events) + lost_at_end
+    print('%d events, %d lost: %s' % (len(events), lost, ', '.join('%s %d' % kv for kv in sorted(counts.items()))),
+          file=sys.stderr)
+    for reason, count in drops.most_common():
+        print('  drop %-24s %d' % (reason, count), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
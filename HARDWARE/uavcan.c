@@ -13,6 +13,7 @@
             
 static CanardInstance g_canard;                //The library instance
 static uint8_t g_canard_memory_pool[1024];     //Arena for memory allocation, used by the library
+                                               //大小可用canard/tests/pool_advisor按录制的总线流量确定，节点描述见pool_advisor_firmware.txt
 static uint32_t  g_uptime = 0;
 uint16_t rc_pwm[6] = {0,0,0,0,0,0};
 
@@ -69,24 +70,26 @@ void onTransferReceived(CanardInstance* ins, CanardRxTransfer* transfer)
 
 void getNodeInfoHandleCanard(CanardRxTransfer* transfer)
 {
-        uint8_t buffer[UAVCAN_GET_NODE_INFO_RESPONSE_MAX_SIZE];
-        memset(buffer,0,UAVCAN_GET_NODE_INFO_RESPONSE_MAX_SIZE);
-        uint16_t len = makeNodeInfoMessage(buffer);
-        int result = canardRequestOrRespond(&g_canard,
-                                            transfer->source_node_id,
-                                            UAVCAN_GET_NODE_INFO_DATA_TYPE_SIGNATURE,
-                                            UAVCAN_GET_NODE_INFO_DATA_TYPE_ID,
-                                            &transfer->transfer_id,
-                                            transfer->priority,
-                                            CanardResponse,
-                                            &buffer[0],
-                                            (uint16_t)len);
+        CanardBitWriter writer;                 // 直接序列化到TX帧，无需有效数据缓冲区
+        if (canardBeginRequestOrRespond(&g_canard,
+                                        &writer,
+                                        transfer->source_node_id,
+                                        UAVCAN_GET_NODE_INFO_DATA_TYPE_SIGNATURE,
+                                        UAVCAN_GET_NODE_INFO_DATA_TYPE_ID,
+                                        &transfer->transfer_id,
+                                        transfer->priority,
+                                        CanardResponse) < 0)
+        {
+            return;
+        }
+        writeNodeInfoMessage(&writer);
+        int result = canardFinishTransfer(&writer);
 }
 
 void uavcanInit(void)
 {
     CanardSTM32CANTimings timings;
-    int result = canardSTM32ComputeCANTimings(HAL_RCC_GetPCLK1Freq(), 500000, &timings);
+    int result = canardSTM32ComputeCANTimings(HAL_RCC_GetPCLK1Freq(), CAN_BIT_RATE, &timings);
     if (result)
     {
         __ASM volatile("BKPT #01");
@@ -105,8 +108,69 @@ void uavcanInit(void)
                NULL);
  
     canardSetLocalNodeID(&g_canard, 10);
+
+#if CANARD_ENABLE_TRACE || CANARD_ENABLE_LATENCY_HISTOGRAMS || CANARD_ENABLE_PROFILING
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;          // 跟踪事件、延迟直方图和剖析计数器的时间戳使用DWT周期计数器
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+#if CANARD_ENABLE_TRACE
+static void writeTraceLine(void* user_reference, const uint8_t* bytes, uint16_t len)
+{
+    (void) user_reference;
+    printf("TRC:");
+    for (uint16_t i = 0; i < len; i++)
+    {
+        printf("%02x", bytes[i]);
+    }
+    printf("\r\n");
+}
+
+void uavcanTraceDump(void)// 通过串口输出跟踪缓冲区，可由USMART调用；用canard/trace_decode.py解码
+{
+    canardTraceDump(writeTraceLine, NULL);
+}
+#endif
+
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+static void printLatency(const char* name, CanardLatencyPath path)
+{
+    static const uint32_t TicksPerUsec = CANARD_LATENCY_TIMESTAMP_HZ / 1000000UL;
+    const CanardLatencyStatistics stats = canardGetLatencyStatistics((uint8_t)path);
+    printf("LAT %s: p50 %u us, p99 %u us, max %u us, %u samples\r\n", name,
+           (unsigned)(stats.p50 / TicksPerUsec), (unsigned)(stats.p99 / TicksPerUsec),
+           (unsigned)(stats.max / TicksPerUsec), (unsigned)stats.count);
 }
 
+void uavcanLatencyDump(void)// 通过串口输出接收、发送入队和发送完成的延迟百分位数，可由USMART调用
+{
+    printLatency("rx", CanardLatencyPathRx);
+    printLatency("tx-queue", CanardLatencyPathTxQueue);
+    printLatency("tx-complete", CanardLatencyPathTxComplete);
+}
+#endif
+
+#if CANARD_ENABLE_PROFILING
+static void printProf(const char* name, CanardProfSite site)
+{
+    const CanardProfStatistics stats = canardGetProfStatistics((uint8_t)site);
+    const uint32_t avg = (stats.count > 0U) ? (uint32_t)(stats.total / stats.count) : 0U;
+    printf("PRF %s: min %u, avg %u, max %u cycles, %u passes\r\n", name,
+           (unsigned)stats.min, (unsigned)avg, (unsigned)stats.max, (unsigned)stats.count);
+}
+
+void uavcanProfDump(void)// 通过串口输出各测量点的最小、平均和最大周期数（72MHz下72个周期为1us），可由USMART调用
+{
+    printProf("handle-rx-frame", CanardProfSiteHandleRxFrame);
+    printProf("tx-transfer", CanardProfSiteTxTransfer);
+    printProf("cleanup", CanardProfSiteCleanup);
+    printProf("stm32-transmit", CanardProfSiteDriverTransmit);
+    printProf("stm32-receive", CanardProfSiteDriverReceive);
+}
+#endif
+
 /*
 add        增加一个元索                     如果队列已满，则抛出一个IIIegaISlabEepeplian异常
 remove   移除并返回队列头部的元素    如果队列为空，则抛出一个NoSuchElementException异常
@@ -163,14 +227,19 @@ void receiveCanard(void)
     if(res)
     {
         singleCanardHandleRxFrame(&g_canard, &rx_frame, HAL_GetTick() * 1000);
+#if !CANARD_ENABLE_TRACE                                      // 启用跟踪时帧已记录，不再逐帧打印
         for(int i = 0; i<8; i++)printf(" %x ", rx_frame.data[i]);
         printf("%x  \r\n", rx_frame.id);
+#endif
     }    
 }
 
 void spinCanard(void)
 {  
     static uint32_t spin_time = 0;
+#if CANARD_ENABLE_BUSLOAD
+    canardUpdateBusLoad(&g_canard, HAL_GetTick() * 1000ULL);   // 推进总线负载的滑动窗口，与接收帧的时间戳同一时钟
+#endif
     if(HAL_GetTick() < spin_time + CANARD_SPIN_PERIOD) return;  // rate limiting
     spin_time = HAL_GetTick();
     HAL_GPIO_TogglePin(GPIOB, GPIO_PIN_12);   
@@ -185,7 +254,30 @@ void spinCanard(void)
                     CANARD_TRANSFER_PRIORITY_LOW,
                     buffer, 
                     UAVCAN_NODE_STATUS_MESSAGE_SIZE);                         //some indication
-    
+
+    uint8_t pool_buffer[CANARD_POOL_STATUS_MESSAGE_SIZE];
+    static uint8_t pool_transfer_id = 0;
+    makePoolStatusMessage(pool_buffer);                      // 上报内存池压力，按块的所有者区分
+    canardBroadcast(&g_canard,
+                    CANARD_POOL_STATUS_DATA_TYPE_SIGNATURE,
+                    CANARD_POOL_STATUS_DATA_TYPE_ID,
+                    &pool_transfer_id,
+                    CANARD_TRANSFER_PRIORITY_LOWEST,
+                    pool_buffer,
+                    CANARD_POOL_STATUS_MESSAGE_SIZE);
+
+#if CANARD_ENABLE_BUSLOAD
+    uint8_t load_buffer[CANARD_BUS_LOAD_MESSAGE_MAX_SIZE];
+    static uint8_t load_transfer_id = 0;
+    const uint16_t load_size = makeBusLoadMessage(load_buffer);  // 上报总线负载，按方向、优先级段和数据类型区分
+    canardBroadcast(&g_canard,
+                    CANARD_BUS_LOAD_DATA_TYPE_SIGNATURE,
+                    CANARD_BUS_LOAD_DATA_TYPE_ID,
+                    &load_transfer_id,
+                    CANARD_TRANSFER_PRIORITY_LOWEST,
+                    load_buffer,
+                    load_size);
+#endif
 }
 
 void publishCanard(void)// 发送正弦波函数例程
@@ -251,21 +343,72 @@ void makeNodeStatusMessage(uint8_t buffer[UAVCAN_NODE_STATUS_MESSAGE_SIZE])
     canardEncodeScalar(buffer, 34,  3, &node_mode);
 }
 
-uint16_t makeNodeInfoMessage(uint8_t buffer[UAVCAN_GET_NODE_INFO_RESPONSE_MAX_SIZE])
+void makePoolStatusMessage(uint8_t buffer[CANARD_POOL_STATUS_MESSAGE_SIZE])
+{
+    const CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&g_canard);
+    memset(buffer, 0, CANARD_POOL_STATUS_MESSAGE_SIZE);
+    canardEncodeScalar(buffer,  0, 16, &stats.capacity_blocks);
+    canardEncodeScalar(buffer, 16, 16, &stats.current_usage_blocks);
+    canardEncodeScalar(buffer, 32, 16, &stats.peak_usage_blocks);
+    for (uint8_t i = 0; i < CANARD_NUM_POOL_OWNERS; i++)    // TX帧、RX状态、RX缓冲块
+    {
+        const CanardPoolOwnerStatistics owner = canardGetPoolOwnerStatistics(&g_canard, (CanardPoolOwner)i);
+        canardEncodeScalar(buffer,  48 + i * 16, 16, &owner.current_usage_blocks);
+        canardEncodeScalar(buffer,  96 + i * 16, 16, &owner.peak_usage_blocks);
+        canardEncodeScalar(buffer, 144 + i * 16, 16, &owner.allocation_failures);
+    }
+}
+
+#if CANARD_ENABLE_BUSLOAD
+uint16_t makeBusLoadMessage(uint8_t buffer[CANARD_BUS_LOAD_MESSAGE_MAX_SIZE])
 {
-    memset(buffer, 0, UAVCAN_GET_NODE_INFO_RESPONSE_MAX_SIZE);
-    makeNodeStatusMessage(buffer);
-   
-    buffer[7] = APP_VERSION_MAJOR;
-    buffer[8] = APP_VERSION_MINOR;
-    buffer[9] = 1;                          // Optional field flags, VCS commit is set
+    const CanardBusLoadStatistics stats = canardGetBusLoadStatistics(&g_canard, CAN_BIT_RATE);
+    const uint32_t bit_rate = CAN_BIT_RATE;
+    const uint16_t window_ms = (uint16_t)(stats.window_usec / 1000U);
+    memset(buffer, 0, CANARD_BUS_LOAD_MESSAGE_MAX_SIZE);
+    canardEncodeScalar(buffer,   0, 32, &bit_rate);
+    canardEncodeScalar(buffer,  32, 16, &window_ms);
+    canardEncodeScalar(buffer,  48, 16, &stats.tx_load_permille);
+    canardEncodeScalar(buffer,  64, 16, &stats.rx_load_permille);
+    for (uint8_t i = 0; i < CANARD_BUSLOAD_NUM_PRIORITY_BANDS; i++)    // 优先级0-7、8-15、16-23、24-31
+    {
+        canardEncodeScalar(buffer, 80 + i * 16, 16, &stats.priority_band_load_permille[i]);
+    }
+    canardEncodeScalar(buffer, 144, 16, &stats.untracked_load_permille);
+
+    uint16_t offset = 160;                                  // 数组是最后一个字段，长度由消息大小隐含
+    for (uint8_t i = 0; (i < stats.num_data_types) && (i < CANARD_BUS_LOAD_MAX_DATA_TYPES); i++)
+    {
+        canardEncodeScalar(buffer, offset,      16, &stats.data_types[i].data_type_id);
+        canardEncodeScalar(buffer, offset + 16,  1, &stats.data_types[i].service);
+        canardEncodeScalar(buffer, offset + 17, 15, &stats.data_types[i].load_permille);
+        offset += 32;
+    }
+    return offset / 8;
+}
+#endif
+
+void writeNodeInfoMessage(CanardBitWriter* writer)
+{
+    uint8_t node_health = UAVCAN_NODE_HEALTH_OK;
+    uint8_t node_mode   = UAVCAN_NODE_MODE_OPERATIONAL;
+    uint32_t uptime_sec = (HAL_GetTick() / 1000);
+    canardWriteScalar(writer, 32, &uptime_sec);         // NodeStatus, same as makeNodeStatusMessage()
+    canardWriteScalar(writer,  2, &node_health);
+    canardWriteScalar(writer,  3, &node_mode);
+    canardWritePadding(writer, 19);                     // Sub mode, vendor specific status code
+
+    const uint8_t software_version[3] = { APP_VERSION_MAJOR, APP_VERSION_MINOR, 1 };    // VCS commit is set
+    canardWriteArray(writer, 8, 3, software_version);
     uint32_t u32 = GIT_HASH;
-    canardEncodeScalar(buffer, 80, 32, &u32); 
-    
-    readUniqueID(&buffer[24]);
-    const size_t name_len = strlen(APP_NODE_NAME);
-    memcpy(&buffer[41], APP_NODE_NAME, name_len);
-    return 41 + name_len ;
+    canardWriteScalar(writer, 32, &u32);
+    canardWritePadding(writer, 64 + 16);                // Image CRC, hardware version major and minor
+
+    uint8_t unique_id[UNIQUE_ID_LENGTH_BYTES];
+    readUniqueID(unique_id);
+    canardWriteArray(writer, 8, UNIQUE_ID_LENGTH_BYTES, unique_id);
+    canardWritePadding(writer, 8);                      // No certificate of authenticity
+    canardWriteArray(writer, 8, (uint16_t)strlen(APP_NODE_NAME), APP_NODE_NAME);
 }
 
 void readUniqueID(uint8_t* out_uid)
@@ -279,13 +422,8 @@ void readUniqueID(uint8_t* out_uid)
 
 void rawcmdHandleCanard(CanardRxTransfer* transfer)
 {
-    
-    int offset = 0;
-    for (int i = 0; i<6; i++)
-    {
-        if (canardDecodeScalar(transfer, offset, 14, true, &rc_pwm[i])<14) { break; }
-        offset += 14;
-    }
+    // 6 x int14, packed back to back; a short transfer only updates the channels it carries
+    (void)canardDecodeArray(transfer, 0, 14, true, 6, rc_pwm);
    // rcpwmUpdate(ar);
 }
 
@@ -336,61 +474,41 @@ inline param_t * getParamByName(uint8_t * name)
   return NULL;
 }
 
-uint16_t encodeParamCanard(param_t * p, uint8_t * buffer)
+void writeParamCanard(CanardBitWriter* writer, param_t * p)
 {
     uint8_t n     = 0;
-    int offset    = 0;
     uint8_t tag   = 1;
     if(p==NULL)
     {   
         tag = 0;
-        canardEncodeScalar(buffer, offset, 5, &n);
-        offset += 5;
-        canardEncodeScalar(buffer, offset,3, &tag);
-        offset += 3;
-        
-        canardEncodeScalar(buffer, offset, 6, &n);
-        offset += 6;
-        canardEncodeScalar(buffer, offset,2, &tag);
-        offset += 2;
-        
-        canardEncodeScalar(buffer, offset, 6, &n);
-        offset += 6;
-        canardEncodeScalar(buffer, offset, 2, &tag);
-        offset += 2;
-        buffer[offset / 8] = 0;
-        return ( offset / 8 + 1 );
+        canardWriteScalar(writer, 5, &n);
+        canardWriteScalar(writer, 3, &tag);
+
+        canardWriteScalar(writer, 6, &n);
+        canardWriteScalar(writer, 2, &tag);
+
+        canardWriteScalar(writer, 6, &n);
+        canardWriteScalar(writer, 2, &tag);
+        canardWritePadding(writer, 8);
+        return;
     }
-    canardEncodeScalar(buffer, offset, 5,&n);
-    offset += 5;
-    canardEncodeScalar(buffer, offset, 3, &tag);
-    offset += 3;
-    canardEncodeScalar(buffer, offset, 64, &p->val);
-    offset += 64;
-    
-    canardEncodeScalar(buffer, offset, 5, &n);
-    offset += 5;
-    canardEncodeScalar(buffer, offset, 3, &tag);
-    offset += 3;
-    canardEncodeScalar(buffer, offset, 64, &p->defval);
-    offset += 64;
-    
-    canardEncodeScalar(buffer, offset, 6, &n);
-    offset += 6;
-    canardEncodeScalar(buffer, offset, 2, &tag);
-    offset += 2;
-    canardEncodeScalar(buffer, offset, 64, &p->max);
-    offset += 64;
-    
-    canardEncodeScalar(buffer, offset, 6, &n);
-    offset += 6;
-    canardEncodeScalar(buffer, offset,2,&tag);
-    offset += 2;
-    canardEncodeScalar(buffer, offset,64,&p->min);
-    offset += 64;
-    
-    memcpy(&buffer[offset / 8], p->name, strlen((char const*)p->name));
-    return  (offset/8 + strlen((char const*)p->name)); 
+    canardWriteScalar(writer, 5, &n);
+    canardWriteScalar(writer, 3, &tag);
+    canardWriteScalar(writer, 64, &p->val);
+
+    canardWriteScalar(writer, 5, &n);
+    canardWriteScalar(writer, 3, &tag);
+    canardWriteScalar(writer, 64, &p->defval);
+
+    canardWriteScalar(writer, 6, &n);
+    canardWriteScalar(writer, 2, &tag);
+    canardWriteScalar(writer, 64, &p->max);
+
+    canardWriteScalar(writer, 6, &n);
+    canardWriteScalar(writer, 2, &tag);
+    canardWriteScalar(writer, 64, &p->min);
+
+    canardWriteArray(writer, 8, (uint16_t)strlen((char const*)p->name), p->name);
 }
 
 
@@ -436,17 +554,20 @@ void getsetHandleCanard(CanardRxTransfer* transfer)
         p->val = val;
     }
 
-    uint8_t  buffer[64] = "";
-    uint16_t len = encodeParamCanard(p, buffer);
-    int result = canardRequestOrRespond(&g_canard,
-                                        transfer->source_node_id,
-                                        UAVCAN_PROTOCOL_PARAM_GETSET_SIGNATURE,
-                                        UAVCAN_PROTOCOL_PARAM_GETSET_ID,
-                                        &transfer->transfer_id,
-                                        transfer->priority,
-                                        CanardResponse,
-                                        &buffer[0],
-                                        (uint16_t)len);
+    CanardBitWriter writer;
+    if (canardBeginRequestOrRespond(&g_canard,
+                                    &writer,
+                                    transfer->source_node_id,
+                                    UAVCAN_PROTOCOL_PARAM_GETSET_SIGNATURE,
+                                    UAVCAN_PROTOCOL_PARAM_GETSET_ID,
+                                    &transfer->transfer_id,
+                                    transfer->priority,
+                                    CanardResponse) < 0)
+    {
+        return;
+    }
+    writeParamCanard(&writer, p);
+    int result = canardFinishTransfer(&writer);
   
 }
 
@@ -45,6 +45,17 @@
 #define UAVCAN_PROTOCOL_PARAM_GETSET_ID                             11
 #define UAVCAN_PROTOCOL_PARAM_GETSET_SIGNATURE                      0xa7b622f939d1a4d5    
 
+#define CANARD_POOL_STATUS_DATA_TYPE_ID                             20100                //厂商自定义消息，见canard/dsdl
+#define CANARD_POOL_STATUS_DATA_TYPE_SIGNATURE                      0xf720e4c9cf2b53fb
+#define CANARD_POOL_STATUS_MESSAGE_SIZE                             24
+
+#define CANARD_BUS_LOAD_DATA_TYPE_ID                                20101                //厂商自定义消息，见canard/dsdl
+#define CANARD_BUS_LOAD_DATA_TYPE_SIGNATURE                         0xe3c1c64a870692c5
+#define CANARD_BUS_LOAD_MESSAGE_MAX_SIZE                            52                   //列出8个数据类型时的大小
+#define CANARD_BUS_LOAD_MAX_DATA_TYPES                              8
+
+#define CAN_BIT_RATE                                                500000               //总线负载按此位速率计算
+
 
 /*
 #
@@ -86,6 +97,18 @@ void sendCanard(void);
 
 void receiveCanard(void);
 
+#if CANARD_ENABLE_TRACE
+void uavcanTraceDump(void);
+#endif
+
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+void uavcanLatencyDump(void);
+#endif
+
+#if CANARD_ENABLE_PROFILING
+void uavcanProfDump(void);
+#endif
+
 void spinCanard(void);
 
 void publishCanard(void);
@@ -98,12 +121,20 @@ void getsetHandleCanard(CanardRxTransfer* transfer);
 
 void getNodeInfoHandleCanard(CanardRxTransfer* transfer);
 
-uint16_t makeNodeInfoMessage(uint8_t buffer[UAVCAN_GET_NODE_INFO_RESPONSE_MAX_SIZE]);
+void writeNodeInfoMessage(CanardBitWriter* writer);
+
+void writeParamCanard(CanardBitWriter* writer, param_t * p);
 
 void readUniqueID(uint8_t* out_uid);
 
 void makeNodeStatusMessage(uint8_t buffer[UAVCAN_NODE_STATUS_MESSAGE_SIZE]);
 
+void makePoolStatusMessage(uint8_t buffer[CANARD_POOL_STATUS_MESSAGE_SIZE]);
+
+#if CANARD_ENABLE_BUSLOAD
+uint16_t makeBusLoadMessage(uint8_t buffer[CANARD_BUS_LOAD_MESSAGE_MAX_SIZE]);
+#endif
+
 static const uint8_t  sine_wave[256] = 
 {
   0x80, 0x83, 0x86, 0x89, 0x8C, 0x90, 0x93, 0x96,
@@ -4,6 +4,7 @@
 //Ҫõĺͷļ(ûԼ) 
 #include "delay.h"	 	
 #include "sys.h"
+#include "uavcan.h"
 								 
 extern void led_set(u8 sta);
 extern void test_fun(void(*ledset)(u8),u8 sta);										  
@@ -17,6 +18,15 @@ struct _m_usmart_nametab usmart_nametab[]=
 #endif		   
 	(void*)delay_ms,"void delay_ms(u16 nms)",
  	(void*)delay_us,"void delay_us(u32 nus)",	 
+#if CANARD_ENABLE_TRACE
+	(void*)uavcanTraceDump,"void uavcanTraceDump(void)",
+#endif
+#if CANARD_ENABLE_LATENCY_HISTOGRAMS
+	(void*)uavcanLatencyDump,"void uavcanLatencyDump(void)",
+#endif
+#if CANARD_ENABLE_PROFILING
+	(void*)uavcanProfDump,"void uavcanProfDump(void)",
+#endif
 				
 };							  
 ///////////////////////////////////END///////////////////////////////////////////////